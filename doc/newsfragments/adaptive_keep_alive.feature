@@ -0,0 +1 @@
+Pick the keep alive interval and the timeout for detecting a dead connection from the measured round trip time, so dead peers are noticed sooner on wired links and lossy Wi-Fi no longer causes spurious reconnects. Round trip times are reported alongside the input latency.
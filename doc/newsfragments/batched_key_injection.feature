@@ -0,0 +1 @@
+Windows clients inject a key together with its modifier changes and auto-repeats in one SendInput call instead of one call per key event.
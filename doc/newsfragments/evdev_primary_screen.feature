@@ -0,0 +1 @@
+Added an evdev based server screen for Linux that captures keyboards and mice through /dev/input and grabs them while the cursor is on another screen.
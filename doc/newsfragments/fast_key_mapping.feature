@@ -0,0 +1 @@
+Clients inject typed text faster: keys that need no modifier changes are mapped through precompiled lookup tables without allocating or logging, which helps password managers and barcode scanners that type thousands of keys per second.
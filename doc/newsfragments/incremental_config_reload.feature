@@ -0,0 +1 @@
+Reloading the server configuration only applies what changed: clients stay connected unless their screen was removed, and options and hotkeys are only sent again where they changed.
@@ -0,0 +1 @@
+Measure input latency from capture on the server to injection on the client, and show the per-screen percentiles in the GUI status tooltip when running as a service.
@@ -0,0 +1 @@
+Add the `motionDatagrams` server option to send mouse motion to clients as authenticated UDP datagrams, falling back to TCP when datagrams do not get through.
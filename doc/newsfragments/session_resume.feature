@@ -0,0 +1 @@
+Clients resume their session after a short network outage instead of reconnecting from scratch, keeping the active screen and clipboard state.
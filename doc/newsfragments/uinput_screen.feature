@@ -0,0 +1 @@
+Linux clients can run without a display server on a uinput screen, enabled with `INPUTLEAP_BUILD_EVDEV`.
@@ -28,6 +28,8 @@ enum qIpcMessageType {
     kIpcLogLine,
     kIpcCommand,
     kIpcShutdown,
+    kIpcLatency,
+    kIpcLogBatch,
 };
 
 enum qIpcClientType {
@@ -40,3 +42,5 @@ extern const char*        kIpcMsgHello;
 extern const char*        kIpcMsgLogLine;
 extern const char*        kIpcMsgCommand;
 extern const char*        kIpcMsgShutdown;
+extern const char*        kIpcMsgLatency;
+extern const char*        kIpcMsgLogBatch;
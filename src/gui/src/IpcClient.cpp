@@ -38,7 +38,8 @@ m_Enabled(false)
 #endif
 
     m_Reader = new IpcReader(m_Socket);
-    connect(m_Reader, &IpcReader::readLogLine, this, &IpcClient::handleReadLogLine);
+    connect(m_Reader, &IpcReader::readLogLines, this, &IpcClient::handleReadLogLines);
+    connect(m_Reader, &IpcReader::readLatency, this, &IpcClient::readLatency);
 }
 
 IpcClient::~IpcClient()
@@ -47,6 +48,8 @@ IpcClient::~IpcClient()
 
 void IpcClient::connected()
 {
+    // drop anything left over from a previous connection
+    m_Reader->reset();
     sendHello();
     Q_EMIT infoMessage("connection established");
 }
@@ -123,9 +126,9 @@ void IpcClient::sendCommand(const QString& command, ElevateMode const elevate)
     stream.writeRawData(elevateBuf, 1);
 }
 
-void IpcClient::handleReadLogLine(const QString& text)
+void IpcClient::handleReadLogLines(const QStringList& lines)
 {
-    Q_EMIT readLogLine(text);
+    Q_EMIT readLogLines(lines);
 }
 
 // TODO: qt must have a built in way of converting int to bytes.
@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QAbstractSocket>
+#include <QStringList>
 
 #include "ElevateMode.h"
 
@@ -48,10 +49,12 @@ private:
 private slots:
     void connected();
     void error(QAbstractSocket::SocketError error);
-    void handleReadLogLine(const QString& text);
+    void handleReadLogLines(const QStringList& lines);
 
 Q_SIGNALS:
-    void readLogLine(const QString& text);
+    void readLogLines(const QStringList& lines);
+    void readLatency(const QString& screen, const QString& stage, unsigned count,
+                     unsigned p50, unsigned p99, unsigned p999);
     void infoMessage(const QString& text);
     void errorMessage(const QString& text);
 
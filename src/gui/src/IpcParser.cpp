@@ -0,0 +1,187 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IpcParser.h"
+#include "Ipc.h"
+
+#include <cstring>
+
+static quint32 readInt(const char* data)
+{
+    return (static_cast<quint32>(static_cast<unsigned char>(data[0])) << 24) |
+           (static_cast<quint32>(static_cast<unsigned char>(data[1])) << 16) |
+           (static_cast<quint32>(static_cast<unsigned char>(data[2])) << 8) |
+            static_cast<quint32>(static_cast<unsigned char>(data[3]));
+}
+
+bool IpcParser::parse(const QByteArray& data)
+{
+    m_Buffer.append(data);
+
+    // don't look at a message again until all of it is here
+    while (m_Buffer.size() - m_Offset >= m_Need) {
+        Status status = parseMessage();
+        if (status == Status::Invalid) {
+            reset();
+            return false;
+        }
+        if (status == Status::NeedMore) {
+            break;
+        }
+        m_Need = 0;
+    }
+
+    if (m_Offset > 0) {
+        m_Buffer.remove(0, m_Offset);
+        m_Offset = 0;
+    }
+    return true;
+}
+
+QStringList IpcParser::takeLogLines()
+{
+    QStringList lines;
+    lines.swap(m_LogLines);
+    return lines;
+}
+
+QList<IpcLatency> IpcParser::takeLatencies()
+{
+    QList<IpcLatency> latencies;
+    latencies.swap(m_Latencies);
+    return latencies;
+}
+
+void IpcParser::reset()
+{
+    m_Buffer.clear();
+    m_Offset = 0;
+    m_Need = 0;
+    m_HaveSequence = false;
+}
+
+IpcParser::Status IpcParser::parseMessage()
+{
+    const char* data = m_Buffer.constData() + m_Offset;
+    const int size = m_Buffer.size() - m_Offset;
+
+    // reads a length at offset, which must be available.  sets need to
+    // the size of the message up to the end of what it counts.
+    auto readLength = [&](int offset, int& need) {
+        quint32 length = readInt(data + offset);
+        if (length > static_cast<quint32>(kMaxMessageSize)) {
+            return -1;
+        }
+        need = offset + 4 + static_cast<int>(length);
+        return static_cast<int>(length);
+    };
+
+    if (size < 4) {
+        m_Need = 4;
+        return Status::NeedMore;
+    }
+
+    const bool isLogLine = memcmp(data, kIpcMsgLogLine, 4) == 0;
+    if (isLogLine || memcmp(data, kIpcMsgLogBatch, 4) == 0) {
+        if (size < 8) {
+            m_Need = 8;
+            return Status::NeedMore;
+        }
+        int length = readLength(4, m_Need);
+        if (length < 0) {
+            return Status::Invalid;
+        }
+        if (size < m_Need) {
+            return Status::NeedMore;
+        }
+
+        if (isLogLine) {
+            m_LogLines.append(QString::fromUtf8(data + 8, length));
+        }
+        else if (!parseLogRecords(data + 8, length)) {
+            return Status::Invalid;
+        }
+    }
+    else if (memcmp(data, kIpcMsgLatency, 4) == 0) {
+        // two strings followed by four integers
+        int screenLength = 0;
+        int stageLength = 0;
+        if (size < 8) {
+            m_Need = 8;
+            return Status::NeedMore;
+        }
+        screenLength = readLength(4, m_Need);
+        if (screenLength < 0) {
+            return Status::Invalid;
+        }
+        m_Need += 4;
+        if (size < m_Need) {
+            return Status::NeedMore;
+        }
+        int stageOffset = m_Need - 4;
+        stageLength = readLength(stageOffset, m_Need);
+        if (stageLength < 0) {
+            return Status::Invalid;
+        }
+        m_Need += 16;
+        if (size < m_Need) {
+            return Status::NeedMore;
+        }
+
+        const char* values = data + stageOffset + 4 + stageLength;
+        IpcLatency latency;
+        latency.screen = QString::fromUtf8(data + 8, screenLength);
+        latency.stage = QString::fromUtf8(data + stageOffset + 4, stageLength);
+        latency.count = readInt(values);
+        latency.p50 = readInt(values + 4);
+        latency.p99 = readInt(values + 8);
+        latency.p999 = readInt(values + 12);
+        m_Latencies.append(latency);
+    }
+    else {
+        return Status::Invalid;
+    }
+
+    m_Offset += m_Need;
+    return Status::Parsed;
+}
+
+bool IpcParser::parseLogRecords(const char* data, int size)
+{
+    // each record is a sequence number and a length followed by the line
+    int offset = 0;
+    while (offset < size) {
+        if (size - offset < 8) {
+            return false;
+        }
+        quint32 sequence = readInt(data + offset);
+        quint32 length = readInt(data + offset + 4);
+        offset += 8;
+        if (length > static_cast<quint32>(size - offset)) {
+            return false;
+        }
+
+        if (m_HaveSequence && sequence != m_NextSequence) {
+            m_LogLines.append(QString("[%1 log lines dropped]").arg(sequence - m_NextSequence));
+        }
+        m_HaveSequence = true;
+        m_NextSequence = sequence + 1;
+
+        m_LogLines.append(QString::fromUtf8(data + offset, static_cast<int>(length)));
+        offset += static_cast<int>(length);
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+//! Latency percentiles reported by input-leaps/c
+struct IpcLatency
+{
+    QString screen;
+    QString stage;
+    unsigned count = 0;
+    unsigned p50 = 0;
+    unsigned p99 = 0;
+    unsigned p999 = 0;
+};
+
+//! Incremental parser of the messages the daemon sends to the GUI
+/*!
+Bytes are fed in as they arrive and complete messages are parsed out of
+them.  A message split over several reads is kept until the rest of it
+arrives, so the parser never has to wait for data.
+*/
+class IpcParser
+{
+public:
+    //! Add received bytes
+    /*!
+    Parses every message completed by \p data.  Returns false if the
+    data is invalid, in which case everything received so far is thrown
+    away.
+    */
+    bool parse(const QByteArray& data);
+
+    //! Take the log lines parsed so far
+    QStringList takeLogLines();
+
+    //! Take the latencies parsed so far
+    QList<IpcLatency> takeLatencies();
+
+    //! Forget any partial message and the last sequence number
+    void reset();
+
+private:
+    enum class Status { Parsed, NeedMore, Invalid };
+
+    Status parseMessage();
+    bool parseLogRecords(const char* data, int size);
+
+    // largest message accepted, far above what the daemon sends
+    static const int kMaxMessageSize = 16 * 1024 * 1024;
+
+    QByteArray m_Buffer;
+    int m_Offset = 0;
+    // bytes from m_Offset needed before trying to parse again
+    int m_Need = 0;
+    bool m_HaveSequence = false;
+    quint32 m_NextSequence = 0;
+    QStringList m_LogLines;
+    QList<IpcLatency> m_Latencies;
+};
@@ -22,7 +22,6 @@
 #include "IpcReader.h"
 #include <QTcpSocket>
 #include "Ipc.h"
-#include <QMutex>
 #include <QByteArray>
 
 #ifdef INPUTLEAP_IPC_VERBOSE
@@ -51,90 +50,30 @@ void IpcReader::stop()
     disconnect(m_Socket, &QTcpSocket::readyRead, this, &IpcReader::read);
 }
 
-void IpcReader::read()
+void IpcReader::reset()
 {
-    QMutexLocker locker(&m_Mutex);
-    IPC_LOG(std::cout << "ready read" << std::endl);
-
-    while (m_Socket->bytesAvailable()) {
-        IPC_LOG(std::cout << "bytes available" << std::endl);
-
-        char codeBuf[5];
-        readStream(codeBuf, 4);
-        codeBuf[4] = 0;
-        IPC_LOG(std::cout << "ipc read: " << codeBuf << std::endl);
-
-        if (memcmp(codeBuf, kIpcMsgLogLine, 4) == 0) {
-            IPC_LOG(std::cout << "reading log line" << std::endl);
-
-            char lenBuf[4];
-            readStream(lenBuf, 4);
-            int len = bytesToInt(lenBuf, 4);
-
-            char* data = new char[len];
-            readStream(data, len);
-            QString line = QString::fromUtf8(data, len);
-            delete[] data;
-
-            Q_EMIT readLogLine(line);
-        }
-        else {
-            IPC_LOG(std::cerr << "aborting, message invalid" << std::endl);
-            return;
-        }
-    }
-
-    IPC_LOG(std::cout << "read done" << std::endl);
+    m_Parser.reset();
 }
 
-bool IpcReader::readStream(char* buffer, int length)
+void IpcReader::read()
 {
-    IPC_LOG(std::cout << "reading stream" << std::endl);
-
-    int read = 0;
-    while (read < length) {
-        int ask = length - read;
-        if (m_Socket->bytesAvailable() < ask) {
-            IPC_LOG(std::cout << "buffer too short, waiting" << std::endl);
-            m_Socket->waitForReadyRead(-1);
-        }
-
-        int got = m_Socket->read(buffer, ask);
-        read += got;
-
-        IPC_LOG(std::cout << "> ask=" << ask << " got=" << got
-            << " read=" << read << std::endl);
+    IPC_LOG(std::cout << "ready read" << std::endl);
 
-        if (got == -1) {
-            IPC_LOG(std::cout << "socket ended, aborting" << std::endl);
-            return false;
-        }
-        else if (length - read > 0) {
-            IPC_LOG(std::cout << "more remains, seek to " << got << std::endl);
-            buffer += got;
-        }
+    // only take what has already arrived, a message split across reads is
+    // finished by a later readyRead instead of blocking the event loop
+    if (!m_Parser.parse(m_Socket->readAll())) {
+        IPC_LOG(std::cerr << "aborting, message invalid" << std::endl);
     }
-    return true;
-}
 
-int IpcReader::bytesToInt(const char *buffer, int size)
-{
-    if (size == 1) {
-        return static_cast<unsigned char>(buffer[0]);
+    QStringList lines = m_Parser.takeLogLines();
+    if (!lines.isEmpty()) {
+        Q_EMIT readLogLines(lines);
     }
-    else if (size == 2) {
-        return
-            ((static_cast<unsigned char>(buffer[0])) << 8) +
-              static_cast<unsigned char>(buffer[1]);
-    }
-    else if (size == 4) {
-        return
-            ((static_cast<unsigned char>(buffer[0])) << 24) +
-            ((static_cast<unsigned char>(buffer[1])) << 16) +
-            ((static_cast<unsigned char>(buffer[2])) << 8) +
-              static_cast<unsigned char>(buffer[3]);
-    }
-    else {
-        return 0;
+
+    for (const IpcLatency& latency : m_Parser.takeLatencies()) {
+        Q_EMIT readLatency(latency.screen, latency.stage, latency.count,
+                           latency.p50, latency.p99, latency.p999);
     }
+
+    IPC_LOG(std::cout << "read done" << std::endl);
 }
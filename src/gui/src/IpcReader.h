@@ -19,9 +19,12 @@
 #pragma once
 
 #include <QObject>
-#include <QMutex>
+#include <QStringList>
+
+#include "IpcParser.h"
 
 class QTcpSocket;
+class QByteArray;
 
 class IpcReader : public QObject
 {
@@ -32,18 +35,17 @@ public:
     virtual ~IpcReader();
     void start();
     void stop();
+    void reset();
 
 Q_SIGNALS:
-    void readLogLine(const QString& text);
-
-private:
-    bool readStream(char* buffer, int length);
-    int bytesToInt(const char* buffer, int size);
+    void readLogLines(const QStringList& lines);
+    void readLatency(const QString& screen, const QString& stage, unsigned count,
+                     unsigned p50, unsigned p99, unsigned p999);
 
 private slots:
     void read();
 
 private:
     QTcpSocket* m_Socket;
-    QMutex m_Mutex;
+    IpcParser m_Parser;
 };
@@ -0,0 +1,93 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LogModel.h"
+
+#include <algorithm>
+
+LogModel::LogModel(QObject* parent, int maxLines) :
+    QAbstractListModel(parent),
+    max_lines_{maxLines > 0 ? maxLines : 1}
+{
+}
+
+void LogModel::appendLines(const QStringList& entries)
+{
+    // every row is one line high, so an entry spanning several lines (a
+    // stack trace, a config dump) takes a row per line like it did in the
+    // plain text view
+    QStringList lines;
+    lines.reserve(entries.size());
+    for (const QString& entry : entries) {
+        if (!entry.contains('\n')) {
+            lines.append(entry);
+            continue;
+        }
+        for (QString line : entry.split('\n')) {
+            if (line.endsWith('\r')) {
+                line.chop(1);
+            }
+            lines.append(line);
+        }
+    }
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    // lines that wouldn't survive this append are never added
+    int first = std::max(0, static_cast<int>(lines.size()) - max_lines_);
+    int count = static_cast<int>(lines.size()) - first;
+
+    int excess = rowCount() + count - max_lines_;
+    if (excess > 0) {
+        beginRemoveRows(QModelIndex(), 0, excess - 1);
+        lines_.erase(lines_.begin(), lines_.begin() + excess);
+        endRemoveRows();
+    }
+
+    int row = rowCount();
+    beginInsertRows(QModelIndex(), row, row + count - 1);
+    for (int i = first; i < lines.size(); ++i) {
+        lines_.push_back(lines[i]);
+    }
+    endInsertRows();
+}
+
+void LogModel::clear()
+{
+    beginResetModel();
+    lines_.clear();
+    endResetModel();
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(lines_.size());
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (role == Qt::DisplayRole) {
+        return line(index.row());
+    }
+    return QVariant();
+}
@@ -0,0 +1,60 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+#include <deque>
+
+//! Log lines shown by the log window
+/*!
+Keeps at most a fixed number of lines, dropping the oldest ones as new ones
+are appended, so that a long running session with debug logging doesn't
+grow without bound.  Lines are only turned into text for the view when they
+are displayed.
+*/
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static const int kDefaultMaxLines = 100000;
+
+    explicit LogModel(QObject* parent = nullptr, int maxLines = kDefaultMaxLines);
+
+    //! Append log entries, dropping the oldest lines if there are too many
+    /*!
+    Entries that span several lines are split into a row per line.
+    */
+    void appendLines(const QStringList& entries);
+
+    //! Remove all lines
+    void clear();
+
+    //! Return the line at \p row
+    const QString& line(int row) const { return lines_[static_cast<std::size_t>(row)]; }
+
+    int maxLines() const { return max_lines_; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    std::deque<QString> lines_;
+    int max_lines_;
+};
@@ -17,16 +17,23 @@
 
 #include "LogWindow.h"
 #include "ui_LogWindow.h"
+#include "LogModel.h"
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
 #include <QDateTime>
+#include <QScrollBar>
+#include <QSortFilterProxyModel>
 
 #include <QTimer>
 
+#include <algorithm>
+
 #define LOGWINDOW_REFRESH_MSECS 100
 
-static const QString s_error_line = QStringLiteral("%1 ERROR: %2\n");
-static const QString s_info_line = QStringLiteral("%1 INFO: %2\n");
-static const QString s_debug_line = QStringLiteral("%1 DEBUG: %2\n");
-static const QString s_text_line = QStringLiteral("%1\n");
+static const QString s_error_line = QStringLiteral("%1 ERROR: %2");
+static const QString s_info_line = QStringLiteral("%1 INFO: %2");
+static const QString s_debug_line = QStringLiteral("%1 DEBUG: %2");
 
 static QString getTimeStamp()
 {
@@ -36,16 +43,26 @@ static QString getTimeStamp()
 
 LogWindow::LogWindow(QWidget *parent) :
     QDialog(parent),
-    ui_{std::make_unique<Ui::LogWindow>()}
+    ui_{std::make_unique<Ui::LogWindow>()},
+    model_{new LogModel(this)},
+    filter_{new QSortFilterProxyModel(this)}
 {
     // explicitly unset DeleteOnClose so the log window can be show and hidden
     // repeatedly until InputLeap is finished
     setAttribute(Qt::WA_DeleteOnClose, false);
     ui_->setupUi(this);
 
-    // purge old log entries from the log window once 10,000 lines have been reached.
-    // This caps the memory use around 40 to 50MB
-    ui_->m_pLogOutput->setMaximumBlockCount(10000);
+    // the model drops the oldest lines once it's full and the view only
+    // lays out the rows that are visible, so a long session stays cheap
+    filter_->setSourceModel(model_);
+    filter_->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    ui_->m_pLogOutput->setModel(filter_);
+
+    QAction* copy = new QAction(tr("&Copy"), ui_->m_pLogOutput);
+    copy->setShortcut(QKeySequence::Copy);
+    copy->setShortcutContext(Qt::WidgetShortcut);
+    connect(copy, &QAction::triggered, this, &LogWindow::copySelection);
+    ui_->m_pLogOutput->addAction(copy);
 
     // Use a timer to flush the buffer every 100 milliseconds
     QTimer* timer = new QTimer(this);
@@ -56,7 +73,7 @@ LogWindow::LogWindow(QWidget *parent) :
 void LogWindow::startNewInstance()
 {
     // put a space between last log output and new instance.
-    if (!buffer_.isEmpty())
+    if (!buffer_.isEmpty() || model_->rowCount() > 0)
         appendRaw("");
 }
 
@@ -77,15 +94,22 @@ void LogWindow::appendError(const QString& text)
 
 void LogWindow::appendRaw(const QString& text)
 {
-    buffer_.append(s_text_line.arg(text));
+    buffer_.append(text);
 }
 
 void LogWindow::flushBuffer()
 {
     if (!buffer_.isEmpty()) {
-        // Insert the new log content from the buffer
-        ui_->m_pLogOutput->appendPlainText(buffer_);
+        // only follow the new lines if the user hasn't scrolled away
+        QScrollBar* scrollBar = ui_->m_pLogOutput->verticalScrollBar();
+        bool atBottom = scrollBar->value() == scrollBar->maximum();
+
+        model_->appendLines(buffer_);
         buffer_.clear();
+
+        if (atBottom) {
+            ui_->m_pLogOutput->scrollToBottom();
+        }
     }
 }
 
@@ -96,7 +120,50 @@ void LogWindow::on_m_pButtonHide_clicked()
 
 void LogWindow::on_m_pButtonClearLog_clicked()
 {
-    ui_->m_pLogOutput->clear();
+    buffer_.clear();
+    model_->clear();
+}
+
+void LogWindow::on_m_pEditFilter_textChanged(const QString& text)
+{
+    filter_->setFilterFixedString(text);
+    ui_->m_pLogOutput->scrollToBottom();
+}
+
+void LogWindow::on_m_pEditFind_returnPressed()
+{
+    const QString text = ui_->m_pEditFind->text();
+    const int rows = filter_->rowCount();
+    if (text.isEmpty() || rows == 0) {
+        return;
+    }
+
+    // search forward from the current line, wrapping around at the end
+    QModelIndex current = ui_->m_pLogOutput->currentIndex();
+    int start = current.isValid() ? current.row() + 1 : 0;
+    for (int i = 0; i < rows; ++i) {
+        QModelIndex index = filter_->index((start + i) % rows, 0);
+        if (filter_->data(index).toString().contains(text, Qt::CaseInsensitive)) {
+            ui_->m_pLogOutput->setCurrentIndex(index);
+            ui_->m_pLogOutput->scrollTo(index, QAbstractItemView::PositionAtCenter);
+            return;
+        }
+    }
+}
+
+void LogWindow::copySelection()
+{
+    QModelIndexList selected = ui_->m_pLogOutput->selectionModel()->selectedRows();
+    if (selected.isEmpty()) {
+        return;
+    }
+    std::sort(selected.begin(), selected.end());
+
+    QStringList lines;
+    for (const QModelIndex& index : selected) {
+        lines.append(filter_->data(index).toString());
+    }
+    QApplication::clipboard()->setText(lines.join('\n'));
 }
 
 LogWindow::~LogWindow() = default;
@@ -18,8 +18,12 @@
 #pragma once
 
 #include <QDialog>
+#include <QStringList>
 #include <memory>
 
+class LogModel;
+class QSortFilterProxyModel;
+
 namespace Ui
 {
     class LogWindow;
@@ -43,9 +47,14 @@ class LogWindow : public QDialog
     private slots:
         void on_m_pButtonHide_clicked();
         void on_m_pButtonClearLog_clicked();
+        void on_m_pEditFilter_textChanged(const QString& text);
+        void on_m_pEditFind_returnPressed();
+        void copySelection();
 
     private:
         std::unique_ptr<Ui::LogWindow> ui_;
-        QString buffer_;
+        LogModel* model_;
+        QSortFilterProxyModel* filter_;
+        QStringList buffer_;
         void flushBuffer();
 };
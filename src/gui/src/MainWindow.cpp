@@ -153,9 +153,10 @@ MainWindow::MainWindow(QSettings& settings, AppConfig& appConfig) :
 
 #if defined(Q_OS_WIN)
     // ipc must always be enabled, so that we can disable command when switching to desktop mode.
-    connect(&m_IpcClient, &IpcClient::readLogLine, this, &MainWindow::appendLogRaw);
+    connect(&m_IpcClient, &IpcClient::readLogLines, this, &MainWindow::appendLogLines);
     connect(&m_IpcClient, &IpcClient::errorMessage, this, &MainWindow::appendLogError);
     connect(&m_IpcClient, &IpcClient::infoMessage, this, &MainWindow::appendLogInfo);
+    connect(&m_IpcClient, &IpcClient::readLatency, this, &MainWindow::updateLatency);
     m_IpcClient.connectToHost();
 #endif
 
@@ -248,6 +249,19 @@ void MainWindow::setStatus(const QString &status)
     ui_->m_pStatusLabel->setText(status);
 }
 
+void MainWindow::updateLatency(const QString& screen, const QString& stage, unsigned count,
+                               unsigned p50, unsigned p99, unsigned p999)
+{
+    m_Latency[screen + " " + stage] =
+        tr("%1 %2: p50 %3 ms, p99 %4 ms, p99.9 %5 ms (%6 samples)")
+            .arg(screen).arg(stage)
+            .arg(p50 / 1000.0, 0, 'f', 1).arg(p99 / 1000.0, 0, 'f', 1)
+            .arg(p999 / 1000.0, 0, 'f', 1).arg(count);
+
+    QStringList lines = m_Latency.values();
+    ui_->m_pStatusLabel->setToolTip(tr("Input latency:\n%1").arg(lines.join("\n")));
+}
+
 void MainWindow::createTrayIcon()
 {
     m_pTrayIconMenu = new QMenu(this);
@@ -447,6 +461,13 @@ void MainWindow::appendLogRaw(const QString& text)
     }
 }
 
+void MainWindow::appendLogLines(const QStringList& lines)
+{
+    for (const auto& line : lines) {
+        appendLogRaw(line);
+    }
+}
+
 void MainWindow::updateFromLogLine(const QString &line)
 {
     // TODO: this code makes Andrew cry
@@ -703,7 +724,14 @@ bool MainWindow::clientArgs(QStringList& args, QString& app)
     // use line edit host name if it is not empty
     if (ui_->m_pCheckBoxAutoConfig->isChecked()) {
         if (ui_->m_pComboServerList->count() != 0) {
+            // the other servers found are standbys in case this one goes away
             QString serverIp = ui_->m_pComboServerList->currentText();
+            for (int i = 0; i < ui_->m_pComboServerList->count(); i++) {
+                QString standbyIp = ui_->m_pComboServerList->itemText(i);
+                if (standbyIp != serverIp) {
+                    args << "--standby" << "[" + standbyIp + "]:" + QString::number(appConfig().port());
+                }
+            }
             args << "[" + serverIp + "]:" + QString::number(appConfig().port());
             return true;
         }
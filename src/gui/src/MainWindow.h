@@ -35,6 +35,7 @@
 #include "Ipc.h"
 #include "LogWindow.h"
 
+#include <QMap>
 #include <QMutex>
 #include <memory>
 
@@ -108,11 +109,14 @@ class MainWindow : public QMainWindow
 
 public slots:
         void appendLogRaw(const QString& text);
+        void appendLogLines(const QStringList& lines);
         void appendLogInfo(const QString& text);
         void appendLogDebug(const QString& text);
         void appendLogError(const QString& text);
         void start_cmd_app();
         void setServerMode(bool isServerMode);
+        void updateLatency(const QString& screen, const QString& stage, unsigned count,
+                           unsigned p50, unsigned p99, unsigned p999);
 
     protected slots:
         void on_m_pGroupClient_toggled(bool on);
@@ -193,6 +197,7 @@ public slots:
         SslCertificate* m_pSslCertificate;
         QStringList m_PendingClientNames;
         LogWindow *m_pLogWindow;
+        QMap<QString, QString> m_Latency;
 
         bool m_fingerprint_expanded = false;
 
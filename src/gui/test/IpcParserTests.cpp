@@ -0,0 +1,125 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../src/IpcParser.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+QByteArray intBytes(quint32 value)
+{
+    QByteArray bytes;
+    bytes.append(static_cast<char>((value >> 24) & 0xff));
+    bytes.append(static_cast<char>((value >> 16) & 0xff));
+    bytes.append(static_cast<char>((value >> 8) & 0xff));
+    bytes.append(static_cast<char>(value & 0xff));
+    return bytes;
+}
+
+QByteArray logLine(const QByteArray& text)
+{
+    return "ILOG" + intBytes(text.size()) + text;
+}
+
+QByteArray logRecord(quint32 sequence, const QByteArray& text)
+{
+    return intBytes(sequence) + intBytes(text.size()) + text;
+}
+
+QByteArray logBatch(const QByteArray& records)
+{
+    return "ILGB" + intBytes(records.size()) + records;
+}
+
+} // namespace
+
+TEST(IpcParserTests, parsesLogLines)
+{
+    IpcParser parser;
+    ASSERT_TRUE(parser.parse(logLine("first") + logLine("second")));
+
+    QStringList lines = parser.takeLogLines();
+    ASSERT_EQ(lines.size(), 2);
+    ASSERT_EQ(lines[0], QString("first"));
+    ASSERT_EQ(lines[1], QString("second"));
+    ASSERT_TRUE(parser.takeLogLines().isEmpty());
+}
+
+TEST(IpcParserTests, resumesMessagesSplitAtEveryByte)
+{
+    QByteArray data = logLine("hello") + logBatch(logRecord(7, "batched")) +
+                      "ILAT" + intBytes(6) + "client" + intBytes(4) + "hook" +
+                      intBytes(3) + intBytes(10) + intBytes(20) + intBytes(30);
+
+    IpcParser parser;
+    for (int i = 0; i < data.size(); ++i) {
+        ASSERT_TRUE(parser.parse(data.mid(i, 1)));
+    }
+
+    QStringList lines = parser.takeLogLines();
+    ASSERT_EQ(lines.size(), 2);
+    ASSERT_EQ(lines[0], QString("hello"));
+    ASSERT_EQ(lines[1], QString("batched"));
+
+    QList<IpcLatency> latencies = parser.takeLatencies();
+    ASSERT_EQ(latencies.size(), 1);
+    ASSERT_EQ(latencies[0].screen, QString("client"));
+    ASSERT_EQ(latencies[0].stage, QString("hook"));
+    ASSERT_EQ(latencies[0].count, 3u);
+    ASSERT_EQ(latencies[0].p50, 10u);
+    ASSERT_EQ(latencies[0].p99, 20u);
+    ASSERT_EQ(latencies[0].p999, 30u);
+}
+
+TEST(IpcParserTests, keepsPartialMessageUntilComplete)
+{
+    QByteArray data = logLine("complete") + logLine("partial");
+
+    IpcParser parser;
+    ASSERT_TRUE(parser.parse(data.left(data.size() - 3)));
+    QStringList lines = parser.takeLogLines();
+    ASSERT_EQ(lines.size(), 1);
+    ASSERT_EQ(lines[0], QString("complete"));
+
+    ASSERT_TRUE(parser.parse(data.right(3)));
+    lines = parser.takeLogLines();
+    ASSERT_EQ(lines.size(), 1);
+    ASSERT_EQ(lines[0], QString("partial"));
+}
+
+TEST(IpcParserTests, reportsDroppedBatchRecords)
+{
+    IpcParser parser;
+    ASSERT_TRUE(parser.parse(logBatch(logRecord(1, "a") + logRecord(2, "b"))));
+    ASSERT_TRUE(parser.parse(logBatch(logRecord(5, "c"))));
+
+    QStringList lines = parser.takeLogLines();
+    ASSERT_EQ(lines.size(), 4);
+    ASSERT_EQ(lines[2], QString("[2 log lines dropped]"));
+    ASSERT_EQ(lines[3], QString("c"));
+}
+
+TEST(IpcParserTests, rejectsUnknownMessage)
+{
+    IpcParser parser;
+    ASSERT_FALSE(parser.parse("XXXXjunk"));
+
+    // the parser starts over with the next data
+    ASSERT_TRUE(parser.parse(logLine("after")));
+    QStringList lines = parser.takeLogLines();
+    ASSERT_EQ(lines.size(), 1);
+    ASSERT_EQ(lines[0], QString("after"));
+}
@@ -0,0 +1,83 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../src/LogModel.h"
+#include <gtest/gtest.h>
+
+TEST(LogModelTests, appendsLines)
+{
+    LogModel model(nullptr, 10);
+    model.appendLines({"a", "b"});
+    model.appendLines({"c"});
+
+    ASSERT_EQ(model.rowCount(), 3);
+    ASSERT_EQ(model.data(model.index(0)).toString(), QString("a"));
+    ASSERT_EQ(model.data(model.index(2)).toString(), QString("c"));
+}
+
+TEST(LogModelTests, dropsOldestLinesWhenFull)
+{
+    LogModel model(nullptr, 3);
+    model.appendLines({"a", "b"});
+    model.appendLines({"c", "d"});
+
+    ASSERT_EQ(model.rowCount(), 3);
+    ASSERT_EQ(model.line(0), QString("b"));
+    ASSERT_EQ(model.line(2), QString("d"));
+}
+
+TEST(LogModelTests, keepsTailOfOversizedBatch)
+{
+    LogModel model(nullptr, 2);
+    model.appendLines({"a"});
+    model.appendLines({"b", "c", "d"});
+
+    ASSERT_EQ(model.rowCount(), 2);
+    ASSERT_EQ(model.line(0), QString("c"));
+    ASSERT_EQ(model.line(1), QString("d"));
+}
+
+TEST(LogModelTests, splitsMultiLineEntries)
+{
+    LogModel model(nullptr, 10);
+    model.appendLines({"a", "trace:\n  one\r\n  two", "b"});
+
+    ASSERT_EQ(model.rowCount(), 5);
+    ASSERT_EQ(model.line(1), QString("trace:"));
+    ASSERT_EQ(model.line(2), QString("  one"));
+    ASSERT_EQ(model.line(3), QString("  two"));
+    ASSERT_EQ(model.line(4), QString("b"));
+}
+
+TEST(LogModelTests, capCountsSplitLines)
+{
+    LogModel model(nullptr, 2);
+    model.appendLines({"a\nb\nc"});
+
+    ASSERT_EQ(model.rowCount(), 2);
+    ASSERT_EQ(model.line(0), QString("b"));
+    ASSERT_EQ(model.line(1), QString("c"));
+}
+
+TEST(LogModelTests, clearRemovesAllLines)
+{
+    LogModel model(nullptr, 10);
+    model.appendLines({"a", "b"});
+    model.clear();
+
+    ASSERT_EQ(model.rowCount(), 0);
+    ASSERT_FALSE(model.data(model.index(0)).isValid());
+}
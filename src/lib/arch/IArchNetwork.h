@@ -19,6 +19,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace inputleap {
 
@@ -217,6 +218,27 @@ public:
     virtual size_t writeSocket(ArchSocket s,
                             const void* buf, size_t len) = 0;
 
+    //! Read a datagram from socket
+    /*!
+    Read one datagram of up to \c len bytes from socket \c s into \c buf
+    and return the number of bytes read, or 0 if no datagram is queued.
+    If \c addr isn't \c nullptr it's set to a new address for the sender,
+    which the caller must release with \c closeAddr().  It's set to
+    \c nullptr if nothing was read.
+    */
+    virtual size_t readFromSocket(ArchSocket s, void* buf, size_t len,
+                            ArchNetAddress* addr) = 0;
+
+    //! Write a datagram to socket
+    /*!
+    Send \c len bytes from \c buf as one datagram on socket \c s to
+    \c addr and return the number of bytes written.  Returns 0 if the
+    datagram could not be queued without blocking;  datagrams are never
+    partially written.
+    */
+    virtual size_t writeToSocket(ArchSocket s, const void* buf, size_t len,
+                            ArchNetAddress addr) = 0;
+
     //! Check error on socket
     /*!
     If the socket \c s is in an error state then throws an appropriate
@@ -250,6 +272,14 @@ public:
     //! Convert a name to a network address
     virtual ArchNetAddress nameToAddr(const std::string&) = 0;
 
+    //! Convert a name to all of its network addresses
+    /*!
+    Returns every address the name resolves to, in the order the resolver
+    prefers them.  Each address must be destroyed with \c closeAddr().
+    Throws the same exceptions as \c nameToAddr().
+    */
+    virtual std::vector<ArchNetAddress> nameToAddrs(const std::string&) = 0;
+
     //! Destroy a network address
     virtual void closeAddr(ArchNetAddress) = 0;
 
@@ -51,8 +51,10 @@ static int (PASCAL FAR *ioctl_winsock)(SOCKET s, int cmd, void FAR * data);
 static int (PASCAL FAR *listen_winsock)(SOCKET s, int backlog);
 static u_short (PASCAL FAR *ntohs_winsock)(u_short v);
 static int (PASCAL FAR *recv_winsock)(SOCKET s, void FAR * buf, int len, int flags);
+static int (PASCAL FAR *recvfrom_winsock)(SOCKET s, void FAR * buf, int len, int flags, struct sockaddr FAR *from, int FAR *fromlen);
 static int (PASCAL FAR *select_winsock)(int nfds, fd_set FAR *readfds, fd_set FAR *writefds, fd_set FAR *exceptfds, const struct timeval FAR *timeout);
 static int (PASCAL FAR *send_winsock)(SOCKET s, const void FAR * buf, int len, int flags);
+static int (PASCAL FAR *sendto_winsock)(SOCKET s, const void FAR * buf, int len, int flags, const struct sockaddr FAR *to, int tolen);
 static int (PASCAL FAR *setsockopt_winsock)(SOCKET s, int level, int optname, const void FAR * optval, int optlen);
 static int (PASCAL FAR *shutdown_winsock)(SOCKET s, int how);
 static SOCKET (PASCAL FAR *socket_winsock)(int af, int type, int protocol);
@@ -178,8 +180,10 @@ ArchNetworkWinsock::initModule(HMODULE module)
     setfunc(listen_winsock, listen, int (PASCAL FAR *)(SOCKET s, int backlog));
     setfunc(ntohs_winsock, ntohs, u_short (PASCAL FAR *)(u_short v));
     setfunc(recv_winsock, recv, int (PASCAL FAR *)(SOCKET s, void FAR * buf, int len, int flags));
+    setfunc(recvfrom_winsock, recvfrom, int (PASCAL FAR *)(SOCKET s, void FAR * buf, int len, int flags, struct sockaddr FAR *from, int FAR *fromlen));
     setfunc(select_winsock, select, int (PASCAL FAR *)(int nfds, fd_set FAR *readfds, fd_set FAR *writefds, fd_set FAR *exceptfds, const struct timeval FAR *timeout));
     setfunc(send_winsock, send, int (PASCAL FAR *)(SOCKET s, const void FAR * buf, int len, int flags));
+    setfunc(sendto_winsock, sendto, int (PASCAL FAR *)(SOCKET s, const void FAR * buf, int len, int flags, const struct sockaddr FAR *to, int tolen));
     setfunc(setsockopt_winsock, setsockopt, int (PASCAL FAR *)(SOCKET s, int level, int optname, const void FAR * optval, int optlen));
     setfunc(shutdown_winsock, shutdown, int (PASCAL FAR *)(SOCKET s, int how));
     setfunc(socket_winsock, socket, SOCKET (PASCAL FAR *)(int af, int type, int protocol));
@@ -582,6 +586,58 @@ ArchNetworkWinsock::writeSocket(ArchSocket s, const void* buf, size_t len)
     return static_cast<size_t>(n);
 }
 
+size_t
+ArchNetworkWinsock::readFromSocket(ArchSocket s, void* buf, size_t len,
+                            ArchNetAddress* addr)
+{
+    assert(s != nullptr);
+
+    if (addr != nullptr) {
+        *addr = nullptr;
+    }
+
+    ArchNetAddress tmp = ArchNetAddressImpl::alloc(sizeof(struct sockaddr_in6));
+    int n = recvfrom_winsock(s->m_socket, buf, (int)len, 0,
+                            TYPED_ADDR(struct sockaddr, tmp), &tmp->m_len);
+    if (n == SOCKET_ERROR) {
+        int err = getsockerror_winsock();
+        free(tmp);
+        // a datagram larger than the buffer is discarded by the stack and
+        // an ICMP port unreachable for an earlier send shows up as a reset;
+        // neither is fatal for a connectionless socket.
+        if (err == WSAEINTR || err == WSAEWOULDBLOCK ||
+            err == WSAEMSGSIZE || err == WSAECONNRESET) {
+            return 0;
+        }
+        throwError(err);
+    }
+
+    if (addr != nullptr && n > 0) {
+        *addr = ARCH->copyAddr(tmp);
+    }
+    free(tmp);
+    return static_cast<size_t>(n);
+}
+
+size_t
+ArchNetworkWinsock::writeToSocket(ArchSocket s, const void* buf, size_t len,
+                            ArchNetAddress addr)
+{
+    assert(s != nullptr);
+    assert(addr != nullptr);
+
+    int n = sendto_winsock(s->m_socket, buf, (int)len, 0,
+                            TYPED_ADDR(struct sockaddr, addr), addr->m_len);
+    if (n == SOCKET_ERROR) {
+        int err = getsockerror_winsock();
+        if (err == WSAEINTR || err == WSAEWOULDBLOCK) {
+            return 0;
+        }
+        throwError(err);
+    }
+    return static_cast<size_t>(n);
+}
+
 void
 ArchNetworkWinsock::throwErrorOnSocket(ArchSocket s)
 {
@@ -742,6 +798,44 @@ ArchNetworkWinsock::nameToAddr(const std::string& name)
     return addr;
 }
 
+std::vector<ArchNetAddress>
+ArchNetworkWinsock::nameToAddrs(const std::string& name)
+{
+    struct addrinfo hints;
+    struct addrinfo *p;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int ret = -1;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((ret = getaddrinfo(name.c_str(), nullptr, &hints, &p)) != 0) {
+        throwNameError(ret);
+    }
+
+    std::vector<ArchNetAddress> addrs;
+    for (struct addrinfo* i = p; i != nullptr; i = i->ai_next) {
+        if (i->ai_family != AF_INET && i->ai_family != AF_INET6) {
+            continue;
+        }
+
+        ArchNetAddressImpl* addr = new ArchNetAddressImpl;
+        if (i->ai_family == AF_INET) {
+            addr->m_len = (socklen_t)sizeof(struct sockaddr_in);
+        } else {
+            addr->m_len = (socklen_t)sizeof(struct sockaddr_in6);
+        }
+        memcpy(&addr->m_addr, i->ai_addr, addr->m_len);
+        addrs.push_back(addr);
+    }
+    freeaddrinfo(p);
+
+    if (addrs.empty()) {
+        throw XArchNetworkNameNoAddress(name);
+    }
+    return addrs;
+}
+
 void
 ArchNetworkWinsock::closeAddr(ArchNetAddress addr)
 {
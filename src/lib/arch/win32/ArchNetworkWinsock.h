@@ -83,6 +83,10 @@ public:
     virtual size_t readSocket(ArchSocket s, void* buf, size_t len);
     virtual size_t writeSocket(ArchSocket s,
                             const void* buf, size_t len);
+    virtual size_t readFromSocket(ArchSocket s, void* buf, size_t len,
+                            ArchNetAddress* addr);
+    virtual size_t writeToSocket(ArchSocket s, const void* buf, size_t len,
+                            ArchNetAddress addr);
     virtual void throwErrorOnSocket(ArchSocket);
     virtual bool setNoDelayOnSocket(ArchSocket, bool noDelay);
     virtual bool setReuseAddrOnSocket(ArchSocket, bool reuse);
@@ -90,6 +94,7 @@ public:
     virtual ArchNetAddress newAnyAddr(EAddressFamily);
     virtual ArchNetAddress copyAddr(ArchNetAddress);
     virtual ArchNetAddress nameToAddr(const std::string&);
+    virtual std::vector<ArchNetAddress> nameToAddrs(const std::string&);
     virtual void closeAddr(ArchNetAddress);
     virtual std::string addrToName(ArchNetAddress);
     virtual std::string addrToString(ArchNetAddress);
@@ -0,0 +1,197 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/DispatchCork.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace inputleap {
+
+namespace {
+
+// deferred work of one thread.  only the thread itself changes depth.  the
+// deferred work and what is running are shared with cancel() and guarded
+// by the state's own mutex, which other threads only take in cancel().
+struct CorkState {
+    int depth = 0;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::vector<std::pair<const void*, std::function<void()>>> deferred;
+    const void* running = nullptr;
+};
+
+// the states of all threads, used by cancel() only
+struct CorkRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<CorkState>> states;
+};
+
+CorkRegistry& registry()
+{
+    static CorkRegistry instance;
+    return instance;
+}
+
+// registers the state of a thread for as long as the thread lives.  the
+// state is shared so that cancel() can finish with it after the thread
+// has gone.
+struct ThreadCorkState {
+    std::shared_ptr<CorkState> state = std::make_shared<CorkState>();
+
+    ThreadCorkState()
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        registry().states.push_back(state);
+    }
+
+    ~ThreadCorkState()
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        auto& states = registry().states;
+        states.erase(std::remove(states.begin(), states.end(), state), states.end());
+    }
+};
+
+CorkState& cork_state()
+{
+    thread_local ThreadCorkState thread_state;
+    return *thread_state.state;
+}
+
+auto find_deferred(CorkState& state, const void* key)
+{
+    return std::find_if(state.deferred.begin(), state.deferred.end(),
+                        [key](const auto& entry) { return entry.first == key; });
+}
+
+// runs work taken from the deferred list of the calling thread.  the mutex
+// isn't held while it runs so it may defer, release or cancel itself.
+void run(std::unique_lock<std::mutex>& lock, CorkState& state, const void* key,
+         std::function<void()> work)
+{
+    state.running = key;
+    lock.unlock();
+    try {
+        work();
+    }
+    catch (...) {
+        lock.lock();
+        state.running = nullptr;
+        state.finished.notify_all();
+        throw;
+    }
+    lock.lock();
+    state.running = nullptr;
+    state.finished.notify_all();
+}
+
+// runs everything deferred on the calling thread, including work deferred
+// by the work itself while still corked
+void run_all(CorkState& state)
+{
+    // take one entry at a time so that work cancelled meanwhile doesn't run
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (!state.deferred.empty()) {
+        auto entry = std::move(state.deferred.front());
+        state.deferred.erase(state.deferred.begin());
+        run(lock, state, entry.first, std::move(entry.second));
+    }
+}
+
+} // namespace
+
+DispatchCork::DispatchCork()
+{
+    ++cork_state().depth;
+}
+
+DispatchCork::~DispatchCork()
+{
+    CorkState& state = cork_state();
+    if (--state.depth != 0) {
+        return;
+    }
+
+    // the work runs uncorked so anything it defers runs right away
+    run_all(state);
+}
+
+void DispatchCork::defer(const void* key, std::function<void()> work)
+{
+    CorkState& state = cork_state();
+    if (state.depth == 0) {
+        work();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (find_deferred(state, key) == state.deferred.end()) {
+        state.deferred.emplace_back(key, std::move(work));
+    }
+}
+
+void DispatchCork::release(const void* key)
+{
+    CorkState& state = cork_state();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    auto i = find_deferred(state, key);
+    if (i != state.deferred.end()) {
+        auto work = std::move(i->second);
+        state.deferred.erase(i);
+        run(lock, state, key, std::move(work));
+    }
+}
+
+void DispatchCork::release_all()
+{
+    run_all(cork_state());
+}
+
+void DispatchCork::cancel(const void* key)
+{
+    CorkState& self = cork_state();
+    std::vector<std::shared_ptr<CorkState>> states;
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        states = registry().states;
+    }
+
+    for (const auto& state : states) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        auto i = find_deferred(*state, key);
+        if (i != state->deferred.end()) {
+            state->deferred.erase(i);
+        }
+
+        // wait for other threads that are running work for the key.  work
+        // that cancels its own key is left to return on its own.
+        if (state.get() != &self) {
+            state->finished.wait(lock, [&state, key]() { return state->running != key; });
+        }
+    }
+}
+
+bool DispatchCork::is_corked()
+{
+    return cork_state().depth != 0;
+}
+
+} // namespace inputleap
@@ -0,0 +1,83 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <functional>
+
+namespace inputleap {
+
+//! Defers work to the end of the current event dispatch
+/*!
+While a cork exists on a thread, work passed to \c defer() on that thread
+is kept and run once when the outermost cork goes away.  The event loop
+corks every dispatch, so a socket that several messages are written to
+while handling one event is handed to the socket multiplexer once, after
+the handler, and the messages go out in a single send instead of waking
+the multiplexer for every message.  Without a cork the work runs at once.
+Deferred work runs on the thread that deferred it but can be cancelled
+from any thread.
+*/
+class DispatchCork {
+public:
+    DispatchCork();
+    ~DispatchCork();
+
+    DispatchCork(const DispatchCork&) = delete;
+    DispatchCork& operator=(const DispatchCork&) = delete;
+
+    //! Defer work
+    /*!
+    Runs \p work when the cork is released, or now if there is no cork.
+    Only the first work deferred for \p key is kept until then;  later
+    calls with the same key are ignored.
+    */
+    static void defer(const void* key, std::function<void()> work);
+
+    //! Run deferred work now
+    /*!
+    Runs the work deferred for \p key, if any, without waiting for the
+    cork to be released.  Use this on latency critical paths, e.g. before
+    blocking until the data written to a socket was sent.
+    */
+    static void release(const void* key);
+
+    //! Run all deferred work now
+    /*!
+    Runs everything deferred on the calling thread.  Code that handles
+    events while a handler is still running, see run_nested_event_loop(),
+    calls this so what the nested handlers write isn't held back until
+    the outer handler returns.
+    */
+    static void release_all();
+
+    //! Discard deferred work
+    /*!
+    Drops the work deferred for \p key on any thread, e.g. when the object
+    it refers to is destroyed.  If another thread is running work for
+    \p key this waits until it's done, so that the work can't outlive the
+    object.  Work running on the calling thread isn't waited for.
+    */
+    static void cancel(const void* key);
+
+    //! Test if corked
+    /*!
+    Returns true if a cork exists on the calling thread.
+    */
+    static bool is_corked();
+};
+
+} // namespace inputleap
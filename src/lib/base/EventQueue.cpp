@@ -20,6 +20,7 @@
 #include "EventQueueTimer.h"
 
 #include "arch/Arch.h"
+#include "base/DispatchCork.h"
 #include "base/SimpleEventQueueBuffer.h"
 #include "base/Stopwatch.h"
 #include "base/EventTypes.h"
@@ -74,7 +75,11 @@ EventQueue::loop()
     Event event;
     getEvent(event);
     while (event.getType() != EventType::QUIT) {
-        dispatchEvent(event);
+        {
+            // what the handlers write goes out together when they're done
+            DispatchCork cork;
+            dispatchEvent(event);
+        }
         Event::deleteData(event);
         getEvent(event);
     }
@@ -120,6 +120,12 @@ enum class EventType : std::uint32_t {
     /// This is sent when the client doesn't want to reconnect after it disconnects from the server.
     SOCKET_STOP_RETRY,
 
+    /// A datagram socket sends this event when \c receive_from() will return a datagram.
+    DATAGRAM_INPUT_READY,
+
+    /// A server connector sends this event to itself when its background name lookup finishes.
+    ADDRESS_RESOLVED,
+
     /// This event is sent whenever a server accepts a client.
     CLIENT_LISTENER_ACCEPTED,
 
@@ -183,6 +189,17 @@ enum class EventType : std::uint32_t {
     /// This event is sent when the screen has been switched to a client.
     SERVER_SCREEN_SWITCHED,
 
+    /** This event is sent by the server to itself after switching screens to bring the
+        entered screen up to date once the enter went out. There is no event data.
+    */
+    SERVER_SYNC_SCREEN,
+
+    /** This event is sent by the drag info worker of the server once it has collected the
+        dragged files, so that they are sent to the entered screen from the event loop. The
+        event data is an instance of Server::DragInfoReadyInfo.
+    */
+    SERVER_DRAG_INFO_READY,
+
     SERVER_APP_RELOAD_CONFIG,
     SERVER_APP_FORCE_RECONNECT,
     SERVER_APP_RESET_SERVER,
@@ -231,6 +248,11 @@ enum class EventType : std::uint32_t {
     /// This event is sent when fake input ends.
     PRIMARY_SCREEN_FAKE_INPUT_END,
 
+    /** This event is sent by a primary screen that reads input on a thread of its own when the
+        input is waiting to be processed on the main thread.
+    */
+    PRIMARY_SCREEN_INPUT_READY,
+
     /** This event is sent whenever the screen has failed for some reason (e.g. the X Windows
         server died).
     */
@@ -259,6 +281,12 @@ enum class EventType : std::uint32_t {
     */
     CLIPBOARD_CHANGED,
 
+    /** This event is sent when an application asks for the data of a clipboard that was
+        offered without it, see IPlatformScreen::set_clipboard_formats(). The data is an
+        instance of a ClipboardInfo.
+    */
+    CLIPBOARD_REQUESTED,
+
     /// This event is sent whenever a clipboard chunk is transferred.
     CLIPBOARD_SENDING,
 
@@ -0,0 +1,54 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/NestedEventLoop.h"
+#include "base/DispatchCork.h"
+#include "base/Event.h"
+#include "base/IEventQueue.h"
+#include "base/Stopwatch.h"
+
+namespace inputleap {
+
+bool run_nested_event_loop(IEventQueue* events, double timeout,
+                           const std::function<bool()>& done)
+{
+    // the outer handler is corked, don't keep what it wrote so far
+    DispatchCork::release_all();
+
+    Stopwatch timer(true);
+    while (!done()) {
+        double time_left = timeout - timer.getTime();
+        if (time_left <= 0.0) {
+            return false;
+        }
+
+        Event event;
+        if (!events->getEvent(event, time_left)) {
+            continue;
+        }
+        if (event.getType() == EventType::QUIT) {
+            // leave it to the event loop
+            events->add_event(EventType::QUIT);
+            return false;
+        }
+        events->dispatchEvent(event);
+        Event::deleteData(event);
+        DispatchCork::release_all();
+    }
+    return true;
+}
+
+} // namespace inputleap
@@ -0,0 +1,44 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <functional>
+
+namespace inputleap {
+
+class IEventQueue;
+
+//! Handle events until a condition holds
+/*!
+For code that has to answer synchronously, e.g. a window message, but
+needs an event to arrive first.  Gets and dispatches events until \p done
+returns true and then returns true.  Returns false once \p timeout
+seconds have passed, or when a quit event arrives; the quit event is put
+back for the outer event loop.
+
+The handlers run re-entrantly, inside the handler that called this.
+Dispatch already copes with that:  a handler may remove itself or others
+while it runs, and work deferred by nested handlers (see DispatchCork)
+runs after each of them rather than when the outer handler returns.  Any
+state the caller relies on may change while waiting, including whatever
+started the wait, so \p done should check for that as well and the caller
+must look at its state again afterwards.
+*/
+bool run_nested_event_loop(IEventQueue* events, double timeout,
+                           const std::function<bool()>& done);
+
+} // namespace inputleap
@@ -316,33 +316,56 @@ splitString(std::string string, const char c)
 // CaselessCmp
 //
 
+namespace {
+
+// same as tolower() in the C locale without the call through the locale
+inline int caseless_char(std::string::value_type c)
+{
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+} // namespace
+
 bool CaselessCmp::cmpEqual(const std::string::value_type& a,
                            const std::string::value_type& b)
 {
-    // should use std::tolower but not in all versions of libstdc++ have it
-    return tolower(a) == tolower(b);
+    return caseless_char(a) == caseless_char(b);
 }
 
 bool CaselessCmp::cmpLess(const std::string::value_type& a,
                           const std::string::value_type& b)
 {
-    // should use std::tolower but not in all versions of libstdc++ have it
-    return tolower(a) < tolower(b);
+    return caseless_char(a) < caseless_char(b);
 }
 
 bool
 CaselessCmp::less(const std::string& a, const std::string& b)
 {
-    return std::lexicographical_compare(
-        a.begin(), a.end(),
-        b.begin(), b.end(),
-        &inputleap::string::CaselessCmp::cmpLess);
+    // every lookup in the configuration's name maps ends up here, so
+    // compare directly instead of through a function pointer
+    std::size_t size = std::min(a.size(), b.size());
+    for (std::size_t i = 0; i < size; ++i) {
+        int ca = caseless_char(a[i]);
+        int cb = caseless_char(b[i]);
+        if (ca != cb) {
+            return ca < cb;
+        }
+    }
+    return a.size() < b.size();
 }
 
 bool
 CaselessCmp::equal(const std::string& a, const std::string& b)
 {
-    return !(less(a, b) || less(b, a));
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (caseless_char(a[i]) != caseless_char(b[i])) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool
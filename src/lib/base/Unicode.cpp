@@ -19,9 +19,20 @@
 #include "arch/Arch.h"
 #include "base/Unicode.h"
 
+#include <bitset>
 #include <climits>
 #include <cstring>
 
+// the block conversions below assume a little endian host, which all
+// SSE2 and practically all NEON targets are
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UNICODE_USE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#include <arm_neon.h>
+#define UNICODE_USE_NEON 1
+#endif
+
 namespace {
 
 enum EWideCharEncoding {
@@ -103,6 +114,222 @@ setError(bool* errors)
     }
 }
 
+//
+// block conversions.  these handle the runs of plain ASCII that make up
+// most text 16 bytes at a time and leave everything else to the
+// character at a time code.
+//
+
+// returns the number of ASCII characters at the start of src
+static std::size_t ascii_length(const std::uint8_t* src, std::size_t n)
+{
+    std::size_t i = 0;
+#if UNICODE_USE_SSE2
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(v) != 0) {
+            break;
+        }
+    }
+#elif UNICODE_USE_NEON
+    for (; i + 16 <= n; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(src + i)) >= 0x80) {
+            break;
+        }
+    }
+#endif
+    while (i < n && src[i] < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+// converts the ASCII characters at the start of the UTF-8 string src
+// to UTF-16 in dst.  returns the number of characters converted.
+static std::size_t ascii_to_utf16(const std::uint8_t* src, std::size_t n, char* dst)
+{
+    std::size_t i = 0;
+#if UNICODE_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(v) != 0) {
+            break;
+        }
+        __m128i* out = reinterpret_cast<__m128i*>(dst + 2 * i);
+        _mm_storeu_si128(out, _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(v, zero));
+    }
+#elif UNICODE_USE_NEON
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(src + i);
+        if (vmaxvq_u8(v) >= 0x80) {
+            break;
+        }
+        std::uint8_t* out = reinterpret_cast<std::uint8_t*>(dst + 2 * i);
+        vst1q_u8(out, vreinterpretq_u8_u16(vmovl_u8(vget_low_u8(v))));
+        vst1q_u8(out + 16, vreinterpretq_u8_u16(vmovl_high_u8(v)));
+    }
+#endif
+    for (; i < n && src[i] < 0x80; ++i) {
+        std::uint16_t c = src[i];
+        std::memcpy(dst + 2 * i, &c, 2);
+    }
+    return i;
+}
+
+#if UNICODE_USE_SSE2
+// loads 8 UTF-16 words in host byte order
+inline static __m128i load16x8(const std::uint8_t* src, bool byteSwapped)
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    if (byteSwapped) {
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+    return v;
+}
+#elif UNICODE_USE_NEON
+inline static uint16x8_t load16x8(const std::uint8_t* src, bool byteSwapped)
+{
+    uint8x16_t v = vld1q_u8(src);
+    if (byteSwapped) {
+        v = vrev16q_u8(v);
+    }
+    return vreinterpretq_u16_u8(v);
+}
+#endif
+
+// converts the ASCII characters at the start of the n word UTF-16 string
+// src to UTF-8 in dst.  returns the number of characters converted.
+static std::size_t utf16_ascii_to_utf8(const std::uint8_t* src, std::size_t n,
+                                       bool byteSwapped, char* dst)
+{
+    std::size_t i = 0;
+#if UNICODE_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i high = _mm_set1_epi16(static_cast<short>(0xff80));
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = load16x8(src + 2 * i, byteSwapped);
+        __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(v, high), zero);
+        if (_mm_movemask_epi8(ascii) != 0xffff) {
+            break;
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(v, v));
+    }
+#elif UNICODE_USE_NEON
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t v = load16x8(src + 2 * i, byteSwapped);
+        if (vmaxvq_u16(v) >= 0x80) {
+            break;
+        }
+        vst1_u8(reinterpret_cast<std::uint8_t*>(dst + i), vmovn_u16(v));
+    }
+#endif
+    for (; i < n; ++i) {
+        std::uint16_t c = decode16(src + 2 * i, byteSwapped);
+        if (c >= 0x80) {
+            break;
+        }
+        dst[i] = static_cast<char>(c);
+    }
+    return i;
+}
+
+// returns the size of the UTF-8 encoding of the n word UTF-16 string src
+// assuming each word is a character of its own.  that's exact except
+// for surrogate pairs, which need 4 bytes rather than 6, and lone
+// surrogates are replaced by a 3 byte character.
+static std::size_t utf16_utf8_length(const std::uint8_t* src, std::size_t n, bool byteSwapped)
+{
+    std::size_t size = n;
+    std::size_t i = 0;
+#if UNICODE_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i over7 = _mm_set1_epi16(static_cast<short>(0xff80));
+    const __m128i over11 = _mm_set1_epi16(static_cast<short>(0xf800));
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = load16x8(src + 2 * i, byteSwapped);
+        int two = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, over7), zero));
+        int three = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, over11), zero));
+        // each word sets two bits in the masks
+        size += (32 - std::bitset<16>(two).count() - std::bitset<16>(three).count()) / 2;
+    }
+#elif UNICODE_USE_NEON
+    const uint16x8_t min2 = vdupq_n_u16(0x80);
+    const uint16x8_t min3 = vdupq_n_u16(0x800);
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t v = load16x8(src + 2 * i, byteSwapped);
+        uint16x8_t extra = vaddq_u16(vshrq_n_u16(vcgeq_u16(v, min2), 15),
+                                     vshrq_n_u16(vcgeq_u16(v, min3), 15));
+        size += vaddvq_u16(extra);
+    }
+#endif
+    for (; i < n; ++i) {
+        std::uint16_t c = decode16(src + 2 * i, byteSwapped);
+        size += (c >= 0x80) + (c >= 0x800);
+    }
+    return size;
+}
+
+// decodes the two or three byte UTF-8 sequence at the start of src if
+// it's a valid character other than U+FFFE and U+FFFF.  returns 0 for
+// anything else, which must go through Unicode::fromUTF8().
+inline static std::uint32_t decode_utf8_bmp(const std::uint8_t* src, std::size_t n,
+                                            std::size_t& size)
+{
+    if (src[0] >= 0xc2 && src[0] < 0xe0) {
+        if (n >= 2 && (src[1] & 0xc0) == 0x80) {
+            size = 2;
+            return ((static_cast<std::uint32_t>(src[0]) & 0x1f) << 6) |
+                    (static_cast<std::uint32_t>(src[1]) & 0x3f);
+        }
+    }
+    else if (src[0] >= 0xe0 && src[0] < 0xf0) {
+        if (n >= 3 && (src[1] & 0xc0) == 0x80 && (src[2] & 0xc0) == 0x80) {
+            std::uint32_t c = ((static_cast<std::uint32_t>(src[0]) & 0x0f) << 12) |
+                              ((static_cast<std::uint32_t>(src[1]) & 0x3f) << 6) |
+                               (static_cast<std::uint32_t>(src[2]) & 0x3f);
+            if (c >= 0x00000800 && (c < 0x0000d800 || c > 0x0000dfff) && c < 0x0000fffe) {
+                size = 3;
+                return c;
+            }
+        }
+    }
+    return 0;
+}
+
+inline static char* encode16(char* dst, std::uint32_t c)
+{
+    std::uint16_t word = static_cast<std::uint16_t>(c);
+    std::memcpy(dst, &word, 2);
+    return dst + 2;
+}
+
+// writes the UTF-8 encoding of c, which must be below 0x00110000 and
+// not a surrogate.  returns the end of the encoding.
+inline static char* encode_utf8(char* dst, std::uint32_t c)
+{
+    if (c < 0x00000080) {
+        *dst++ = static_cast<char>(c);
+    }
+    else if (c < 0x00000800) {
+        *dst++ = static_cast<char>(((c >>  6) & 0x0000001f) + 0xc0);
+        *dst++ = static_cast<char>((c         & 0x0000003f) + 0x80);
+    }
+    else if (c < 0x00010000) {
+        *dst++ = static_cast<char>(((c >> 12) & 0x0000000f) + 0xe0);
+        *dst++ = static_cast<char>(((c >>  6) & 0x0000003f) + 0x80);
+        *dst++ = static_cast<char>((c         & 0x0000003f) + 0x80);
+    }
+    else {
+        *dst++ = static_cast<char>(((c >> 18) & 0x00000007) + 0xf0);
+        *dst++ = static_cast<char>(((c >> 12) & 0x0000003f) + 0x80);
+        *dst++ = static_cast<char>(((c >>  6) & 0x0000003f) + 0x80);
+        *dst++ = static_cast<char>((c         & 0x0000003f) + 0x80);
+    }
+    return dst;
+}
+
 
 //
 // Unicode
@@ -113,10 +340,13 @@ std::uint32_t Unicode::s_replacement = 0x0000fffd;
 
 bool Unicode::isUTF8(const std::string& src)
 {
-    // convert and test each character
+    // skip runs of ASCII and test the characters in between
     const std::uint8_t* data = reinterpret_cast<const std::uint8_t*>(src.c_str());
     for (std::size_t n = src.size(); n > 0; ) {
-        if (fromUTF8(data, n) == s_invalid) {
+        std::size_t ascii = ascii_length(data, n);
+        data += ascii;
+        n -= ascii;
+        if (n > 0 && fromUTF8(data, n) == s_invalid) {
             return false;
         }
     }
@@ -181,35 +411,51 @@ Unicode::UTF8ToUTF16(const std::string& src, bool* errors)
     // default to success
     resetError(errors);
 
-    // get size of input string and reserve some space in output
+    // no byte of input turns into more than one word of output so
+    // allocate for the worst case and trim afterwards
     std::size_t n = src.size();
-    std::string dst;
-    dst.reserve(2 * n);
+    std::string dst(2 * n, '\0');
+    char* out = &dst[0];
 
-    // convert each character
+    // convert each run of ASCII at once and everything else a character
+    // at a time
     const std::uint8_t* data = reinterpret_cast<const std::uint8_t*>(src.c_str());
     while (n > 0) {
-        std::uint32_t c = fromUTF8(data, n);
-        if (c == s_invalid) {
-            c = s_replacement;
-        }
-        else if (c >= 0x00110000) {
-            setError(errors);
-            c = s_replacement;
-        }
-        if (c < 0x00010000) {
-            std::uint16_t ucs2 = static_cast<std::uint16_t>(c);
-            dst.append(reinterpret_cast<const char*>(&ucs2), 2);
-        }
-        else {
-            c -= 0x00010000;
-            std::uint16_t utf16h = static_cast<std::uint16_t>((c >> 10) + 0xd800);
-            std::uint16_t utf16l = static_cast<std::uint16_t>((c & 0x03ff) + 0xdc00);
-            dst.append(reinterpret_cast<const char*>(&utf16h), 2);
-            dst.append(reinterpret_cast<const char*>(&utf16l), 2);
+        std::size_t ascii = ascii_to_utf16(data, n, out);
+        data += ascii;
+        n -= ascii;
+        out += 2 * ascii;
+
+        while (n > 0 && data[0] >= 0x80) {
+            std::size_t size;
+            std::uint32_t c = decode_utf8_bmp(data, n, size);
+            if (c != 0) {
+                data += size;
+                n -= size;
+                out = encode16(out, c);
+                continue;
+            }
+
+            c = fromUTF8(data, n);
+            if (c == s_invalid) {
+                c = s_replacement;
+            }
+            else if (c >= 0x00110000) {
+                setError(errors);
+                c = s_replacement;
+            }
+            if (c < 0x00010000) {
+                out = encode16(out, c);
+            }
+            else {
+                c -= 0x00010000;
+                out = encode16(out, (c >> 10) + 0xd800);
+                out = encode16(out, (c & 0x03ff) + 0xdc00);
+            }
         }
     }
 
+    dst.resize(out - dst.data());
     return dst;
 }
 
@@ -457,10 +703,6 @@ Unicode::wideCharToUTF8(const wchar_t* src, std::size_t size, bool* errors)
 
 std::string Unicode::doUCS2ToUTF8(const std::uint8_t* data, std::size_t n, bool* errors)
 {
-    // make some space
-    std::string dst;
-    dst.reserve(n);
-
     // check if first character is 0xfffe or 0xfeff
     bool byteSwapped = false;
     if (n >= 1) {
@@ -481,12 +723,32 @@ std::string Unicode::doUCS2ToUTF8(const std::uint8_t* data, std::size_t n, bool*
         }
     }
 
-    // convert each character
-    for (; n > 0; data += 2, --n) {
-        std::uint32_t c = decode16(data, byteSwapped);
-        toUTF8(dst, c, errors);
+    // size the output up front
+    std::string dst(utf16_utf8_length(data, n, byteSwapped), '\0');
+    char* out = &dst[0];
+
+    // convert each run of ASCII at once and everything else a character
+    // at a time
+    while (n > 0) {
+        std::size_t ascii = utf16_ascii_to_utf8(data, n, byteSwapped, out);
+        data += 2 * ascii;
+        n -= ascii;
+        out += ascii;
+
+        for (; n > 0; data += 2, --n) {
+            std::uint32_t c = decode16(data, byteSwapped);
+            if (c < 0x00000080) {
+                break;
+            }
+            if (c >= 0x0000d800 && c <= 0x0000dfff) {
+                setError(errors);
+                c = s_replacement;
+            }
+            out = encode_utf8(out, c);
+        }
     }
 
+    dst.resize(out - dst.data());
     return dst;
 }
 
@@ -527,10 +789,6 @@ std::string Unicode::doUCS4ToUTF8(const std::uint8_t* data, std::size_t n, bool*
 
 std::string Unicode::doUTF16ToUTF8(const std::uint8_t* data, std::size_t n, bool* errors)
 {
-    // make some space
-    std::string dst;
-    dst.reserve(n);
-
     // check if first character is 0xfffe or 0xfeff
     bool byteSwapped = false;
     if (n >= 1) {
@@ -551,38 +809,54 @@ std::string Unicode::doUTF16ToUTF8(const std::uint8_t* data, std::size_t n, bool
         }
     }
 
-    // convert each character
-    for (; n > 0; data += 2, --n) {
-        std::uint32_t c = decode16(data, byteSwapped);
-        if (c < 0x0000d800 || c > 0x0000dfff) {
-            toUTF8(dst, c, errors);
-        }
-        else if (n == 1) {
-            // error -- missing second word
-            setError(errors);
-            toUTF8(dst, s_replacement, nullptr);
-        }
-        else if (c >= 0x0000d800 && c <= 0x0000dbff) {
-            data += 2;
-            --n;
-            std::uint32_t c2 = decode16(data, byteSwapped);
-            if (c2 < 0x0000dc00 || c2 > 0x0000dfff) {
-                // error -- [d800,dbff] not followed by [dc00,dfff]
+    // size the output up front
+    std::string dst(utf16_utf8_length(data, n, byteSwapped), '\0');
+    char* out = &dst[0];
+
+    // convert each run of ASCII at once and everything else a character
+    // at a time
+    while (n > 0) {
+        std::size_t ascii = utf16_ascii_to_utf8(data, n, byteSwapped, out);
+        data += 2 * ascii;
+        n -= ascii;
+        out += ascii;
+
+        for (; n > 0; data += 2, --n) {
+            std::uint32_t c = decode16(data, byteSwapped);
+            if (c < 0x00000080) {
+                break;
+            }
+            if (c < 0x0000d800 || c > 0x0000dfff) {
+                out = encode_utf8(out, c);
+            }
+            else if (n == 1) {
+                // error -- missing second word
                 setError(errors);
-                toUTF8(dst, s_replacement, nullptr);
+                out = encode_utf8(out, s_replacement);
+            }
+            else if (c >= 0x0000d800 && c <= 0x0000dbff) {
+                data += 2;
+                --n;
+                std::uint32_t c2 = decode16(data, byteSwapped);
+                if (c2 < 0x0000dc00 || c2 > 0x0000dfff) {
+                    // error -- [d800,dbff] not followed by [dc00,dfff]
+                    setError(errors);
+                    out = encode_utf8(out, s_replacement);
+                }
+                else {
+                    c = (((c - 0x0000d800) << 10) | (c2 - 0x0000dc00)) + 0x00010000;
+                    out = encode_utf8(out, c);
+                }
             }
             else {
-                c = (((c - 0x0000d800) << 10) | (c2 - 0x0000dc00)) + 0x00010000;
-                toUTF8(dst, c, errors);
+                // error -- [dc00,dfff] without leading [d800,dbff]
+                setError(errors);
+                out = encode_utf8(out, s_replacement);
             }
         }
-        else {
-            // error -- [dc00,dfff] without leading [d800,dbff]
-            setError(errors);
-            toUTF8(dst, s_replacement, nullptr);
-        }
     }
 
+    dst.resize(out - dst.data());
     return dst;
 }
 
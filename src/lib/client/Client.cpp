@@ -18,6 +18,7 @@
 
 #include "client/Client.h"
 
+#include "client/ServerConnector.h"
 #include "client/ServerProxy.h"
 #include "inputleap/Screen.h"
 #include "inputleap/FileChunk.h"
@@ -33,6 +34,7 @@
 #include "net/IDataSocket.h"
 #include "net/ISocketFactory.h"
 #include "net/SecureSocket.h"
+#include "net/UDPSocket.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/EventQueueTimer.h"
@@ -76,6 +78,14 @@ Client::Client(IEventQueue* events, const std::string& name, const NetworkAddres
     assert(m_socketFactory != nullptr);
     assert(m_screen != nullptr);
 
+    connector_ = std::make_unique<ServerConnector>(
+            m_events, m_socketFactory,
+            [this](std::unique_ptr<IDataSocket> socket, const NetworkAddress& address) {
+                handle_connected(std::move(socket), address);
+            },
+            [this](const std::string& what){ handle_connection_failed(what); });
+    connector_->set_failover_deadline(m_args.failover_deadline);
+
     // register suspend/resume event handlers
     m_events->add_handler(EventType::SCREEN_SUSPEND, get_event_target(),
                           [this](const auto& e){ handle_suspend(); });
@@ -99,17 +109,28 @@ Client::~Client()
     m_events->remove_handler(EventType::SCREEN_SUSPEND, get_event_target());
     m_events->remove_handler(EventType::SCREEN_RESUME, get_event_target());
 
+    stop_session_resume();
     cleanupTimer();
     cleanupScreen();
     cleanupConnecting();
     cleanupConnection();
+    connector_.reset();
     delete m_socketFactory;
+
+    const auto& counters = clipboard_cache_.get_counters();
+    if (counters.hits != 0 || counters.misses != 0) {
+        LOG_DEBUG("clipboard cache: hits=%llu misses=%llu evictions=%llu spills=%llu",
+                  static_cast<unsigned long long>(counters.hits),
+                  static_cast<unsigned long long>(counters.misses),
+                  static_cast<unsigned long long>(counters.evictions),
+                  static_cast<unsigned long long>(counters.spills));
+    }
 }
 
 void
 Client::connect()
 {
-    if (m_stream != nullptr) {
+    if (m_stream != nullptr || connector_->is_connecting()) {
         return;
     }
     if (m_suspended) {
@@ -123,50 +144,21 @@ Client::connect()
         security_level = ConnectionSecurityLevel::ENCRYPTED_AUTHENTICATED;
     }
 
-    try {
-        // resolve the server hostname.  do this every time we connect
-        // in case we couldn't resolve the address earlier or the address
-        // has changed (which can happen frequently if this is a laptop
-        // being shuttled between various networks).  patch by Brent
-        // Priddy.
-        m_serverAddress.resolve();
-
-        // m_serverAddress will be null if the hostname address is not reolved
-        if (m_serverAddress.getAddress() != nullptr) {
-          // to help users troubleshoot, show server host name (issue: 60)
-          LOG_NOTE("connecting to '%s': %s:%i",
-          m_serverAddress.getHostname().c_str(),
-          ARCH->addrToString(m_serverAddress.getAddress()).c_str(),
-          m_serverAddress.getPort());
-        }
-
-        // create the socket
-        auto socket = m_socketFactory->create(ARCH->getAddrFamily(m_serverAddress.getAddress()),
-                                              security_level);
-        // filter socket messages, including a packetizing filter
-        auto socket_ptr = socket.get();
-        m_stream = new PacketStreamFilter(m_events, std::move(socket));
+    // the connector looks up the server's addresses on another thread and
+    // races connections to them.  the timer covers both.
+    std::vector<NetworkAddress> servers{m_serverAddress};
+    servers.insert(servers.end(), standby_addresses_.begin(), standby_addresses_.end());
 
-        // connect
-        LOG_DEBUG1("connecting to server");
-        setupConnecting();
-        setupTimer();
-        socket_ptr->connect(m_serverAddress);
-    }
-    catch (XBase& e) {
-        cleanupTimer();
-        cleanupConnecting();
-        cleanupStream();
-        LOG_DEBUG1("connection failed");
-        sendConnectionFailedEvent(e.what());
-        return;
-    }
+    LOG_DEBUG1("connecting to server");
+    setupTimer();
+    connector_->connect(servers, security_level);
 }
 
 void
 Client::disconnect(const char* msg)
 {
     m_connectOnResume = false;
+    stop_session_resume();
     cleanupTimer();
     cleanupScreen();
     cleanupConnecting();
@@ -185,6 +177,145 @@ Client::handshakeComplete()
     m_ready = true;
     m_screen->enable();
     send_event(EventType::CLIENT_CONNECTED);
+
+    if (connection_lost_time_ > 0.0) {
+        double elapsed = current_time_seconds() - connection_lost_time_;
+        connection_lost_time_ = 0.0;
+        reconnect_latency_.record_seconds(elapsed);
+        LOG_NOTE("reconnected %.0fms after losing the connection", 1.0e3 * elapsed);
+    }
+}
+
+bool Client::start_session_resume()
+{
+    if (resuming_) {
+        // lost the new connection too, try another one
+        m_server->detach_stream();
+        cleanupTimer();
+        cleanupConnecting();
+        cleanupConnection();
+        retry_session_resume();
+        return true;
+    }
+
+    connection_lost_time_ = current_time_seconds();
+    if (m_server == nullptr || !m_server->is_resumable() || m_suspended) {
+        return false;
+    }
+
+    // keep the screen and the server proxy, only the connection is gone
+    LOG_NOTE("lost the connection to the server, resuming the session");
+    m_server->detach_stream();
+    cleanupTimer();
+    cleanupConnecting();
+    cleanupConnection();
+
+    resuming_ = true;
+    resume_timer_ = m_events->newOneShotTimer(kSessionGracePeriod, nullptr);
+    m_events->add_handler(EventType::TIMER, resume_timer_,
+                          [this](const auto& e){ handle_resume_timeout(); });
+    connect();
+    return true;
+}
+
+void Client::session_resumed()
+{
+    stop_session_resume();
+
+    double elapsed = current_time_seconds() - connection_lost_time_;
+    connection_lost_time_ = 0.0;
+    resume_latency_.record_seconds(elapsed);
+    LOG_NOTE("resumed the session %.0fms after losing the connection", 1.0e3 * elapsed);
+
+    // the server didn't get what happened here in the meantime
+    if (info_pending_) {
+        info_pending_ = false;
+        m_server->onInfoChanged();
+    }
+    for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+        if (grab_pending_[id]) {
+            grab_pending_[id] = false;
+            m_server->onGrabClipboard(id);
+            if (!m_active) {
+                sendClipboard(id);
+            }
+        }
+    }
+}
+
+void Client::session_resume_failed()
+{
+    stop_session_resume();
+    cleanupTimer();
+    cleanupScreen();
+    cleanupConnecting();
+    cleanupConnection();
+    send_event(EventType::CLIENT_DISCONNECTED);
+}
+
+void Client::retry_session_resume()
+{
+    // keep trying until the session expires
+    if (resume_retry_timer_ == nullptr) {
+        resume_retry_timer_ = m_events->newOneShotTimer(0.25, nullptr);
+        m_events->add_handler(EventType::TIMER, resume_retry_timer_,
+                              [this](const auto& e){ handle_resume_retry(); });
+    }
+}
+
+void Client::stop_session_resume()
+{
+    resuming_ = false;
+    info_pending_ = false;
+    for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+        grab_pending_[id] = false;
+    }
+    if (resume_timer_ != nullptr) {
+        m_events->remove_handler(EventType::TIMER, resume_timer_);
+        m_events->deleteTimer(resume_timer_);
+        resume_timer_ = nullptr;
+    }
+    if (resume_retry_timer_ != nullptr) {
+        m_events->remove_handler(EventType::TIMER, resume_retry_timer_);
+        m_events->deleteTimer(resume_retry_timer_);
+        resume_retry_timer_ = nullptr;
+    }
+}
+
+void Client::set_standby_servers(const std::vector<NetworkAddress>& servers)
+{
+    standby_addresses_ = servers;
+}
+
+void Client::set_clipboard_cache_directory(const fs::path& directory)
+{
+    clipboard_cache_.set_spill_directory(directory);
+}
+
+std::unique_ptr<UDPSocket> Client::create_datagram_socket()
+{
+    return m_socketFactory->create_datagram(
+                ARCH->getAddrFamily(getServerAddress().getAddress()));
+}
+
+std::vector<LatencyReport> Client::get_latency_reports() const
+{
+    std::vector<LatencyReport> reports;
+    if (m_server != nullptr) {
+        reports = m_server->get_latency_reports(getName());
+    }
+    if (resume_latency_.get_count() != 0) {
+        reports.push_back({getName(), LatencyStage::Resume, resume_latency_.get_summary()});
+    }
+    if (reconnect_latency_.get_count() != 0) {
+        reports.push_back({getName(), LatencyStage::Reconnect,
+                           reconnect_latency_.get_summary()});
+    }
+    if (clipboard_fetch_latency_.get_count() != 0) {
+        reports.push_back({getName(), LatencyStage::ClipboardFetch,
+                           clipboard_fetch_latency_.get_summary()});
+    }
+    return reports;
 }
 
 bool
@@ -202,6 +333,9 @@ Client::isConnecting() const
 NetworkAddress
 Client::getServerAddress() const
 {
+    if (connected_address_.isValid()) {
+        return connected_address_;
+    }
     return m_serverAddress;
 }
 
@@ -260,11 +394,31 @@ Client::leave()
 void
 Client::setClipboard(ClipboardID id, const IClipboard* clipboard)
 {
+    if (clipboard_requested_[id] != 0.0) {
+        double elapsed = current_time_seconds() - clipboard_requested_[id];
+        clipboard_requested_[id] = 0.0;
+        clipboard_fetch_latency_.record_seconds(elapsed);
+        LOG_DEBUG("clipboard %d arrived %.0fms after it was asked for", id, 1.0e3 * elapsed);
+    }
+
      m_screen->setClipboard(id, clipboard);
     m_ownClipboard[id]  = false;
     m_sentClipboard[id] = false;
 }
 
+void Client::set_clipboard_formats(ClipboardID id,
+                                   const std::vector<IClipboard::EFormat>& formats)
+{
+    clipboard_requested_[id] = 0.0;
+    m_ownClipboard[id]  = false;
+    m_sentClipboard[id] = false;
+
+    // without rendering on demand the data is needed right away
+    if (!m_screen->set_clipboard_formats(id, formats)) {
+        request_clipboard(id);
+    }
+}
+
 void
 Client::grabClipboard(ClipboardID id)
 {
@@ -420,6 +574,12 @@ void Client::send_event(EventType type)
 void
 Client::sendConnectionFailedEvent(const char* msg)
 {
+    if (resuming_) {
+        LOG_DEBUG1("could not connect to resume the session: %s", msg);
+        retry_session_resume();
+        return;
+    }
+
     FailInfo info{msg};
     info.m_retry = true;
     m_events->add_event(EventType::CLIENT_CONNECTION_FAILED, get_event_target(),
@@ -434,23 +594,6 @@ void Client::send_file_chunk(const FileChunk& chunk)
     m_server->file_chunk_sending(chunk);
 }
 
-void
-Client::setupConnecting()
-{
-    assert(m_stream != nullptr);
-
-    if (m_args.m_enableCrypto) {
-        m_events->add_handler(EventType::DATA_SOCKET_SECURE_CONNECTED, m_stream->get_event_target(),
-                              [this](const auto& e){ handle_connected(); });
-    }
-    else {
-        m_events->add_handler(EventType::DATA_SOCKET_CONNECTED, m_stream->get_event_target(),
-                              [this](const auto& e){ handle_connected(); });
-    }
-    m_events->add_handler(EventType::DATA_SOCKET_CONNECTION_FAILED, m_stream->get_event_target(),
-                          [this](const auto& e){ handle_connection_failed(e); });
-}
-
 void
 Client::setupConnection()
 {
@@ -481,6 +624,8 @@ Client::setupScreen()
                           [this](const auto& e){ handle_shape_changed(); });
     m_events->add_handler(EventType::CLIPBOARD_GRABBED, get_event_target(),
                           [this](const auto& e){ handle_clipboard_grabbed(e); });
+    m_events->add_handler(EventType::CLIPBOARD_REQUESTED, get_event_target(),
+                          [this](const auto& e){ handle_clipboard_requested(e); });
 }
 
 void
@@ -488,7 +633,9 @@ Client::setupTimer()
 {
     assert(m_timer == nullptr);
 
-    m_timer = m_events->newOneShotTimer(15.0, nullptr);
+    // leave every standby server its failover deadline on top
+    double timeout = 15.0 + m_args.failover_deadline * standby_addresses_.size();
+    m_timer = m_events->newOneShotTimer(timeout, nullptr);
     m_events->add_handler(EventType::TIMER, m_timer,
                           [this](const auto& e){ handle_connect_timeout(); });
 }
@@ -496,10 +643,8 @@ Client::setupTimer()
 void
 Client::cleanupConnecting()
 {
-    if (m_stream != nullptr) {
-        m_events->remove_handler(EventType::DATA_SOCKET_CONNECTED, m_stream->get_event_target());
-        m_events->remove_handler(EventType::DATA_SOCKET_CONNECTION_FAILED,
-                                m_stream->get_event_target());
+    if (connector_ != nullptr) {
+        connector_->cancel();
     }
 }
 
@@ -527,6 +672,7 @@ Client::cleanupScreen()
         }
         m_events->remove_handler(EventType::SCREEN_SHAPE_CHANGED, get_event_target());
         m_events->remove_handler(EventType::CLIPBOARD_GRABBED, get_event_target());
+        m_events->remove_handler(EventType::CLIPBOARD_REQUESTED, get_event_target());
         delete m_server;
         m_server = nullptr;
     }
@@ -547,15 +693,24 @@ Client::cleanupStream()
 {
     delete m_stream;
     m_stream = nullptr;
+    connected_address_ = NetworkAddress();
 }
 
 void
-Client::handle_connected()
+Client::handle_connected(std::unique_ptr<IDataSocket> socket, const NetworkAddress& address)
 {
     LOG_DEBUG1("connected;  wait for hello");
-    cleanupConnecting();
+
+    // filter socket messages, including a packetizing filter
+    connected_address_ = address;
+    m_stream = new PacketStreamFilter(m_events, std::move(socket));
     setupConnection();
 
+    // the server still has our clipboard state if we resume the session
+    if (resuming_) {
+        return;
+    }
+
     // reset clipboard state
     for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
         m_ownClipboard[id]  = false;
@@ -564,15 +719,11 @@ Client::handle_connected()
     }
 }
 
-void Client::handle_connection_failed(const Event& event)
+void Client::handle_connection_failed(const std::string& what)
 {
-    const auto& info = event.get_data_as<IDataSocket::ConnectionFailedInfo>();
-
     cleanupTimer();
-    cleanupConnecting();
-    cleanupStream();
     LOG_DEBUG1("connection failed");
-    sendConnectionFailedEvent(info.m_what.c_str());
+    sendConnectionFailedEvent(what.c_str());
 }
 
 void Client::handle_connect_timeout()
@@ -587,6 +738,9 @@ void Client::handle_connect_timeout()
 
 void Client::handle_output_error()
 {
+    if (start_session_resume()) {
+        return;
+    }
     cleanupTimer();
     cleanupScreen();
     cleanupConnection();
@@ -596,6 +750,9 @@ void Client::handle_output_error()
 
 void Client::handle_disconnected()
 {
+    if (start_session_resume()) {
+        return;
+    }
     cleanupTimer();
     cleanupScreen();
     cleanupConnection();
@@ -606,6 +763,10 @@ void Client::handle_disconnected()
 void Client::handle_shape_changed()
 {
     LOG_DEBUG("resolution changed");
+    if (resuming_) {
+        info_pending_ = true;
+        return;
+    }
     m_server->onInfoChanged();
 }
 
@@ -617,14 +778,20 @@ void Client::handle_clipboard_grabbed(const Event& event)
 
     const auto& info = event.get_data_as<IScreen::ClipboardInfo>();
 
-    // grab ownership
-    m_server->onGrabClipboard(info.m_id);
-
     // we now own the clipboard and it has not been sent to the server
     m_ownClipboard[info.m_id]  = true;
     m_sentClipboard[info.m_id] = false;
     m_timeClipboard[info.m_id] = 0;
 
+    // tell the server once the session is resumed
+    if (resuming_) {
+        grab_pending_[info.m_id] = true;
+        return;
+    }
+
+    // grab ownership
+    m_server->onGrabClipboard(info.m_id);
+
     // if we're not the active screen then send the clipboard now,
     // otherwise we'll wait until we leave.
     if (!m_active) {
@@ -632,6 +799,22 @@ void Client::handle_clipboard_grabbed(const Event& event)
     }
 }
 
+void Client::handle_clipboard_requested(const Event& event)
+{
+    const auto& info = event.get_data_as<IScreen::ClipboardInfo>();
+    request_clipboard(info.m_id);
+}
+
+void Client::request_clipboard(ClipboardID id)
+{
+    if (m_server == nullptr) {
+        return;
+    }
+    if (m_server->request_clipboard(id)) {
+        clipboard_requested_[id] = current_time_seconds();
+    }
+}
+
 void Client::handle_hello()
 {
     std::int16_t major, minor;
@@ -659,7 +842,12 @@ void Client::handle_hello()
                             kProtocolMinorVersion, &m_name);
 
     // now connected but waiting to complete handshake
-    setupScreen();
+    if (resuming_) {
+        m_server->attach_stream(m_stream);
+    }
+    else {
+        setupScreen();
+    }
     cleanupTimer();
 
     // make sure we process any remaining messages later.  we won't
@@ -709,6 +897,22 @@ Client::onFileReceiveCompleted()
     }
 }
 
+void Client::handle_resume_timeout()
+{
+    LOG_NOTE("could not resume the session within %.1fs", kSessionGracePeriod);
+    session_resume_failed();
+}
+
+void Client::handle_resume_retry()
+{
+    if (resume_retry_timer_ != nullptr) {
+        m_events->remove_handler(EventType::TIMER, resume_retry_timer_);
+        m_events->deleteTimer(resume_retry_timer_);
+        resume_retry_timer_ = nullptr;
+    }
+    connect();
+}
+
 void Client::handle_stop_retry()
 {
     m_args.m_restartable = false;
@@ -23,15 +23,20 @@
 #include "inputleap/Fwd.h"
 #include "inputleap/IClient.h"
 #include "inputleap/Clipboard.h"
+#include "inputleap/ClipboardCache.h"
 #include "inputleap/DragInformation.h"
 #include "inputleap/INode.h"
 #include "inputleap/ClientArgs.h"
+#include "inputleap/LatencyStats.h"
 #include "net/Fwd.h"
 #include "net/NetworkAddress.h"
 #include "base/EventTypes.h"
+#include <memory>
+#include <vector>
 
 namespace inputleap {
 
+class ServerConnector;
 class ServerProxy;
 class IStream;
 class Thread;
@@ -80,6 +85,28 @@ public:
     */
     virtual void handshakeComplete();
 
+    //! Resume the session after losing the connection
+    /*!
+    Keeps the screen and tries to resume the session with the server on a
+    new connection.  Returns false if the server didn't offer to resume
+    the session, in which case the caller should disconnect.
+    */
+    bool start_session_resume();
+
+    //! Notify of resumed session
+    /*!
+    Notifies the client that the server resumed the session on the new
+    connection.
+    */
+    void session_resumed();
+
+    //! Notify of failure to resume the session
+    /*!
+    Notifies the client that the server could not resume the session.  The
+    client disconnects and connects again from scratch.
+    */
+    void session_resume_failed();
+
     //! Received drag information
     void dragInfoReceived(std::uint32_t fileNum, std::string data);
 
@@ -89,6 +116,41 @@ public:
     //! Send dragging file information back to server
     void sendDragInfo(std::uint32_t fileCount, std::string& info, size_t size);
 
+    //! Set standby servers
+    /*!
+    Sets the servers to fail over to, in order, when the server passed to
+    the c'tor doesn't answer.
+    */
+    void set_standby_servers(const std::vector<NetworkAddress>& servers);
+
+    //! Set clipboard cache directory
+    /*!
+    Clipboards dropped from the in-memory clipboard cache are kept in
+    \p directory until it is full.
+    */
+    void set_clipboard_cache_directory(const fs::path& directory);
+
+    //! Get the clipboard cache
+    /*!
+    Holds the clipboards sent to and received from servers.  It outlives
+    connections so a server can offer content by hash after reconnecting.
+    */
+    ClipboardCache& get_clipboard_cache() { return clipboard_cache_; }
+
+    //! Set clipboard formats
+    /*!
+    Offers the formats of a clipboard the server sends only when it's
+    pasted.  The data is asked for when the screen needs it and arrives
+    with setClipboard().
+    */
+    void set_clipboard_formats(ClipboardID id, const std::vector<IClipboard::EFormat>& formats);
+
+    //! Create a datagram socket
+    /*!
+    Creates an unbound UDP socket in the address family of the server
+    address.
+    */
+    std::unique_ptr<UDPSocket> create_datagram_socket();
 
     //@}
     //! @name accessors
@@ -109,8 +171,9 @@ public:
 
     //! Get address of server
     /*!
-    Returns the address of the server the client is connected (or wants
-    to connect) to.
+    Returns the address of the server the client is connected to or, when
+    not connected, the address of the primary server it wants to connect
+    to.
     */
     NetworkAddress getServerAddress() const;
 
@@ -126,6 +189,14 @@ public:
     //! Return drag file list
     DragFileList getDragFileList() { return m_dragFileList; }
 
+    //! Get latency of input from the server
+    /*!
+    Returns the latencies of the input received since connecting, if
+    connected, and the time it took to resume the session or reconnect
+    after losing the connection.
+    */
+    std::vector<LatencyReport> get_latency_reports() const;
+
     //@}
 
     // IScreen overrides
@@ -162,7 +233,6 @@ private:
     void send_file_chunk(const FileChunk& data);
     void send_file_thread(const char* filename);
     void write_to_drop_dir_thread();
-    void setupConnecting();
     void setupConnection();
     void setupScreen();
     void setupTimer();
@@ -171,20 +241,26 @@ private:
     void cleanupScreen();
     void cleanupTimer();
     void cleanupStream();
-    void handle_connected();
-    void handle_connection_failed(const Event& event);
+    void handle_connected(std::unique_ptr<IDataSocket> socket, const NetworkAddress& address);
+    void handle_connection_failed(const std::string& what);
     void handle_connect_timeout();
     void handle_output_error();
     void handle_disconnected();
     void handle_shape_changed();
     void handle_clipboard_grabbed(const Event& event);
+    void handle_clipboard_requested(const Event& event);
     void handle_hello();
     void handle_suspend();
     void handle_resume();
     void handle_file_chunk_sending(const Event& event);
     void handle_file_receive_completed(const Event&);
     void handle_stop_retry();
+    void handle_resume_timeout();
+    void handle_resume_retry();
+    void retry_session_resume();
+    void stop_session_resume();
     void onFileReceiveCompleted();
+    void request_clipboard(ClipboardID id);
     void sendClipboardThread(void*);
 
 public:
@@ -193,7 +269,11 @@ public:
 private:
     std::string m_name;
     NetworkAddress m_serverAddress;
+    std::vector<NetworkAddress> standby_addresses_;
+    NetworkAddress connected_address_;
+    ClipboardCache clipboard_cache_;
     ISocketFactory* m_socketFactory;
+    std::unique_ptr<ServerConnector> connector_;
     inputleap::Screen* m_screen;
     inputleap::IStream* m_stream;
     EventQueueTimer* m_timer;
@@ -217,6 +297,20 @@ private:
     ClientArgs m_args;
     bool m_enableClipboard;
     size_t m_maximumClipboardSize;
+
+    // resuming the session after losing the connection
+    bool resuming_ = false;
+    EventQueueTimer* resume_timer_ = nullptr;
+    EventQueueTimer* resume_retry_timer_ = nullptr;
+    bool info_pending_ = false;
+    bool grab_pending_[kClipboardEnd] = {};
+    double connection_lost_time_ = 0.0;
+    LatencyHistogram resume_latency_;
+    LatencyHistogram reconnect_latency_;
+
+    // time the data of a clipboard offered by its formats was asked for
+    double clipboard_requested_[kClipboardEnd] = {};
+    LatencyHistogram clipboard_fetch_latency_;
 };
 
 } // namespace inputleap
@@ -0,0 +1,113 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/MotionDatagramChannel.h"
+
+#include "inputleap/protocol_types.h"
+#include "net/UDPSocket.h"
+#include "base/IEventQueue.h"
+#include "base/EventQueueTimer.h"
+#include "base/Log.h"
+
+#include <vector>
+
+namespace inputleap {
+
+MotionDatagramChannel::MotionDatagramChannel(IEventQueue* events,
+                                             std::unique_ptr<UDPSocket> socket,
+                                             const NetworkAddress& server,
+                                             std::uint32_t session,
+                                             const MotionDatagramKey& key,
+                                             MotionHandler handler) :
+    events_{events},
+    socket_{std::move(socket)},
+    server_{server},
+    session_{session},
+    key_{key},
+    handler_{std::move(handler)},
+    ack_timer_{nullptr}
+{
+    events_->add_handler(EventType::DATAGRAM_INPUT_READY, socket_->get_event_target(),
+                         [this](const auto& e){ handle_input(); });
+
+    // the first ack opens the lane, later ones keep it open
+    ack_timer_ = events_->newTimer(kMotionDatagramAckRate, nullptr);
+    events_->add_handler(EventType::TIMER, ack_timer_,
+                         [this](const auto& e){ send_ack(); });
+    send_ack();
+}
+
+MotionDatagramChannel::~MotionDatagramChannel()
+{
+    LOG_DEBUG("motion datagrams from server: %u received, %u out of order, "
+              "%u ahead of the stream", receiver_.get_received(), receiver_.get_stale(),
+              receiver_.get_held());
+
+    events_->remove_handler(EventType::TIMER, ack_timer_);
+    events_->deleteTimer(ack_timer_);
+    events_->remove_handler(EventType::DATAGRAM_INPUT_READY, socket_->get_event_target());
+    socket_->close();
+}
+
+void MotionDatagramChannel::sync(const MotionDatagram& sync)
+{
+    MotionDatagramReceiver::Motion motion;
+    if (receiver_.accept_sync(sync, motion)) {
+        handler_(motion);
+    }
+}
+
+void MotionDatagramChannel::send_ack()
+{
+    // acks are numbered so the server can tell old ones sent again
+    MotionDatagram ack = receiver_.make_ack(session_);
+    ack.ack_seq = ++acks_sent_;
+
+    std::uint8_t buffer[kMaxMotionDatagramSize];
+    std::size_t size = encode_motion_datagram(ack, key_, buffer);
+    if (!socket_->send_to(buffer, size, server_)) {
+        LOG_DEBUG2("cannot send motion datagram ack");
+    }
+}
+
+void MotionDatagramChannel::handle_input()
+{
+    // apply the net motion of all queued datagrams at once
+    MotionDatagramReceiver::Motion motion;
+    bool have_motion = false;
+
+    std::vector<std::uint8_t> data;
+    NetworkAddress from;
+    while (socket_->receive_from(data, from)) {
+        MotionDatagram datagram;
+        if (!decode_motion_datagram(data.data(), data.size(), key_, datagram) ||
+                datagram.session != session_ ||
+                datagram.type != MotionDatagram::Type::Motion) {
+            LOG_DEBUG2("discarding unauthenticated datagram from %s",
+                       from.getHostname().c_str());
+            continue;
+        }
+        if (receiver_.accept(datagram, motion)) {
+            have_motion = true;
+        }
+    }
+
+    if (have_motion) {
+        handler_(motion);
+    }
+}
+
+} // namespace inputleap
@@ -0,0 +1,77 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "inputleap/MotionDatagram.h"
+#include "net/Fwd.h"
+#include "net/NetworkAddress.h"
+#include "base/Fwd.h"
+#include "base/EventTarget.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace inputleap {
+
+//! Motion datagram endpoint of the client
+/*!
+Receives the mouse motion the server sends as datagrams after a
+\c kMsgCDatagramOffer and acks it every \c kMotionDatagramAckRate seconds.
+The acks also tell the server where to send motion datagrams to.
+*/
+class MotionDatagramChannel : public EventTarget {
+public:
+    using MotionHandler = std::function<void(const MotionDatagramReceiver::Motion&)>;
+
+    /*!
+    Sends acks for \p session to \p server from \p socket and calls
+    \p handler with the motion of received datagrams.
+    */
+    MotionDatagramChannel(IEventQueue* events, std::unique_ptr<UDPSocket> socket,
+                          const NetworkAddress& server, std::uint32_t session,
+                          const MotionDatagramKey& key, MotionHandler handler);
+    ~MotionDatagramChannel();
+
+    //! @name manipulators
+    //@{
+
+    //! Apply motion resent over the stream
+    /*!
+    Calls the handler with the motion of \p sync unless that motion was
+    already received as a datagram.
+    */
+    void sync(const MotionDatagram& sync);
+
+    //@}
+
+private:
+    void send_ack();
+    void handle_input();
+
+private:
+    IEventQueue* events_;
+    std::unique_ptr<UDPSocket> socket_;
+    NetworkAddress server_;
+    std::uint32_t session_;
+    MotionDatagramKey key_;
+    MotionHandler handler_;
+    MotionDatagramReceiver receiver_;
+    std::uint32_t acks_sent_ = 0;
+    EventQueueTimer* ack_timer_;
+};
+
+} // namespace inputleap
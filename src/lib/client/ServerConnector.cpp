@@ -0,0 +1,361 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/ServerConnector.h"
+
+#include "net/IDataSocket.h"
+#include "net/ISocketFactory.h"
+#include "net/XSocket.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "base/IEventQueue.h"
+#include "base/EventQueueTimer.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace inputleap {
+
+ServerConnector::ServerConnector(IEventQueue* events, ISocketFactory* socket_factory,
+                                 ConnectedHandler connected, FailedHandler failed,
+                                 Resolver resolver) :
+    events_{events},
+    socket_factory_{socket_factory},
+    connected_{std::move(connected)},
+    failed_{std::move(failed)},
+    resolver_{std::move(resolver)}
+{
+    if (!resolver_) {
+        resolver_ = [](const NetworkAddress& address) { return address.resolve_all(); };
+    }
+
+    events_->add_handler(EventType::ADDRESS_RESOLVED, this,
+                         [this](const auto& e){ handle_resolved(); });
+}
+
+ServerConnector::~ServerConnector()
+{
+    cancel();
+    events_->remove_handler(EventType::ADDRESS_RESOLVED, this);
+}
+
+void ServerConnector::connect(const NetworkAddress& address,
+                              ConnectionSecurityLevel security_level)
+{
+    connect(std::vector<NetworkAddress>{address}, security_level);
+}
+
+void ServerConnector::connect(const std::vector<NetworkAddress>& servers,
+                              ConnectionSecurityLevel security_level)
+{
+    assert(!servers.empty());
+
+    cancel();
+    security_level_ = security_level;
+    last_error_.clear();
+
+    // resolve the server hostname.  do this every time we connect in
+    // case we couldn't resolve the address earlier or the address has
+    // changed (which can happen frequently if this is a laptop being
+    // shuttled between various networks).  the lookup can take seconds
+    // so it mustn't block the event loop.
+    auto resolution = std::make_shared<Resolution>();
+    resolution_ = resolution;
+
+    IEventQueue* events = events_;
+    Resolver resolver = resolver_;
+    const EventTarget* target = this;
+    Thread thread([events, resolver, servers, resolution, target]() {
+        std::vector<std::vector<NetworkAddress>> addresses;
+        std::string error;
+        for (const auto& server : servers) {
+            addresses.emplace_back();
+            try {
+                addresses.back() = resolver(server);
+                if (addresses.back().empty()) {
+                    error = XSocketAddress(XSocketAddress::kNoAddress,
+                                           server.getHostname(), server.getPort()).what();
+                }
+            }
+            catch (XBase& e) {
+                // the other servers may still be reachable
+                LOG_DEBUG1("cannot resolve %s: %s", server.getHostname().c_str(), e.what());
+                error = e.what();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(resolution->mutex);
+            resolution->done = true;
+            resolution->addresses = std::move(addresses);
+            resolution->error = std::move(error);
+        }
+        events->add_event(EventType::ADDRESS_RESOLVED, target);
+    });
+}
+
+void ServerConnector::cancel()
+{
+    // the lookup thread can't be stopped, its result is ignored instead
+    resolution_.reset();
+    pending_.clear();
+    cancel_attempt_timer();
+    while (!attempts_.empty()) {
+        remove_attempt(attempts_.back().socket.get(), nullptr);
+    }
+}
+
+bool ServerConnector::is_connecting() const
+{
+    return resolution_ != nullptr || !attempts_.empty() || !pending_.empty();
+}
+
+std::vector<NetworkAddress> ServerConnector::order_addresses(
+        const std::vector<NetworkAddress>& addresses, const NetworkAddress& preferred)
+{
+    std::vector<NetworkAddress> ordered;
+    ordered.reserve(addresses.size());
+
+    std::deque<NetworkAddress> first_family;
+    std::deque<NetworkAddress> other_family;
+    bool have_family = false;
+    IArchNetwork::EAddressFamily family = IArchNetwork::kUNKNOWN;
+    for (const auto& address : addresses) {
+        if (preferred.isValid() && ordered.empty() && address == preferred) {
+            ordered.push_back(address);
+            continue;
+        }
+
+        auto address_family = ARCH->getAddrFamily(address.getAddress());
+        if (!have_family) {
+            have_family = true;
+            family = address_family;
+        }
+        if (address_family == family) {
+            first_family.push_back(address);
+        } else {
+            other_family.push_back(address);
+        }
+    }
+
+    // alternate between the families so that a broken network for one of
+    // them costs at most one attempt delay
+    while (!first_family.empty() || !other_family.empty()) {
+        if (!first_family.empty()) {
+            ordered.push_back(first_family.front());
+            first_family.pop_front();
+        }
+        if (!other_family.empty()) {
+            ordered.push_back(other_family.front());
+            other_family.pop_front();
+        }
+    }
+    return ordered;
+}
+
+void ServerConnector::handle_resolved()
+{
+    if (resolution_ == nullptr) {
+        return;
+    }
+
+    std::vector<std::vector<NetworkAddress>> addresses;
+    {
+        std::lock_guard<std::mutex> lock(resolution_->mutex);
+        if (!resolution_->done) {
+            // from a lookup that was cancelled
+            return;
+        }
+        addresses = std::move(resolution_->addresses);
+        last_error_ = std::move(resolution_->error);
+    }
+    resolution_.reset();
+
+    for (std::size_t server = 0; server < addresses.size(); ++server) {
+        for (auto& address : order_addresses(addresses[server], last_address_)) {
+            pending_.push_back({std::move(address), server});
+        }
+    }
+    if (pending_.empty()) {
+        fail();
+        return;
+    }
+
+    current_server_ = pending_.front().server;
+    start_next_attempt();
+}
+
+void ServerConnector::handle_attempt_timer()
+{
+    cancel_attempt_timer();
+    start_next_attempt();
+}
+
+void ServerConnector::handle_attempt_connected(IDataSocket* socket)
+{
+    NetworkAddress address;
+    auto winner = remove_attempt(socket, &address);
+
+    // close the attempts that lost the race
+    pending_.clear();
+    cancel_attempt_timer();
+    while (!attempts_.empty()) {
+        remove_attempt(attempts_.back().socket.get(), nullptr);
+    }
+
+    last_address_ = address;
+    connected_(std::move(winner), address);
+}
+
+void ServerConnector::handle_attempt_failed(IDataSocket* socket, const Event& event)
+{
+    const auto& info = event.get_data_as<IDataSocket::ConnectionFailedInfo>();
+
+    NetworkAddress address;
+    remove_attempt(socket, &address);
+    LOG_DEBUG1("connecting to %s:%i failed: %s",
+               ARCH->addrToString(address.getAddress()).c_str(), address.getPort(),
+               info.m_what.c_str());
+    last_error_ = info.m_what;
+
+    // don't wait for the attempt delay when there's nothing in flight
+    if (!pending_.empty()) {
+        cancel_attempt_timer();
+        start_next_attempt();
+    }
+    else if (attempts_.empty()) {
+        fail();
+    }
+}
+
+void ServerConnector::start_next_attempt()
+{
+    auto connected_type = EventType::DATA_SOCKET_CONNECTED;
+    if (security_level_ != ConnectionSecurityLevel::PLAINTEXT) {
+        connected_type = EventType::DATA_SOCKET_SECURE_CONNECTED;
+    }
+
+    while (!pending_.empty()) {
+        NetworkAddress address = pending_.front().address;
+        current_server_ = pending_.front().server;
+        pending_.pop_front();
+
+        IDataSocket* socket = nullptr;
+        try {
+            // to help users troubleshoot, show server host name (issue: 60)
+            LOG_NOTE("connecting to '%s': %s:%i", address.getHostname().c_str(),
+                     ARCH->addrToString(address.getAddress()).c_str(), address.getPort());
+
+            Attempt attempt;
+            attempt.socket = socket_factory_->create(ARCH->getAddrFamily(address.getAddress()),
+                                                     security_level_);
+            attempt.address = address;
+            socket = attempt.socket.get();
+            attempts_.push_back(std::move(attempt));
+
+            events_->add_handler(connected_type, socket->get_event_target(),
+                                 [this, socket](const auto& e){
+                                     handle_attempt_connected(socket);
+                                 });
+            events_->add_handler(EventType::DATA_SOCKET_CONNECTION_FAILED,
+                                 socket->get_event_target(),
+                                 [this, socket](const auto& e){
+                                     handle_attempt_failed(socket, e);
+                                 });
+            socket->connect(address);
+            break;
+        }
+        catch (XBase& e) {
+            if (socket != nullptr) {
+                remove_attempt(socket, nullptr);
+            }
+            LOG_DEBUG1("cannot connect to %s:%i: %s",
+                       ARCH->addrToString(address.getAddress()).c_str(), address.getPort(),
+                       e.what());
+            last_error_ = e.what();
+        }
+    }
+
+    if (attempts_.empty()) {
+        fail();
+        return;
+    }
+    schedule_next_attempt();
+}
+
+void ServerConnector::schedule_next_attempt()
+{
+    if (pending_.empty() || attempt_timer_ != nullptr) {
+        return;
+    }
+
+    // give the server a chance before failing over to the next one
+    double delay = kConnectAttemptDelay;
+    if (pending_.front().server != current_server_) {
+        delay = failover_deadline_;
+    }
+    attempt_timer_ = events_->newOneShotTimer(delay, nullptr);
+    events_->add_handler(EventType::TIMER, attempt_timer_,
+                         [this](const auto& e){ handle_attempt_timer(); });
+}
+
+void ServerConnector::cancel_attempt_timer()
+{
+    if (attempt_timer_ != nullptr) {
+        events_->remove_handler(EventType::TIMER, attempt_timer_);
+        events_->deleteTimer(attempt_timer_);
+        attempt_timer_ = nullptr;
+    }
+}
+
+std::unique_ptr<IDataSocket> ServerConnector::remove_attempt(IDataSocket* socket,
+                                                             NetworkAddress* address)
+{
+    auto i = std::find_if(attempts_.begin(), attempts_.end(),
+                          [socket](const Attempt& attempt) {
+                              return attempt.socket.get() == socket;
+                          });
+    if (i == attempts_.end()) {
+        return {};
+    }
+
+    // a secure socket keeps its own handler for the plain connected event
+    if (security_level_ != ConnectionSecurityLevel::PLAINTEXT) {
+        events_->remove_handler(EventType::DATA_SOCKET_SECURE_CONNECTED,
+                                socket->get_event_target());
+    } else {
+        events_->remove_handler(EventType::DATA_SOCKET_CONNECTED, socket->get_event_target());
+    }
+    events_->remove_handler(EventType::DATA_SOCKET_CONNECTION_FAILED,
+                            socket->get_event_target());
+
+    auto removed = std::move(i->socket);
+    if (address != nullptr) {
+        *address = i->address;
+    }
+    attempts_.erase(i);
+    return removed;
+}
+
+void ServerConnector::fail()
+{
+    std::string error = last_error_.empty() ? "Connection failed" : last_error_;
+    cancel();
+    failed_(error);
+}
+
+} // namespace inputleap
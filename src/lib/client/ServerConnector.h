@@ -0,0 +1,183 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "net/ConnectionSecurityLevel.h"
+#include "net/Fwd.h"
+#include "net/NetworkAddress.h"
+#include "base/Fwd.h"
+#include "base/EventTarget.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace inputleap {
+
+//! Connects a client to its server
+/*!
+Looks up the server's host name on a separate thread so a slow resolver
+doesn't stall the event loop, then races connection attempts to the
+addresses it found in the manner of RFC 8305 ("Happy Eyeballs"):  a new
+attempt starts every \c kConnectAttemptDelay seconds, or as soon as the
+previous one fails, and the first socket to connect (and finish the TLS
+handshake when secure) wins while the others are closed.  The address
+that won is tried first the next time.
+
+Standby servers can be given after the primary one.  Their addresses
+join the race only when every attempt to the servers before them has
+failed or none of those connected within the failover deadline, so a
+standby is used while the primary is down but the primary wins while it
+is up.
+*/
+class ServerConnector : public EventTarget {
+public:
+    using Resolver = std::function<std::vector<NetworkAddress>(const NetworkAddress&)>;
+    using ConnectedHandler = std::function<void(std::unique_ptr<IDataSocket>,
+                                                const NetworkAddress&)>;
+    using FailedHandler = std::function<void(const std::string&)>;
+
+    //! Time between the starts of two connection attempts
+    static constexpr double kConnectAttemptDelay = 0.25;
+
+    //! Default time to wait for a server before trying the next one
+    static constexpr double kDefaultFailoverDeadline = 3.0;
+
+    /*!
+    Creates sockets with \p socket_factory and calls \p connected with the
+    socket that won and its address, or \p failed with the reason when no
+    address could be connected to.  \p resolver looks up the addresses of
+    a server;  it's called on another thread and defaults to
+    \c NetworkAddress::resolve_all().
+    */
+    ServerConnector(IEventQueue* events, ISocketFactory* socket_factory,
+                    ConnectedHandler connected, FailedHandler failed,
+                    Resolver resolver = Resolver());
+    ~ServerConnector();
+
+    //! @name manipulators
+    //@{
+
+    //! Connect to a server
+    /*!
+    Starts connecting to \p address, cancelling any connection that is
+    still in progress.  Exactly one of the handlers is called later.
+    */
+    void connect(const NetworkAddress& address, ConnectionSecurityLevel security_level);
+
+    //! Connect to one of several servers
+    /*!
+    Like \c connect() but tries the \p servers in order, failing over to
+    the next one as described above.  \p servers must not be empty.
+    */
+    void connect(const std::vector<NetworkAddress>& servers,
+                 ConnectionSecurityLevel security_level);
+
+    //! Set the failover deadline
+    /*!
+    Sets the number of seconds to wait for a server to connect before
+    trying the next one.
+    */
+    void set_failover_deadline(double seconds) { failover_deadline_ = seconds; }
+
+    //! Stop connecting
+    /*!
+    Closes all connection attempts and ignores the pending lookup.  No
+    handler is called.
+    */
+    void cancel();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Test if connecting
+    /*!
+    Returns true while a lookup or a connection attempt is in progress.
+    */
+    bool is_connecting() const;
+
+    //! Get the last address connected to
+    /*!
+    Returns the address of the last connection that won, or the invalid
+    address if there wasn't one yet.
+    */
+    const NetworkAddress& get_last_address() const { return last_address_; }
+
+    //! Order addresses for connecting
+    /*!
+    Returns \p addresses with \p preferred first if it's among them and
+    the rest interleaved by address family, starting with the family of
+    the first address.
+    */
+    static std::vector<NetworkAddress> order_addresses(
+            const std::vector<NetworkAddress>& addresses, const NetworkAddress& preferred);
+
+    //@}
+
+private:
+    // written by the lookup thread, read on the event loop.  there's a
+    // list of addresses for each server, empty if it couldn't be resolved.
+    struct Resolution {
+        std::mutex mutex;
+        bool done = false;
+        std::vector<std::vector<NetworkAddress>> addresses;
+        std::string error;
+    };
+
+    struct Candidate {
+        NetworkAddress address;
+        std::size_t server;
+    };
+
+    struct Attempt {
+        std::unique_ptr<IDataSocket> socket;
+        NetworkAddress address;
+    };
+
+    void handle_resolved();
+    void handle_attempt_timer();
+    void handle_attempt_connected(IDataSocket* socket);
+    void handle_attempt_failed(IDataSocket* socket, const Event& event);
+
+    void start_next_attempt();
+    void schedule_next_attempt();
+    void cancel_attempt_timer();
+    std::unique_ptr<IDataSocket> remove_attempt(IDataSocket* socket, NetworkAddress* address);
+    void fail();
+
+private:
+    IEventQueue* events_;
+    ISocketFactory* socket_factory_;
+    ConnectedHandler connected_;
+    FailedHandler failed_;
+    Resolver resolver_;
+
+    ConnectionSecurityLevel security_level_ = ConnectionSecurityLevel::PLAINTEXT;
+    std::shared_ptr<Resolution> resolution_;
+    std::deque<Candidate> pending_;
+    std::vector<Attempt> attempts_;
+    EventQueueTimer* attempt_timer_ = nullptr;
+    std::size_t current_server_ = 0;
+    double failover_deadline_ = kDefaultFailoverDeadline;
+    std::string last_error_;
+    NetworkAddress last_address_;
+};
+
+} // namespace inputleap
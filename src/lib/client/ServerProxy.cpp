@@ -19,7 +19,9 @@
 #include "client/ServerProxy.h"
 
 #include "client/Client.h"
+#include "client/MotionDatagramChannel.h"
 #include "inputleap/FileChunk.h"
+#include "inputleap/ClipboardCache.h"
 #include "inputleap/ClipboardChunk.h"
 #include "inputleap/StreamChunker.h"
 #include "inputleap/Clipboard.h"
@@ -28,11 +30,15 @@
 #include "inputleap/protocol_types.h"
 #include "inputleap/Exceptions.h"
 #include "io/IStream.h"
+#include "net/UDPSocket.h"
+#include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 #include "base/EventQueueTimer.h"
 #include "base/XBase.h"
+#include "base/Time.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace inputleap {
@@ -72,11 +78,46 @@ ServerProxy::ServerProxy(Client* client, inputleap::IStream* stream, IEventQueue
 
 ServerProxy::~ServerProxy()
 {
+    motion_channel_.reset();
     setKeepAliveRate(-1.0);
-    m_events->remove_handler(EventType::STREAM_INPUT_READY, m_stream->get_event_target());
+    if (m_stream != nullptr) {
+        m_events->remove_handler(EventType::STREAM_INPUT_READY, m_stream->get_event_target());
+    }
     m_events->remove_handler(EventType::CLIPBOARD_SENDING, this);
 }
 
+void ServerProxy::detach_stream()
+{
+    if (m_stream == nullptr) {
+        return;
+    }
+    m_events->remove_handler(EventType::STREAM_INPUT_READY, m_stream->get_event_target());
+    m_stream = nullptr;
+    frames_.set_stream(nullptr);
+
+    // nothing to wait for until there's a new connection
+    if (m_keepAliveAlarmTimer != nullptr) {
+        m_events->remove_handler(EventType::TIMER, m_keepAliveAlarmTimer);
+        m_events->deleteTimer(m_keepAliveAlarmTimer);
+        m_keepAliveAlarmTimer = nullptr;
+    }
+}
+
+void ServerProxy::attach_stream(inputleap::IStream* stream)
+{
+    assert(m_stream == nullptr);
+    assert(stream != nullptr);
+
+    m_stream = stream;
+    m_events->add_handler(EventType::STREAM_INPUT_READY, m_stream->get_event_target(),
+                          [this](const auto& e){ handle_data(); });
+
+    // the server asks for our info on the new connection, we answer with
+    // the session instead
+    m_parser = &ServerProxy::parseHandshakeMessage;
+    resuming_ = true;
+}
+
 void
 ServerProxy::resetKeepAliveAlarm()
 {
@@ -102,11 +143,14 @@ ServerProxy::setKeepAliveRate(double rate)
 
 void ServerProxy::handle_data()
 {
-    // handle messages until there are no more.  first read message code.
-    std::uint8_t code[4];
-    std::uint32_t n = m_stream->read(code, 4);
-    while (n != 0) {
+    // handle messages until there are no more or the budget runs out.
+    // each message is taken off the stream whole and parsed from memory.
+    frames_.set_stream(m_stream);
+    read_budget_.start(current_time_seconds());
+    while (frames_.read_frame()) {
         // verify we got an entire code
+        std::uint8_t code[4];
+        std::uint32_t n = frames_.read(code, 4);
         if (n != 4) {
             LOG_ERR("incomplete message from server: %d bytes", n);
             m_client->disconnect("incomplete message from server");
@@ -140,8 +184,14 @@ void ServerProxy::handle_data()
             return;
         }
 
-        // next message
-        n = m_stream->read(code, 4);
+        // let other events through if we've fallen behind.  motion is
+        // only still pending if more motion is queued, it collapses with
+        // that in the next slice.
+        if (!read_budget_.consume(current_time_seconds()) && frames_.isReady()) {
+            LOG_DEBUG2("yielding after %u messages from server", read_budget_.get_count());
+            m_events->add_event(EventType::STREAM_INPUT_READY, m_stream->get_event_target());
+            return;
+        }
     }
 
     flushCompressedMouse();
@@ -150,7 +200,19 @@ void ServerProxy::handle_data()
 ServerProxy::EResult ServerProxy::parseHandshakeMessage(const std::uint8_t* code)
 {
     if (memcmp(code, kMsgQInfo, 4) == 0) {
-        queryInfo();
+        if (resuming_) {
+            LOG_DEBUG1("resuming session after %u messages", session_received_);
+            ProtocolUtil::writef(m_stream, kMsgQResume, &session_token_, session_received_);
+        }
+        else {
+            queryInfo();
+        }
+    }
+
+    else if (memcmp(code, kMsgCResume, 4) == 0) {
+        if (!sessionResumed()) {
+            return kDisconnect;
+        }
     }
 
     else if (memcmp(code, kMsgCInfoAck, 4) == 0) {
@@ -188,7 +250,7 @@ ServerProxy::EResult ServerProxy::parseHandshakeMessage(const std::uint8_t* code
 
     else if (memcmp(code, kMsgEIncompatible, 4) == 0) {
         std::int32_t major, minor;
-        ProtocolUtil::readf(m_stream,
+        ProtocolUtil::readf(&frames_,
                         kMsgEIncompatible + 4, &major, &minor);
         LOG_ERR("server has incompatible version %d.%d", major, minor);
         m_client->disconnect("server has incompatible version");
@@ -221,6 +283,11 @@ ServerProxy::EResult ServerProxy::parseHandshakeMessage(const std::uint8_t* code
 
 ServerProxy::EResult ServerProxy::parseMessage(const std::uint8_t* code)
 {
+    // count messages for resuming the session
+    if (session_) {
+        ++session_received_;
+    }
+
     if (memcmp(code, kMsgDMouseMove, 4) == 0) {
         mouseMove();
     }
@@ -229,6 +296,14 @@ ServerProxy::EResult ServerProxy::parseMessage(const std::uint8_t* code)
         mouseRelativeMove();
     }
 
+    else if (memcmp(code, kMsgDMouseMoveTimed, 4) == 0) {
+        mouseMoveTimed();
+    }
+
+    else if (memcmp(code, kMsgDMouseRelMoveTimed, 4) == 0) {
+        mouseRelativeMoveTimed();
+    }
+
     else if (memcmp(code, kMsgDMouseWheel, 4) == 0) {
         mouseWheel();
     }
@@ -253,10 +328,20 @@ ServerProxy::EResult ServerProxy::parseMessage(const std::uint8_t* code)
         keyRepeat();
     }
 
+    else if (memcmp(code, kMsgDMotionSync, 4) == 0) {
+        motionSync();
+    }
+
     else if (memcmp(code, kMsgCKeepAlive, 4) == 0) {
-        // echo keep alives and reset alarm
-        ProtocolUtil::writef(m_stream, kMsgCKeepAlive);
-        resetKeepAliveAlarm();
+        keepAlive();
+    }
+
+    else if (memcmp(code, kMsgCKeepAliveTimed, 4) == 0) {
+        keepAliveTimed();
+    }
+
+    else if (memcmp(code, kMsgCClock, 4) == 0) {
+        clockReceived();
     }
 
     else if (memcmp(code, kMsgCNoop, 4) == 0) {
@@ -291,6 +376,14 @@ ServerProxy::EResult ServerProxy::parseMessage(const std::uint8_t* code)
         setClipboard();
     }
 
+    else if (memcmp(code, kMsgDClipboardCached, 4) == 0) {
+        setCachedClipboard();
+    }
+
+    else if (memcmp(code, kMsgDClipboardFormats, 4) == 0) {
+        setClipboardFormats();
+    }
+
     else if (memcmp(code, kMsgCResetOptions, 4) == 0) {
         resetOptions();
     }
@@ -306,6 +399,14 @@ ServerProxy::EResult ServerProxy::parseMessage(const std::uint8_t* code)
         dragInfoReceived();
     }
 
+    else if (memcmp(code, kMsgCDatagramOffer, 4) == 0) {
+        datagramOffer();
+    }
+
+    else if (memcmp(code, kMsgCSession, 4) == 0) {
+        sessionStarted();
+    }
+
     else if (memcmp(code, kMsgCClose, 4) == 0) {
         // server wants us to hangup
         LOG_DEBUG1("recv close");
@@ -330,18 +431,29 @@ ServerProxy::EResult ServerProxy::parseMessage(const std::uint8_t* code)
     // TCP_NODELAY is enabled.
     ProtocolUtil::writef(m_stream, kMsgCNoop);
 
+    // let the server drop the messages we have
+    if (session_ && session_received_ - session_acked_ >= kSessionAckInterval) {
+        sendSessionAck();
+    }
+
     return kOkay;
 }
 
 void ServerProxy::handle_keep_alive_alarm()
 {
     LOG_NOTE("server is dead");
-    m_client->disconnect("server is not responding");
+    if (!m_client->start_session_resume()) {
+        m_client->disconnect("server is not responding");
+    }
 }
 
 void
 ServerProxy::onInfoChanged()
 {
+    if (m_stream == nullptr) {
+        return;
+    }
+
     // ignore mouse motion until we receive acknowledgment of our info
     // change message.
     m_ignoreMouse = true;
@@ -353,6 +465,9 @@ ServerProxy::onInfoChanged()
 bool
 ServerProxy::onGrabClipboard(ClipboardID id)
 {
+    if (m_stream == nullptr) {
+        return false;
+    }
     LOG_DEBUG1("sending clipboard %d changed", id);
     ProtocolUtil::writef(m_stream, kMsgCClipboard, id, m_seqNum);
     return true;
@@ -364,21 +479,92 @@ ServerProxy::onClipboardChanged(ClipboardID id, const IClipboard* clipboard)
     std::string data = IClipboard::marshall(clipboard);
     LOG_DEBUG("sending clipboard %d seqnum=%d", id, m_seqNum);
 
+    // the server may offer it back later
+    if (clipboard_cache_ && data.size() >= ClipboardCache::kMinSize) {
+        m_client->get_clipboard_cache().insert(ClipboardCache::hash(data), data);
+    }
+
     StreamChunker::sendClipboard(data, data.size(), id, m_seqNum, m_events, this);
 }
 
+bool ServerProxy::request_clipboard(ClipboardID id)
+{
+    if (m_stream == nullptr) {
+        return false;
+    }
+    LOG_DEBUG("asking for clipboard %d", id);
+    ProtocolUtil::writef(m_stream, kMsgQClipboard, id, clipboard_formats_seq_[id]);
+    return true;
+}
+
 void
 ServerProxy::flushCompressedMouse()
 {
     if (m_compressMouse) {
         m_compressMouse = false;
         m_client->mouseMove(m_xMouse, m_yMouse);
+        recordMotionInjected();
     }
     if (m_compressMouseRelative) {
         m_compressMouseRelative = false;
         m_client->mouseRelativeMove(m_dxMouse, m_dyMouse);
         m_dxMouse = 0;
         m_dyMouse = 0;
+        recordMotionInjected();
+    }
+}
+
+void ServerProxy::recordMotionReceived(std::uint32_t sent, double now)
+{
+    // the send time is only meaningful once we know the server's clock
+    if (clock_.is_valid()) {
+        std::int32_t latency = wire_time_diff(to_wire_time(now), clock_.to_local(sent));
+        send_to_receive_.record(latency > 0 ? static_cast<std::uint32_t>(latency) : 0);
+    }
+
+    // compressed motion waits since the first message was received
+    if (motion_received_ == 0.0) {
+        motion_received_ = now;
+    }
+}
+
+void ServerProxy::recordMotionInjected()
+{
+    if (motion_received_ != 0.0) {
+        receive_to_inject_.record_seconds(current_time_seconds() - motion_received_);
+        motion_received_ = 0.0;
+    }
+}
+
+std::vector<LatencyReport> ServerProxy::get_latency_reports(const std::string& name) const
+{
+    std::vector<LatencyReport> reports;
+    if (send_to_receive_.get_count() != 0) {
+        reports.push_back({name, LatencyStage::SendToReceive, send_to_receive_.get_summary()});
+    }
+    if (receive_to_inject_.get_count() != 0) {
+        reports.push_back({name, LatencyStage::ReceiveToInject,
+                           receive_to_inject_.get_summary()});
+    }
+    return reports;
+}
+
+void ServerProxy::apply_datagram_motion(const MotionDatagramReceiver::Motion& motion)
+{
+    if (m_ignoreMouse) {
+        return;
+    }
+
+    // motion from the stream that's still pending came first
+    flushCompressedMouse();
+
+    if (motion.has_absolute) {
+        LOG_DEBUG2("recv mouse move datagram %d,%d", motion.x, motion.y);
+        m_client->mouseMove(motion.x, motion.y);
+    }
+    if (motion.dx != 0 || motion.dy != 0) {
+        LOG_DEBUG2("recv mouse relative move datagram %d,%d", motion.dx, motion.dy);
+        m_client->mouseRelativeMove(motion.dx, motion.dy);
     }
 }
 
@@ -521,7 +707,7 @@ ServerProxy::enter()
     std::int16_t x, y;
     std::uint16_t mask;
     std::uint32_t seqNum;
-    ProtocolUtil::readf(m_stream, kMsgCEnter + 4, &x, &y, &seqNum, &mask);
+    ProtocolUtil::readf(&frames_, kMsgCEnter + 4, &x, &y, &seqNum, &mask);
     LOG_DEBUG1("recv enter, %d,%d %d %04x", x, y, seqNum, mask);
 
     // discard old compressed mouse motion, if any
@@ -530,6 +716,7 @@ ServerProxy::enter()
     m_dxMouse               = 0;
     m_dyMouse               = 0;
     m_seqNum                = seqNum;
+    motion_received_        = 0.0;
 
     // forward
     m_client->enter(x, y, seqNum, static_cast<KeyModifierMask>(mask), false);
@@ -556,7 +743,7 @@ ServerProxy::setClipboard()
     ClipboardID id;
     std::uint32_t seq;
 
-    int r = ClipboardChunk::assemble(m_stream, dataCached, id, seq);
+    int r = ClipboardChunk::assemble(&frames_, dataCached, id, seq);
 
     if (r == kStart) {
         size_t size = ClipboardChunk::getExpectedSize();
@@ -565,6 +752,10 @@ ServerProxy::setClipboard()
     else if (r == kFinish) {
         LOG_DEBUG("received clipboard %d size=%zd", id, dataCached.size());
 
+        if (clipboard_cache_ && dataCached.size() >= ClipboardCache::kMinSize) {
+            m_client->get_clipboard_cache().insert(ClipboardCache::hash(dataCached), dataCached);
+        }
+
         // forward
         Clipboard clipboard;
         clipboard.unmarshall(dataCached, 0);
@@ -574,13 +765,73 @@ ServerProxy::setClipboard()
     }
 }
 
+void ServerProxy::setCachedClipboard()
+{
+    // parse
+    ClipboardID id;
+    std::uint32_t seq;
+    std::string hash;
+    ProtocolUtil::readf(&frames_, kMsgDClipboardCached + 4, &id, &seq, &hash);
+
+    // validate
+    if (id >= kClipboardEnd) {
+        return;
+    }
+
+    // ask for the data if we don't have it anymore
+    std::string data;
+    if (!m_client->get_clipboard_cache().find(hash, data)) {
+        LOG_DEBUG("clipboard %d not in cache, asking for it", id);
+        ProtocolUtil::writef(m_stream, kMsgCClipboardMiss, id, &hash);
+        return;
+    }
+    LOG_DEBUG("received cached clipboard %d size=%zd", id, data.size());
+
+    // forward
+    Clipboard clipboard;
+    clipboard.unmarshall(data, 0);
+    m_client->setClipboard(id, &clipboard);
+
+    LOG_INFO("clipboard was updated");
+}
+
+void ServerProxy::setClipboardFormats()
+{
+    // parse
+    ClipboardID id;
+    std::uint32_t seq;
+    std::vector<std::uint32_t> described;
+    ProtocolUtil::readf(&frames_, kMsgDClipboardFormats + 4, &id, &seq, &described);
+
+    // validate
+    if (id >= kClipboardEnd) {
+        return;
+    }
+
+    // pairs of format and size, skip formats we don't know
+    std::vector<IClipboard::EFormat> formats;
+    std::uint64_t size = 0;
+    for (std::size_t i = 0; i + 1 < described.size(); i += 2) {
+        if (described[i] < IClipboard::kNumFormats) {
+            formats.push_back(static_cast<IClipboard::EFormat>(described[i]));
+            size += described[i + 1];
+        }
+    }
+    LOG_DEBUG("received clipboard %d formats=%zd size=%llu", id, formats.size(),
+              static_cast<unsigned long long>(size));
+
+    // forward
+    clipboard_formats_seq_[id] = seq;
+    m_client->set_clipboard_formats(id, formats);
+}
+
 void
 ServerProxy::grabClipboard()
 {
     // parse
     ClipboardID id;
     std::uint32_t seqNum;
-    ProtocolUtil::readf(m_stream, kMsgCClipboard + 4, &id, &seqNum);
+    ProtocolUtil::readf(&frames_, kMsgCClipboard + 4, &id, &seqNum);
     LOG_DEBUG("recv grab clipboard %d", id);
 
     // validate
@@ -600,7 +851,7 @@ ServerProxy::keyDown()
 
     // parse
     std::uint16_t id, mask, button;
-    ProtocolUtil::readf(m_stream, kMsgDKeyDown + 4, &id, &mask, &button);
+    ProtocolUtil::readf(&frames_, kMsgDKeyDown + 4, &id, &mask, &button);
     LOG_DEBUG1("recv key down id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button);
 
     // translate
@@ -623,7 +874,7 @@ ServerProxy::keyRepeat()
 
     // parse
     std::uint16_t id, mask, count, button;
-    ProtocolUtil::readf(m_stream, kMsgDKeyRepeat + 4,
+    ProtocolUtil::readf(&frames_, kMsgDKeyRepeat + 4,
                                 &id, &mask, &count, &button);
     LOG_DEBUG1("recv key repeat id=0x%08x, mask=0x%04x, count=%d, button=0x%04x", id, mask, count, button);
 
@@ -647,7 +898,7 @@ ServerProxy::keyUp()
 
     // parse
     std::uint16_t id, mask, button;
-    ProtocolUtil::readf(m_stream, kMsgDKeyUp + 4, &id, &mask, &button);
+    ProtocolUtil::readf(&frames_, kMsgDKeyUp + 4, &id, &mask, &button);
     LOG_DEBUG1("recv key up id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button);
 
     // translate
@@ -670,7 +921,7 @@ ServerProxy::mouseDown()
 
     // parse
     std::int8_t id;
-    ProtocolUtil::readf(m_stream, kMsgDMouseDown + 4, &id);
+    ProtocolUtil::readf(&frames_, kMsgDMouseDown + 4, &id);
     LOG_DEBUG1("recv mouse down id=%d", id);
 
     // forward
@@ -685,7 +936,7 @@ ServerProxy::mouseUp()
 
     // parse
     std::int8_t id;
-    ProtocolUtil::readf(m_stream, kMsgDMouseUp + 4, &id);
+    ProtocolUtil::readf(&frames_, kMsgDMouseUp + 4, &id);
     LOG_DEBUG1("recv mouse up id=%d", id);
 
     // forward
@@ -696,63 +947,97 @@ void
 ServerProxy::mouseMove()
 {
     // parse
-    bool ignore;
     std::int16_t x, y;
-    ProtocolUtil::readf(m_stream, kMsgDMouseMove + 4, &x, &y);
-
-    // note if we should ignore the move
-    ignore = m_ignoreMouse;
-
-    // compress mouse motion events if more input follows
-    if (!ignore && !m_compressMouse && m_stream->isReady()) {
-        m_compressMouse = true;
-    }
-
-    // if compressing then ignore the motion but record it
-    if (m_compressMouse) {
-        m_compressMouseRelative = false;
-        ignore    = true;
-        m_xMouse  = x;
-        m_yMouse  = y;
-        m_dxMouse = 0;
-        m_dyMouse = 0;
-    }
+    ProtocolUtil::readf(&frames_, kMsgDMouseMove + 4, &x, &y);
     LOG_DEBUG2("recv mouse move %d,%d", x, y);
 
-    // forward
-    if (!ignore) {
-        m_client->mouseMove(x, y);
-    }
+    forwardMouseMove(x, y);
 }
 
 void
 ServerProxy::mouseRelativeMove()
 {
     // parse
-    bool ignore;
     std::int16_t dx, dy;
-    ProtocolUtil::readf(m_stream, kMsgDMouseRelMove + 4, &dx, &dy);
+    ProtocolUtil::readf(&frames_, kMsgDMouseRelMove + 4, &dx, &dy);
+    LOG_DEBUG2("recv mouse relative move %d,%d", dx, dy);
+
+    forwardMouseRelativeMove(dx, dy);
+}
+
+void ServerProxy::mouseMoveTimed()
+{
+    // parse
+    std::int16_t x, y;
+    std::uint32_t captured, sent;
+    ProtocolUtil::readf(&frames_, kMsgDMouseMoveTimed + 4, &x, &y, &captured, &sent);
+    LOG_DEBUG2("recv mouse move %d,%d captured=%u sent=%u", x, y, captured, sent);
+
+    recordMotionReceived(sent, current_time_seconds());
+    forwardMouseMove(x, y);
+}
+
+void ServerProxy::mouseRelativeMoveTimed()
+{
+    // parse
+    std::int16_t dx, dy;
+    std::uint32_t captured, sent;
+    ProtocolUtil::readf(&frames_, kMsgDMouseRelMoveTimed + 4, &dx, &dy, &captured, &sent);
+    LOG_DEBUG2("recv mouse relative move %d,%d captured=%u sent=%u", dx, dy, captured, sent);
 
-    // note if we should ignore the move
-    ignore = m_ignoreMouse;
+    recordMotionReceived(sent, current_time_seconds());
+    forwardMouseRelativeMove(dx, dy);
+}
 
-    // compress mouse motion events if more input follows
-    if (!ignore && !m_compressMouseRelative && m_stream->isReady()) {
-        m_compressMouseRelative = true;
+void ServerProxy::forwardMouseMove(std::int16_t x, std::int16_t y)
+{
+    if (m_ignoreMouse) {
+        motion_received_ = 0.0;
+        return;
     }
 
-    // if compressing then ignore the motion but record it
-    if (m_compressMouseRelative) {
-        ignore     = true;
-        m_dxMouse += dx;
-        m_dyMouse += dy;
+    // absolute motion replaces any motion before it
+    m_compressMouse         = true;
+    m_compressMouseRelative = false;
+    m_xMouse  = x;
+    m_yMouse  = y;
+    m_dxMouse = 0;
+    m_dyMouse = 0;
+
+    // collapse the motion queued right behind this into one move
+    if (!isMotionQueued()) {
+        flushCompressedMouse();
     }
-    LOG_DEBUG2("recv mouse relative move %d,%d", dx, dy);
+}
 
-    // forward
-    if (!ignore) {
-        m_client->mouseRelativeMove(dx, dy);
+void ServerProxy::forwardMouseRelativeMove(std::int16_t dx, std::int16_t dy)
+{
+    if (m_ignoreMouse) {
+        motion_received_ = 0.0;
+        return;
     }
+
+    // relative motion adds up
+    m_compressMouseRelative = true;
+    m_dxMouse += dx;
+    m_dyMouse += dy;
+
+    // collapse the motion queued right behind this into one move
+    if (!isMotionQueued()) {
+        flushCompressedMouse();
+    }
+}
+
+bool ServerProxy::isMotionQueued()
+{
+    std::uint8_t code[4];
+    bool motion = frames_.read_frame() && frames_.read(code, 4) == 4 &&
+                  (memcmp(code, kMsgDMouseMove, 4) == 0 ||
+                   memcmp(code, kMsgDMouseRelMove, 4) == 0 ||
+                   memcmp(code, kMsgDMouseMoveTimed, 4) == 0 ||
+                   memcmp(code, kMsgDMouseRelMoveTimed, 4) == 0);
+    frames_.unread_frame();
+    return motion;
 }
 
 void
@@ -763,7 +1048,7 @@ ServerProxy::mouseWheel()
 
     // parse
     std::int16_t xDelta, yDelta;
-    ProtocolUtil::readf(m_stream, kMsgDMouseWheel + 4, &xDelta, &yDelta);
+    ProtocolUtil::readf(&frames_, kMsgDMouseWheel + 4, &xDelta, &yDelta);
     LOG_DEBUG2("recv mouse wheel %+d,%+d", xDelta, yDelta);
 
     // forward
@@ -775,7 +1060,7 @@ ServerProxy::screensaver()
 {
     // parse
     std::int8_t on;
-    ProtocolUtil::readf(m_stream, kMsgCScreenSaver + 4, &on);
+    ProtocolUtil::readf(&frames_, kMsgCScreenSaver + 4, &on);
     LOG_DEBUG1("recv screen saver on=%d", on);
 
     // forward
@@ -794,6 +1079,9 @@ ServerProxy::resetOptions()
     // reset keep alive
     setKeepAliveRate(kKeepAliveRate);
 
+    // features are offered again with the options
+    timestamps_ = false;
+
     // reset modifier translation table
     for (KeyModifierID id = 0; id < kKeyModifierIDLast; ++id) {
         m_modifierTranslationTable[id] = id;
@@ -805,7 +1093,7 @@ ServerProxy::setOptions()
 {
     // parse
     OptionsList options;
-    ProtocolUtil::readf(m_stream, kMsgDSetOptions + 4, &options);
+    ProtocolUtil::readf(&frames_, kMsgDSetOptions + 4, &options);
     LOG_DEBUG1("recv set options size=%zd", options.size());
 
     // forward
@@ -836,6 +1124,20 @@ ServerProxy::setOptions()
             // update keep alive
             setKeepAliveRate(1.0e-3 * static_cast<double>(options[i + 1]));
         }
+        else if (options[i] == kOptionProtocolFeatures) {
+            // tell the server which of the offered features we support
+            std::uint32_t features = options[i + 1] & kProtocolFeaturesSupported;
+            LOG_DEBUG1("sending features %08x", features);
+            ProtocolUtil::writef(m_stream, kMsgCFeatures, features);
+
+            // start estimating the server's clock right away
+            bool timestamps = (features & kProtocolFeatureTimestamps) != 0;
+            if (timestamps && !timestamps_) {
+                ProtocolUtil::writef(m_stream, kMsgQClock, to_wire_time(current_time_seconds()));
+            }
+            timestamps_ = timestamps;
+            clipboard_cache_ = (features & kProtocolFeatureClipboardCache) != 0;
+        }
 
         if (id != kKeyModifierIDNull) {
             m_modifierTranslationTable[id] =
@@ -865,7 +1167,7 @@ void
 ServerProxy::fileChunkReceived()
 {
     int result = FileChunk::assemble(
-                    m_stream,
+                    &frames_,
                     m_client->getReceivedFileData(),
                     m_client->getExpectedFileSize());
 
@@ -886,13 +1188,168 @@ ServerProxy::dragInfoReceived()
     // parse
     std::uint32_t fileNum = 0;
     std::string content;
-    ProtocolUtil::readf(m_stream, kMsgDDragInfo + 4, &fileNum, &content);
+    ProtocolUtil::readf(&frames_, kMsgDDragInfo + 4, &fileNum, &content);
 
     m_client->dragInfoReceived(fileNum, content);
 }
 
+void ServerProxy::datagramOffer()
+{
+    // parse
+    std::uint16_t port;
+    std::uint32_t session;
+    std::string key;
+    ProtocolUtil::readf(&frames_, kMsgCDatagramOffer + 4, &port, &session, &key);
+    LOG_DEBUG1("recv motion datagram offer port=%d session=%08x", port, session);
+
+    MotionDatagramKey sessionKey;
+    if (key.size() != sessionKey.size() || port == 0) {
+        LOG_WARN("invalid motion datagram offer from server");
+        return;
+    }
+    std::copy(key.begin(), key.end(), sessionKey.begin());
+
+    // datagrams go to the host we're connected to
+    NetworkAddress serverAddress = m_client->getServerAddress();
+    if (!serverAddress.isValid()) {
+        return;
+    }
+    ArchNetAddress address = ARCH->copyAddr(serverAddress.getAddress());
+    ARCH->setAddrPort(address, port);
+    NetworkAddress destination(address);
+
+    // without a channel motion keeps arriving over the stream
+    motion_channel_.reset();
+    try {
+        motion_channel_ = std::make_unique<MotionDatagramChannel>(
+                    m_events, m_client->create_datagram_socket(), destination, session,
+                    sessionKey,
+                    [this](const auto& motion){ apply_datagram_motion(motion); });
+    }
+    catch (XBase& e) {
+        LOG_WARN("cannot receive motion datagrams: %s", e.what());
+    }
+}
+
+void ServerProxy::motionSync()
+{
+    // parse
+    MotionDatagram sync;
+    ProtocolUtil::readf(&frames_, kMsgDMotionSync + 4, &sync.seq, &sync.flags,
+                        &sync.x, &sync.y, &sync.dx_total, &sync.dy_total);
+    LOG_DEBUG2("recv motion sync seq=%u", sync.seq);
+
+    if (motion_channel_) {
+        motion_channel_->sync(sync);
+    }
+    else if ((sync.flags & MotionDatagram::kAbsolute) != 0) {
+        // we never had datagrams but the position is still valid
+        MotionDatagramReceiver::Motion motion;
+        motion.has_absolute = true;
+        motion.x = sync.x;
+        motion.y = sync.y;
+        apply_datagram_motion(motion);
+    }
+}
+
+void ServerProxy::keepAlive()
+{
+    // echo keep alives and reset alarm
+    ProtocolUtil::writef(m_stream, kMsgCKeepAlive);
+    resetKeepAliveAlarm();
+    if (session_) {
+        sendSessionAck();
+    }
+
+    // keep the estimate of the server's clock current
+    if (timestamps_) {
+        ProtocolUtil::writef(m_stream, kMsgQClock, to_wire_time(current_time_seconds()));
+    }
+}
+
+void ServerProxy::keepAliveTimed()
+{
+    // parse
+    std::uint32_t server_time, timeout_ms;
+    ProtocolUtil::readf(&frames_, kMsgCKeepAliveTimed + 4, &server_time, &timeout_ms);
+
+    // echo the server's timestamp so it can measure the round trip time
+    ProtocolUtil::writef(m_stream, kMsgCKeepAliveEcho, server_time);
+
+    // wait for the server as long as it waits for us
+    if (timeout_ms != 0) {
+        m_keepAliveAlarm = 1.0e-3 * static_cast<double>(timeout_ms);
+    }
+    resetKeepAliveAlarm();
+    if (session_) {
+        sendSessionAck();
+    }
+
+    if (timestamps_) {
+        ProtocolUtil::writef(m_stream, kMsgQClock, to_wire_time(current_time_seconds()));
+    }
+}
+
+void ServerProxy::clockReceived()
+{
+    // parse
+    std::uint32_t query_time, server_time;
+    ProtocolUtil::readf(&frames_, kMsgCClock + 4, &query_time, &server_time);
+
+    clock_.add_sample(query_time, server_time, to_wire_time(current_time_seconds()));
+    LOG_DEBUG2("recv clock, server offset=%dus rtt=%uus", clock_.get_offset(),
+               clock_.get_round_trip_time());
+}
+
+void ServerProxy::sessionStarted()
+{
+    // parse
+    std::string token;
+    ProtocolUtil::readf(&frames_, kMsgCSession + 4, &token);
+    LOG_DEBUG1("recv session");
+
+    // the count starts after this message
+    session_ = true;
+    session_token_ = token;
+    session_received_ = 0;
+    session_acked_ = 0;
+}
+
+bool ServerProxy::sessionResumed()
+{
+    // parse
+    std::int8_t resumed;
+    ProtocolUtil::readf(&frames_, kMsgCResume + 4, &resumed);
+    resuming_ = false;
+
+    if (resumed == 0) {
+        LOG_NOTE("server could not resume the session");
+        session_ = false;
+        m_client->session_resume_failed();
+        return false;
+    }
+
+    // the server continues with the messages we missed
+    LOG_DEBUG1("recv session resumed");
+    m_parser = &ServerProxy::parseMessage;
+    session_acked_ = session_received_;
+    resetKeepAliveAlarm();
+    m_client->session_resumed();
+    return true;
+}
+
+void ServerProxy::sendSessionAck()
+{
+    ProtocolUtil::writef(m_stream, kMsgCSessionAck, session_received_);
+    session_acked_ = session_received_;
+}
+
 void ServerProxy::handle_clipboard_sending_event(const Event& event)
 {
+    // chunks of a clipboard sent before the connection was lost
+    if (m_stream == nullptr) {
+        return;
+    }
     const auto& chunk = event.get_data_as<ClipboardChunk>();
     ProtocolUtil::writef(m_stream, kMsgDClipboard, chunk.id_, chunk.sequence_, chunk.mark_,
                          &chunk.data_);
@@ -900,11 +1357,17 @@ void ServerProxy::handle_clipboard_sending_event(const Event& event)
 
 void ServerProxy::file_chunk_sending(const FileChunk& chunk)
 {
+    if (m_stream == nullptr) {
+        return;
+    }
     ProtocolUtil::writef(m_stream, kMsgDFileTransfer, chunk.mark_, &chunk.data_);
 }
 
 void ServerProxy::sendDragInfo(std::uint32_t fileCount, const char* info, size_t size)
 {
+    if (m_stream == nullptr) {
+        return;
+    }
     std::string data(info, size);
     ProtocolUtil::writef(m_stream, kMsgDDragInfo, fileCount, &data);
 }
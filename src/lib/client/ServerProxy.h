@@ -21,15 +21,22 @@
 #include "inputleap/clipboard_types.h"
 #include "inputleap/key_types.h"
 #include "inputleap/Fwd.h"
+#include "inputleap/FrameStream.h"
+#include "inputleap/LatencyStats.h"
+#include "inputleap/MotionDatagram.h"
+#include "inputleap/ReadBudget.h"
 #include "base/Fwd.h"
 #include "base/Event.h"
 #include "base/EventTarget.h"
+#include <memory>
+#include <vector>
 
 namespace inputleap {
 
 class Client;
 class ClientInfo;
 class IStream;
+class MotionDatagramChannel;
 
 //! Proxy for server
 /*!
@@ -52,6 +59,36 @@ public:
     bool onGrabClipboard(ClipboardID);
     void onClipboardChanged(ClipboardID, const IClipboard*);
 
+    //! Ask for clipboard data
+    /*!
+    Asks the server for the data of the clipboard it last offered by its
+    formats.  The data arrives like any other clipboard.  Returns false if
+    there's no connection to ask on.
+    */
+    bool request_clipboard(ClipboardID id);
+
+    //! Detach from the stream
+    /*!
+    Stops using the stream after the connection to the server was lost.
+    The session can then be resumed on a new connection with
+    attach_stream().  Messages to the server are dropped until then.
+    */
+    void detach_stream();
+
+    //! Attach to a stream
+    /*!
+    Asks the server to resume the session on \p stream, a new connection
+    that said hello.  The client is notified when the server has answered.
+    */
+    void attach_stream(inputleap::IStream* stream);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Check if the server offered to resume the session on a new connection
+    bool is_resumable() const { return session_; }
+
     //@}
 
     // sending file chunk to server
@@ -60,6 +97,13 @@ public:
     // sending dragging information to server
     void sendDragInfo(std::uint32_t fileCount, const char* info, size_t size);
 
+    //! Get input latency
+    /*!
+    Returns the latencies of input received from the server, reported as
+    the latency of screen \p name.
+    */
+    std::vector<LatencyReport> get_latency_reports(const std::string& name) const;
+
 #ifdef INPUTLEAP_TEST_ENV
     void handleDataForTest() { handleData(Event(), nullptr); }
 #endif
@@ -73,6 +117,23 @@ private:
     // if compressing mouse motion then send the last motion now
     void flushCompressedMouse();
 
+    // forward mouse motion, compressing it if more motion follows
+    void forwardMouseMove(std::int16_t x, std::int16_t y);
+    void forwardMouseRelativeMove(std::int16_t dx, std::int16_t dy);
+
+    // check if the next queued message is mouse motion, without taking
+    // it off the stream
+    bool isMotionQueued();
+
+    // note a timestamped motion message was received at \p now
+    void recordMotionReceived(std::uint32_t sent, double now);
+
+    // note mouse motion was injected
+    void recordMotionInjected();
+
+    // apply motion received as datagrams or resent over the stream
+    void apply_datagram_motion(const MotionDatagramReceiver::Motion& motion);
+
     void sendInfo(const ClientInfo&);
 
     void resetKeepAliveAlarm();
@@ -90,6 +151,8 @@ private:
     void enter();
     void leave();
     void setClipboard();
+    void setCachedClipboard();
+    void setClipboardFormats();
     void grabClipboard();
     void keyDown();
     void keyRepeat();
@@ -98,6 +161,8 @@ private:
     void mouseUp();
     void mouseMove();
     void mouseRelativeMove();
+    void mouseMoveTimed();
+    void mouseRelativeMoveTimed();
     void mouseWheel();
     void screensaver();
     void resetOptions();
@@ -106,6 +171,14 @@ private:
     void infoAcknowledgment();
     void fileChunkReceived();
     void dragInfoReceived();
+    void datagramOffer();
+    void clockReceived();
+    void keepAlive();
+    void keepAliveTimed();
+    void motionSync();
+    void sessionStarted();
+    bool sessionResumed();
+    void sendSessionAck();
     void handle_clipboard_sending_event(const Event&);
 
 private:
@@ -114,6 +187,10 @@ private:
     Client* m_client;
     inputleap::IStream* m_stream;
 
+    // the message being parsed, the server's stream is only read a whole
+    // message at a time
+    FrameStream frames_;
+
     std::uint32_t m_seqNum;
 
     bool m_compressMouse;
@@ -123,11 +200,35 @@ private:
 
     bool m_ignoreMouse;
 
+    // bounds the messages handled per input ready event
+    ReadBudget read_budget_;
+
     KeyModifierID m_modifierTranslationTable[kKeyModifierIDLast];
 
     double m_keepAliveAlarm;
     EventQueueTimer* m_keepAliveAlarmTimer;
 
+    std::unique_ptr<MotionDatagramChannel> motion_channel_;
+
+    bool timestamps_ = false;
+
+    // the server may offer clipboards by hash
+    bool clipboard_cache_ = false;
+
+    // sequence numbers of the clipboards the server offered by their formats
+    std::uint32_t clipboard_formats_seq_[kClipboardEnd] = {};
+    ClockOffsetEstimator clock_;
+    double motion_received_ = 0.0;     // receive time of uninjected motion
+    LatencyHistogram send_to_receive_;
+    LatencyHistogram receive_to_inject_;
+
+    // session that can be resumed on a new connection
+    bool session_ = false;
+    std::string session_token_;
+    std::uint32_t session_received_ = 0;
+    std::uint32_t session_acked_ = 0;
+    bool resuming_ = false;
+
     MessageParser m_parser;
     IEventQueue* m_events;
 };
@@ -26,10 +26,12 @@
 #include "base/log_outputters.h"
 #include "inputleap/Exceptions.h"
 #include "inputleap/ArgsBase.h"
+#include "inputleap/LatencyStats.h"
 #include "ipc/IpcServerProxy.h"
 #include "ipc/IpcMessage.h"
 #include "ipc/Ipc.h"
 #include "base/EventQueue.h"
+#include "base/EventQueueTimer.h"
 #include "common/DataDirectories.h"
 
 #if SYSAPI_WIN32
@@ -51,6 +53,9 @@ namespace inputleap {
 
 App* App::s_instance = nullptr;
 
+// seconds between input latency reports to the daemon
+static const double kLatencyReportRate = 5.0;
+
 App::App(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBarReceiver, ArgsBase* args) :
     m_bye(&exit),
     m_taskBarReceiver(nullptr),
@@ -61,6 +66,7 @@ App::App(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBarReceiver, A
     m_createTaskBarReceiver(createTaskBarReceiver),
     m_appUtil(events),
     m_ipcClient(nullptr),
+    m_latencyTimer(nullptr),
     m_socketMultiplexer(nullptr)
 {
     assert(s_instance == nullptr);
@@ -206,11 +212,20 @@ App::initIpcClient()
 
     m_events->add_handler(EventType::IPC_CLIENT_MESSAGE_RECEIVED, m_ipcClient,
                           [this](const auto& event) { handle_ipc_message(event); });
+
+    // report input latency so the gui can show it
+    m_latencyTimer = m_events->newTimer(kLatencyReportRate, nullptr);
+    m_events->add_handler(EventType::TIMER, m_latencyTimer,
+                          [this](const auto& event) { send_latency_reports(); });
 }
 
 void
 App::cleanupIpcClient()
 {
+    m_events->remove_handler(EventType::TIMER, m_latencyTimer);
+    m_events->deleteTimer(m_latencyTimer);
+    m_latencyTimer = nullptr;
+
     m_ipcClient->disconnect();
     m_events->remove_handler(EventType::IPC_CLIENT_MESSAGE_RECEIVED, m_ipcClient);
     delete m_ipcClient;
@@ -225,6 +240,16 @@ void App::handle_ipc_message(const Event& e)
     }
 }
 
+void App::send_latency_reports()
+{
+    for (const auto& report : get_latency_reports()) {
+        const auto& latency = report.summary;
+        m_ipcClient->send(IpcLatencyMessage(report.screen, latency_stage_name(report.stage),
+                                            static_cast<std::uint32_t>(latency.count),
+                                            latency.p50, latency.p99, latency.p999));
+    }
+}
+
 void App::run_events_loop()
 {
     m_events->loop();
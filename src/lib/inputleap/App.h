@@ -27,6 +27,7 @@
 #include "net/SocketMultiplexer.h"
 #include "common/common.h"
 #include <memory>
+#include <vector>
 
 #include "inputleap/win32/AppUtilWindows.h"
 
@@ -97,12 +98,16 @@ public:
 
 private:
     void handle_ipc_message(const Event& event);
+    void send_latency_reports();
 
 protected:
     void initIpcClient();
     void cleanupIpcClient();
     void run_events_loop();
 
+    // Returns the input latency to report to the daemon.
+    virtual std::vector<LatencyReport> get_latency_reports() const { return {}; }
+
     IArchTaskBarReceiver* m_taskBarReceiver;
     bool m_suspended;
     IEventQueue* m_events;
@@ -114,6 +119,7 @@ private:
     CreateTaskBarReceiverFunc m_createTaskBarReceiver;
     ARCH_APP_UTIL m_appUtil;
     IpcClient* m_ipcClient;
+    EventQueueTimer* m_latencyTimer;
     std::unique_ptr<SocketMultiplexer> m_socketMultiplexer;
 };
 
@@ -168,6 +174,7 @@ private:
     " [--restart|--no-restart]" \
     " [--debug <level>]"
 
+#if WINAPI_MSWINDOWS
 // Windows args
 #define HELP_SYS_ARGS \
     " [--exit-pause]"
@@ -177,5 +184,17 @@ private:
     "                             (obsolete, use input-leapd instead)\n" \
     "      --exit-pause         wait for key press on exit, can be useful for\n" \
     "                             reading error messages that occur on exit.\n"
+#elif WINAPI_EVDEV
+// evdev args
+#define HELP_SYS_ARGS \
+    " [--screen-size <width>x<height>] [--evdev-device <path>]"
+#define HELP_SYS_INFO \
+    "      --screen-size <size> size of the screen as <width>x<height>,\n" \
+    "                             1920x1080 by default.\n" \
+    "      --evdev-device <path>\n" \
+    "                           capture input from this device, can be given\n" \
+    "                             more than once.  all keyboards and mice are\n" \
+    "                             captured by default (server only).\n"
+#endif
 
 } // namespace inputleap
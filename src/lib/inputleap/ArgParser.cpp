@@ -30,6 +30,9 @@
 #include <VersionHelpers.h>
 #endif
 
+#include <cstdio>
+#include <cstdlib>
+
 namespace inputleap {
 
 XArgvParserError::XArgvParserError(const char *fmt, ...) :
@@ -143,6 +146,13 @@ ArgParser::parseServerArgs(ServerArgs& args, int argc, const char* const* argv)
             }
             else if (a.shift("--disable-client-cert-checking")) {
                 args.check_client_certificates = false;
+            }
+            else if (a.shift("--io-threads", nullptr, &optarg)) {
+                int count = atoi(optarg);
+                if (count < 1 || count > 64) {
+                    throw XArgvParserError("invalid number of io threads `%s'", optarg);
+                }
+                args.io_threads = static_cast<std::size_t>(count);
             } else {
                 throw XArgvParserError("unrecognized option `%s'", a.peek());
             }
@@ -188,6 +198,20 @@ ArgParser::parseClientArgs(ClientArgs& args, int argc, const char* const* argv)
                 // define scroll
                 args.m_yscroll = atoi(optarg);
             }
+            else if (a.shift("--standby", nullptr, &optarg)) {
+                // server to fail over to, may be given more than once
+                args.standby_addresses.push_back(optarg);
+            }
+            else if (a.shift("--clipboard-cache-dir", nullptr, &optarg)) {
+                args.clipboard_cache_dir = optarg;
+            }
+            else if (a.shift("--failover-deadline", nullptr, &optarg)) {
+                double deadline = atof(optarg);
+                if (deadline <= 0.0) {
+                    throw XArgvParserError("invalid failover deadline `%s'", optarg);
+                }
+                args.failover_deadline = deadline;
+            }
             else if (a.size() == 1) {
                 args.network_address = a.shift();
                 return true;
@@ -321,6 +345,34 @@ bool ArgParser::use_x11(Argv& argv)
 }
 #endif
 
+#if WINAPI_EVDEV
+bool ArgParser::parse_evdev_arg(ArgsBase& argsBase, Argv& argv)
+{
+    const char* optarg = nullptr;
+
+    if (argv.shift("--screen-size", nullptr, &optarg)) {
+        int width = 0;
+        int height = 0;
+        char extra = 0;
+        if (sscanf(optarg, "%dx%d%c", &width, &height, &extra) != 2 ||
+                width <= 0 || height <= 0) {
+            throw XArgvParserError("invalid screen size `%s'", optarg);
+        }
+        argsBase.screen_width = width;
+        argsBase.screen_height = height;
+    }
+    else if (argv.shift("--evdev-device", nullptr, &optarg)) {
+        argsBase.evdev_devices.push_back(optarg);
+    }
+    else {
+        // option not supported here
+        return false;
+    }
+
+    return true;
+}
+#endif
+
 bool
 ArgParser::parsePlatformArg(ArgsBase& argsBase, Argv& argv)
 {
@@ -331,6 +383,11 @@ ArgParser::parsePlatformArg(ArgsBase& argsBase, Argv& argv)
     return parseCarbonArg(argsBase, argv);
 #endif
 
+#if WINAPI_EVDEV
+    if (parse_evdev_arg(argsBase, argv))
+        return true;
+#endif
+
 #if WINAPI_XWINDOWS
     if (argsBase.use_x11)
         return parseXWindowsArg(argsBase, argv);
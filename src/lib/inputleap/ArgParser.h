@@ -95,6 +95,7 @@ private:
     bool parseCarbonArg(ArgsBase& argsBase, Argv& argv);
     bool parseXWindowsArg(ArgsBase& argsBase, Argv& argv);
     bool parse_ei_arg(ArgsBase& argsBase, Argv& argv);
+    bool parse_evdev_arg(ArgsBase& argsBase, Argv& argv);
     bool use_x11(Argv& argv);
 
 private:
@@ -19,6 +19,9 @@
 #pragma once
 
 #include "io/filesystem.h"
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace inputleap {
 
@@ -54,6 +57,13 @@ public:
     bool use_x11 = false;
     bool use_ei = false;
     bool use_portal = true; // use the XDG portals for ei
+#if WINAPI_EVDEV
+    // there's no display to ask for the size of the screen
+    std::int32_t screen_width = 1920;
+    std::int32_t screen_height = 1080;
+    // devices the server captures input from, empty for all
+    std::vector<std::string> evdev_devices;
+#endif
 };
 
 } // namespace inputleap
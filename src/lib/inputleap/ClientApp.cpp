@@ -25,6 +25,7 @@
 #include "inputleap/Screen.h"
 #include "inputleap/XScreen.h"
 #include "inputleap/ClientArgs.h"
+#include "inputleap/LatencyStats.h"
 #include "net/NetworkAddress.h"
 #include "net/TCPSocketFactory.h"
 #include "net/SocketMultiplexer.h"
@@ -41,13 +42,19 @@
 #include "base/Log.h"
 #include "common/Version.h"
 
+#if WINAPI_MSWINDOWS
 #include "platform/MSWindowsScreen.h"
+#elif WINAPI_EVDEV
+#include "platform/UinputScreen.h"
+#endif
 
 #include <iostream>
+#include <random>
 #include <stdio.h>
 #include <sstream>
 
 #define RETRY_TIME 1.0
+#define MAX_RETRY_TIME 30.0
 
 namespace inputleap {
 
@@ -55,7 +62,8 @@ ClientApp::ClientApp(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBa
     App(events, createTaskBarReceiver, new ClientArgs()),
     m_client(nullptr),
     m_clientScreen(nullptr),
-    m_serverAddress(nullptr)
+    m_serverAddress(nullptr),
+    retry_backoff_(RETRY_TIME, MAX_RETRY_TIME, std::random_device()())
 {
 }
 
@@ -91,6 +99,20 @@ ClientApp::parseArgs(int argc, const char* const* argv)
                 }
             }
         }
+
+        // standby servers are resolved when connecting, only the port
+        // must be valid now
+        standby_addresses_.clear();
+        for (const auto& address : args().standby_addresses) {
+            try {
+                standby_addresses_.emplace_back(address, kDefaultPort);
+            }
+            catch (XSocketAddress& e) {
+                LOG_PRINT("%s: %s" BYE,
+                    args().m_exename.c_str(), e.what(), args().m_exename.c_str());
+                m_bye(kExitFailed);
+            }
+        }
     }
 }
 
@@ -101,6 +123,8 @@ ClientApp::help()
     buffer << "Start the InputLeap client and connect to a remote server component.\n"
            << "\n"
            << "Usage: " << args().m_exename << " [--yscroll <delta>]"
+           << " [--standby <server-address>]... [--failover-deadline <seconds>]"
+           << " [--clipboard-cache-dir <path>]"
            << HELP_SYS_ARGS
            << HELP_COMMON_ARGS << " <server-address>\n"
            << "\n"
@@ -109,6 +133,16 @@ ClientApp::help()
            << HELP_SYS_INFO
            << "      --yscroll <delta>    defines the vertical scrolling delta, which is\n"
            << "                           120 by default.\n"
+           << "      --standby <server-address>\n"
+           << "                           a server to fail over to when the ones before\n"
+           << "                           it don't answer.  May be given more than once.\n"
+           << "      --failover-deadline <seconds>\n"
+           << "                           how long to wait for a server before trying\n"
+           << "                           the next one, 3 by default.\n"
+           << "      --clipboard-cache-dir <path>\n"
+           << "                           keep clipboards that don't fit the memory\n"
+           << "                           cache in <path> so the server doesn't have to\n"
+           << "                           send them again.\n"
            << HELP_COMMON_INFO_2
            << "\n"
            << "Default options are marked with a *\n"
@@ -161,16 +195,16 @@ void ClientApp::updateStatus(const std::string& msg)
 void
 ClientApp::resetRestartTimeout()
 {
-    // retry time can nolonger be changed
-    //s_retryTime = 0.0;
+    retry_backoff_.reset();
 }
 
 
 double
 ClientApp::nextRestartTimeout()
 {
-    // retry at a constant rate (Issue 52)
-    return RETRY_TIME;
+    // back off with jitter so that the clients of a server that went away
+    // don't all reconnect at the same moment when it comes back
+    return retry_backoff_.next();
 }
 
 
@@ -209,7 +243,7 @@ void
 ClientApp::scheduleClientRestart(double retryTime)
 {
     // install a timer and handler to retry later
-    LOG_DEBUG("retry in %.0f seconds", retryTime);
+    LOG_DEBUG("retry in %.1f seconds", retryTime);
     EventQueueTimer* timer = m_events->newOneShotTimer(retryTime, nullptr);
     m_events->add_handler(EventType::TIMER, timer,
                           [this, timer](const Event& event) { handle_client_restart(event, timer); });
@@ -315,6 +349,11 @@ ClientApp::startClient()
         if (!m_clientScreen) {
             client_screen = open_client_screen();
             m_client = openClient(args().m_name, *m_serverAddress, client_screen.get());
+            m_client->set_standby_servers(standby_addresses_);
+            if (!args().clipboard_cache_dir.empty()) {
+                m_client->set_clipboard_cache_directory(
+                            inputleap::fs::u8path(args().clipboard_cache_dir));
+            }
             m_clientScreen = std::move(client_screen);
             LOG_NOTE("started client");
         }
@@ -361,6 +400,14 @@ ClientApp::stopClient()
 }
 
 
+std::vector<LatencyReport> ClientApp::get_latency_reports() const
+{
+    if (m_client == nullptr) {
+        return {};
+    }
+    return m_client->get_latency_reports();
+}
+
 int
 ClientApp::mainLoop()
 {
@@ -466,8 +513,12 @@ ClientApp::startNode()
 
 std::unique_ptr<IPlatformScreen> ClientApp::create_platform_screen()
 {
+#if WINAPI_MSWINDOWS
     return std::make_unique<MSWindowsScreen>(false, args().m_noHooks, args().m_stopOnDeskSwitch,
                                              m_events);
+#elif WINAPI_EVDEV
+    return std::make_unique<UinputScreen>(args().screen_width, args().screen_height, m_events);
+#endif
 }
 
 } // namespace inputleap
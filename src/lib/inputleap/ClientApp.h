@@ -22,7 +22,10 @@
 #include "base/Fwd.h"
 #include "net/Fwd.h"
 #include "inputleap/App.h"
+#include "inputleap/RetryBackoff.h"
+#include "net/NetworkAddress.h"
 #include "ClientArgs.h"
+#include <vector>
 
 namespace inputleap {
 
@@ -76,12 +79,17 @@ public:
 
     Client* getClientPtr() { return m_client; }
 
+protected:
+    std::vector<LatencyReport> get_latency_reports() const override;
+
 private:
     std::unique_ptr<IPlatformScreen> create_platform_screen();
 
     Client* m_client;
     std::unique_ptr<inputleap::Screen> m_clientScreen;
     NetworkAddress* m_serverAddress;
+    std::vector<NetworkAddress> standby_addresses_;
+    RetryBackoff retry_backoff_;
 };
 
 } // namespace inputleap
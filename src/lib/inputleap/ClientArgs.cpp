@@ -20,7 +20,8 @@
 namespace inputleap {
 
 ClientArgs::ClientArgs() :
-    m_yscroll(0)
+    m_yscroll(0),
+    failover_deadline(3.0)
 {
 }
 
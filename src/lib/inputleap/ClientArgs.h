@@ -18,6 +18,8 @@
 #pragma once
 
 #include "inputleap/ArgsBase.h"
+#include <string>
+#include <vector>
 
 namespace inputleap {
 
@@ -27,6 +29,16 @@ public:
 
 public:
     int m_yscroll;
+
+    // servers to fail over to, in order, when the server at network_address
+    // doesn't answer
+    std::vector<std::string> standby_addresses;
+
+    // seconds to wait for a server before trying the next one
+    double failover_deadline;
+
+    // where clipboards that don't fit the memory cache go, none if empty
+    std::string clipboard_cache_dir;
 };
 
 } // namespace inputleap
@@ -0,0 +1,187 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/ClipboardCache.h"
+
+#include "base/Log.h"
+#include "net/SecureUtils.h"
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace inputleap {
+
+ClipboardCache::ClipboardCache(std::size_t max_bytes) :
+    max_bytes_{max_bytes}
+{
+}
+
+ClipboardCache::~ClipboardCache()
+{
+    while (!spilled_.empty()) {
+        remove_spilled(spilled_.begin());
+    }
+}
+
+void ClipboardCache::set_spill_directory(const fs::path& directory, std::size_t max_bytes)
+{
+    while (!spilled_.empty()) {
+        remove_spilled(spilled_.begin());
+    }
+
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        LOG_WARN("can't use clipboard cache directory %s: %s",
+                 directory.u8string().c_str(), error.message().c_str());
+        spill_directory_.clear();
+        return;
+    }
+    spill_directory_ = directory;
+    max_spill_bytes_ = max_bytes;
+}
+
+void ClipboardCache::insert(const Hash& hash, const std::string& data)
+{
+    auto found = index_.find(hash);
+    if (found != index_.end()) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return;
+    }
+
+    // content that's now in memory doesn't need its spilled copy
+    auto spilled = spilled_index_.find(hash);
+    if (spilled != spilled_index_.end()) {
+        remove_spilled(spilled->second);
+    }
+
+    entries_.push_front({hash, data});
+    index_[hash] = entries_.begin();
+    size_ += data.size();
+    evict();
+}
+
+bool ClipboardCache::find(const Hash& hash, std::string& data)
+{
+    auto found = index_.find(hash);
+    if (found != index_.end()) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+        data = found->second->data;
+        ++counters_.hits;
+        return true;
+    }
+
+    if (unspill(hash, data)) {
+        ++counters_.hits;
+        insert(hash, data);
+        return true;
+    }
+
+    ++counters_.misses;
+    return false;
+}
+
+ClipboardCache::Hash ClipboardCache::hash(const std::string& data)
+{
+    // the net library owns the OpenSSL dependency
+    return get_sha256_digest(data);
+}
+
+bool ClipboardCache::contains(const Hash& hash) const
+{
+    return index_.count(hash) != 0 || spilled_index_.count(hash) != 0;
+}
+
+void ClipboardCache::evict()
+{
+    // always keep the newest content, even if it's over the limit
+    while (size_ > max_bytes_ && entries_.size() > 1) {
+        const Entry& oldest = entries_.back();
+        if (!spill_directory_.empty() && oldest.data.size() <= max_spill_bytes_) {
+            spill(oldest);
+        }
+        size_ -= oldest.data.size();
+        index_.erase(oldest.hash);
+        entries_.pop_back();
+        ++counters_.evictions;
+    }
+}
+
+void ClipboardCache::spill(const Entry& entry)
+{
+    std::ofstream file;
+    open_utf8_path(file, get_spill_path(entry.hash), std::ios::out | std::ios::binary);
+    file.write(entry.data.data(), static_cast<std::streamsize>(entry.data.size()));
+    if (!file) {
+        LOG_DEBUG("failed to spill clipboard to %s", spill_directory_.u8string().c_str());
+        return;
+    }
+
+    spilled_.push_front({entry.hash, entry.data.size()});
+    spilled_index_[entry.hash] = spilled_.begin();
+    spilled_size_ += entry.data.size();
+    ++counters_.spills;
+
+    while (spilled_size_ > max_spill_bytes_) {
+        remove_spilled(std::prev(spilled_.end()));
+    }
+}
+
+bool ClipboardCache::unspill(const Hash& hash, std::string& data)
+{
+    auto found = spilled_index_.find(hash);
+    if (found == spilled_index_.end()) {
+        return false;
+    }
+
+    std::ifstream file;
+    open_utf8_path(file, get_spill_path(hash), std::ios::in | std::ios::binary);
+    std::string content(found->second->size, '\0');
+    file.read(&content[0], static_cast<std::streamsize>(content.size()));
+    bool ok = static_cast<bool>(file);
+    file.close();
+    remove_spilled(found->second);
+
+    // someone else may have changed the file, don't trust it blindly
+    if (!ok || ClipboardCache::hash(content) != hash) {
+        return false;
+    }
+    data = std::move(content);
+    return true;
+}
+
+void ClipboardCache::remove_spilled(SpilledEntries::iterator entry)
+{
+    std::error_code error;
+    fs::remove(get_spill_path(entry->hash), error);
+    spilled_size_ -= entry->size;
+    spilled_index_.erase(entry->hash);
+    spilled_.erase(entry);
+}
+
+fs::path ClipboardCache::get_spill_path(const Hash& hash) const
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    std::string name;
+    name.reserve(2 * hash.size());
+    for (unsigned char c : hash) {
+        name.push_back(hex_digits[c >> 4]);
+        name.push_back(hex_digits[c & 0x0f]);
+    }
+    return spill_directory_ / name;
+}
+
+} // namespace inputleap
@@ -0,0 +1,150 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "io/filesystem.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace inputleap {
+
+//! Content addressed store of clipboard data
+/*!
+Keeps marshalled clipboards the screen has sent or received, keyed by
+their SHA-256, so content the other side already has doesn't need to be
+transferred again (see \c kMsgDClipboardCached).  The least recently used
+content is dropped once the cache holds more than its size limit.  With
+a spill directory set, dropped content is written there instead and read
+back when asked for, up to a separate limit for the directory.
+*/
+class ClipboardCache {
+public:
+    //! SHA-256 of the content, 32 bytes
+    using Hash = std::string;
+
+    struct Counters {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        //! Content dropped from memory, spilled or not
+        std::uint64_t evictions = 0;
+        //! Content written to the spill directory
+        std::uint64_t spills = 0;
+    };
+
+    //! Default memory limit in bytes
+    static constexpr std::size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+    //! Default spill directory limit in bytes
+    static constexpr std::size_t kDefaultMaxSpillBytes = 512 * 1024 * 1024;
+
+    //! Smallest content worth caching
+    /*!
+    Below this the hash and the chance of a miss cost about as much as
+    sending the data.
+    */
+    static constexpr std::size_t kMinSize = 4096;
+
+    explicit ClipboardCache(std::size_t max_bytes = kDefaultMaxBytes);
+    ~ClipboardCache();
+
+    ClipboardCache(const ClipboardCache&) = delete;
+    ClipboardCache& operator=(const ClipboardCache&) = delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Spill dropped content to \p directory
+    /*!
+    The directory is created if needed.  Files the cache wrote there are
+    removed when the cache goes away.
+    */
+    void set_spill_directory(const fs::path& directory,
+                             std::size_t max_bytes = kDefaultMaxSpillBytes);
+
+    //! Add content
+    /*!
+    Stores \p data under \p hash, which must be hash(data), and makes it
+    the most recently used.
+    */
+    void insert(const Hash& hash, const std::string& data);
+
+    //! Look up content
+    /*!
+    Stores the content with \p hash in \p data and returns true, or
+    returns false if the cache doesn't hold it.  Counts a hit or a miss.
+    */
+    bool find(const Hash& hash, std::string& data);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Hash content
+    static Hash hash(const std::string& data);
+
+    //! Test if content is cached, in memory or spilled
+    bool contains(const Hash& hash) const;
+
+    //! Get the bytes held in memory
+    std::size_t get_size() const { return size_; }
+
+    //! Get the hit, miss and eviction counts
+    const Counters& get_counters() const { return counters_; }
+
+    //@}
+
+private:
+    struct Entry {
+        Hash hash;
+        std::string data;
+    };
+
+    struct SpilledEntry {
+        Hash hash;
+        std::size_t size;
+    };
+
+    using Entries = std::list<Entry>;
+    using SpilledEntries = std::list<SpilledEntry>;
+
+    void evict();
+    void spill(const Entry& entry);
+    bool unspill(const Hash& hash, std::string& data);
+    void remove_spilled(SpilledEntries::iterator entry);
+    fs::path get_spill_path(const Hash& hash) const;
+
+private:
+    std::size_t max_bytes_;
+    std::size_t size_ = 0;
+
+    // most recently used first
+    Entries entries_;
+    std::unordered_map<Hash, Entries::iterator> index_;
+
+    fs::path spill_directory_;
+    std::size_t max_spill_bytes_ = 0;
+    std::size_t spilled_size_ = 0;
+    SpilledEntries spilled_;
+    std::unordered_map<Hash, SpilledEntries::iterator> spilled_index_;
+
+    Counters counters_;
+};
+
+} // namespace inputleap
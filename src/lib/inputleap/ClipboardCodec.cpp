@@ -0,0 +1,345 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/ClipboardCodec.h"
+
+#include <bitset>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLIPBOARD_CODEC_USE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CLIPBOARD_CODEC_USE_NEON 1
+#endif
+
+namespace inputleap {
+
+namespace clipboard_codec {
+
+namespace {
+
+const std::uint32_t kBiRgb = 0;
+const std::uint32_t kBiBitfields = 3;
+const std::uint32_t kInfoHeaderSize = 40;
+
+std::uint16_t read16(const std::string& data, std::size_t offset)
+{
+    return static_cast<std::uint16_t>(static_cast<std::uint8_t>(data[offset]) |
+                                      static_cast<std::uint8_t>(data[offset + 1]) << 8);
+}
+
+std::uint32_t read32(const std::string& data, std::size_t offset)
+{
+    return static_cast<std::uint32_t>(read16(data, offset)) |
+           static_cast<std::uint32_t>(read16(data, offset + 2)) << 16;
+}
+
+void write16(char* data, std::uint16_t value)
+{
+    data[0] = static_cast<char>(value & 0xff);
+    data[1] = static_cast<char>(value >> 8);
+}
+
+void write32(char* data, std::uint32_t value)
+{
+    write16(data, static_cast<std::uint16_t>(value & 0xffff));
+    write16(data + 2, static_cast<std::uint16_t>(value >> 16));
+}
+
+// returns the value of the first run of digits in [begin, end) or -1 if
+// there's none or it's too large
+long long parse_offset(const char* begin, const char* end)
+{
+    while (begin != end && (*begin < '0' || *begin > '9')) {
+        ++begin;
+    }
+    if (begin == end) {
+        return -1;
+    }
+    long long value = 0;
+    for (; begin != end && *begin >= '0' && *begin <= '9'; ++begin) {
+        value = 10 * value + (*begin - '0');
+        if (value > 0x7fffffff) {
+            return -1;
+        }
+    }
+    return value;
+}
+
+void convert_row(const char* src, std::uint16_t src_bits, char* dst, std::uint16_t dst_bits,
+                 std::int32_t width)
+{
+    if (src_bits == dst_bits) {
+        std::memcpy(dst, src, static_cast<std::size_t>(width) * (src_bits / 8));
+    }
+    else if (src_bits == 32) {
+        for (std::int32_t x = 0; x < width; ++x, src += 4, dst += 3) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+    else {
+        // the fourth byte is unused by BI_RGB
+        for (std::int32_t x = 0; x < width; ++x, src += 3, dst += 4) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = 0;
+        }
+    }
+}
+
+} // namespace
+
+std::size_t count_lf(const char* data, std::size_t size)
+{
+    std::size_t count = 0;
+    std::size_t i = 0;
+#if CLIPBOARD_CODEC_USE_SSE2
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        count += std::bitset<16>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, lf))).count();
+    }
+#elif CLIPBOARD_CODEC_USE_NEON
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(data + i));
+        count += vaddvq_u8(vshrq_n_u8(vceqq_u8(v, lf), 7));
+    }
+#endif
+    for (; i < size; ++i) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+std::string lf_to_crlf(std::string text)
+{
+    std::size_t count = count_lf(text.data(), text.size());
+    if (count == 0) {
+        return text;
+    }
+
+    std::string result(text.size() + count, '\0');
+    const char* src = text.data();
+    const char* end = src + text.size();
+    char* dst = &result[0];
+    while (const void* found = std::memchr(src, '\n', end - src)) {
+        const char* lf = static_cast<const char*>(found);
+        std::memcpy(dst, src, lf - src);
+        dst += lf - src;
+        *dst++ = '\r';
+        *dst++ = '\n';
+        src = lf + 1;
+    }
+    std::memcpy(dst, src, end - src);
+    return result;
+}
+
+std::string crlf_to_lf(std::string text)
+{
+    char* data = &text[0];
+    char* end = data + text.size();
+
+    // move the text between the CRLFs down over the CRs.  nothing moves
+    // until the first CRLF.
+    char* dst = nullptr;
+    char* src = data;
+    while (void* found = std::memchr(src, '\r', end - src)) {
+        char* cr = static_cast<char*>(found);
+        bool drop = cr + 1 != end && cr[1] == '\n';
+        char* keep_end = drop ? cr : cr + 1;
+        if (dst != nullptr) {
+            std::memmove(dst, src, keep_end - src);
+            dst += keep_end - src;
+        }
+        else if (drop) {
+            dst = cr;
+        }
+        src = cr + 1;
+    }
+    if (dst == nullptr) {
+        return text;
+    }
+    std::memmove(dst, src, end - src);
+    dst += end - src;
+
+    text.resize(dst - data);
+    return text;
+}
+
+std::string html_to_cf_html(const std::string& fragment)
+{
+    static const char kHeader[] =
+        "Version:0.9\r\nStartHTML:0000000105\r\n"
+        "EndHTML:%010u\r\n"
+        "StartFragment:%010u\r\nEndFragment:%010u\r\n";
+    static const char kPrefix[] = "<!DOCTYPE><HTML><BODY><!--StartFragment-->";
+    static const char kSuffix[] = "<!--EndFragment--></BODY></HTML>\r\n";
+
+    // the header has the same size whatever the offsets.  StartHTML is
+    // constant by its design.
+    const std::size_t header_size = 105;
+    const std::size_t prefix_size = sizeof(kPrefix) - 1;
+    const std::size_t suffix_size = sizeof(kSuffix) - 1;
+
+    std::uint32_t start_fragment = static_cast<std::uint32_t>(header_size + prefix_size);
+    std::uint32_t end_fragment = start_fragment + static_cast<std::uint32_t>(fragment.size());
+    std::uint32_t end_html = end_fragment + static_cast<std::uint32_t>(suffix_size);
+
+    char header[header_size + 1];
+    std::snprintf(header, sizeof(header), kHeader, end_html, start_fragment, end_fragment);
+
+    std::string result;
+    result.reserve(end_html);
+    result.append(header, header_size);
+    result.append(kPrefix, prefix_size);
+    result += fragment;
+    result.append(kSuffix, suffix_size);
+    return result;
+}
+
+std::string cf_html_to_html(const std::string& data)
+{
+    // read the description up to the first tag.  each line is a name and
+    // a value separated by a colon.
+    long long start = -1;
+    long long end = -1;
+    const char* scan = data.data();
+    const char* data_end = scan + data.size();
+    while (scan != data_end && *scan != '<' && (start < 0 || end < 0)) {
+        const char* line_end = scan;
+        while (line_end != data_end && *line_end != '\r' && *line_end != '\n') {
+            ++line_end;
+        }
+        const void* colon = std::memchr(scan, ':', line_end - scan);
+        if (colon != nullptr) {
+            const char* value = static_cast<const char*>(colon);
+            std::size_t name_size = value - scan;
+            if (name_size == 13 && std::memcmp(scan, "StartFragment", 13) == 0) {
+                start = parse_offset(value + 1, line_end);
+            }
+            else if (name_size == 11 && std::memcmp(scan, "EndFragment", 11) == 0) {
+                end = parse_offset(value + 1, line_end);
+            }
+        }
+        scan = line_end;
+        while (scan != data_end && (*scan == '\r' || *scan == '\n')) {
+            ++scan;
+        }
+    }
+
+    if (start <= 0 || end <= 0 || start >= end ||
+            static_cast<unsigned long long>(end) > data.size()) {
+        return std::string();
+    }
+    return data.substr(static_cast<std::size_t>(start), static_cast<std::size_t>(end - start));
+}
+
+bool parse_dib(const std::string& dib, DibInfo& info)
+{
+    if (dib.size() < kInfoHeaderSize) {
+        return false;
+    }
+
+    info.header_size = read32(dib, 0);
+    std::int32_t width = static_cast<std::int32_t>(read32(dib, 4));
+    std::int32_t height = static_cast<std::int32_t>(read32(dib, 8));
+    info.bit_count = read16(dib, 14);
+    info.compression = read32(dib, 16);
+    std::uint32_t colors = read32(dib, 32);
+
+    // keep the sizes well within what the arithmetic below can handle
+    if (info.header_size < kInfoHeaderSize || info.header_size > dib.size() ||
+            width <= 0 || width > 0x10000 || height == 0 ||
+            height < -0x10000 || height > 0x10000 ||
+            info.bit_count == 0 || info.bit_count > 32 || colors > 0x10000) {
+        return false;
+    }
+    info.width = width;
+    info.top_down = height < 0;
+    info.height = info.top_down ? -height : height;
+
+    // the masks follow a plain BITMAPINFOHEADER but are part of the
+    // later versions
+    info.bits_offset = info.header_size + 4 * static_cast<std::size_t>(colors);
+    if (info.compression == kBiBitfields && info.header_size == kInfoHeaderSize) {
+        info.bits_offset += 12;
+    }
+
+    info.stride = ((static_cast<std::size_t>(width) * info.bit_count + 31) / 32) * 4;
+    return info.bits_offset <= dib.size() &&
+           static_cast<unsigned long long>(info.stride) * info.height <=
+               dib.size() - info.bits_offset;
+}
+
+std::string convert_dib(std::string dib, std::uint16_t bit_count)
+{
+    DibInfo info;
+    if ((bit_count != 24 && bit_count != 32) || !parse_dib(dib, info) ||
+            (info.bit_count != 24 && info.bit_count != 32)) {
+        return std::string();
+    }
+    if (info.compression == kBiBitfields) {
+        if (info.bit_count != 32 || info.bits_offset < 52 ||
+                read32(dib, 40) != 0x00ff0000 || read32(dib, 44) != 0x0000ff00 ||
+                read32(dib, 48) != 0x000000ff) {
+            return std::string();
+        }
+    }
+    else if (info.compression != kBiRgb) {
+        return std::string();
+    }
+
+    if (info.header_size == kInfoHeaderSize && info.compression == kBiRgb &&
+            info.bits_offset == kInfoHeaderSize && !info.top_down &&
+            info.bit_count == bit_count) {
+        return dib;
+    }
+
+    std::size_t stride = ((static_cast<std::size_t>(info.width) * bit_count + 31) / 32) * 4;
+    std::string result(kInfoHeaderSize + stride * info.height, '\0');
+
+    char* header = &result[0];
+    write32(header, kInfoHeaderSize);
+    write32(header + 4, static_cast<std::uint32_t>(info.width));
+    write32(header + 8, static_cast<std::uint32_t>(info.height));
+    write16(header + 12, 1);
+    write16(header + 14, bit_count);
+    write32(header + 16, kBiRgb);
+    write32(header + 20, static_cast<std::uint32_t>(stride * info.height));
+    write32(header + 24, read32(dib, 24));
+    write32(header + 28, read32(dib, 28));
+
+    // rows are stored bottom up unless the height was negative
+    const char* src = dib.data() + info.bits_offset;
+    char* dst = header + kInfoHeaderSize;
+    for (std::int32_t y = 0; y < info.height; ++y) {
+        std::int32_t src_row = info.top_down ? info.height - 1 - y : y;
+        convert_row(src + src_row * info.stride, info.bit_count, dst + y * stride, bit_count,
+                    info.width);
+    }
+    return result;
+}
+
+} // namespace clipboard_codec
+
+} // namespace inputleap
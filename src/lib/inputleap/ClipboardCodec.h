@@ -0,0 +1,115 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace inputleap {
+
+//! Clipboard data conversions
+/*!
+Conversions between the clipboard formats of \c IClipboard and the
+formats platforms put on their clipboards.  These only transform data
+and don't depend on any platform API.
+*/
+namespace clipboard_codec {
+
+//! @name newlines
+//@{
+
+//! Count the LFs in \p size bytes at \p data
+std::size_t count_lf(const char* data, std::size_t size);
+
+//! Convert LF newlines to CRLF
+/*!
+Inserts a CR before every LF in \p text.  \p text is returned as is if
+it has no LF.
+*/
+std::string lf_to_crlf(std::string text);
+
+//! Convert CRLF newlines to LF
+/*!
+Removes every CR followed by a LF in \p text.  This is done in place.
+*/
+std::string crlf_to_lf(std::string text);
+
+//@}
+
+//! @name HTML
+//@{
+
+//! Wrap an HTML fragment in the CF_HTML format
+/*!
+Returns \p fragment as a complete document preceded by the CF_HTML
+description that locates the fragment in it.
+*/
+std::string html_to_cf_html(const std::string& fragment);
+
+//! Extract the fragment of CF_HTML data
+/*!
+Reads the description at the start of \p data and returns the fragment
+it locates.  Returns an empty string if \p data doesn't describe a
+fragment within it.
+*/
+std::string cf_html_to_html(const std::string& data);
+
+//@}
+
+//! @name bitmaps
+//@{
+
+//! Layout of a device independent bitmap
+struct DibInfo {
+    std::uint32_t header_size = 0;
+    std::int32_t width = 0;
+    //! Number of rows, always positive
+    std::int32_t height = 0;
+    //! Whether the first row is the top one
+    bool top_down = false;
+    std::uint16_t bit_count = 0;
+    std::uint32_t compression = 0;
+    //! Offset of the pixels from the start of the header
+    std::size_t bits_offset = 0;
+    //! Bytes per row including padding
+    std::size_t stride = 0;
+};
+
+//! Read the layout of a DIB
+/*!
+Reads the BITMAPINFOHEADER, or a later version of it, at the start of
+\p dib.  Returns false if the header is invalid or \p dib is too short
+for the pixels it describes.
+*/
+bool parse_dib(const std::string& dib, DibInfo& info);
+
+//! Convert a DIB to the \c IClipboard::kBitmap format
+/*!
+Converts \p dib to a bottom-up BI_RGB bitmap with \p bit_count bits per
+pixel, which must be 24 or 32, following a 40 byte BITMAPINFOHEADER.
+The source must have 24 or 32 bits per pixel and use BI_RGB, or
+BI_BITFIELDS with the usual masks.  Returns \p dib as is if it's already
+in that format or an empty string if it isn't supported.
+*/
+std::string convert_dib(std::string dib, std::uint16_t bit_count);
+
+//@}
+
+} // namespace clipboard_codec
+
+} // namespace inputleap
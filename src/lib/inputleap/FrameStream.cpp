@@ -0,0 +1,120 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/FrameStream.h"
+
+#include <cstring>
+
+namespace inputleap {
+
+void FrameStream::set_stream(IStream* stream)
+{
+    if (stream != stream_) {
+        stream_ = stream;
+        frame_.clear();
+        position_ = 0;
+        unread_ = false;
+    }
+}
+
+bool FrameStream::read_frame()
+{
+    position_ = 0;
+    if (unread_) {
+        unread_ = false;
+        return true;
+    }
+    frame_.clear();
+
+    // a packetizing stream reports the size of the current packet once
+    // all of it has arrived
+    std::uint32_t size = stream_->getSize();
+    if (size == 0) {
+        return false;
+    }
+    frame_.resize(size);
+    frame_.resize(stream_->read(frame_.data(), size));
+    return !frame_.empty();
+}
+
+void FrameStream::unread_frame()
+{
+    position_ = 0;
+    unread_ = !frame_.empty();
+}
+
+void FrameStream::close()
+{
+    frame_.clear();
+    position_ = 0;
+    unread_ = false;
+    stream_->close();
+}
+
+std::uint32_t FrameStream::read(void* buffer, std::uint32_t n)
+{
+    if (n > get_remaining()) {
+        n = get_remaining();
+    }
+    if (buffer != nullptr && n != 0) {
+        std::memcpy(buffer, frame_.data() + position_, n);
+    }
+    position_ += n;
+    return n;
+}
+
+void FrameStream::write(const void* buffer, std::uint32_t n)
+{
+    stream_->write(buffer, n);
+}
+
+void FrameStream::flush()
+{
+    stream_->flush();
+}
+
+void FrameStream::shutdownInput()
+{
+    frame_.clear();
+    position_ = 0;
+    unread_ = false;
+    stream_->shutdownInput();
+}
+
+void FrameStream::shutdownOutput()
+{
+    stream_->shutdownOutput();
+}
+
+const EventTarget* FrameStream::get_event_target() const
+{
+    return stream_->get_event_target();
+}
+
+bool FrameStream::isReady() const
+{
+    return get_remaining() != 0 || stream_->isReady();
+}
+
+std::uint32_t FrameStream::getSize() const
+{
+    if (get_remaining() != 0) {
+        return get_remaining();
+    }
+    return stream_->getSize();
+}
+
+} // namespace inputleap
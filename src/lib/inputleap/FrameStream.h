@@ -0,0 +1,96 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "io/IStream.h"
+#include <cstdint>
+#include <vector>
+
+namespace inputleap {
+
+//! Reads a packetized stream one whole message at a time
+/*!
+Wraps a packetizing stream such as \c PacketStreamFilter, which only
+reports data once a complete packet has arrived.  read_frame() takes the
+next packet out of the wrapped stream in a single read;  reads then come
+from memory until the frame is used up and never run into the next
+message.  A packet that hasn't fully arrived stays in the wrapped stream
+and read_frame() returns false until the rest is there.  Everything
+other than reading goes to the wrapped stream.
+*/
+class FrameStream : public IStream {
+public:
+    FrameStream() = default;
+    explicit FrameStream(IStream* stream) : stream_{stream} { }
+
+    //! @name manipulators
+    //@{
+
+    //! Set the wrapped stream
+    /*!
+    Discards the current frame if the stream changes, e.g. when a
+    session moves to a new connection.
+    */
+    void set_stream(IStream* stream);
+
+    //! Read the next message
+    /*!
+    Replaces the current frame, including any part of it that wasn't
+    read, with the next complete packet.  Returns false if there's no
+    complete packet yet.
+    */
+    bool read_frame();
+
+    //! Put the current frame back
+    /*!
+    The next read_frame() returns the current frame again, from its
+    start, instead of reading the next packet.  Lets a reader look at the
+    next message and leave it for later.
+    */
+    void unread_frame();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of unread bytes in the current frame
+    std::uint32_t get_remaining() const
+    {
+        return static_cast<std::uint32_t>(frame_.size() - position_);
+    }
+
+    //@}
+
+    // IStream overrides
+    void close() override;
+    std::uint32_t read(void* buffer, std::uint32_t n) override;
+    void write(const void* buffer, std::uint32_t n) override;
+    void flush() override;
+    void shutdownInput() override;
+    void shutdownOutput() override;
+    const EventTarget* get_event_target() const override;
+    bool isReady() const override;
+    std::uint32_t getSize() const override;
+
+private:
+    IStream* stream_ = nullptr;
+    std::vector<std::uint8_t> frame_;
+    std::size_t position_ = 0;
+    bool unread_ = false;
+};
+
+} // namespace inputleap
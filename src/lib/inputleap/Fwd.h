@@ -87,6 +87,11 @@ class ISecondaryScreen;
 // KeyMap.h
 class KeyMap;
 
+// LatencyStats.h
+class LatencyHistogram;
+class ClockOffsetEstimator;
+struct LatencyReport;
+
 // PacketStreamFilter.h
 class PacketStreamFilter;
 
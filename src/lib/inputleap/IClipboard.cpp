@@ -109,6 +109,25 @@ std::string IClipboard::marshall(const IClipboard* clipboard)
     return data;
 }
 
+std::vector<std::uint32_t> IClipboard::describe(const IClipboard* clipboard)
+{
+    assert(clipboard != nullptr);
+
+    std::vector<std::uint32_t> formats;
+    if (clipboard->open(0)) {
+        for (std::uint32_t format = 0; format != IClipboard::kNumFormats; ++format) {
+            IClipboard::EFormat eFormat = static_cast<IClipboard::EFormat>(format);
+            if (clipboard->has(eFormat)) {
+                formats.push_back(format);
+                formats.push_back(static_cast<std::uint32_t>(clipboard->get(eFormat).size()));
+            }
+        }
+        clipboard->close();
+    }
+
+    return formats;
+}
+
 bool
 IClipboard::copy(IClipboard* dst, const IClipboard* src)
 {
@@ -19,7 +19,9 @@
 #pragma once
 
 #include "base/EventTypes.h"
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace inputleap {
 
@@ -148,6 +150,13 @@ public:
     */
     static void unmarshall(IClipboard* clipboard, const std::string& data, Time time);
 
+    //! Describe clipboard data
+    /*!
+    Return the formats in \p clipboard and the size of their data in
+    bytes as pairs of format and size, without the data itself.
+    */
+    static std::vector<std::uint32_t> describe(const IClipboard* clipboard);
+
     //! Copy clipboard
     /*!
     Transfers all the data in one clipboard to another.  The
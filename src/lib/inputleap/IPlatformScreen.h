@@ -20,11 +20,13 @@
 
 #include "inputleap/DragInformation.h"
 #include "inputleap/clipboard_types.h"
+#include "inputleap/IClipboard.h"
 #include "inputleap/IScreen.h"
 #include "inputleap/IPrimaryScreen.h"
 #include "inputleap/ISecondaryScreen.h"
 #include "inputleap/IKeyState.h"
 #include "inputleap/option_types.h"
+#include <vector>
 
 namespace inputleap {
 
@@ -84,6 +86,18 @@ public:
     */
     virtual bool setClipboard(ClipboardID id, const IClipboard*) = 0;
 
+    //! Set clipboard formats
+    /*!
+    Offer \p formats on the system clipboard indicated by \c id without
+    their data.  When an application pastes, the screen sends a
+    \c EventType::CLIPBOARD_REQUESTED event and renders the data passed
+    to the following setClipboard().  Returns false if the screen can't
+    render clipboard data on demand, the caller must then get the data
+    and call setClipboard().
+    */
+    virtual bool set_clipboard_formats(ClipboardID id,
+                                       const std::vector<IClipboard::EFormat>& formats) = 0;
+
     //! Check clipboard owner
     /*!
     Check ownership of all clipboards and post grab events for any that
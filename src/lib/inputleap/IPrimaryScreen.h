@@ -22,6 +22,7 @@
 #include "inputleap/mouse_types.h"
 #include "base/Event.h"
 #include "base/EventTypes.h"
+#include "base/Time.h"
 
 namespace inputleap {
 
@@ -51,14 +52,17 @@ public:
     //! Motion event data
     class MotionInfo {
     public:
-        MotionInfo(std::int32_t x, std::int32_t y) :
+        MotionInfo(std::int32_t x, std::int32_t y, double time = current_time_seconds()) :
             m_x{x},
-            m_y{y}
+            m_y{y},
+            m_time{time}
         {}
 
     public:
         std::int32_t m_x;
         std::int32_t m_y;
+        //! Capture time as returned by \c current_time_seconds()
+        double m_time;
     };
     //! Wheel motion event data
     class WheelInfo {
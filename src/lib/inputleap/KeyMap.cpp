@@ -23,9 +23,17 @@
 #include <assert.h>
 #include <cctype>
 #include <cstdlib>
+#include <utility>
 
 namespace inputleap {
 
+// modifiers that keysForKeyItem() doesn't insist on matching
+static const KeyModifierMask s_notRequiredMask =
+    KeyModifierAltGr | KeyModifierNumLock | KeyModifierScrollLock;
+
+// modifiers that keysForModifierState() can change
+static const KeyModifierMask s_modifierBits = (1u << kKeyModifierNumBits) - 1;
+
 KeyMap::NameToKeyMap* KeyMap::s_nameToKeyMap = nullptr;
 KeyMap::NameToModifierMap* KeyMap::s_nameToModifierMap = nullptr;
 KeyMap::KeyToNameMap* KeyMap::s_keyToNameMap = nullptr;
@@ -33,6 +41,7 @@ KeyMap::ModifierToNameMap* KeyMap::s_modifierToNameMap = nullptr;
 
 KeyMap::KeyMap() :
     m_numGroups(0),
+    m_numKeyPages(0),
     m_composeAcrossGroups(false)
 {
     m_modifierKeyItem.m_id        = kKeyNone;
@@ -56,6 +65,10 @@ KeyMap::swap(KeyMap& x)
 {
     m_keyIDMap.swap(x.m_keyIDMap);
     m_modifierKeys.swap(x.m_modifierKeys);
+    m_keyPages.swap(x.m_keyPages);
+    std::swap(m_numKeyPages, x.m_numKeyPages);
+    m_compiledKeys.swap(x.m_compiledKeys);
+    m_compiledEntries.swap(x.m_compiledEntries);
     m_halfDuplex.swap(x.m_halfDuplex);
     m_halfDuplexMods.swap(x.m_halfDuplexMods);
     std::int32_t tmp1 = m_numGroups;
@@ -74,6 +87,9 @@ KeyMap::addKeyEntry(const KeyItem& item)
         return;
     }
 
+    // the flat key tables are stale until the next finish()
+    m_keyPages.clear();
+
     // resize number of groups for key
     std::int32_t numGroups = item.m_group + 1;
     if (getNumGroups() > numGroups) {
@@ -142,6 +158,9 @@ bool KeyMap::addKeyCombinationEntry(KeyID id, std::int32_t group, const KeyID* k
         return false;
     }
 
+    // the flat key tables are stale until the next finish()
+    m_keyPages.clear();
+
     std::int32_t numGroups = group + 1;
     if (getNumGroups() > numGroups) {
         numGroups = getNumGroups();
@@ -230,6 +249,9 @@ KeyMap::finish()
 
     // compute keys that generate each modifier
     setModifierKeys();
+
+    // build the tables for quickly mapping keys
+    compileKeys();
 }
 
 void
@@ -255,6 +277,14 @@ const KeyMap::KeyItem* KeyMap::mapKey(Keystrokes& keys, KeyID id, std::int32_t g
                                       KeyModifierMask& currentState, KeyModifierMask desiredMask,
                                       bool isAutoRepeat) const
 {
+    // most keys are characters that need no modifier changes.  map those
+    // without copying the active modifiers or logging.
+    const KeyItem* item;
+    if (!isCommand(desiredMask) &&
+        mapCompiledKey(keys, id, group, currentState, desiredMask, isAutoRepeat, item)) {
+        return item;
+    }
+
     LOG_DEBUG1("mapKey %04x (%d) with mask %04x, start state: %04x", id, id, desiredMask, currentState);
 
     // handle group change
@@ -267,7 +297,6 @@ const KeyMap::KeyItem* KeyMap::mapKey(Keystrokes& keys, KeyID id, std::int32_t g
         return nullptr;
     }
 
-    const KeyItem* item;
     switch (id) {
     case kKeyShift_L:
     case kKeyShift_R:
@@ -490,6 +519,125 @@ KeyMap::setModifierKeys()
     }
 }
 
+void
+KeyMap::compileKeys()
+{
+    m_keyPages.clear();
+    m_numKeyPages = 0;
+    m_compiledKeys.clear();
+    m_compiledEntries.clear();
+    if (getNumGroups() == 0) {
+        return;
+    }
+
+    // number the pages that have keys
+    m_keyPages.resize(kNumKeyPages, 0);
+    for (auto i = m_keyIDMap.begin(); i != m_keyIDMap.end(); ++i) {
+        if (i->first < kNumKeyPages * kKeyPageSize) {
+            std::uint32_t& page = m_keyPages[i->first / kKeyPageSize];
+            if (page == 0) {
+                page = ++m_numKeyPages;
+            }
+        }
+    }
+
+    // flatten the entries of each key in each group
+    const CompiledKey noKey = { 0, 0 };
+    m_compiledKeys.resize(static_cast<std::size_t>(getNumGroups()) *
+                            m_numKeyPages * kKeyPageSize, noKey);
+    for (auto i = m_keyIDMap.begin(); i != m_keyIDMap.end(); ++i) {
+        KeyID id = i->first;
+        if (id >= kNumKeyPages * kKeyPageSize) {
+            continue;
+        }
+
+        // mapKey() handles these itself
+        if (id == kKeySetModifiers || id == kKeyClearModifiers ||
+            id == kKeyNextGroup || id == kKeyPrevGroup) {
+            continue;
+        }
+
+        const KeyGroupTable& groupTable = i->second;
+        std::uint32_t page = m_keyPages[id / kKeyPageSize] - 1;
+        for (std::int32_t g = 0; g < getNumGroups(); ++g) {
+            const KeyEntryList& entries = groupTable[g];
+            CompiledKey& key = m_compiledKeys[
+                (g * m_numKeyPages + page) * kKeyPageSize + id % kKeyPageSize];
+            key.m_first = static_cast<std::uint32_t>(m_compiledEntries.size());
+            key.m_count = static_cast<std::uint32_t>(entries.size());
+            for (size_t j = 0; j < entries.size(); ++j) {
+                const KeyItem& item = entries[j].back();
+                CompiledEntry entry;
+                entry.m_item      = nullptr;
+                entry.m_required  = item.m_required;
+                entry.m_sensitive = item.m_sensitive;
+                entry.m_held      = item.m_sensitive & s_modifierBits;
+                entry.m_free      = ~(item.m_sensitive | s_notRequiredMask) &
+                                        s_modifierBits;
+                if (entries[j].size() == 1 && !item.m_dead &&
+                    item.m_generates == 0 && item.m_group == g) {
+                    entry.m_item = &item;
+                }
+                m_compiledEntries.push_back(entry);
+            }
+        }
+    }
+}
+
+bool KeyMap::mapCompiledKey(Keystrokes& keys, KeyID id, std::int32_t group,
+                            KeyModifierMask currentState, KeyModifierMask desiredMask,
+                            bool isAutoRepeat, const KeyItem*& item) const
+{
+    if (m_keyPages.empty() || id >= kNumKeyPages * kKeyPageSize) {
+        return false;
+    }
+
+    std::uint32_t page = m_keyPages[id / kKeyPageSize];
+    if (page == 0) {
+        // no key on the page.  the function keys in 0xe000 to 0xefff
+        // may still be handled specially.
+        if (id >= 0xe000) {
+            return false;
+        }
+        item = nullptr;
+        return true;
+    }
+
+    std::int32_t effectiveGroup = getEffectiveGroup(group, 0);
+    const CompiledKey& key = m_compiledKeys[
+        (effectiveGroup * m_numKeyPages + page - 1) * kKeyPageSize + id % kKeyPageSize];
+
+    // pick the entry findBestKey() would pick if it matches exactly
+    const CompiledEntry* entry = m_compiledEntries.data() + key.m_first;
+    const CompiledEntry* end   = entry + key.m_count;
+    for (; entry != end; ++entry) {
+        if ((entry->m_required & desiredMask) == entry->m_required &&
+            (entry->m_required & desiredMask) == (entry->m_sensitive & desiredMask)) {
+            break;
+        }
+    }
+    if (entry == end || entry->m_item == nullptr || entry->m_item->m_group != group) {
+        return false;
+    }
+
+    // anything that needs a modifier changed takes the general path
+    if (((currentState ^ entry->m_required) & entry->m_held) != 0 ||
+        ((currentState ^ desiredMask) & entry->m_free) != 0) {
+        return false;
+    }
+
+    const KeyItem& keyItem = *entry->m_item;
+    if (isAutoRepeat) {
+        keys.push_back(Keystroke(keyItem.m_button, false, true, keyItem.m_client));
+        keys.push_back(Keystroke(keyItem.m_button,  true, true, keyItem.m_client));
+    }
+    else {
+        keys.push_back(Keystroke(keyItem.m_button, true, false, keyItem.m_client));
+    }
+    item = &keyItem;
+    return true;
+}
+
 const KeyMap::KeyItem* KeyMap::mapCommandKey(Keystrokes& keys, KeyID id, std::int32_t group,
                                              ModifierToKeys& activeModifiers,
                                              KeyModifierMask& currentState,
@@ -729,9 +877,6 @@ bool KeyMap::keysForKeyItem(const KeyItem& keyItem, std::int32_t& group,
                             KeyModifierMask desiredState, KeyModifierMask overrideModifiers,
                             bool isAutoRepeat, Keystrokes& keystrokes) const
 {
-    static const KeyModifierMask s_notRequiredMask =
-        KeyModifierAltGr | KeyModifierNumLock | KeyModifierScrollLock;
-
     // add keystrokes to adjust the group
     if (group != keyItem.m_group) {
         group = keyItem.m_group;
@@ -1150,8 +1295,9 @@ bool KeyMap::parseKey(const std::string& x, KeyID& key)
 
     // parse the key
     key = kKeyNone;
-    if (s_nameToKeyMap->count(x) > 0) {
-        key = s_nameToKeyMap->find(x)->second;
+    auto named = s_nameToKeyMap->find(x);
+    if (named != s_nameToKeyMap->end()) {
+        key = named->second;
     }
     // XXX -- we're assuming ASCII encoding here
     else if (x.size() == 1) {
@@ -1196,8 +1342,9 @@ bool KeyMap::parseModifiers(std::string& x, KeyModifierMask& mask)
             return false;
         }
 
-        if (s_nameToModifierMap->count(c) > 0) {
-            KeyModifierMask mod = s_nameToModifierMap->find(c)->second;
+        auto named = s_nameToModifierMap->find(c);
+        if (named != s_nameToModifierMap->end()) {
+            KeyModifierMask mod = named->second;
             if ((mask & mod) != 0) {
                 // modifier appears twice
                 return false;
@@ -1298,4 +1445,17 @@ KeyMap::Keystroke::Keystroke(std::int32_t group, bool absolute, bool restore) :
     m_data.m_group.m_restore  = restore;
 }
 
+//
+// KeyMap::Keystrokes
+//
+
+void KeyMap::Keystrokes::spill(const Keystroke& keystroke)
+{
+    if (m_size == kInlineSize) {
+        m_spill.assign(m_inline, m_inline + m_size);
+    }
+    m_spill.push_back(keystroke);
+    ++m_size;
+}
+
 }
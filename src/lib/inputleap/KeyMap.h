@@ -25,6 +25,7 @@
 #include <gtest/gtest_prod.h>
 #endif
 
+#include <cstddef>
 #include <map>
 #include <set>
 #include <vector>
@@ -85,6 +86,7 @@ public:
             kGroup                        //!< Set new group
         };
 
+        Keystroke() = default;
         Keystroke(KeyButton, bool press, bool repeat, std::uint32_t clientData);
         Keystroke(std::int32_t group, bool absolute, bool restore);
 
@@ -113,7 +115,62 @@ public:
     };
 
     //! A sequence of keystrokes
-    typedef std::vector<Keystroke> Keystrokes;
+    /*!
+    A minimal vector of \c Keystroke that keeps the first \c kInlineSize
+    keystrokes in place.  That's enough for a key and the modifier changes
+    around it so mapping a key doesn't touch the heap.
+    */
+    class Keystrokes {
+    public:
+        enum { kInlineSize = 16 };
+
+        typedef Keystroke* iterator;
+        typedef const Keystroke* const_iterator;
+
+        void push_back(const Keystroke& keystroke)
+        {
+            if (m_size < kInlineSize) {
+                m_inline[m_size++] = keystroke;
+            }
+            else {
+                spill(keystroke);
+            }
+        }
+
+        void clear()
+        {
+            m_spill.clear();
+            m_size = 0;
+        }
+
+        bool empty() const { return m_size == 0; }
+        std::size_t size() const { return m_size; }
+
+        iterator begin() { return data(); }
+        iterator end() { return data() + m_size; }
+        const_iterator begin() const { return data(); }
+        const_iterator end() const { return data() + m_size; }
+
+        Keystroke& operator[](std::size_t i) { return data()[i]; }
+        const Keystroke& operator[](std::size_t i) const { return data()[i]; }
+        Keystroke& back() { return data()[m_size - 1]; }
+        const Keystroke& back() const { return data()[m_size - 1]; }
+
+    private:
+        void spill(const Keystroke&);
+
+        Keystroke* data() { return m_size <= kInlineSize ? m_inline : m_spill.data(); }
+        const Keystroke* data() const
+        {
+            return m_size <= kInlineSize ? m_inline : m_spill.data();
+        }
+
+    private:
+        std::size_t m_size = 0;
+        Keystroke m_inline[kInlineSize];
+        // all keystrokes once there are more than fit in place
+        std::vector<Keystroke> m_spill;
+    };
 
     //! A mapping of a modifier to keys for that modifier
     typedef std::multimap<KeyModifierMask, KeyItem> ModifierToKeys;
@@ -337,6 +394,7 @@ private:
     FRIEND_TEST(KeyMapTests,
                 findBestKey_onlyOneRequiredDown_matchTwoRequiredChangesItem);
     FRIEND_TEST(KeyMapTests, findBestKey_noRequiredDown_cannotMatch);
+    FRIEND_TEST(KeyMapTests, mapKey_compiledMatchesGeneralPath);
 #endif
 
 private:
@@ -359,6 +417,17 @@ private:
     // computes the map of modifiers to the keys that generate the modifiers
     void setModifierKeys();
 
+    // builds the flat key tables from the key map
+    void compileKeys();
+
+    // maps a character key using the flat key tables.  this only handles
+    // keys that are pressed with a single button in the active group and
+    // need no modifier changes;  returns \c false if the key needs the
+    // general path and otherwise sets \p item like \c mapCharacterKey.
+    bool mapCompiledKey(Keystrokes& keys, KeyID id, std::int32_t group,
+                        KeyModifierMask currentState, KeyModifierMask desiredMask,
+                        bool isAutoRepeat, const KeyItem*& item) const;
+
     // maps a command key.  a command key is a keyboard shortcut and we're
     // trying to synthesize a button press with an exact sets of modifiers,
     // not trying to synthesize a character.  so we just need to find the
@@ -462,6 +531,31 @@ private:
     // A set of buttons
     typedef std::set<KeyButton> KeyButtonSet;
 
+    // An entry of the flat key tables.  The masks are those of the last
+    // item of the entry.  m_item is set only if the entry is a single key
+    // that doesn't generate a modifier;  a press of such a key needs no
+    // modifier changes if the modifiers in m_held match m_required and
+    // those in m_free already match the desired state.
+    struct CompiledEntry {
+        const KeyItem* m_item;
+        KeyModifierMask m_required;
+        KeyModifierMask m_sensitive;
+        KeyModifierMask m_held;
+        KeyModifierMask m_free;
+    };
+
+    // The entries for one KeyID in one group
+    struct CompiledKey {
+        std::uint32_t m_first;
+        std::uint32_t m_count;
+    };
+
+    // The flat key tables cover KeyIDs below kNumKeyPages * kKeyPageSize
+    enum {
+        kKeyPageSize = 256,
+        kNumKeyPages = 256
+    };
+
     // Key maps for parsing/formatting
     typedef std::map<std::string, KeyID,
                             inputleap::string::CaselessCmp> NameToKeyMap;
@@ -475,6 +569,14 @@ private:
     std::int32_t m_numGroups;
     ModifierToKeyTable m_modifierKeys;
 
+    // flat key tables.  m_keyPages maps the page of a KeyID to its page
+    // number + 1 (0 if no key is on the page) and m_compiledKeys holds,
+    // for each group, kKeyPageSize keys for each of those pages.
+    std::vector<std::uint32_t> m_keyPages;
+    std::uint32_t m_numKeyPages;
+    std::vector<CompiledKey> m_compiledKeys;
+    std::vector<CompiledEntry> m_compiledEntries;
+
     // composition info
     bool m_composeAcrossGroups;
 
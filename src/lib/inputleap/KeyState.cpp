@@ -837,19 +837,26 @@ void KeyState::fakeKeys(const Keystrokes& keys, std::uint32_t count)
         return;
     }
 
-    // generate key events
     LOG_DEBUG1("keystrokes:");
+    if (count == 1) {
+        fakeKeyBatch(keys.begin(), keys.size());
+        return;
+    }
+
+    // expand the repeats so the platform gets all events at once
+    Keystrokes batch;
     for (auto k = keys.begin(); k != keys.end(); ) {
         if (k->m_type == Keystroke::kButton && k->m_data.m_button.m_repeat) {
             // repeat from here up to but not including the next key
             // with m_repeat == false count times.
             auto start = k;
-            while (count-- > 0) {
-                // send repeating events
-                for (k = start; k != keys.end() &&
-                                k->m_type == Keystroke::kButton &&
-                                k->m_data.m_button.m_repeat; ++k) {
-                    fakeKey(*k);
+            while (k != keys.end() && k->m_type == Keystroke::kButton &&
+                        k->m_data.m_button.m_repeat) {
+                ++k;
+            }
+            for (std::uint32_t i = 0; i < count; ++i) {
+                for (auto r = start; r != k; ++r) {
+                    batch.push_back(*r);
                 }
             }
 
@@ -857,13 +864,18 @@ void KeyState::fakeKeys(const Keystrokes& keys, std::uint32_t count)
             // repeat keys, exactly where we'd like to continue from.
         }
         else {
-            // send event
-            fakeKey(*k);
-
-            // next key
+            batch.push_back(*k);
             ++k;
         }
     }
+    fakeKeyBatch(batch.begin(), batch.size());
+}
+
+void KeyState::fakeKeyBatch(const Keystroke* keystrokes, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        fakeKey(keystrokes[i]);
+    }
 }
 
 void
@@ -96,6 +96,15 @@ protected:
     */
     virtual void fakeKey(const Keystroke& keystroke) = 0;
 
+    //! Fake a sequence of key events
+    /*!
+    Synthesize events for the \p count keystrokes starting at
+    \p keystrokes, in order.  The default calls \c fakeKey() for each
+    keystroke.  Platforms that can inject several events with one call
+    should override this so that typing a character costs one call.
+    */
+    virtual void fakeKeyBatch(const Keystroke* keystrokes, std::size_t count);
+
     //! Get the active modifiers
     /*!
     Returns the modifiers that are currently active according to our
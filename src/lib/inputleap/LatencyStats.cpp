@@ -0,0 +1,293 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/LatencyStats.h"
+#include "inputleap/protocol_types.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace inputleap {
+
+namespace {
+
+// values below kSubBuckets are recorded exactly, larger ones keep their
+// top kSubBucketBits bits
+const unsigned kSubBucketBits = 6;
+const std::uint32_t kSubBuckets = 1u << kSubBucketBits;
+const std::uint32_t kHalfSubBuckets = kSubBuckets / 2;
+const std::size_t kBuckets = kSubBuckets + (32 - kSubBucketBits) * kHalfSubBuckets;
+
+unsigned bit_width(std::uint32_t value)
+{
+    unsigned width = 0;
+    while (value != 0) {
+        value >>= 1;
+        ++width;
+    }
+    return width;
+}
+
+} // namespace
+
+std::uint32_t to_wire_time(double seconds)
+{
+    return static_cast<std::uint32_t>(static_cast<std::uint64_t>(seconds * 1.0e6));
+}
+
+//
+// LatencyHistogram
+//
+
+LatencyHistogram::LatencyHistogram() :
+    counts_(kBuckets, 0)
+{
+}
+
+std::size_t LatencyHistogram::bucket_index(std::uint32_t us)
+{
+    if (us < kSubBuckets) {
+        return us;
+    }
+    unsigned shift = bit_width(us) - kSubBucketBits;
+    return kSubBuckets + (shift - 1) * kHalfSubBuckets + ((us >> shift) - kHalfSubBuckets);
+}
+
+std::uint32_t LatencyHistogram::bucket_highest_value(std::size_t index)
+{
+    if (index < kSubBuckets) {
+        return static_cast<std::uint32_t>(index);
+    }
+    std::size_t i = index - kSubBuckets;
+    unsigned shift = static_cast<unsigned>(i / kHalfSubBuckets) + 1;
+    std::uint64_t sub_bucket = i % kHalfSubBuckets + kHalfSubBuckets;
+    return static_cast<std::uint32_t>(((sub_bucket + 1) << shift) - 1);
+}
+
+void LatencyHistogram::record(std::uint32_t us)
+{
+    ++counts_[bucket_index(us)];
+    ++count_;
+    if (us > max_) {
+        max_ = us;
+    }
+}
+
+void LatencyHistogram::record_seconds(double seconds)
+{
+    double us = std::round(seconds * 1.0e6);
+    if (us <= 0.0) {
+        record(0);
+    }
+    else if (us >= 4294967295.0) {
+        record(0xffffffffu);
+    }
+    else {
+        record(static_cast<std::uint32_t>(us));
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(counts_.begin(), counts_.end(), 0);
+    count_ = 0;
+    max_ = 0;
+}
+
+std::uint32_t LatencyHistogram::get_percentile(double percentile) const
+{
+    if (count_ == 0) {
+        return 0;
+    }
+
+    // the rank of the latency we're looking for, counting from 1.  allow
+    // for rounding errors so 99.9% of 1000 is 999 and not 1000.
+    std::uint64_t rank = static_cast<std::uint64_t>(
+                std::ceil(percentile / 100.0 * static_cast<double>(count_) - 1.0e-6));
+    if (rank < 1) {
+        rank = 1;
+    }
+    else if (rank > count_) {
+        rank = count_;
+    }
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            // don't report more than was actually recorded
+            std::uint32_t value = bucket_highest_value(i);
+            return value < max_ ? value : max_;
+        }
+    }
+    return max_;
+}
+
+LatencyHistogram::Summary LatencyHistogram::get_summary() const
+{
+    Summary summary;
+    summary.count = count_;
+    summary.p50 = get_percentile(50.0);
+    summary.p99 = get_percentile(99.0);
+    summary.p999 = get_percentile(99.9);
+    summary.max = max_;
+    return summary;
+}
+
+//
+// ClockOffsetEstimator
+//
+
+void ClockOffsetEstimator::add_sample(std::uint32_t local_sent, std::uint32_t remote,
+                                      std::uint32_t local_received)
+{
+    std::int32_t round_trip_time = wire_time_diff(local_received, local_sent);
+    if (round_trip_time < 0) {
+        return;
+    }
+
+    // assume the remote side answered halfway through the round trip
+    std::uint32_t local_midpoint = local_sent + static_cast<std::uint32_t>(round_trip_time / 2);
+
+    Sample& sample = samples_[next_];
+    sample.offset = wire_time_diff(remote, local_midpoint);
+    sample.round_trip_time = static_cast<std::uint32_t>(round_trip_time);
+
+    next_ = (next_ + 1) % kSamples;
+    if (size_ < kSamples) {
+        ++size_;
+    }
+}
+
+void ClockOffsetEstimator::reset()
+{
+    size_ = 0;
+    next_ = 0;
+}
+
+const ClockOffsetEstimator::Sample* ClockOffsetEstimator::best() const
+{
+    const Sample* best = nullptr;
+    for (std::size_t i = 0; i < size_; ++i) {
+        if (best == nullptr || samples_[i].round_trip_time < best->round_trip_time) {
+            best = &samples_[i];
+        }
+    }
+    return best;
+}
+
+std::int32_t ClockOffsetEstimator::get_offset() const
+{
+    const Sample* sample = best();
+    return sample != nullptr ? sample->offset : 0;
+}
+
+std::uint32_t ClockOffsetEstimator::get_round_trip_time() const
+{
+    const Sample* sample = best();
+    return sample != nullptr ? sample->round_trip_time : 0;
+}
+
+std::uint32_t ClockOffsetEstimator::to_local(std::uint32_t remote) const
+{
+    return remote - static_cast<std::uint32_t>(get_offset());
+}
+
+//
+// RoundTripEstimator
+//
+
+namespace {
+
+// the smallest meaningful difference between round trip times.  this also
+// absorbs the time the peer takes to get to the keep alive in its event
+// loop.
+const double kRoundTripGranularity = 0.01;
+
+// keep alives are sent this many timeouts apart
+const double kKeepAliveTimeouts = 10.0;
+
+} // namespace
+
+void RoundTripEstimator::add_sample(double round_trip_time)
+{
+    if (round_trip_time < 0.0) {
+        return;
+    }
+
+    if (!valid_) {
+        smoothed_ = round_trip_time;
+        variation_ = round_trip_time / 2.0;
+        valid_ = true;
+    }
+    else {
+        // gains from RFC 6298.  the variation must be updated first since
+        // it uses the old smoothed value.
+        variation_ = 0.75 * variation_ + 0.25 * std::fabs(smoothed_ - round_trip_time);
+        smoothed_ = 0.875 * smoothed_ + 0.125 * round_trip_time;
+    }
+}
+
+void RoundTripEstimator::reset()
+{
+    valid_ = false;
+    smoothed_ = 0.0;
+    variation_ = 0.0;
+}
+
+double RoundTripEstimator::get_timeout() const
+{
+    return smoothed_ + std::max(kRoundTripGranularity, 4.0 * variation_);
+}
+
+double RoundTripEstimator::get_keep_alive_rate(double max_rate) const
+{
+    if (!valid_) {
+        return max_rate;
+    }
+    return std::min(max_rate, std::max(kKeepAliveMinRate, kKeepAliveTimeouts * get_timeout()));
+}
+
+double RoundTripEstimator::get_death_timeout(double rate) const
+{
+    double timeout = valid_ ? get_timeout() : 0.0;
+    return kKeepAlivesUntilDeath * (rate + timeout);
+}
+
+const char* latency_stage_name(LatencyStage stage)
+{
+    switch (stage) {
+    case LatencyStage::HookToSend:
+        return "hook-to-send";
+    case LatencyStage::SendToReceive:
+        return "send-to-receive";
+    case LatencyStage::ReceiveToInject:
+        return "receive-to-inject";
+    case LatencyStage::RoundTrip:
+        return "round-trip";
+    case LatencyStage::Resume:
+        return "resume";
+    case LatencyStage::Reconnect:
+        return "reconnect";
+    case LatencyStage::ClipboardFetch:
+        return "clipboard-fetch";
+    case LatencyStage::ScreenSwitch:
+        return "screen-switch";
+    }
+    return "unknown";
+}
+
+} // namespace inputleap
@@ -0,0 +1,244 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace inputleap {
+
+//! Convert a time to a wire timestamp
+/*!
+Returns \p seconds, as returned by \c current_time_seconds(), in
+microseconds modulo 2^32.  Wire timestamps wrap after about 71 minutes so
+they must only be compared with \c wire_time_diff().
+*/
+std::uint32_t to_wire_time(double seconds);
+
+//! Get the difference between two wire timestamps
+/*!
+Returns \p later - \p earlier in microseconds.  The result is only correct
+if the timestamps are less than about 35 minutes apart.
+*/
+inline std::int32_t wire_time_diff(std::uint32_t later, std::uint32_t earlier)
+{
+    return static_cast<std::int32_t>(later - earlier);
+}
+
+//! Latency histogram
+/*!
+Records latencies in microseconds with a bounded relative error, like an
+HDR histogram.  Latencies below 64us are recorded exactly, larger ones in
+buckets that are at most 1/32 of their value wide.  Recording is O(1) and
+the histogram has a fixed size regardless of the number of samples.
+*/
+class LatencyHistogram {
+public:
+    //! Percentiles of the recorded latencies, in microseconds
+    struct Summary {
+        std::uint64_t count = 0;
+        std::uint32_t p50 = 0;
+        std::uint32_t p99 = 0;
+        std::uint32_t p999 = 0;
+        std::uint32_t max = 0;
+    };
+
+    LatencyHistogram();
+
+    //! @name manipulators
+    //@{
+
+    //! Record a latency of \p us microseconds
+    void record(std::uint32_t us);
+
+    //! Record a latency of \p seconds, clamping negative values to zero
+    void record_seconds(double seconds);
+
+    //! Discard all recorded latencies
+    void reset();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of recorded latencies
+    std::uint64_t get_count() const { return count_; }
+
+    //! Get a percentile
+    /*!
+    Returns the latency that \p percentile percent of the recorded latencies
+    are at or below, rounded up to the end of its bucket.  Returns 0 if
+    nothing was recorded.
+    */
+    std::uint32_t get_percentile(double percentile) const;
+
+    //! Get the largest recorded latency
+    std::uint32_t get_max() const { return max_; }
+
+    //! Get the count and the usual percentiles
+    Summary get_summary() const;
+
+    //@}
+
+private:
+    static std::size_t bucket_index(std::uint32_t us);
+    static std::uint32_t bucket_highest_value(std::size_t index);
+
+private:
+    std::vector<std::uint32_t> counts_;
+    std::uint64_t count_ = 0;
+    std::uint32_t max_ = 0;
+};
+
+//! Clock offset estimator
+/*!
+Estimates the offset of a remote clock from round trips, like NTP.  Each
+round trip is a local send time, the remote time when the remote side
+answered and the local receive time, all as wire timestamps.  The estimate
+uses the recent round trip with the lowest round trip time because its
+remote time is the least uncertain.
+*/
+class ClockOffsetEstimator {
+public:
+    //! @name manipulators
+    //@{
+
+    //! Add a round trip
+    void add_sample(std::uint32_t local_sent, std::uint32_t remote, std::uint32_t local_received);
+
+    //! Discard all round trips
+    void reset();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Check if there's an estimate
+    bool is_valid() const { return size_ != 0; }
+
+    //! Get the remote clock minus the local clock in microseconds
+    std::int32_t get_offset() const;
+
+    //! Get the round trip time of the round trip the estimate is based on
+    std::uint32_t get_round_trip_time() const;
+
+    //! Convert a remote wire timestamp to the local clock
+    std::uint32_t to_local(std::uint32_t remote) const;
+
+    //@}
+
+private:
+    struct Sample {
+        std::int32_t offset;
+        std::uint32_t round_trip_time;
+    };
+
+    const Sample* best() const;
+
+private:
+    static const std::size_t kSamples = 8;
+
+    std::array<Sample, kSamples> samples_;
+    std::size_t size_ = 0;
+    std::size_t next_ = 0;
+};
+
+//! Round trip time estimator
+/*!
+Smooths round trip times the way TCP does (RFC 6298): it keeps an
+exponentially weighted mean and mean deviation of the samples and derives
+a retransmission-style timeout from them.  The keep alive rate and the
+time after which a peer is considered dead are derived from the timeout,
+so that they shrink on fast, steady links and grow on slow or jittery ones.
+All times are in seconds.
+*/
+class RoundTripEstimator {
+public:
+    //! @name manipulators
+    //@{
+
+    //! Add a round trip time
+    void add_sample(double round_trip_time);
+
+    //! Discard the estimate
+    void reset();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Check if there's an estimate
+    bool is_valid() const { return valid_; }
+
+    //! Get the smoothed round trip time (SRTT)
+    double get_smoothed() const { return smoothed_; }
+
+    //! Get the round trip time variation (RTTVAR)
+    double get_variation() const { return variation_; }
+
+    //! Get the time within which a reply is expected (RTO)
+    double get_timeout() const;
+
+    //! Get the keep alive rate
+    /*!
+    Returns the time between keep alives, at least \c kKeepAliveMinRate and
+    at most \p max_rate.  Returns \p max_rate if there's no estimate.
+    */
+    double get_keep_alive_rate(double max_rate) const;
+
+    //! Get the time after which the peer is considered dead
+    /*!
+    Returns how long to wait for any message when keep alives are sent
+    every \p rate seconds.  This allows for \c kKeepAlivesUntilDeath lost
+    keep alives, each of which may also be late by the timeout.
+    */
+    double get_death_timeout(double rate) const;
+
+    //@}
+
+private:
+    bool valid_ = false;
+    double smoothed_ = 0.0;
+    double variation_ = 0.0;
+};
+
+//! Stage of input latency
+enum class LatencyStage : std::uint8_t {
+    HookToSend,         //!< primary screen capture to sending to a client
+    SendToReceive,      //!< sending to a client to the client receiving it
+    ReceiveToInject,    //!< the client receiving input to injecting it
+    RoundTrip,          //!< keep alive round trip between primary and client
+    Resume,             //!< losing the connection to resuming the session
+    Reconnect,          //!< losing the connection to a full reconnect
+    ClipboardFetch,     //!< pasting a lazily sent clipboard to its data arriving
+    ScreenSwitch        //!< hitting a screen edge to motion on the new screen
+};
+
+//! Get the name of a latency stage as used in reports
+const char* latency_stage_name(LatencyStage stage);
+
+//! Latency of one stage for one screen
+struct LatencyReport {
+    std::string screen;
+    LatencyStage stage;
+    LatencyHistogram::Summary summary;
+};
+
+} // namespace inputleap
@@ -0,0 +1,385 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/MotionDatagram.h"
+
+#include <random>
+
+namespace inputleap {
+
+namespace {
+
+const std::uint8_t kMagic0 = 'L';
+const std::uint8_t kMagic1 = 'D';
+
+const std::size_t kHeaderSize = 12;
+const std::size_t kTagSize = 8;
+const std::size_t kMotionSize = kHeaderSize + 16 + kTagSize;
+const std::size_t kAckSize = kHeaderSize + 8 + kTagSize;
+
+static_assert(kMotionSize <= kMaxMotionDatagramSize, "motion datagram too large");
+static_assert(kAckSize <= kMaxMotionDatagramSize, "ack datagram too large");
+
+void write_u16(std::uint8_t* out, std::uint16_t v)
+{
+    out[0] = static_cast<std::uint8_t>(v >> 8);
+    out[1] = static_cast<std::uint8_t>(v);
+}
+
+void write_u32(std::uint8_t* out, std::uint32_t v)
+{
+    out[0] = static_cast<std::uint8_t>(v >> 24);
+    out[1] = static_cast<std::uint8_t>(v >> 16);
+    out[2] = static_cast<std::uint8_t>(v >> 8);
+    out[3] = static_cast<std::uint8_t>(v);
+}
+
+std::uint16_t read_u16(const std::uint8_t* in)
+{
+    return static_cast<std::uint16_t>((in[0] << 8) | in[1]);
+}
+
+std::uint32_t read_u32(const std::uint8_t* in)
+{
+    return (static_cast<std::uint32_t>(in[0]) << 24) |
+           (static_cast<std::uint32_t>(in[1]) << 16) |
+           (static_cast<std::uint32_t>(in[2]) << 8) |
+            static_cast<std::uint32_t>(in[3]);
+}
+
+std::uint64_t read_u64_le(const std::uint8_t* in)
+{
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | in[i];
+    }
+    return v;
+}
+
+std::uint64_t rotl(std::uint64_t x, int b)
+{
+    return (x << b) | (x >> (64 - b));
+}
+
+void sip_round(std::uint64_t& v0, std::uint64_t& v1, std::uint64_t& v2, std::uint64_t& v3)
+{
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+// SipHash-2-4, a keyed hash designed as a MAC for short messages
+std::uint64_t siphash24(const MotionDatagramKey& key, const std::uint8_t* data, std::size_t size)
+{
+    std::uint64_t k0 = read_u64_le(key.data());
+    std::uint64_t k1 = read_u64_le(key.data() + 8);
+    std::uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    std::uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    std::uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    std::uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    const std::uint8_t* end = data + (size & ~static_cast<std::size_t>(7));
+    for (; data != end; data += 8) {
+        std::uint64_t m = read_u64_le(data);
+        v3 ^= m;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    std::uint64_t b = static_cast<std::uint64_t>(size) << 56;
+    for (std::size_t i = 0; i < (size & 7); ++i) {
+        b |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+    }
+    v3 ^= b;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) {
+        sip_round(v0, v1, v2, v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+void write_tag(const MotionDatagramKey& key, std::uint8_t* data, std::size_t size)
+{
+    std::uint64_t tag = siphash24(key, data, size);
+    write_u32(data + size, static_cast<std::uint32_t>(tag >> 32));
+    write_u32(data + size + 4, static_cast<std::uint32_t>(tag));
+}
+
+bool check_tag(const MotionDatagramKey& key, const std::uint8_t* data, std::size_t size)
+{
+    std::uint8_t tag[kTagSize];
+    std::uint64_t expected = siphash24(key, data, size);
+    write_u32(tag, static_cast<std::uint32_t>(expected >> 32));
+    write_u32(tag + 4, static_cast<std::uint32_t>(expected));
+
+    // constant time comparison, every byte is looked at
+    std::uint8_t diff = 0;
+    for (std::size_t i = 0; i < kTagSize; ++i) {
+        diff |= static_cast<std::uint8_t>(tag[i] ^ data[size + i]);
+    }
+    return diff == 0;
+}
+
+} // namespace
+
+bool is_newer_sequence(std::uint32_t a, std::uint32_t b)
+{
+    return static_cast<std::int32_t>(a - b) > 0;
+}
+
+std::size_t encode_motion_datagram(const MotionDatagram& datagram,
+                                   const MotionDatagramKey& key, std::uint8_t* out)
+{
+    out[0] = kMagic0;
+    out[1] = kMagic1;
+    out[2] = static_cast<std::uint8_t>(datagram.type);
+    out[3] = datagram.flags;
+    write_u32(out + 4, datagram.session);
+    write_u32(out + 8, datagram.seq);
+
+    std::size_t size = kHeaderSize;
+    if (datagram.type == MotionDatagram::Type::Motion) {
+        write_u16(out + size, static_cast<std::uint16_t>(datagram.x));
+        write_u16(out + size + 2, static_cast<std::uint16_t>(datagram.y));
+        write_u32(out + size + 4, static_cast<std::uint32_t>(datagram.dx_total));
+        write_u32(out + size + 8, static_cast<std::uint32_t>(datagram.dy_total));
+        write_u32(out + size + 12, datagram.epoch);
+        size += 16;
+    }
+    else {
+        write_u32(out + size, datagram.received);
+        write_u32(out + size + 4, datagram.ack_seq);
+        size += 8;
+    }
+
+    write_tag(key, out, size);
+    return size + kTagSize;
+}
+
+bool peek_motion_datagram_session(const std::uint8_t* data, std::size_t size,
+                                  std::uint32_t& session)
+{
+    if (size < kHeaderSize + kTagSize || data[0] != kMagic0 || data[1] != kMagic1) {
+        return false;
+    }
+    session = read_u32(data + 4);
+    return true;
+}
+
+bool decode_motion_datagram(const std::uint8_t* data, std::size_t size,
+                            const MotionDatagramKey& key, MotionDatagram& datagram)
+{
+    if (size < kHeaderSize + kTagSize || data[0] != kMagic0 || data[1] != kMagic1) {
+        return false;
+    }
+
+    auto type = static_cast<MotionDatagram::Type>(data[2]);
+    if (type == MotionDatagram::Type::Motion) {
+        if (size != kMotionSize) {
+            return false;
+        }
+    }
+    else if (type == MotionDatagram::Type::Ack) {
+        if (size != kAckSize) {
+            return false;
+        }
+    }
+    else {
+        return false;
+    }
+
+    if (!check_tag(key, data, size - kTagSize)) {
+        return false;
+    }
+
+    datagram = MotionDatagram();
+    datagram.type = type;
+    datagram.flags = data[3];
+    datagram.session = read_u32(data + 4);
+    datagram.seq = read_u32(data + 8);
+    if (type == MotionDatagram::Type::Motion) {
+        datagram.x = static_cast<std::int16_t>(read_u16(data + kHeaderSize));
+        datagram.y = static_cast<std::int16_t>(read_u16(data + kHeaderSize + 2));
+        datagram.dx_total = static_cast<std::int32_t>(read_u32(data + kHeaderSize + 4));
+        datagram.dy_total = static_cast<std::int32_t>(read_u32(data + kHeaderSize + 8));
+        datagram.epoch = read_u32(data + kHeaderSize + 12);
+    }
+    else {
+        datagram.received = read_u32(data + kHeaderSize);
+        datagram.ack_seq = read_u32(data + kHeaderSize + 4);
+    }
+    return true;
+}
+
+MotionDatagramKey make_motion_datagram_key()
+{
+    std::random_device random;
+    std::uniform_int_distribution<unsigned> byte(0, 255);
+
+    MotionDatagramKey key;
+    for (auto& b : key) {
+        b = static_cast<std::uint8_t>(byte(random));
+    }
+    return key;
+}
+
+//
+// MotionDatagramSender
+//
+
+MotionDatagramSender::MotionDatagramSender(std::uint32_t session)
+{
+    last_.type = MotionDatagram::Type::Motion;
+    last_.session = session;
+}
+
+const MotionDatagram& MotionDatagramSender::move(std::int16_t x, std::int16_t y)
+{
+    ordered_ = false;
+    ++last_.seq;
+    last_.flags = MotionDatagram::kAbsolute;
+    last_.x = x;
+    last_.y = y;
+    unsynced_ = true;
+    return last_;
+}
+
+const MotionDatagram& MotionDatagramSender::move_relative(std::int32_t dx, std::int32_t dy)
+{
+    ordered_ = false;
+    ++last_.seq;
+    last_.flags = MotionDatagram::kRelative;
+
+    // totals wrap around, receivers only look at differences
+    last_.dx_total = static_cast<std::int32_t>(static_cast<std::uint32_t>(last_.dx_total) +
+                                               static_cast<std::uint32_t>(dx));
+    last_.dy_total = static_cast<std::int32_t>(static_cast<std::uint32_t>(last_.dy_total) +
+                                               static_cast<std::uint32_t>(dy));
+    unsynced_ = true;
+    return last_;
+}
+
+bool MotionDatagramSender::take_sync(MotionDatagram& sync)
+{
+    // the next datagram must not overtake the input about to be sent
+    ordered_ = true;
+
+    if (!unsynced_) {
+        return false;
+    }
+    unsynced_ = false;
+    sync = last_;
+    ++last_.epoch;
+    return true;
+}
+
+bool MotionDatagramSender::take_barrier(MotionDatagram& barrier)
+{
+    if (!ordered_) {
+        return false;
+    }
+    ordered_ = false;
+    unsynced_ = false;
+    barrier = last_;
+    ++last_.epoch;
+    return true;
+}
+
+//
+// MotionDatagramReceiver
+//
+
+bool MotionDatagramReceiver::accept(const MotionDatagram& datagram, Motion& motion)
+{
+    // input sent before this datagram is still on its way over the
+    // stream.  datagrams are snapshots so only the newest is kept.
+    if (is_newer_sequence(datagram.epoch, syncs_)) {
+        if (!have_held_ || is_newer_sequence(datagram.seq, held_.seq)) {
+            held_ = datagram;
+            have_held_ = true;
+        }
+        ++held_count_;
+        ++received_;
+        return false;
+    }
+
+    if (!apply(datagram, motion)) {
+        ++stale_;
+        return false;
+    }
+    ++received_;
+    return true;
+}
+
+bool MotionDatagramReceiver::accept_sync(const MotionDatagram& sync, Motion& motion)
+{
+    ++syncs_;
+    bool applied = apply(sync, motion);
+
+    if (have_held_ && !is_newer_sequence(held_.epoch, syncs_)) {
+        have_held_ = false;
+        if (apply(held_, motion)) {
+            applied = true;
+        }
+        else {
+            ++stale_;
+        }
+    }
+    return applied;
+}
+
+bool MotionDatagramReceiver::apply(const MotionDatagram& datagram, Motion& motion)
+{
+    if (have_seq_ && !is_newer_sequence(datagram.seq, last_seq_)) {
+        return false;
+    }
+    have_seq_ = true;
+    last_seq_ = datagram.seq;
+
+    // relative motion is recovered from the totals so lost datagrams
+    // don't lose any motion
+    motion.dx += static_cast<std::int32_t>(static_cast<std::uint32_t>(datagram.dx_total) -
+                                           static_cast<std::uint32_t>(dx_total_));
+    motion.dy += static_cast<std::int32_t>(static_cast<std::uint32_t>(datagram.dy_total) -
+                                           static_cast<std::uint32_t>(dy_total_));
+    dx_total_ = datagram.dx_total;
+    dy_total_ = datagram.dy_total;
+
+    if ((datagram.flags & MotionDatagram::kAbsolute) != 0) {
+        motion.has_absolute = true;
+        motion.x = datagram.x;
+        motion.y = datagram.y;
+    }
+    return true;
+}
+
+MotionDatagram MotionDatagramReceiver::make_ack(std::uint32_t session) const
+{
+    MotionDatagram ack;
+    ack.type = MotionDatagram::Type::Ack;
+    ack.session = session;
+    ack.seq = last_seq_;
+    ack.received = received_;
+    return ack;
+}
+
+} // namespace inputleap
@@ -0,0 +1,230 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace inputleap {
+
+//! Session key of a motion datagram lane
+using MotionDatagramKey = std::array<std::uint8_t, 16>;
+
+//! Mouse motion datagram
+/*!
+Mouse motion can be delivered over UDP next to the stream connection once
+both sides agreed on \c kProtocolFeatureMotionDatagrams.  Each datagram is
+authenticated with a SipHash-2-4 tag keyed by the session key sent over the
+stream in \c kMsgCDatagramOffer, so datagrams from other hosts or earlier
+sessions are ignored.
+
+Motion datagrams carry the latest absolute position and the running totals
+of relative motion instead of deltas.  A lost datagram is therefore made up
+for by the next one, and datagrams arriving out of order are discarded by
+sequence number.
+
+Datagrams can overtake input sent over the stream before them.  Every
+datagram carries the number of \c kMsgDMotionSync sent over the stream
+before it, and one is sent ahead of the first datagram following other
+input.  The secondary holds back datagrams until it has seen that many
+syncs, so motion is never applied before input that preceded it.
+*/
+struct MotionDatagram {
+    enum class Type : std::uint8_t {
+        //! Motion snapshot;  primary -> secondary
+        Motion = 1,
+        //! Receive report;  secondary -> primary.  Also tells the primary
+        //! where to send motion datagrams.
+        Ack = 2
+    };
+
+    enum Flags : std::uint8_t {
+        kAbsolute = 1 << 0,     //!< \c x, \c y hold the latest position
+        kRelative = 1 << 1      //!< the latest motion was relative
+    };
+
+    Type type = Type::Motion;
+    std::uint8_t flags = 0;
+    std::uint32_t session = 0;
+
+    //! Sequence number for motion, highest received sequence number for acks
+    std::uint32_t seq = 0;
+
+    std::int16_t x = 0;
+    std::int16_t y = 0;
+    std::int32_t dx_total = 0;
+    std::int32_t dy_total = 0;
+
+    //! Number of \c kMsgDMotionSync sent before it, only used by motion
+    std::uint32_t epoch = 0;
+
+    //! Number of motion datagrams received, only used by acks
+    std::uint32_t received = 0;
+
+    //! Sequence number of the ack, only used by acks
+    std::uint32_t ack_seq = 0;
+};
+
+//! Maximum encoded size of a motion datagram
+static const std::size_t kMaxMotionDatagramSize = 36;
+
+//! Check if sequence number \p a is newer than \p b, allowing for wrap around
+bool is_newer_sequence(std::uint32_t a, std::uint32_t b);
+
+//! Encode a motion datagram
+/*!
+Writes \p datagram, authenticated with \p key, to \p out which must have
+room for \c kMaxMotionDatagramSize bytes.  Returns the encoded size.
+*/
+std::size_t encode_motion_datagram(const MotionDatagram& datagram,
+                                   const MotionDatagramKey& key, std::uint8_t* out);
+
+//! Get the session of an encoded motion datagram
+/*!
+Returns false if \p data isn't a motion datagram.  The datagram is not
+authenticated;  use this only to look up the key to decode it with.
+*/
+bool peek_motion_datagram_session(const std::uint8_t* data, std::size_t size,
+                                  std::uint32_t& session);
+
+//! Decode a motion datagram
+/*!
+Returns false if \p data is malformed or wasn't authenticated with \p key.
+*/
+bool decode_motion_datagram(const std::uint8_t* data, std::size_t size,
+                            const MotionDatagramKey& key, MotionDatagram& datagram);
+
+//! Create a random session key
+MotionDatagramKey make_motion_datagram_key();
+
+//! Motion datagram sender state
+/*!
+Turns mouse motion into motion datagrams for one lane.
+*/
+class MotionDatagramSender {
+public:
+    explicit MotionDatagramSender(std::uint32_t session);
+
+    //! @name manipulators
+    //@{
+
+    //! Return the datagram for an absolute move to \p x, \p y
+    const MotionDatagram& move(std::int16_t x, std::int16_t y);
+
+    //! Return the datagram for a relative move by \p dx, \p dy
+    const MotionDatagram& move_relative(std::int32_t dx, std::int32_t dy);
+
+    //! Take the motion to resend over the stream
+    /*!
+    Must be called before any other input is sent over the stream.
+    Returns true and sets \p sync to the latest datagram if any motion was
+    sent since the last call.
+    */
+    bool take_sync(MotionDatagram& sync);
+
+    //! Take the sync to send ahead of the next datagram
+    /*!
+    Returns true and sets \p barrier to the latest datagram if input went
+    over the stream since the last datagram.  \p barrier must be sent as a
+    \c kMsgDMotionSync before the next datagram, which the secondary then
+    only applies after that input.
+    */
+    bool take_barrier(MotionDatagram& barrier);
+
+    //@}
+
+private:
+    MotionDatagram last_;
+    bool unsynced_ = false;
+    // input went over the stream since the last datagram
+    bool ordered_ = true;
+};
+
+//! Motion datagram receiver state
+/*!
+Tracks the motion datagrams and stream syncs accepted for one lane.
+*/
+class MotionDatagramReceiver {
+public:
+    //! Motion to apply
+    struct Motion {
+        bool has_absolute = false;
+        std::int32_t x = 0;
+        std::int32_t y = 0;
+        std::int32_t dx = 0;
+        std::int32_t dy = 0;
+    };
+
+    //! @name manipulators
+    //@{
+
+    //! Accept a motion datagram
+    /*!
+    Adds the motion implied by \p datagram to \p motion and returns true,
+    or returns false if \p datagram is older than one already accepted.
+    Calling this for a batch of datagrams leaves the net motion of the
+    batch in \p motion.  A datagram sent after syncs that haven't arrived
+    yet is held back until they do and false is returned.
+    */
+    bool accept(const MotionDatagram& datagram, Motion& motion);
+
+    //! Accept motion resent over the stream
+    /*!
+    Like \c accept() but for a \c kMsgDMotionSync, which isn't counted
+    as a received datagram.  Also applies the datagram held back for this
+    sync, if any.
+    */
+    bool accept_sync(const MotionDatagram& sync, Motion& motion);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Return the receive report for the primary
+    MotionDatagram make_ack(std::uint32_t session) const;
+
+    //! Number of motion datagrams accepted
+    std::uint32_t get_received() const { return received_; }
+
+    //! Number of motion datagrams discarded as stale
+    std::uint32_t get_stale() const { return stale_; }
+
+    //! Number of motion datagrams that had to wait for the stream
+    std::uint32_t get_held() const { return held_count_; }
+
+    //@}
+
+private:
+    bool apply(const MotionDatagram& datagram, Motion& motion);
+
+private:
+    std::uint32_t syncs_ = 0;
+    // the newest datagram that arrived before the syncs sent ahead of it
+    bool have_held_ = false;
+    MotionDatagram held_;
+    std::uint32_t held_count_ = 0;
+
+    bool have_seq_ = false;
+    std::uint32_t last_seq_ = 0;
+    std::int32_t dx_total_ = 0;
+    std::int32_t dy_total_ = 0;
+    std::uint32_t received_ = 0;
+    std::uint32_t stale_ = 0;
+};
+
+} // namespace inputleap
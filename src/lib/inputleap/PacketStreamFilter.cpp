@@ -86,15 +86,21 @@ std::uint32_t PacketStreamFilter::read(void* buffer, std::uint32_t n)
 
 void PacketStreamFilter::write(const void* buffer, std::uint32_t count)
 {
-    // write the length of the payload
-    std::uint8_t length[4];
-    length[0] = static_cast<std::uint8_t>((count >> 24) & 0xff);
-    length[1] = static_cast<std::uint8_t>((count >> 16) & 0xff);
-    length[2] = static_cast<std::uint8_t>((count >> 8) & 0xff);
-    length[3] = static_cast<std::uint8_t>(count& 0xff);
-    getStream()->write(length, sizeof(length));
-
-    // write the payload
+    // the length of the payload goes first
+    std::uint8_t packet[kMaxSmallPacket + 4];
+    packet[0] = static_cast<std::uint8_t>((count >> 24) & 0xff);
+    packet[1] = static_cast<std::uint8_t>((count >> 16) & 0xff);
+    packet[2] = static_cast<std::uint8_t>((count >> 8) & 0xff);
+    packet[3] = static_cast<std::uint8_t>(count& 0xff);
+
+    // most messages are a few bytes, write them to the stream in one go.
+    // not worth copying large ones.
+    if (count <= kMaxSmallPacket) {
+        memcpy(packet + 4, buffer, count);
+        getStream()->write(packet, count + 4);
+        return;
+    }
+    getStream()->write(packet, 4);
     getStream()->write(buffer, count);
 }
 
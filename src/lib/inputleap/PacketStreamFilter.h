@@ -47,6 +47,9 @@ protected:
     void filterEvent(const Event&) override;
 
 private:
+    // payloads up to this size are written together with their length
+    static constexpr std::uint32_t kMaxSmallPacket = 256;
+
     bool isReadyNoLock() const;
 
     // returns false on erroneous packet size
@@ -60,6 +60,8 @@ public:
 
     // IPlatformScreen overrides
 
+    bool set_clipboard_formats(ClipboardID, const std::vector<IClipboard::EFormat>&) override
+        { return false; }
     void fakeDraggingFiles(DragFileList fileList)  override
         { (void) fileList; throw std::runtime_error("fakeDraggingFiles not implemented"); }
     const std::string& getDropTarget() const override
@@ -61,6 +61,15 @@ bool PlatformScreenLoggingWrapper::setClipboard(ClipboardID id, const IClipboard
     return result;
 }
 
+bool PlatformScreenLoggingWrapper::set_clipboard_formats(
+        ClipboardID id, const std::vector<IClipboard::EFormat>& formats)
+{
+    bool result = screen_->set_clipboard_formats(id, formats);
+    LOG_DEBUG1("PlatformScreen::set_clipboard_formats() id=%d formats=%zd => %d",
+               id, formats.size(), result);
+    return result;
+}
+
 void PlatformScreenLoggingWrapper::checkClipboards()
 {
     LOG_DEBUG1("PlatformScreen::checkClipboards()");
@@ -33,6 +33,8 @@ public:
     bool canLeave() override;
     void leave() override;
     bool setClipboard(ClipboardID id, const IClipboard* clipboard) override;
+    bool set_clipboard_formats(ClipboardID id,
+                               const std::vector<IClipboard::EFormat>& formats) override;
     void checkClipboards() override;
     void openScreensaver(bool notify) override;
     void closeScreensaver() override;
@@ -0,0 +1,39 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/ReadBudget.h"
+
+namespace inputleap {
+
+ReadBudget::ReadBudget(std::uint32_t max_messages, double max_time) :
+    max_messages_{max_messages},
+    max_time_{max_time}
+{
+}
+
+void ReadBudget::start(double now)
+{
+    count_ = 0;
+    start_ = now;
+}
+
+bool ReadBudget::consume(double now)
+{
+    ++count_;
+    return count_ < max_messages_ && now - start_ < max_time_;
+}
+
+} // namespace inputleap
@@ -0,0 +1,72 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace inputleap {
+
+//! Bounds the work done for one input ready event
+/*!
+A peer that fell behind can leave thousands of messages queued on its
+stream.  Handling them all in one go stalls the event loop and every other
+screen with it.  A reader starts the budget when it begins draining its
+stream and charges it for each message;  once the message count or the
+elapsed time runs out it should stop and post itself another input ready
+event so other events get dispatched in between.
+*/
+class ReadBudget {
+public:
+    //! Messages handled per slice by default
+    static constexpr std::uint32_t kDefaultMaxMessages = 256;
+
+    //! Seconds spent per slice by default
+    static constexpr double kDefaultMaxTime = 0.002;
+
+    ReadBudget(std::uint32_t max_messages = kDefaultMaxMessages,
+               double max_time = kDefaultMaxTime);
+
+    //! @name manipulators
+    //@{
+
+    //! Start a new slice at time \p now
+    void start(double now);
+
+    //! Charge one message
+    /*!
+    Counts a message handled at time \p now.  Returns false if the slice
+    is used up and the reader should yield.
+    */
+    bool consume(double now);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of messages charged in this slice
+    std::uint32_t get_count() const { return count_; }
+
+    //@}
+
+private:
+    std::uint32_t max_messages_;
+    double max_time_;
+    std::uint32_t count_ = 0;
+    double start_ = 0.0;
+};
+
+} // namespace inputleap
@@ -0,0 +1,44 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/RetryBackoff.h"
+
+#include <algorithm>
+
+namespace inputleap {
+
+RetryBackoff::RetryBackoff(double initial_delay, double max_delay, std::uint32_t seed) :
+    initial_delay_{initial_delay},
+    max_delay_{std::max(initial_delay, max_delay)},
+    ceiling_{initial_delay},
+    random_{seed}
+{
+}
+
+double RetryBackoff::next()
+{
+    std::uniform_real_distribution<double> jitter(0.5 * ceiling_, ceiling_);
+    double delay = jitter(random_);
+    ceiling_ = std::min(2.0 * ceiling_, max_delay_);
+    return delay;
+}
+
+void RetryBackoff::reset()
+{
+    ceiling_ = initial_delay_;
+}
+
+} // namespace inputleap
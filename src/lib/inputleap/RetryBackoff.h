@@ -0,0 +1,72 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+namespace inputleap {
+
+//! Jittered exponential backoff
+/*!
+Spaces out attempts to reconnect.  The ceiling starts at the initial delay
+and doubles with every retry up to the maximum delay;  each delay is drawn
+uniformly from the upper half of the ceiling.  The jitter keeps many
+clients that lost the same server from reconnecting in lockstep when it
+comes back.
+*/
+class RetryBackoff {
+public:
+    /*!
+    \p seed seeds the jitter;  clients should pass something that differs
+    between hosts and runs, such as a value from \c std::random_device.
+    */
+    RetryBackoff(double initial_delay, double max_delay, std::uint32_t seed);
+
+    //! @name manipulators
+    //@{
+
+    //! Get the next delay
+    /*!
+    Returns the number of seconds to wait before the next attempt and
+    raises the ceiling for the one after it.
+    */
+    double next();
+
+    //! Start over
+    /*!
+    Lowers the ceiling back to the initial delay, e.g. after connecting.
+    */
+    void reset();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the current ceiling in seconds
+    double get_ceiling() const { return ceiling_; }
+
+    //@}
+
+private:
+    double initial_delay_;
+    double max_delay_;
+    double ceiling_;
+    std::mt19937 random_;
+};
+
+} // namespace inputleap
@@ -161,6 +161,12 @@ Screen::setClipboard(ClipboardID id, const IClipboard* clipboard)
     m_screen->setClipboard(id, clipboard);
 }
 
+bool Screen::set_clipboard_formats(ClipboardID id,
+                                   const std::vector<IClipboard::EFormat>& formats)
+{
+    return m_screen->set_clipboard_formats(id, formats);
+}
+
 void
 Screen::grabClipboard(ClipboardID id)
 {
@@ -99,6 +99,13 @@ public:
     */
     void setClipboard(ClipboardID, const IClipboard*);
 
+    //! Set clipboard formats
+    /*!
+    Offers the formats of a clipboard whose data is sent when it's pasted.
+    Returns false if the data is needed right away.
+    */
+    bool set_clipboard_formats(ClipboardID, const std::vector<IClipboard::EFormat>& formats);
+
     //! Grab clipboard
     /*!
     Grabs (i.e. take ownership of) the system clipboard.
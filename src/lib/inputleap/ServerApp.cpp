@@ -41,7 +41,11 @@
 #include "common/Version.h"
 #include "common/DataDirectories.h"
 
+#if WINAPI_MSWINDOWS
 #include "platform/MSWindowsScreen.h"
+#elif WINAPI_EVDEV
+#include "platform/EvdevScreen.h"
+#endif
 
 #include <iostream>
 #include <stdio.h>
@@ -110,6 +114,7 @@ ServerApp::help()
            << "Usage: " << args().m_exename
            << " [--address <address>]"
            << " [--config <pathname>]"
+           << " [--io-threads <count>]"
            << HELP_SYS_ARGS
            << HELP_COMMON_ARGS
            << "\n"
@@ -117,6 +122,9 @@ ServerApp::help()
            << "Options:\n"
            << "  -a, --address <address>  listen for clients on the given address.\n"
            << "  -c, --config <pathname>  use the named configuration file instead.\n"
+           << "      --io-threads <count> service client connections on <count>\n"
+           << "                             threads.  defaults to one less than the\n"
+           << "                             number of cores, at most 4.\n"
            << HELP_COMMON_INFO_1
            << "      --disable-client-cert-checking disable client SSL certificate \n"
               "                                     checking (deprecated)\n"
@@ -149,9 +157,16 @@ ServerApp::reloadSignalHandler(Arch::ESignal, void*)
 void ServerApp::reload_config()
 {
     LOG_DEBUG("reload configuration");
-    if (loadConfig(args().m_configFile)) {
-        if (server_) {
-            server_->setConfig(*args().m_config);
+
+    // the server applies what changed compared to the configuration in use
+    Config config;
+    if (read_config(args().m_configFile, config)) {
+        if (!server_) {
+            *args().m_config = config;
+        }
+        else if (!server_->setConfig(config)) {
+            LOG_ERR("cannot use configuration, it doesn't include the primary screen");
+            return;
         }
         LOG_NOTE("reloaded configuration");
     }
@@ -220,6 +235,11 @@ ServerApp::loadConfig()
 }
 
 bool ServerApp::loadConfig(const std::string& pathname)
+{
+    return read_config(pathname, *args().m_config);
+}
+
+bool ServerApp::read_config(const std::string& pathname, Config& config)
 {
     try {
         // load configuration
@@ -233,7 +253,7 @@ bool ServerApp::loadConfig(const std::string& pathname)
                 pathname.c_str());
             return false;
         }
-        configStream >> *args().m_config;
+        configStream >> config;
         LOG_DEBUG("configuration read successfully");
         return true;
     }
@@ -614,7 +634,7 @@ ServerApp::openClientListener(const NetworkAddress& address)
 
     ClientListener* listen = new ClientListener(
         address,
-        std::make_unique<TCPSocketFactory>(m_events, getSocketMultiplexer()),
+        std::make_unique<TCPSocketFactory>(m_events, getSocketMultiplexer(), io_workers_.get()),
         m_events, security_level);
 
     m_events->add_handler(EventType::CLIENT_LISTENER_CONNECTED, listen,
@@ -652,6 +672,15 @@ ServerApp::mainLoop()
     // create socket multiplexer.
     setSocketMultiplexer(std::make_unique<SocketMultiplexer>());
 
+    // client connections get their own threads for reading, writing and
+    // TLS so they don't all queue up behind each other
+    std::size_t io_threads = args().io_threads;
+    if (io_threads == 0) {
+        io_threads = SocketMultiplexerPool::get_default_size();
+    }
+    io_workers_ = std::make_unique<SocketMultiplexerPool>(io_threads);
+    LOG_DEBUG1("servicing clients on %u threads", static_cast<unsigned>(io_threads));
+
     // if configuration has no screens then add this system
     // as the default
     if (args().m_config->begin() == args().m_config->end()) {
@@ -723,6 +752,14 @@ ServerApp::mainLoop()
     return kExitSuccess;
 }
 
+std::vector<LatencyReport> ServerApp::get_latency_reports() const
+{
+    if (!server_) {
+        return {};
+    }
+    return server_->get_latency_reports();
+}
+
 void ServerApp::reset_server()
 {
     LOG_DEBUG1("resetting server");
@@ -810,8 +847,13 @@ ServerApp::startNode()
 
 std::unique_ptr<IPlatformScreen> ServerApp::create_platform_screen()
 {
+#if WINAPI_MSWINDOWS
     return std::make_unique<MSWindowsScreen>(true, args().m_noHooks, args().m_stopOnDeskSwitch,
                                              m_events);
+#elif WINAPI_EVDEV
+    return std::make_unique<EvdevScreen>(args().evdev_devices, args().screen_width,
+                                         args().screen_height, m_events);
+#endif
 }
 
 } // namespace inputleap
@@ -24,6 +24,7 @@
 #include "base/Fwd.h"
 #include "server/Config.h"
 #include "net/NetworkAddress.h"
+#include "net/SocketMultiplexerPool.h"
 #include "arch/Arch.h"
 #include "arch/IArchMultithread.h"
 #include "base/EventTypes.h"
@@ -68,6 +69,7 @@ public:
     void reload_config();
     void loadConfig() override;
     bool loadConfig(const std::string& pathname) override;
+    bool read_config(const std::string& pathname, Config& config);
     void force_reconnect();
     void reset_server();
     void handle_client_connected(const Event& event, ClientListener* listener);
@@ -103,6 +105,9 @@ public:
 
     Server* getServerPtr() { return server_.get(); }
 
+    // services the client connections.  declared first so it goes away
+    // after everything that owns a socket.
+    std::unique_ptr<SocketMultiplexerPool> io_workers_;
     std::unique_ptr<Server> server_;
     EServerState m_serverState;
     std::unique_ptr<Screen> server_screen_;
@@ -111,6 +116,9 @@ public:
     EventQueueTimer* m_timer;
     NetworkAddress* listen_address_;
 
+protected:
+    std::vector<LatencyReport> get_latency_reports() const override;
+
 private:
     std::unique_ptr<IPlatformScreen> create_platform_screen();
     void handle_screen_switched(const Event& event);
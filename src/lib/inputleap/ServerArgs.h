@@ -18,6 +18,7 @@
 #pragma once
 
 #include "inputleap/ArgsBase.h"
+#include <cstddef>
 
 namespace inputleap {
 
@@ -32,6 +33,7 @@ public:
     Config* m_config;
     std::string m_screenChangeScript;
     bool check_client_certificates = true;
+    std::size_t io_threads = 0; // 0 picks a default from the number of cores
 };
 
 } // namespace inputleap
@@ -31,6 +31,15 @@ const char*                kMsgCScreenSaver     = "CSEC%1i";
 const char*                kMsgCResetOptions    = "CROP";
 const char*                kMsgCInfoAck        = "CIAK";
 const char*                kMsgCKeepAlive        = "CALV";
+const char*                kMsgCKeepAliveTimed    = "CALT%4i%4i";
+const char*                kMsgCKeepAliveEcho    = "CALE%4i";
+const char*                kMsgCFeatures        = "CFEA%4i";
+const char*                kMsgCDatagramOffer    = "CUDP%2i%4i%s";
+const char*                kMsgCClock            = "CCLK%4i%4i";
+const char*                kMsgCSession        = "CSES%s";
+const char*                kMsgCSessionAck        = "CACK%4i";
+const char*                kMsgCResume            = "CRSM%1i";
+const char*                kMsgCClipboardMiss    = "CCMS%1i%s";
 const char*                kMsgDKeyDown        = "DKDN%2i%2i%2i";
 const char*                kMsgDKeyDown1_0        = "DKDN%2i%2i";
 const char*                kMsgDKeyRepeat        = "DKRP%2i%2i%2i%2i";
@@ -41,14 +50,22 @@ const char*                kMsgDMouseDown        = "DMDN%1i";
 const char*                kMsgDMouseUp        = "DMUP%1i";
 const char*                kMsgDMouseMove        = "DMMV%2i%2i";
 const char*                kMsgDMouseRelMove    = "DMRM%2i%2i";
+const char*                kMsgDMotionSync        = "DMSY%4i%1i%2i%2i%4i%4i";
+const char*                kMsgDMouseMoveTimed    = "DMMT%2i%2i%4i%4i";
+const char*                kMsgDMouseRelMoveTimed = "DMRT%2i%2i%4i%4i";
 const char*                kMsgDMouseWheel        = "DMWM%2i%2i";
 const char*                kMsgDMouseWheel1_0    = "DMWM%2i";
 const char*                kMsgDClipboard        = "DCLP%1i%4i%1i%s";
+const char*                kMsgDClipboardCached    = "DCCH%1i%4i%s";
+const char*                kMsgDClipboardFormats    = "DCFM%1i%4i%4I";
 const char*                kMsgDInfo            = "DINF%2i%2i%2i%2i%2i%2i%2i";
 const char*                kMsgDSetOptions        = "DSOP%4I";
 const char*                kMsgDFileTransfer    = "DFTR%1i%s";
 const char*                kMsgDDragInfo        = "DDRG%2i%s";
 const char*                kMsgQInfo            = "QINF";
+const char*                kMsgQClock            = "QCLK%4i";
+const char*                kMsgQResume            = "QRSM%s%4i";
+const char*                kMsgQClipboard        = "QCLP%1i%4i";
 const char*                kMsgEIncompatible    = "EICV%2i%2i";
 const char*                kMsgEBusy             = "EBSY";
 const char*                kMsgEUnknown        = "EUNK";
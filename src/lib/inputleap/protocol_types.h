@@ -51,6 +51,12 @@ static const double        kKeepAliveRate = 3.0;
 // number of skipped kMsgCKeepAlive messages that indicates a problem
 static const double        kKeepAlivesUntilDeath = 3.0;
 
+// shortest time between kMsgCKeepAliveTimed (in seconds).  with
+// kProtocolFeatureAdaptiveKeepAlive the primary picks the keep alive rate
+// from the measured round trip time, between this and the keep alive rate
+// option.
+static const double        kKeepAliveMinRate = 0.5;
+
 // obsolete heartbeat stuff
 static const double        kHeartRate = -1.0;
 static const double        kHeartBeatsUntilDeath = 3.0;
@@ -80,6 +86,48 @@ enum EDirectionMask {
     kBottomMask = 1 << kBottom
 };
 
+// protocol features negotiated on top of the protocol version.  the
+// primary offers them with kOptionProtocolFeatures and the secondary
+// replies with kMsgCFeatures.  a feature is only used once both sides
+// agreed on it.
+enum EProtocolFeature : std::uint32_t {
+    kProtocolFeatureMotionDatagrams   = 1 << 0,
+    kProtocolFeatureTimestamps        = 1 << 1,
+    kProtocolFeatureAdaptiveKeepAlive = 1 << 2,
+    kProtocolFeatureSessionResume     = 1 << 3,
+    kProtocolFeatureClipboardCache    = 1 << 4,
+    kProtocolFeatureLazyClipboard     = 1 << 5
+};
+
+// protocol features supported by this build
+static const std::uint32_t kProtocolFeaturesSupported = kProtocolFeatureMotionDatagrams |
+                                                        kProtocolFeatureTimestamps |
+                                                        kProtocolFeatureAdaptiveKeepAlive |
+                                                        kProtocolFeatureSessionResume |
+                                                        kProtocolFeatureClipboardCache |
+                                                        kProtocolFeatureLazyClipboard;
+
+// clipboards smaller than this (in bytes) are sent in full on entering a
+// screen even once kProtocolFeatureLazyClipboard was agreed on
+static const std::uint32_t kLazyClipboardMinSize = 64 * 1024;
+
+// time the primary keeps the session of a secondary whose connection was
+// lost, and the time the secondary tries to resume it (in seconds).  while
+// the session is kept the secondary stays connected as far as the primary
+// is concerned.
+static const double        kSessionGracePeriod = 5.0;
+
+// number of messages after which the secondary acknowledges the messages
+// of a session even if no keep alive arrived
+static const std::uint32_t kSessionAckInterval = 256;
+
+// time between motion datagram acks from the secondary (in seconds)
+static const double        kMotionDatagramAckRate = 1.0;
+
+// number of missed motion datagram acks after which the primary falls
+// back to sending motion over the stream
+static const double        kMotionDatagramAcksUntilDown = 3.0;
+
 // Data transfer constants
 enum EDataTransfer {
     kDataStart = 1,
@@ -182,6 +230,64 @@ extern const char*        kMsgCInfoAck;
 // defined by an option.
 extern const char*        kMsgCKeepAlive;
 
+// keep connection alive with round trip timing:  primary -> secondary
+// sent instead of kMsgCKeepAlive once kProtocolFeatureAdaptiveKeepAlive
+// was agreed on.  $1 = the primary's timestamp, $2 = time in milliseconds
+// after which the secondary should give up on the primary if it doesn't
+// receive any message.  the secondary replies with kMsgCKeepAliveEcho
+// instead of kMsgCKeepAlive.
+extern const char*        kMsgCKeepAliveTimed;
+
+// keep alive reply:  secondary -> primary
+// $1 = $1 of the kMsgCKeepAliveTimed being answered.  the primary derives
+// the round trip time from it.
+extern const char*        kMsgCKeepAliveEcho;
+
+// protocol features:  secondary -> primary
+// sent in reply to a kOptionProtocolFeatures option.  $1 = the offered
+// kProtocolFeature flags that the secondary supports.
+extern const char*        kMsgCFeatures;
+
+// motion datagram offer:  primary -> secondary
+// sent once kProtocolFeatureMotionDatagrams was agreed on.  $1 = UDP port
+// of the primary, $2 = session id, $3 = session key.  the secondary sends
+// authenticated acks to that port every kMotionDatagramAckRate seconds.
+// while the primary receives them it may send mouse motion as datagrams
+// (see MotionDatagram.h) instead of kMsgDMouseMove and kMsgDMouseRelMove.
+extern const char*        kMsgCDatagramOffer;
+
+// clock:  primary -> secondary
+// sent in reply to a kMsgQClock.  $1 = the secondary's timestamp from the
+// query, $2 = the primary's timestamp when answering.  timestamps are in
+// microseconds modulo 2^32 (see LatencyStats.h).
+extern const char*        kMsgCClock;
+
+// session token:  primary -> secondary
+// sent once kProtocolFeatureSessionResume was agreed on.  $1 = token that
+// lets the secondary resume the session over a new connection with
+// kMsgQResume.  the messages after this one are counted by both sides.
+extern const char*        kMsgCSession;
+
+// session acknowledgment:  secondary -> primary
+// $1 = number of messages received since kMsgCSession.  sent with every
+// keep alive reply and after every kSessionAckInterval messages.  the
+// primary only keeps unacknowledged messages for resuming the session.
+extern const char*        kMsgCSessionAck;
+
+// session resumed:  primary -> secondary
+// sent in reply to a kMsgQResume.  $1 = 1 if the session was resumed, in
+// which case the primary continues with the messages the secondary
+// missed.  if $1 = 0 the primary closes the connection and the secondary
+// has to connect from scratch.
+extern const char*        kMsgCResume;
+
+// cached clipboard miss:  secondary -> primary
+// sent in reply to a kMsgDClipboardCached when the secondary doesn't hold
+// the content anymore.  $1 = clipboard identifier, $2 = the hash from the
+// kMsgDClipboardCached.  the primary then sends the data with
+// kMsgDClipboard.
+extern const char*        kMsgCClipboardMiss;
+
 //
 // data codes
 //
@@ -232,6 +338,28 @@ extern const char*        kMsgDMouseMove;
 // $1 = dx, $2 = dy.  dx,dy are motion deltas.
 extern const char*        kMsgDMouseRelMove;
 
+// motion sync:  primary -> secondary
+// the latest motion sent as a datagram, repeated on the stream before any
+// other message that depends on the cursor position.  $1 = datagram
+// sequence number, $2 = datagram flags, $3 = x, $4 = y, $5 = running total
+// of relative x motion, $6 = running total of relative y motion.  the
+// secondary applies it unless it already received that datagram.  it is
+// also sent ahead of the first datagram after other input;  datagrams are
+// only applied once the syncs sent before them arrived.
+extern const char*        kMsgDMotionSync;
+
+// timestamped mouse move:  primary -> secondary
+// sent instead of kMsgDMouseMove once kProtocolFeatureTimestamps was
+// agreed on and the primary knows when the motion was captured.  $1 = x,
+// $2 = y, $3 = primary's timestamp of the capture, $4 = primary's
+// timestamp of sending the message.
+extern const char*        kMsgDMouseMoveTimed;
+
+// timestamped relative mouse move:  primary -> secondary
+// like kMsgDMouseMoveTimed but sent instead of kMsgDMouseRelMove.
+// $1 = dx, $2 = dy, $3 = capture timestamp, $4 = send timestamp.
+extern const char*        kMsgDMouseRelMoveTimed;
+
 // mouse scroll:  primary -> secondary
 // $1 = xDelta, $2 = yDelta.  the delta should be +120 for one tick forward
 // (away from the user) or right and -120 for one tick backward (toward
@@ -249,6 +377,25 @@ extern const char*        kMsgDMouseWheel1_0;
 // identifier.
 extern const char*        kMsgDClipboard;
 
+// cached clipboard data:  primary -> secondary
+// sent instead of kMsgDClipboard once kProtocolFeatureClipboardCache was
+// agreed on and the primary knows the secondary has seen the content
+// before.  $1 = clipboard identifier, $2 = sequence number as in
+// kMsgDClipboard, $3 = SHA-256 of the clipboard data.  the secondary sets
+// its clipboard from its cache (see ClipboardCache.h) or replies with
+// kMsgCClipboardMiss.
+extern const char*        kMsgDClipboardCached;
+
+// clipboard formats:  primary -> secondary
+// sent instead of kMsgDClipboard for large clipboards once
+// kProtocolFeatureLazyClipboard was agreed on.  $1 = clipboard identifier,
+// $2 = sequence number as in kMsgDClipboard, $3 = pairs of format and
+// size of the data in that format (see IClipboard::describe()).  the
+// secondary offers the formats on its clipboard and asks for the data
+// with kMsgQClipboard when it's pasted.  there is no such message the
+// other way, clipboards of the secondary are sent eagerly.
+extern const char*        kMsgDClipboardFormats;
+
 // client data:  secondary -> primary
 // $1 = coordinate of leftmost pixel on secondary screen,
 // $2 = coordinate of topmost pixel on secondary screen,
@@ -291,6 +438,27 @@ extern const char*        kMsgDDragInfo;
 // client should reply with a kMsgDInfo.
 extern const char*        kMsgQInfo;
 
+// query clock:  secondary -> primary
+// sent with every kMsgCKeepAlive reply once kProtocolFeatureTimestamps was
+// agreed on.  $1 = the secondary's timestamp.  the primary replies with
+// kMsgCClock, which lets the secondary estimate the offset between the
+// clocks to convert the timestamps of kMsgDMouseMoveTimed.
+extern const char*        kMsgQClock;
+
+// resume session:  secondary -> primary
+// sent instead of kMsgDInfo in reply to the kMsgQInfo of a new connection
+// if the secondary has a session to resume.  $1 = token from kMsgCSession,
+// $2 = number of messages received in the session.  the primary replies
+// with kMsgCResume.
+extern const char*        kMsgQResume;
+
+// query clipboard:  secondary -> primary
+// asks for the data of a clipboard announced with kMsgDClipboardFormats.
+// $1 = clipboard identifier, $2 = sequence number from the
+// kMsgDClipboardFormats.  the primary replies with kMsgDClipboard unless
+// the clipboard changed in the meantime.
+extern const char*        kMsgQClipboard;
+
 
 //
 // error codes
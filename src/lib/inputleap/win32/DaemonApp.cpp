@@ -335,6 +335,11 @@ void DaemonApp::handle_ipc_message(const Event& e)
             break;
         }
 
+        case kIpcLatency:
+            // pass on to the gui, the daemon has no use for it
+            m_ipcServer->send(m, kIpcClientGui);
+            break;
+
         case kIpcHello:
             const auto& hm = static_cast<const IpcHelloMessage&>(m);
             std::string type;
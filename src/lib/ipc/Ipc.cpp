@@ -22,3 +22,5 @@ const char*                kIpcMsgHello        = "IHEL%1i";
 const char*                kIpcMsgLogLine        = "ILOG%s";
 const char*                kIpcMsgCommand        = "ICMD%s%1i";
 const char*                kIpcMsgShutdown        = "ISDN";
+const char*                kIpcMsgLatency        = "ILAT%s%s%4i%4i%4i%4i";
+const char*                kIpcMsgLogBatch        = "ILGB%4i";
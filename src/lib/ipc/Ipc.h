@@ -26,6 +26,8 @@ enum EIpcMessage {
     kIpcLogLine,
     kIpcCommand,
     kIpcShutdown,
+    kIpcLatency,
+    kIpcLogBatch,
 };
 
 enum EIpcClientType {
@@ -50,3 +52,15 @@ extern const char*        kIpcMsgCommand;
 // shutdown: daemon -> node
 // the daemon tells input-leaps/c to shut down gracefully.
 extern const char*        kIpcMsgShutdown;
+
+// input latency: node -> daemon -> gui
+// sent periodically by input-leaps/c for each screen and latency stage.
+// $1 = screen name, $2 = stage name, $3 = number of samples, $4, $5, $6 =
+// 50th, 99th and 99.9th percentile in microseconds.
+extern const char*        kIpcMsgLatency;
+
+// log batch: daemon -> gui
+// $1 = size of the log records that follow.  each record is a 4 byte
+// sequence number and a 4 byte length followed by that many bytes of log
+// line.  sequence numbers are consecutive, a jump means lines were dropped.
+extern const char*        kIpcMsgLogBatch;
@@ -90,6 +90,9 @@ void IpcClientProxy::handle_data()
         else if (memcmp(code, kIpcMsgCommand, 4) == 0) {
             event_data = create_event_data<IpcCommandMessage>(parseCommand());
         }
+        else if (memcmp(code, kIpcMsgLatency, 4) == 0) {
+            event_data = create_event_data<IpcLatencyMessage>(parseLatency());
+        }
         else {
             LOG_ERR("invalid ipc message");
             disconnect();
@@ -121,10 +124,31 @@ IpcClientProxy::send(const IpcMessage& message)
         break;
     }
 
+    case kIpcLogBatch: {
+        // the records are already in their wire format
+        const IpcLogBatchMessage& lbm = static_cast<const IpcLogBatchMessage&>(message);
+        ProtocolUtil::writef(stream_.get(), kIpcMsgLogBatch, lbm.size());
+        for (int i = 0; i < 2; ++i) {
+            if (lbm.span(i).size != 0) {
+                stream_->write(lbm.span(i).data, static_cast<std::uint32_t>(lbm.span(i).size));
+            }
+        }
+        break;
+    }
+
     case kIpcShutdown:
         ProtocolUtil::writef(stream_.get(), kIpcMsgShutdown);
         break;
 
+    case kIpcLatency: {
+        const IpcLatencyMessage& lm = static_cast<const IpcLatencyMessage&>(message);
+        std::string screen = lm.screen();
+        std::string stage = lm.stage();
+        ProtocolUtil::writef(stream_.get(), kIpcMsgLatency, &screen, &stage, lm.count(),
+                             lm.p50(), lm.p99(), lm.p999());
+        break;
+    }
+
     default:
         LOG_ERR("ipc message not supported: %d", message.type());
         break;
@@ -152,6 +176,17 @@ IpcCommandMessage IpcClientProxy::parseCommand()
     return IpcCommandMessage(command, elevate != 0);
 }
 
+IpcLatencyMessage IpcClientProxy::parseLatency()
+{
+    std::string screen, stage;
+    std::uint32_t count, p50, p99, p999;
+    ProtocolUtil::readf(stream_.get(), kIpcMsgLatency + 4, &screen, &stage, &count, &p50, &p99,
+                        &p999);
+
+    // must be deleted by event handler.
+    return IpcLatencyMessage(screen, stage, count, p50, p99, p999);
+}
+
 void
 IpcClientProxy::disconnect()
 {
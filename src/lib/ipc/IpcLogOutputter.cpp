@@ -29,27 +29,31 @@
 #include "base/EventQueue.h"
 #include "base/Time.h"
 
+#include <cstring>
+
 namespace inputleap {
 
 enum EIpcLogOutputter {
-    kBufferMaxSize = 1000,
-    kMaxSendLines = 100,
-    kBufferRateWriteLimit = 1000, // writes per kBufferRateTime
+    kBufferMaxSize = 256 * 1024,
+    kMaxSendSize = 64 * 1024,
+    kBufferRateByteLimit = 256 * 1024, // bytes per kBufferRateTime
     kBufferRateTimeLimit = 1 // seconds
 };
 
 IpcLogOutputter::IpcLogOutputter(IpcServer& ipcServer, EIpcClientType clientType, bool useThread) :
     m_ipcServer(ipcServer),
+    m_buffer(kBufferMaxSize),
     m_sending(false),
     m_bufferThread(nullptr),
     m_running(false),
     m_bufferWaiting(false),
     m_bufferThreadId(0),
-    m_bufferMaxSize(kBufferMaxSize),
-    m_bufferRateWriteLimit(kBufferRateWriteLimit),
+    m_bufferRateByteLimit(kBufferRateByteLimit),
     m_bufferRateTimeLimit(kBufferRateTimeLimit),
-    m_bufferWriteCount(0),
+    m_bufferRateBytes(0),
     m_bufferRateStart(inputleap::current_time_seconds()),
+    m_nextSequence(0),
+    m_droppedLines(0),
     m_clientType(clientType)
 {
     if (useThread) {
@@ -106,30 +110,38 @@ IpcLogOutputter::write(ELevel, const char* text)
     return true;
 }
 
-void IpcLogOutputter::appendBuffer(const std::string& text)
+void IpcLogOutputter::appendBuffer(const char* text)
 {
+    std::size_t size = std::strlen(text);
+
     std::lock_guard<std::mutex> lock(m_bufferMutex);
 
-    double elapsed = inputleap::current_time_seconds() - m_bufferRateStart;
-    if (elapsed < m_bufferRateTimeLimit) {
-        if (m_bufferWriteCount >= m_bufferRateWriteLimit) {
-            // discard the log line if we've logged too much.
-            return;
-        }
+    // number dropped lines too so the gap shows
+    std::uint32_t sequence = m_nextSequence++;
+
+    double now = inputleap::current_time_seconds();
+    if (now - m_bufferRateStart >= m_bufferRateTimeLimit) {
+        m_bufferRateBytes = 0;
+        m_bufferRateStart = now;
     }
-    else {
-        m_bufferWriteCount = 0;
-        m_bufferRateStart = inputleap::current_time_seconds();
+    if (m_bufferRateBytes > m_bufferRateByteLimit ||
+            size > m_bufferRateByteLimit - m_bufferRateBytes) {
+        // discard the log line if we've logged too much.
+        ++m_droppedLines;
+        return;
     }
+    m_bufferRateBytes += static_cast<std::uint32_t>(size);
 
-    if (m_buffer.size() >= m_bufferMaxSize) {
-        // if the queue is exceeds size limit,
-        // throw away the oldest item
-        m_buffer.pop_front();
+    // throws away the oldest lines if the buffer is full
+    if (!m_buffer.push(sequence, text, size)) {
+        ++m_droppedLines;
     }
+}
 
-    m_buffer.push_back(text);
-    m_bufferWriteCount++;
+bool IpcLogOutputter::hasPending() const
+{
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    return m_buffer.has_pending();
 }
 
 bool
@@ -146,7 +158,7 @@ void IpcLogOutputter::buffer_thread()
 
     try {
         while (isRunning()) {
-            if (m_buffer.empty() || !m_ipcServer.hasClients(m_clientType)) {
+            if (!hasPending() || !m_ipcServer.hasClients(m_clientType)) {
                 std::unique_lock<std::mutex> lock(notify_mutex_);
                 ARCH->wait_cond_var(notify_cv_, lock, -1);
             }
@@ -168,50 +180,63 @@ IpcLogOutputter::notifyBuffer()
     notify_cv_.notify_all();
 }
 
-std::string IpcLogOutputter::getChunk(size_t count)
-{
-    std::lock_guard<std::mutex> lock(m_bufferMutex);
-
-    if (m_buffer.size() < count) {
-        count = m_buffer.size();
-    }
-
-    std::string chunk;
-    for (size_t i = 0; i < count; i++) {
-        chunk.append(m_buffer.front());
-        chunk.append("\n");
-        m_buffer.pop_front();
-    }
-    return chunk;
-}
-
 void
 IpcLogOutputter::sendBuffer()
 {
-    if (m_buffer.empty() || !m_ipcServer.hasClients(m_clientType)) {
+    if (!hasPending() || !m_ipcServer.hasClients(m_clientType)) {
         return;
     }
 
-    IpcLogLineMessage message(getChunk(kMaxSendLines));
+    // the lines are sent straight from the buffer.  they're kept there
+    // until they've been sent, so new lines can be logged meanwhile.
+    IpcLogRing::Span spans[2];
+    {
+        std::lock_guard<std::mutex> lock(m_bufferMutex);
+        if (m_buffer.acquire(kMaxSendSize, spans) == 0) {
+            return;
+        }
+    }
+
+    IpcLogBatchMessage message(spans);
     m_sending = true;
-    m_ipcServer.send(message, kIpcClientGui);
+    try {
+        m_ipcServer.send(message, kIpcClientGui);
+    }
+    catch (...) {
+        m_sending = false;
+        std::lock_guard<std::mutex> lock(m_bufferMutex);
+        m_buffer.release();
+        throw;
+    }
     m_sending = false;
+
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    m_buffer.release();
 }
 
-void IpcLogOutputter::bufferMaxSize(std::uint16_t bufferMaxSize)
+void IpcLogOutputter::bufferMaxSize(std::size_t bufferMaxSize)
 {
-    m_bufferMaxSize = bufferMaxSize;
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    m_buffer.reset(bufferMaxSize);
 }
 
-std::uint16_t IpcLogOutputter::bufferMaxSize() const
+std::size_t IpcLogOutputter::bufferMaxSize() const
 {
-    return m_bufferMaxSize;
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    return m_buffer.capacity();
 }
 
-void IpcLogOutputter::bufferRateLimit(std::uint16_t writeLimit, double timeLimit)
+void IpcLogOutputter::bufferRateLimit(std::uint32_t byteLimit, double timeLimit)
 {
-    m_bufferRateWriteLimit = writeLimit;
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    m_bufferRateByteLimit = byteLimit;
     m_bufferRateTimeLimit = timeLimit;
 }
 
+std::uint64_t IpcLogOutputter::droppedLines() const
+{
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    return m_droppedLines + m_buffer.evicted();
+}
+
 } // namespace inputleap
@@ -22,8 +22,8 @@
 #include "arch/IArchMultithread.h"
 #include "base/ILogOutputter.h"
 #include "ipc/Ipc.h"
+#include "ipc/IpcLogRing.h"
 
-#include <deque>
 #include <condition_variable>
 #include <mutex>
 
@@ -35,7 +35,10 @@ class IpcClientProxy;
 
 //! Write log to GUI over IPC
 /*!
-This outputter writes output to the GUI via IPC.
+This outputter writes output to the GUI via IPC.  Log lines are numbered
+and written into a fixed size ring, which is sent to the GUI in batches.
+Lines dropped because the ring was full or because of the rate limit
+leave a gap in the numbers.
 */
 class IpcLogOutputter : public ILogOutputter {
 public:
@@ -61,16 +64,19 @@ public:
 
     //! Set the buffer size
     /*!
-    Set the maximum size of the buffer to protect memory
-    from runaway logging.
+    Set the size of the buffer in bytes to protect memory from runaway
+    logging.  Each line takes 8 bytes more than its text.  This throws
+    away the buffered lines and must not be called while the buffer is
+    being sent.
     */
-    void bufferMaxSize(std::uint16_t bufferMaxSize);
+    void bufferMaxSize(std::size_t bufferMaxSize);
 
     //! Set the rate limit
     /*!
-    Set the maximum number of \p writeRate for every \p timeRate in seconds.
+    Set the maximum number of bytes of log lines, \p byteLimit, to
+    buffer for every \p timeLimit in seconds.
     */
-    void bufferRateLimit(std::uint16_t writeLimit, double timeLimit);
+    void bufferRateLimit(std::uint32_t byteLimit, double timeLimit);
 
     //! Send the buffer
     /*!
@@ -86,25 +92,30 @@ public:
 
     //! Get the buffer size
     /*!
-    Returns the maximum size of the buffer.
+    Returns the size of the buffer in bytes.
     */
-    std::uint16_t bufferMaxSize() const;
+    std::size_t bufferMaxSize() const;
+
+    //! Get the number of dropped lines
+    /*!
+    Returns the number of lines that were dropped because the buffer was
+    full or because of the rate limit.
+    */
+    std::uint64_t droppedLines() const;
 
     //@}
 
 private:
     void init();
     void buffer_thread();
-    std::string getChunk(size_t count);
-    void appendBuffer(const std::string& text);
+    void appendBuffer(const char* text);
+    bool hasPending() const;
     bool isRunning();
 
 private:
-    typedef std::deque<std::string> Buffer;
-
     IpcServer& m_ipcServer;
-    Buffer m_buffer;
-    std::mutex m_bufferMutex;
+    IpcLogRing m_buffer;
+    mutable std::mutex m_bufferMutex;
     bool m_sending;
     Thread* m_bufferThread;
     bool m_running;
@@ -113,11 +124,12 @@ private:
     bool m_bufferWaiting;
     IArchMultithread::ThreadID
  m_bufferThreadId;
-    std::uint16_t m_bufferMaxSize;
-    std::uint16_t m_bufferRateWriteLimit;
+    std::uint32_t m_bufferRateByteLimit;
     double m_bufferRateTimeLimit;
-    std::uint16_t m_bufferWriteCount;
+    std::uint32_t m_bufferRateBytes;
     double m_bufferRateStart;
+    std::uint32_t m_nextSequence;
+    std::uint64_t m_droppedLines;
     EIpcClientType m_clientType;
     std::mutex m_runningMutex;
 };
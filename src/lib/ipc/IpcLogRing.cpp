@@ -0,0 +1,140 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ipc/IpcLogRing.h"
+
+#include <cstring>
+
+namespace inputleap {
+
+IpcLogRing::IpcLogRing(std::size_t capacity) :
+    ring_(capacity)
+{
+}
+
+void IpcLogRing::reset(std::size_t capacity)
+{
+    ring_.assign(capacity, 0);
+    start_ = 0;
+    size_ = 0;
+    acquired_ = 0;
+    evicted_ = 0;
+}
+
+bool IpcLogRing::push(std::uint32_t sequence, const char* text, std::size_t size)
+{
+    std::size_t total = kRecordHeaderSize + size;
+    if (total > ring_.size() || size > 0xffffffffu) {
+        return false;
+    }
+
+    // make room by throwing away the oldest records that aren't being sent
+    if (ring_.size() - size_ < total) {
+        if (acquired_ != 0) {
+            return false;
+        }
+        while (ring_.size() - size_ < total) {
+            std::size_t oldest = record_size(start_);
+            start_ = (start_ + oldest) % ring_.size();
+            size_ -= oldest;
+            ++evicted_;
+        }
+    }
+
+    std::uint32_t length = static_cast<std::uint32_t>(size);
+    unsigned char header[kRecordHeaderSize] = {
+        static_cast<unsigned char>(sequence >> 24), static_cast<unsigned char>(sequence >> 16),
+        static_cast<unsigned char>(sequence >> 8), static_cast<unsigned char>(sequence),
+        static_cast<unsigned char>(length >> 24), static_cast<unsigned char>(length >> 16),
+        static_cast<unsigned char>(length >> 8), static_cast<unsigned char>(length)
+    };
+    write(header, sizeof(header));
+    write(text, size);
+    return true;
+}
+
+std::size_t IpcLogRing::acquire(std::size_t max_size, Span spans[2])
+{
+    spans[0] = Span();
+    spans[1] = Span();
+
+    // take whole records, even if the first one is too big
+    std::size_t total = acquired_;
+    while (total < size_) {
+        std::size_t next = record_size((start_ + total) % ring_.size());
+        if (total > acquired_ && total + next - acquired_ > max_size) {
+            break;
+        }
+        total += next;
+    }
+    std::size_t size = total - acquired_;
+    if (size == 0) {
+        return 0;
+    }
+    std::size_t first = (start_ + acquired_) % ring_.size();
+    acquired_ = total;
+
+    std::size_t contiguous = ring_.size() - first;
+    spans[0].data = ring_.data() + first;
+    spans[0].size = size < contiguous ? size : contiguous;
+    if (size > contiguous) {
+        spans[1].data = ring_.data();
+        spans[1].size = size - contiguous;
+    }
+    return size;
+}
+
+void IpcLogRing::release()
+{
+    if (ring_.empty()) {
+        return;
+    }
+    start_ = (start_ + acquired_) % ring_.size();
+    size_ -= acquired_;
+    acquired_ = 0;
+}
+
+std::uint32_t IpcLogRing::read32(std::size_t offset) const
+{
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        value = (value << 8) |
+                static_cast<unsigned char>(ring_[(offset + i) % ring_.size()]);
+    }
+    return value;
+}
+
+void IpcLogRing::write(const void* data, std::size_t size)
+{
+    std::size_t end = (start_ + size_) % ring_.size();
+    std::size_t contiguous = ring_.size() - end;
+    const char* bytes = static_cast<const char*>(data);
+    if (size <= contiguous) {
+        std::memcpy(ring_.data() + end, bytes, size);
+    }
+    else {
+        std::memcpy(ring_.data() + end, bytes, contiguous);
+        std::memcpy(ring_.data(), bytes + contiguous, size - contiguous);
+    }
+    size_ += size;
+}
+
+std::size_t IpcLogRing::record_size(std::size_t offset) const
+{
+    return kRecordHeaderSize + read32(offset + 4);
+}
+
+} // namespace inputleap
@@ -0,0 +1,111 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace inputleap {
+
+//! Fixed size buffer of log records
+/*!
+Log records are written once into a ring of bytes in the form they are
+sent to IPC clients in: a 4 byte sequence number and a 4 byte length,
+both big endian, followed by the text.  The oldest records are thrown
+away to make room for new ones.  Records are sent straight from the ring
+and are not thrown away while they're being sent.
+
+The ring is not thread safe.
+*/
+class IpcLogRing {
+public:
+    //! Contiguous part of the ring
+    struct Span {
+        const char* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    //! Size of the header of each record
+    static const std::size_t kRecordHeaderSize = 8;
+
+    explicit IpcLogRing(std::size_t capacity);
+
+    //! @name manipulators
+    //@{
+
+    //! Change the capacity
+    /*!
+    Throws away all records, which must not be acquired.
+    */
+    void reset(std::size_t capacity);
+
+    //! Add a record
+    /*!
+    Appends a record of \p size bytes of \p text with \p sequence number,
+    throwing away the oldest records if needed.  Returns false if the
+    record was dropped instead, either because it's larger than the ring
+    or because the records that would have to be thrown away are
+    acquired.
+    */
+    bool push(std::uint32_t sequence, const char* text, std::size_t size);
+
+    //! Acquire the oldest records
+    /*!
+    Gets the oldest records, up to \p max_size bytes of them but at least
+    one, in at most two spans.  Returns the total size of the spans.  The
+    records stay in the ring until \c release() is called.
+    */
+    std::size_t acquire(std::size_t max_size, Span spans[2]);
+
+    //! Throw away the acquired records
+    void release();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Test if there are records that aren't acquired
+    bool has_pending() const { return size_ > acquired_; }
+
+    //! Get the number of bytes of records in the ring
+    std::size_t size() const { return size_; }
+
+    //! Get the capacity in bytes
+    std::size_t capacity() const { return ring_.size(); }
+
+    //! Get the number of records thrown away to make room
+    std::uint64_t evicted() const { return evicted_; }
+
+    //@}
+
+private:
+    std::uint32_t read32(std::size_t offset) const;
+    void write(const void* data, std::size_t size);
+    std::size_t record_size(std::size_t offset) const;
+
+private:
+    std::vector<char> ring_;
+    // offset of the oldest record
+    std::size_t start_ = 0;
+    std::size_t size_ = 0;
+    // bytes at start_ given out by acquire()
+    std::size_t acquired_ = 0;
+    std::uint64_t evicted_ = 0;
+};
+
+} // namespace inputleap
@@ -59,6 +59,22 @@ IpcLogLineMessage::~IpcLogLineMessage()
 {
 }
 
+IpcLogBatchMessage::IpcLogBatchMessage(const IpcLogRing::Span spans[2]) :
+    IpcMessage(kIpcLogBatch)
+{
+    m_spans[0] = spans[0];
+    m_spans[1] = spans[1];
+}
+
+IpcLogBatchMessage::~IpcLogBatchMessage()
+{
+}
+
+std::uint32_t IpcLogBatchMessage::size() const
+{
+    return static_cast<std::uint32_t>(m_spans[0].size + m_spans[1].size);
+}
+
 IpcCommandMessage::IpcCommandMessage(const std::string& command, bool elevate) :
     IpcMessage(kIpcCommand),
     m_command(command),
@@ -70,4 +86,21 @@ IpcCommandMessage::~IpcCommandMessage()
 {
 }
 
+IpcLatencyMessage::IpcLatencyMessage(const std::string& screen, const std::string& stage,
+                                     std::uint32_t count, std::uint32_t p50, std::uint32_t p99,
+                                     std::uint32_t p999) :
+    IpcMessage(kIpcLatency),
+    m_screen(screen),
+    m_stage(stage),
+    m_count(count),
+    m_p50(p50),
+    m_p99(p99),
+    m_p999(p999)
+{
+}
+
+IpcLatencyMessage::~IpcLatencyMessage()
+{
+}
+
 } // namespace inputleap
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "ipc/Ipc.h"
+#include "ipc/IpcLogRing.h"
 #include "base/EventTypes.h"
 #include "base/Event.h"
 #include <string>
@@ -70,6 +71,22 @@ private:
     std::string m_logLine;
 };
 
+class IpcLogBatchMessage : public IpcMessage {
+public:
+    //! Refers to the records in \p spans, which must outlive the message.
+    IpcLogBatchMessage(const IpcLogRing::Span spans[2]);
+    virtual ~IpcLogBatchMessage();
+
+    //! Gets the parts of the log records.
+    const IpcLogRing::Span& span(int index) const { return m_spans[index]; }
+
+    //! Gets the total size of the log records.
+    std::uint32_t size() const;
+
+private:
+    IpcLogRing::Span m_spans[2];
+};
+
 class IpcCommandMessage : public IpcMessage {
 public:
     IpcCommandMessage(const std::string& command, bool elevate);
@@ -86,4 +103,33 @@ private:
     bool m_elevate;
 };
 
+class IpcLatencyMessage : public IpcMessage {
+public:
+    IpcLatencyMessage(const std::string& screen, const std::string& stage, std::uint32_t count,
+                      std::uint32_t p50, std::uint32_t p99, std::uint32_t p999);
+    virtual ~IpcLatencyMessage();
+
+    //! Gets the name of the screen the latency was measured for.
+    std::string screen() const { return m_screen; }
+
+    //! Gets the name of the latency stage.
+    std::string stage() const { return m_stage; }
+
+    //! Gets the number of samples.
+    std::uint32_t count() const { return m_count; }
+
+    //! Gets the percentiles in microseconds.
+    std::uint32_t p50() const { return m_p50; }
+    std::uint32_t p99() const { return m_p99; }
+    std::uint32_t p999() const { return m_p999; }
+
+private:
+    std::string m_screen;
+    std::string m_stage;
+    std::uint32_t m_count;
+    std::uint32_t m_p50;
+    std::uint32_t m_p99;
+    std::uint32_t m_p999;
+};
+
 } // namespace inputleap
@@ -89,6 +89,15 @@ IpcServerProxy::send(const IpcMessage& message)
         break;
     }
 
+    case kIpcLatency: {
+        const IpcLatencyMessage& lm = static_cast<const IpcLatencyMessage&>(message);
+        std::string screen = lm.screen();
+        std::string stage = lm.stage();
+        ProtocolUtil::writef(&m_stream, kIpcMsgLatency, &screen, &stage, lm.count(), lm.p50(),
+                             lm.p99(), lm.p999());
+        break;
+    }
+
     default:
         LOG_ERR("ipc message not supported: %d", message.type());
         break;
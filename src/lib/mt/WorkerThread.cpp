@@ -0,0 +1,80 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mt/WorkerThread.h"
+#include "base/Log.h"
+#include <exception>
+
+namespace inputleap {
+
+WorkerThread::WorkerThread() :
+    thread_([this]() { run(); })
+{
+}
+
+WorkerThread::~WorkerThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void WorkerThread::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+std::size_t WorkerThread::get_pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size() + (running_job_ ? 1 : 0);
+}
+
+void WorkerThread::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        std::function<void()> job = std::move(jobs_.front());
+        jobs_.pop_front();
+        running_job_ = true;
+        lock.unlock();
+
+        try {
+            job();
+        }
+        catch (const std::exception& e) {
+            LOG_WARN("worker job failed: %s", e.what());
+        }
+
+        lock.lock();
+        running_job_ = false;
+    }
+}
+
+} // namespace inputleap
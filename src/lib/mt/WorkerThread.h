@@ -0,0 +1,74 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace inputleap {
+
+//! Thread running jobs one after the other
+/*!
+Runs the jobs passed to post() in order on one thread that is kept for
+the lifetime of the object, instead of starting a thread for each job.
+Destroying the worker waits for the running job and drops the jobs that
+haven't started.
+*/
+class WorkerThread {
+public:
+    WorkerThread();
+    ~WorkerThread();
+
+    WorkerThread(const WorkerThread&) = delete;
+    WorkerThread& operator=(const WorkerThread&) = delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Run a job
+    /*!
+    Queues \p job to run on the worker thread after the jobs posted before
+    it.  Exceptions thrown by \p job are logged and otherwise ignored.
+    */
+    void post(std::function<void()> job);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of jobs that haven't finished
+    std::size_t get_pending() const;
+
+    //@}
+
+private:
+    void run();
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_;
+    bool running_job_ = false;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace inputleap
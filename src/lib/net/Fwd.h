@@ -43,6 +43,9 @@ class ISocketMultiplexerJob;
 // NetworkAddress.h
 class NetworkAddress;
 
+// PacketFramer.h
+class PacketFramer;
+
 // SecureListenSocket.h
 class SecureListenSocket;
 
@@ -52,10 +55,16 @@ class SecureSocket;
 // SocketMultiplexer.h
 class SocketMultiplexer;
 
+// SocketMultiplexerPool.h
+class SocketMultiplexerPool;
+
 // TCPSocket.h
 class TCPSocket;
 
 // TCPSocketFactory.h
 class TCPSocketFactory;
 
+// UDPSocket.h
+class UDPSocket;
+
 } // namespace inputleap
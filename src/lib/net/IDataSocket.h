@@ -52,6 +52,16 @@ public:
     */
     virtual void connect(const NetworkAddress&) = 0;
 
+    //! Frame input into packets
+    /*!
+    Makes the socket follow the length prefix of PacketStreamFilter
+    packets as data arrives on its multiplexer thread.  The socket then
+    sends an input ready event only once a whole packet is buffered, and
+    an input format error event if a packet announces more than
+    \p max_packet_size bytes.
+    */
+    virtual void set_packet_framing(std::uint32_t max_packet_size) = 0;
+
     //@}
 
     // ISocket overrides
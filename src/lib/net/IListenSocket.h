@@ -20,6 +20,7 @@
 
 #include "net/ISocket.h"
 #include "base/EventTypes.h"
+#include <functional>
 #include <memory>
 
 namespace inputleap {
@@ -31,6 +32,8 @@ listen for incoming connections.
 */
 class IListenSocket : public ISocket {
 public:
+    using AdmissionFilter = std::function<bool(const NetworkAddress& peer)>;
+
     //! Accept connection
     /*!
     Accept a connection, returning a socket representing the full-duplex
@@ -38,6 +41,16 @@ public:
     This is only valid after a call to \c bind().
     */
     virtual std::unique_ptr<IDataSocket> accept() = 0;
+
+    //! Set admission filter
+    /*!
+    Sets a function that \c accept() calls with the address of each
+    connecting peer before setting up the connection.  When it returns
+    false the connection is closed at once and \c accept() returns
+    nullptr.  This keeps unwanted connections from costing more than the
+    accept itself, e.g. no TLS context is created for them.
+    */
+    virtual void set_admission_filter(AdmissionFilter filter) = 0;
 };
 
 } // namespace inputleap
@@ -43,6 +43,10 @@ public:
     virtual std::unique_ptr<IListenSocket>
         create_listen(IArchNetwork::EAddressFamily family,
                       ConnectionSecurityLevel security_level) const = 0;
+
+    //! Create datagram socket
+    virtual std::unique_ptr<UDPSocket>
+        create_datagram(IArchNetwork::EAddressFamily family) const = 0;
 };
 
 } // namespace inputleap
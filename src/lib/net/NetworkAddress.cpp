@@ -105,6 +105,16 @@ NetworkAddress::NetworkAddress(const std::string& hostname, int port) :
     checkPort();
 }
 
+NetworkAddress::NetworkAddress(ArchNetAddress address) :
+    m_address(address),
+    m_hostname(),
+    m_port(0)
+{
+    assert(m_address != nullptr);
+    m_hostname = ARCH->addrToString(m_address);
+    m_port     = ARCH->getAddrPort(m_address);
+}
+
 NetworkAddress::~NetworkAddress()
 {
     if (m_address != nullptr) {
@@ -164,6 +174,44 @@ NetworkAddress::resolve()
     ARCH->setAddrPort(m_address, m_port);
 }
 
+std::vector<NetworkAddress>
+NetworkAddress::resolve_all() const
+{
+    std::vector<ArchNetAddress> addrs;
+    try {
+        if (m_hostname.empty()) {
+            addrs.push_back(ARCH->newAnyAddr(IArchNetwork::kINET6));
+        }
+        else {
+            addrs = ARCH->nameToAddrs(m_hostname);
+        }
+    }
+    catch (XArchNetworkNameUnknown&) {
+        throw XSocketAddress(XSocketAddress::kNotFound, m_hostname, m_port);
+    }
+    catch (XArchNetworkNameNoAddress&) {
+        throw XSocketAddress(XSocketAddress::kNoAddress, m_hostname, m_port);
+    }
+    catch (XArchNetworkNameUnsupported&) {
+        throw XSocketAddress(XSocketAddress::kUnsupported, m_hostname, m_port);
+    }
+    catch (XArchNetworkName&) {
+        throw XSocketAddress(XSocketAddress::kUnknown, m_hostname, m_port);
+    }
+
+    std::vector<NetworkAddress> result;
+    result.reserve(addrs.size());
+    for (ArchNetAddress addr : addrs) {
+        ARCH->setAddrPort(addr, m_port);
+        NetworkAddress copy;
+        copy.m_address  = addr;
+        copy.m_hostname = m_hostname;
+        copy.m_port     = m_port;
+        result.push_back(copy);
+    }
+    return result;
+}
+
 bool
 NetworkAddress::operator==(const NetworkAddress& addr) const
 {
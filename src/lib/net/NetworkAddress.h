@@ -20,6 +20,7 @@
 
 #include "base/EventTypes.h"
 #include "arch/IArchNetwork.h"
+#include <vector>
 
 namespace inputleap {
 
@@ -52,6 +53,14 @@ public:
     */
     NetworkAddress(const std::string& hostname, int port);
 
+    /*!
+    Construct the network address from a native \c address, such as the
+    sender address reported for a received datagram.  The address is
+    adopted and released by the d'tor.  The hostname is the numeric form
+    of the address.
+    */
+    explicit NetworkAddress(ArchNetAddress address);
+
     NetworkAddress(const NetworkAddress&);
 
     ~NetworkAddress();
@@ -74,6 +83,16 @@ public:
     //! @name accessors
     //@{
 
+    //! Resolve address to all candidates
+    /*!
+    Resolves the hostname to every address it has and returns one
+    resolved copy of this address per result, keeping the hostname and
+    port.  The order is the one the resolver prefers.  This address is
+    left unchanged.  Throws XSocketAddress if resolution is unsuccessful.
+    This blocks on the resolver, so it may be called from any thread.
+    */
+    std::vector<NetworkAddress> resolve_all() const;
+
     //! Check address equality
     /*!
     Returns true if this address is equal to \p address.
@@ -0,0 +1,76 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "net/PacketFramer.h"
+
+#include <algorithm>
+
+namespace inputleap {
+
+PacketFramer::PacketFramer(std::uint32_t max_size) :
+    max_size_(max_size)
+{
+}
+
+bool PacketFramer::add(const std::uint8_t* data, std::uint32_t n)
+{
+    if (error_) {
+        return false;
+    }
+
+    while (n > 0) {
+        if (remaining_ == 0) {
+            // collect the length of the next packet
+            header_[header_size_++] = *data++;
+            --n;
+            ++received_;
+            if (header_size_ < sizeof(header_)) {
+                continue;
+            }
+            header_size_ = 0;
+            remaining_ = (static_cast<std::uint32_t>(header_[0]) << 24) |
+                         (static_cast<std::uint32_t>(header_[1]) << 16) |
+                         (static_cast<std::uint32_t>(header_[2]) <<  8) |
+                          static_cast<std::uint32_t>(header_[3]);
+            if (remaining_ > max_size_) {
+                error_ = true;
+                return false;
+            }
+            if (remaining_ == 0) {
+                complete_ = received_;
+            }
+            continue;
+        }
+
+        // skip over the payload
+        std::uint32_t skip = std::min(n, remaining_);
+        data += skip;
+        n -= skip;
+        received_ += skip;
+        remaining_ -= skip;
+        if (remaining_ == 0) {
+            complete_ = received_;
+        }
+    }
+    return true;
+}
+
+void PacketFramer::consume(std::uint32_t n)
+{
+    consumed_ += n;
+}
+
+} // namespace inputleap
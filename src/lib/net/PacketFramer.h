@@ -0,0 +1,75 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace inputleap {
+
+//! Tracks packet boundaries in a byte stream
+/*!
+Follows the 4 byte big endian length prefix that PacketStreamFilter
+writes in front of every message.  A socket feeds it the bytes it
+receives and reports what its reader consumed, so it can tell whether a
+whole packet is buffered without keeping a copy of the data.  This lets
+the socket's multiplexer thread do the framing and only wake the event
+loop for complete packets.
+*/
+class PacketFramer {
+public:
+    //! Frame packets of up to \p max_size payload bytes
+    explicit PacketFramer(std::uint32_t max_size);
+
+    //! @name manipulators
+    //@{
+
+    //! Account for received bytes
+    /*!
+    Returns false if a packet announces a size above the maximum.  The
+    framer stops tracking after that and has_packet() stays false.
+    */
+    bool add(const std::uint8_t* data, std::uint32_t n);
+
+    //! Account for bytes the reader took off the stream
+    void consume(std::uint32_t n);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Check if a whole packet is buffered and not yet consumed
+    bool has_packet() const { return !error_ && complete_ > consumed_; }
+
+    //! Check if a packet announced an invalid size
+    bool has_error() const { return error_; }
+
+    //@}
+
+private:
+    std::uint32_t max_size_;
+    // stream offsets: end of the last complete packet and bytes consumed
+    std::uint64_t complete_ = 0;
+    std::uint64_t consumed_ = 0;
+    std::uint64_t received_ = 0;
+    // state of the packet in progress
+    std::uint8_t header_[4] = {};
+    std::uint32_t header_size_ = 0;
+    std::uint32_t remaining_ = 0;
+    bool error_ = false;
+};
+
+} // namespace inputleap
@@ -29,8 +29,9 @@ namespace inputleap {
 
 SecureListenSocket::SecureListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
                                        IArchNetwork::EAddressFamily family,
-                                       ConnectionSecurityLevel security_level) :
-    TCPListenSocket(events, socketMultiplexer, family),
+                                       ConnectionSecurityLevel security_level,
+                                       SocketMultiplexerPool* workers) :
+    TCPListenSocket(events, socketMultiplexer, family, workers),
     security_level_{security_level}
 {
 }
@@ -39,18 +40,19 @@ std::unique_ptr<IDataSocket> SecureListenSocket::accept()
 {
     std::unique_ptr<SecureSocket> socket;
     try {
-        socket = std::make_unique<SecureSocket>(m_events, m_socketMultiplexer,
-                                                 ARCH->acceptSocket(m_socket, nullptr),
+        // turn unwanted peers away before paying for the TLS setup
+        ArchSocket accepted = accept_admitted();
+        if (accepted == nullptr) {
+            setListeningJob();
+            return nullptr;
+        }
+        socket = std::make_unique<SecureSocket>(m_events, accept_multiplexer(), accepted,
                                                 security_level_);
         socket->initSsl(true);
         setListeningJob();
 
-        bool loaded = socket->load_certificates(inputleap::DataDirectories::ssl_certificate_path());
-        if (!loaded) {
-            return nullptr;
-        }
-
-        socket->secureAccept();
+        // the worker loads the certificate and runs the handshake
+        socket->secure_accept(inputleap::DataDirectories::ssl_certificate_path());
 
         return socket;
     }
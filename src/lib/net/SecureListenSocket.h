@@ -27,7 +27,8 @@ class SecureListenSocket : public TCPListenSocket {
 public:
     SecureListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
                        IArchNetwork::EAddressFamily family,
-                       ConnectionSecurityLevel security_level);
+                       ConnectionSecurityLevel security_level,
+                       SocketMultiplexerPool* workers = nullptr);
 
     // IListenSocket overrides
     std::unique_ptr<IDataSocket> accept() override;
@@ -74,6 +74,8 @@ SecureSocket::SecureSocket(IEventQueue* events, SocketMultiplexer* socketMultipl
 
 SecureSocket::~SecureSocket()
 {
+    // a deferred wakeup calls newJob(), which uses the SSL state
+    cancel_deferred_job();
     isFatal(true);
     // take socket from multiplexer ASAP otherwise the race condition
     // could cause events to get called on a dead object. TCPSocket
@@ -134,9 +136,9 @@ SecureSocket::secureConnect()
                                                          getSocket(), isReadable(), isWritable()));
 }
 
-void
-SecureSocket::secureAccept()
+void SecureSocket::secure_accept(const inputleap::fs::path& certificate_path)
 {
+    accept_certificate_path_ = certificate_path;
     setJob(std::make_unique<TSocketMultiplexerMethodJob>([this](auto j, auto r, auto w, auto e)
                                                          { return serviceAccept(j, r, w, e); },
                                                          getSocket(), isReadable(), isWritable()));
@@ -164,11 +166,11 @@ SecureSocket::doRead()
     }
 
     if (bytesRead > 0) {
-        bool wasEmpty = (m_inputBuffer.getSize() == 0);
+        bool wasReady = is_input_ready();
 
         // slurp up as much as possible
         do {
-            m_inputBuffer.write(buffer, bytesRead);
+            add_input(buffer, bytesRead);
 
             if (m_inputBuffer.getSize() > MAX_INPUT_BUFFER_SIZE) {
                 break;
@@ -180,8 +182,8 @@ SecureSocket::doRead()
             }
         } while (bytesRead > 0 || status > 0);
 
-        // send input ready if input buffer was empty
-        if (wasEmpty) {
+        // send input ready if the reader had nothing to do
+        if (!wasReady && is_input_ready()) {
             sendEvent(EventType::STREAM_INPUT_READY);
         }
     }
@@ -755,6 +757,13 @@ MultiplexerJobStatus SecureSocket::serviceAccept(ISocketMultiplexerJob* job,
 
     std::lock_guard<std::mutex> lock(tcp_mutex_);
 
+    if (!accept_certificate_loaded_) {
+        if (!load_certificates(accept_certificate_path_)) {
+            return {false, {}};
+        }
+        accept_certificate_loaded_ = true;
+    }
+
     int status = 0;
 #ifdef SYSAPI_WIN32
     status = secureAccept(static_cast<int>(getSocket()->m_socket));
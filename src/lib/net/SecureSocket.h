@@ -51,7 +51,9 @@ public:
     void isFatal(bool b) { m_fatal = b; }
     bool isSecureReady();
     void secureConnect();
-    void secureAccept();
+    // starts the server side handshake.  the certificate is loaded by
+    // the first accept job, i.e. on the socket's multiplexer thread
+    void secure_accept(const inputleap::fs::path& certificate_path);
     int secureRead(void* buffer, int size, int& read);
     int secureWrite(const void* buffer, int size, int& wrote);
     EJobResult doRead() override;
@@ -98,6 +100,8 @@ private:
     ConnectionSecurityLevel security_level_ = ConnectionSecurityLevel::ENCRYPTED;
 
     int secure_accept_retry_ = 0; // used only in secureAccept()
+    inputleap::fs::path accept_certificate_path_; // used only in serviceAccept()
+    bool accept_certificate_loaded_ = false; // used only in serviceAccept()
     int secure_connect_retry_ = 0; // used only in secureConnect()
     int secure_read_retry_ = 0; // used only in secureRead()
     int secure_write_retry_ = 0; // used only in secureWrite()
@@ -245,6 +245,16 @@ walked in either direction.
 #define	FLDSIZE_Y	(FLDBASE + 1)
 #define	FLDSIZE_X	(FLDBASE * 2 + 1)
 
+std::string get_sha256_digest(const std::string& data)
+{
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (EVP_Digest(data.data(), data.size(), digest, &length, EVP_sha256(), nullptr) <= 0) {
+        throw std::runtime_error("failed to calculate sha256 digest");
+    }
+    return std::string(reinterpret_cast<const char*>(digest), length);
+}
+
 std::string create_fingerprint_randomart(const std::vector<std::uint8_t>& dgst_raw)
 {
     /*
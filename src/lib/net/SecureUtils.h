@@ -35,6 +35,8 @@ FingerprintData get_pem_file_cert_fingerprint(const std::string& path, Fingerpri
 
 void generate_pem_self_signed_cert(const std::string& path);
 
+std::string get_sha256_digest(const std::string& data);
+
 std::string create_fingerprint_randomart(const std::vector<std::uint8_t>& dgst_raw);
 
 } // namespace inputleap
@@ -0,0 +1,51 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "net/SocketMultiplexerPool.h"
+
+#include "net/SocketMultiplexer.h"
+#include <algorithm>
+#include <thread>
+
+namespace inputleap {
+
+SocketMultiplexerPool::SocketMultiplexerPool(std::size_t size)
+{
+    size = std::max<std::size_t>(size, 1);
+    multiplexers_.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        multiplexers_.push_back(std::make_unique<SocketMultiplexer>());
+    }
+}
+
+SocketMultiplexerPool::~SocketMultiplexerPool() = default;
+
+SocketMultiplexer* SocketMultiplexerPool::next()
+{
+    std::size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    return multiplexers_[index % multiplexers_.size()].get();
+}
+
+std::size_t SocketMultiplexerPool::get_default_size()
+{
+    std::size_t cores = std::thread::hardware_concurrency();
+    if (cores <= 1) {
+        return 1;
+    }
+    return std::min(cores - 1, kMaxDefaultSize);
+}
+
+} // namespace inputleap
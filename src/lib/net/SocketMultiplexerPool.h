@@ -0,0 +1,77 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Fwd.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace inputleap {
+
+//! Set of socket multiplexers for accepted connections
+/*!
+A single multiplexer services every socket on one thread, including the
+TLS handshakes and decryption of all connected clients.  The pool runs
+several multiplexers, each on its own thread, and hands them out in turn
+so accepted connections are spread over the workers.  A worker does all
+of the TLS work of its sockets, from loading the certificate to
+decryption, and finds the packet boundaries so the event loop is only
+woken up for whole messages.  Events from all workers are still
+delivered through the one event queue;  the proxies and routing stay on
+the main thread.
+*/
+class SocketMultiplexerPool {
+public:
+    //! Upper bound for get_default_size()
+    static constexpr std::size_t kMaxDefaultSize = 4;
+
+    explicit SocketMultiplexerPool(std::size_t size);
+    ~SocketMultiplexerPool();
+
+    SocketMultiplexerPool(const SocketMultiplexerPool&) = delete;
+    SocketMultiplexerPool& operator=(const SocketMultiplexerPool&) = delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Get the multiplexer for the next connection
+    SocketMultiplexer* next();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of multiplexers
+    std::size_t get_size() const { return multiplexers_.size(); }
+
+    //! Get the pool size to use when none was configured
+    /*!
+    Leaves one core for the event loop and keeps the pool small since
+    each worker is a thread that mostly waits on its sockets.
+    */
+    static std::size_t get_default_size();
+
+    //@}
+
+private:
+    std::vector<std::unique_ptr<SocketMultiplexer>> multiplexers_;
+    std::atomic<std::size_t> next_{0};
+};
+
+} // namespace inputleap
@@ -20,6 +20,7 @@
 
 #include "net/NetworkAddress.h"
 #include "net/SocketMultiplexer.h"
+#include "net/SocketMultiplexerPool.h"
 #include "net/TCPSocket.h"
 #include "net/TSocketMultiplexerMethodJob.h"
 #include "net/XSocket.h"
@@ -30,9 +31,12 @@
 
 namespace inputleap {
 
-TCPListenSocket::TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family) :
+TCPListenSocket::TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                                 IArchNetwork::EAddressFamily family,
+                                 SocketMultiplexerPool* workers) :
     m_events(events),
-    m_socketMultiplexer(socketMultiplexer)
+    m_socketMultiplexer(socketMultiplexer),
+    workers_(workers)
 {
     try {
         m_socket = ARCH->newSocket(family, IArchNetwork::kSTREAM);
@@ -101,12 +105,49 @@ const EventTarget* TCPListenSocket::get_event_target() const
     return this;
 }
 
+void TCPListenSocket::set_admission_filter(AdmissionFilter filter)
+{
+    admission_filter_ = std::move(filter);
+}
+
+ArchSocket TCPListenSocket::accept_admitted()
+{
+    if (!admission_filter_) {
+        return ARCH->acceptSocket(m_socket, nullptr);
+    }
+
+    ArchNetAddress peer = nullptr;
+    ArchSocket socket = ARCH->acceptSocket(m_socket, &peer);
+    if (socket == nullptr || peer == nullptr) {
+        return socket;
+    }
+
+    NetworkAddress address(peer);
+    if (!admission_filter_(address)) {
+        ARCH->closeSocket(socket);
+        return nullptr;
+    }
+    return socket;
+}
+
+SocketMultiplexer* TCPListenSocket::accept_multiplexer()
+{
+    if (workers_ != nullptr) {
+        return workers_->next();
+    }
+    return m_socketMultiplexer;
+}
+
 std::unique_ptr<IDataSocket> TCPListenSocket::accept()
 {
     std::unique_ptr<IDataSocket> socket;
     try {
-        socket = std::make_unique<TCPSocket>(m_events, m_socketMultiplexer,
-                                             ARCH->acceptSocket(m_socket, nullptr));
+        ArchSocket accepted = accept_admitted();
+        if (accepted == nullptr) {
+            setListeningJob();
+            return nullptr;
+        }
+        socket = std::make_unique<TCPSocket>(m_events, accept_multiplexer(), accepted);
         setListeningJob();
         return socket;
     }
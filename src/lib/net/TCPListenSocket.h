@@ -37,7 +37,13 @@ A listen socket using TCP.
 */
 class TCPListenSocket : public IListenSocket, public EventTarget {
 public:
-    TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family);
+    /*!
+    Accepted connections are serviced by \p workers if given, otherwise by
+    \p socketMultiplexer like the listen socket itself.
+    */
+    TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                    IArchNetwork::EAddressFamily family,
+                    SocketMultiplexerPool* workers = nullptr);
     virtual ~TCPListenSocket();
 
     // ISocket overrides
@@ -47,10 +53,18 @@ public:
 
     // IListenSocket overrides
     std::unique_ptr<IDataSocket> accept() override;
+    void set_admission_filter(AdmissionFilter filter) override;
 
 protected:
     void setListeningJob();
 
+    // accepts the next connection and returns it if the admission filter
+    // lets it in, otherwise closes it and returns nullptr
+    ArchSocket accept_admitted();
+
+    // returns the multiplexer for the next accepted connection
+    SocketMultiplexer* accept_multiplexer();
+
 public:
     MultiplexerJobStatus serviceListening(ISocketMultiplexerJob*, bool, bool, bool);
 
@@ -59,6 +73,8 @@ protected:
     std::mutex mutex_;
     IEventQueue* m_events;
     SocketMultiplexer* m_socketMultiplexer;
+    SocketMultiplexerPool* workers_;
+    AdmissionFilter admission_filter_;
 };
 
 } // namespace inputleap
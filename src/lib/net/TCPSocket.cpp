@@ -24,6 +24,7 @@
 #include "net/XSocket.h"
 #include "arch/Arch.h"
 #include "arch/XArch.h"
+#include "base/DispatchCork.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 
@@ -70,6 +71,7 @@ TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
 
 TCPSocket::~TCPSocket()
 {
+    cancel_deferred_job();
     try {
         close();
     }
@@ -139,6 +141,9 @@ std::uint32_t TCPSocket::read(void* buffer, std::uint32_t n)
         memcpy(buffer, m_inputBuffer.peek(n), n);
     }
     m_inputBuffer.pop(n);
+    if (framer_) {
+        framer_->consume(n);
+    }
 
     // if no more data and we cannot read or write then send disconnected
     if (n > 0 && m_inputBuffer.getSize() == 0 && !m_readable && !m_writable) {
@@ -174,15 +179,26 @@ void TCPSocket::write(const void* buffer, std::uint32_t n)
         is_flushed_ = false;
     }
 
-    // make sure we're waiting to write
+    // make sure we're waiting to write.  while an event is dispatched
+    // that waits until the handler is done, so the messages it writes
+    // wake the multiplexer once and go out in one send.
     if (wasEmpty) {
-        setJob(newJob());
+        DispatchCork::defer(this, [this]() { setJob(newJob()); });
     }
 }
 
+void TCPSocket::cancel_deferred_job()
+{
+    // the wakeup may be deferred by the event loop, which may be another
+    // thread
+    DispatchCork::cancel(this);
+}
+
 void
 TCPSocket::flush()
 {
+    DispatchCork::release(this);
+
     std::unique_lock<std::mutex> lock(tcp_mutex_);
     flushed_cv_.wait(lock, [this](){ return is_flushed_; });
 }
@@ -291,6 +307,19 @@ TCPSocket::connect(const NetworkAddress& addr)
     setJob(newJob());
 }
 
+void TCPSocket::set_packet_framing(std::uint32_t max_packet_size)
+{
+    std::lock_guard<std::mutex> lock(tcp_mutex_);
+    framer_ = std::make_unique<PacketFramer>(max_packet_size);
+
+    // frame whatever arrived before framing was turned on
+    std::uint32_t size = m_inputBuffer.getSize();
+    if (size > 0 && !framer_->add(static_cast<const std::uint8_t*>(m_inputBuffer.peek(size)),
+                                  size)) {
+        sendEvent(EventType::STREAM_INPUT_FORMAT_ERROR);
+    }
+}
+
 void
 TCPSocket::init()
 {
@@ -327,11 +356,11 @@ TCPSocket::doRead()
     bytesRead = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
 
     if (bytesRead > 0) {
-        bool wasEmpty = (m_inputBuffer.getSize() == 0);
+        bool wasReady = is_input_ready();
 
         // slurp up as much as possible
         do {
-            m_inputBuffer.write(buffer, static_cast<std::uint32_t>(bytesRead));
+            add_input(buffer, static_cast<std::uint32_t>(bytesRead));
 
             if (m_inputBuffer.getSize() > MAX_INPUT_BUFFER_SIZE) {
                 break;
@@ -340,8 +369,8 @@ TCPSocket::doRead()
             bytesRead = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
         } while (bytesRead > 0);
 
-        // send input ready if input buffer was empty
-        if (wasEmpty) {
+        // send input ready if the reader had nothing to do
+        if (!wasReady && is_input_ready()) {
             sendEvent(EventType::STREAM_INPUT_READY);
         }
     }
@@ -446,6 +475,27 @@ void TCPSocket::sendEvent(EventType type)
     m_events->add_event(type, get_event_target());
 }
 
+void TCPSocket::add_input(const void* data, std::uint32_t n)
+{
+    m_inputBuffer.write(data, n);
+
+    // runs on the multiplexer thread so the event loop isn't woken up
+    // for partial packets
+    if (framer_ && !framer_->has_error()) {
+        if (!framer_->add(static_cast<const std::uint8_t*>(data), n)) {
+            sendEvent(EventType::STREAM_INPUT_FORMAT_ERROR);
+        }
+    }
+}
+
+bool TCPSocket::is_input_ready() const
+{
+    if (framer_) {
+        return framer_->has_packet();
+    }
+    return m_inputBuffer.getSize() > 0;
+}
+
 void
 TCPSocket::discardWrittenData(int bytesWrote)
 {
@@ -468,6 +518,9 @@ TCPSocket::onConnected()
 void
 TCPSocket::onInputShutdown()
 {
+    if (framer_) {
+        framer_->consume(m_inputBuffer.getSize());
+    }
     m_inputBuffer.pop(m_inputBuffer.getSize());
     m_readable = false;
 }
@@ -22,6 +22,7 @@
 #include "base/EventTarget.h"
 #include "net/IDataSocket.h"
 #include "net/ISocketMultiplexerJob.h"
+#include "net/PacketFramer.h"
 #include "io/StreamBuffer.h"
 #include "arch/IArchNetwork.h"
 #include <condition_variable>
@@ -59,6 +60,7 @@ public:
 
     // IDataSocket overrides
     void connect(const NetworkAddress&) override;
+    void set_packet_framing(std::uint32_t max_packet_size) override;
 
 
     virtual std::unique_ptr<ISocketMultiplexerJob> newJob();
@@ -77,6 +79,11 @@ protected:
 
     void removeJob();
     void setJob(std::unique_ptr<ISocketMultiplexerJob>&& job);
+
+    // drops a wakeup deferred by write() or waits for it if another thread
+    // is running it.  destructors call this before tearing down anything
+    // newJob() uses.
+    void cancel_deferred_job();
     MultiplexerJobStatus newJobOrStopServicing();
 
     bool isReadable() { return m_readable; }
@@ -85,6 +92,14 @@ protected:
     void sendEvent(EventType type);
     void discardWrittenData(int bytesWrote);
 
+    // buffers received data and frames it if packet framing is on.
+    // may only be called with tcp_mutex_ acquired
+    void add_input(const void* data, std::uint32_t n);
+
+    // true if the reader has something to do: any data or, with packet
+    // framing, a whole packet.  may only be called with tcp_mutex_ acquired
+    bool is_input_ready() const;
+
 private:
     void init();
 
@@ -104,6 +119,7 @@ protected:
     IEventQueue* m_events;
     StreamBuffer m_inputBuffer;
     StreamBuffer m_outputBuffer;
+    std::unique_ptr<PacketFramer> framer_;
 
     mutable std::mutex tcp_mutex_;
 private:
@@ -21,14 +21,17 @@
 #include "net/TCPListenSocket.h"
 #include "net/SecureSocket.h"
 #include "net/SecureListenSocket.h"
+#include "net/UDPSocket.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
 
 namespace inputleap {
 
-TCPSocketFactory::TCPSocketFactory(IEventQueue* events, SocketMultiplexer* socketMultiplexer) :
+TCPSocketFactory::TCPSocketFactory(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                                   SocketMultiplexerPool* workers) :
     m_events(events),
-    m_socketMultiplexer(socketMultiplexer)
+    m_socketMultiplexer(socketMultiplexer),
+    workers_(workers)
 {
     // do nothing
 }
@@ -58,10 +61,18 @@ std::unique_ptr<IListenSocket>
 {
     if (security_level != ConnectionSecurityLevel::PLAINTEXT) {
         return std::make_unique<SecureListenSocket>(m_events, m_socketMultiplexer, family,
-                                                    security_level);
+                                                    security_level, workers_);
     } else {
-        return std::make_unique<TCPListenSocket>(m_events, m_socketMultiplexer, family);
+        return std::make_unique<TCPListenSocket>(m_events, m_socketMultiplexer, family,
+                                                 workers_);
     }
 }
 
+std::unique_ptr<UDPSocket>
+    TCPSocketFactory::create_datagram(IArchNetwork::EAddressFamily family) const
+{
+    // datagrams carry their own authentication, see MotionDatagram.h
+    return std::make_unique<UDPSocket>(m_events, m_socketMultiplexer, family);
+}
+
 } // namespace inputleap
@@ -28,7 +28,12 @@ namespace inputleap {
 //! Socket factory for TCP sockets
 class TCPSocketFactory : public ISocketFactory {
 public:
-    TCPSocketFactory(IEventQueue* events, SocketMultiplexer* socketMultiplexer);
+    /*!
+    Connections accepted by listen sockets from this factory are spread
+    over \p workers if given.
+    */
+    TCPSocketFactory(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                     SocketMultiplexerPool* workers = nullptr);
     virtual ~TCPSocketFactory();
 
     // ISocketFactory overrides
@@ -40,9 +45,13 @@ public:
         create_listen(IArchNetwork::EAddressFamily family,
                       ConnectionSecurityLevel security_level) const override;
 
+    std::unique_ptr<UDPSocket>
+        create_datagram(IArchNetwork::EAddressFamily family) const override;
+
 private:
     IEventQueue* m_events;
     SocketMultiplexer* m_socketMultiplexer;
+    SocketMultiplexerPool* workers_;
 };
 
 } // namespace inputleap
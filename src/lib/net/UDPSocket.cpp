@@ -0,0 +1,203 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "net/UDPSocket.h"
+
+#include "net/SocketMultiplexer.h"
+#include "net/TSocketMultiplexerMethodJob.h"
+#include "net/XSocket.h"
+#include "arch/Arch.h"
+#include "arch/XArch.h"
+#include "base/Log.h"
+#include "base/IEventQueue.h"
+
+#include <memory>
+
+namespace inputleap {
+
+// datagrams larger than this are truncated and therefore discarded by the
+// receiver.  this is well above anything sent over the motion lane.
+static const std::size_t MAX_DATAGRAM_SIZE = 1500;
+
+// number of datagrams queued before the oldest ones are dropped
+static const std::size_t MAX_QUEUED_DATAGRAMS = 256;
+
+UDPSocket::UDPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                     IArchNetwork::EAddressFamily family) :
+    m_events(events),
+    m_socketMultiplexer(socketMultiplexer)
+{
+    try {
+        m_socket = ARCH->newSocket(family, IArchNetwork::kDGRAM);
+    }
+    catch (XArchNetwork& e) {
+        throw XSocketCreate(e.what());
+    }
+
+    LOG_DEBUG("Opening new datagram socket: %p", m_socket);
+}
+
+UDPSocket::~UDPSocket()
+{
+    try {
+        close();
+    }
+    catch (...) {
+        // ignore
+    }
+}
+
+void UDPSocket::bind(const NetworkAddress& addr)
+{
+    try {
+        ARCH->setReuseAddrOnSocket(m_socket, true);
+        ARCH->bindSocket(m_socket, addr.getAddress());
+    }
+    catch (XArchNetworkAddressInUse& e) {
+        throw XSocketAddressInUse(e.what());
+    }
+    catch (XArchNetwork& e) {
+        throw XSocketBind(e.what());
+    }
+    start_reading();
+}
+
+void UDPSocket::close()
+{
+    if (m_socket == nullptr) {
+        return;
+    }
+
+    LOG_DEBUG("Closing datagram socket: %p", m_socket);
+
+    // remove ourself from the multiplexer
+    m_socketMultiplexer->removeSocket(this);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.clear();
+    reading_ = false;
+
+    ArchSocket socket = m_socket;
+    m_socket = nullptr;
+    try {
+        ARCH->closeSocket(socket);
+    }
+    catch (XArchNetwork& e) {
+        // ignore, there's not much we can do
+        LOG_WARN("error closing datagram socket: %s", e.what());
+    }
+}
+
+const EventTarget* UDPSocket::get_event_target() const
+{
+    return this;
+}
+
+bool UDPSocket::send_to(const void* data, std::size_t size, const NetworkAddress& address)
+{
+    if (m_socket == nullptr || !address.isValid()) {
+        return false;
+    }
+
+    std::size_t written = 0;
+    try {
+        written = ARCH->writeToSocket(m_socket, data, size, address.getAddress());
+    }
+    catch (XArchNetwork& e) {
+        // datagrams are best effort, the caller falls back to the stream
+        LOG_DEBUG1("error writing datagram: %s", e.what());
+        return false;
+    }
+
+    // the local port is assigned on first send so we can receive replies
+    start_reading();
+    return written == size;
+}
+
+bool UDPSocket::receive_from(std::vector<std::uint8_t>& data, NetworkAddress& from)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty()) {
+        return false;
+    }
+    data = std::move(queue_.front().data);
+    from = queue_.front().from;
+    queue_.pop_front();
+    return true;
+}
+
+void UDPSocket::start_reading()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (reading_ || m_socket == nullptr) {
+            return;
+        }
+        reading_ = true;
+    }
+
+    m_socketMultiplexer->addSocket(this, std::make_unique<TSocketMultiplexerMethodJob>(
+                [this](auto j, auto r, auto w, auto e)
+                { return service_readable(j, r, w, e); },
+                m_socket, true, false));
+}
+
+MultiplexerJobStatus UDPSocket::service_readable(ISocketMultiplexerJob*, bool read, bool, bool)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (m_socket == nullptr) {
+        return {false, {}};
+    }
+    if (!read) {
+        // errors on a connectionless socket (e.g. an ICMP port unreachable
+        // for an earlier datagram) are not fatal
+        return {true, {}};
+    }
+
+    bool wasEmpty = queue_.empty();
+    std::uint8_t buffer[MAX_DATAGRAM_SIZE];
+    for (;;) {
+        ArchNetAddress from = nullptr;
+        std::size_t n = 0;
+        try {
+            n = ARCH->readFromSocket(m_socket, buffer, sizeof(buffer), &from);
+        }
+        catch (XArchNetwork& e) {
+            LOG_DEBUG1("error reading datagram: %s", e.what());
+            break;
+        }
+        if (n == 0) {
+            if (from != nullptr) {
+                ARCH->closeAddr(from);
+            }
+            break;
+        }
+
+        if (queue_.size() == MAX_QUEUED_DATAGRAMS) {
+            queue_.pop_front();
+        }
+        queue_.push_back(Datagram{std::vector<std::uint8_t>(buffer, buffer + n),
+                                  NetworkAddress(from)});
+    }
+
+    if (wasEmpty && !queue_.empty()) {
+        m_events->add_event(EventType::DATAGRAM_INPUT_READY, get_event_target());
+    }
+    return {true, {}};
+}
+
+} // namespace inputleap
@@ -0,0 +1,91 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Fwd.h"
+#include "base/EventTarget.h"
+#include "net/ISocket.h"
+#include "net/ISocketMultiplexerJob.h"
+#include "net/NetworkAddress.h"
+#include "arch/IArchNetwork.h"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace inputleap {
+
+//! UDP datagram socket
+/*!
+A connectionless socket using UDP.  Received datagrams are queued by the
+socket multiplexer thread and \c EventType::DATAGRAM_INPUT_READY is sent
+when the queue becomes non-empty.  Datagrams are unreliable by nature;
+when the queue is full the oldest datagrams are dropped.
+*/
+class UDPSocket : public ISocket, public EventTarget {
+public:
+    UDPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+              IArchNetwork::EAddressFamily family);
+    ~UDPSocket() override;
+
+    // ISocket overrides
+    void bind(const NetworkAddress&) override;
+    void close() override;
+    const EventTarget* get_event_target() const override;
+
+    //! @name manipulators
+    //@{
+
+    //! Send a datagram
+    /*!
+    Sends \p size bytes from \p data as one datagram to \p address.
+    Returns false if the datagram was dropped, either because the
+    socket's send buffer is full or because of a network error.  The
+    socket starts receiving once it has been bound or has sent a
+    datagram.
+    */
+    bool send_to(const void* data, std::size_t size, const NetworkAddress& address);
+
+    //! Receive a datagram
+    /*!
+    Removes the oldest queued datagram and stores it in \p data and its
+    sender in \p from.  Returns false if no datagram is queued.
+    */
+    bool receive_from(std::vector<std::uint8_t>& data, NetworkAddress& from);
+
+    //@}
+
+private:
+    struct Datagram {
+        std::vector<std::uint8_t> data;
+        NetworkAddress from;
+    };
+
+    void start_reading();
+    MultiplexerJobStatus service_readable(ISocketMultiplexerJob*, bool, bool, bool);
+
+private:
+    IEventQueue* m_events;
+    SocketMultiplexer* m_socketMultiplexer;
+    ArchSocket m_socket;
+
+    mutable std::mutex mutex_;
+    std::deque<Datagram> queue_;
+    bool reading_ = false;
+};
+
+} // namespace inputleap
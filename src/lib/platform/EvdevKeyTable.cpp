@@ -0,0 +1,341 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/EvdevKeyTable.h"
+
+#include <linux/input-event-codes.h>
+
+namespace inputleap {
+
+namespace {
+
+struct KeyEntry {
+    std::uint16_t code;
+    KeyID id;
+    KeyID other_id;
+};
+
+// letters.  other_id is the KeyID with exactly one of shift and caps lock.
+const KeyEntry s_letters[] = {
+    { KEY_A, 'a', 'A' }, { KEY_B, 'b', 'B' }, { KEY_C, 'c', 'C' },
+    { KEY_D, 'd', 'D' }, { KEY_E, 'e', 'E' }, { KEY_F, 'f', 'F' },
+    { KEY_G, 'g', 'G' }, { KEY_H, 'h', 'H' }, { KEY_I, 'i', 'I' },
+    { KEY_J, 'j', 'J' }, { KEY_K, 'k', 'K' }, { KEY_L, 'l', 'L' },
+    { KEY_M, 'm', 'M' }, { KEY_N, 'n', 'N' }, { KEY_O, 'o', 'O' },
+    { KEY_P, 'p', 'P' }, { KEY_Q, 'q', 'Q' }, { KEY_R, 'r', 'R' },
+    { KEY_S, 's', 'S' }, { KEY_T, 't', 'T' }, { KEY_U, 'u', 'U' },
+    { KEY_V, 'v', 'V' }, { KEY_W, 'w', 'W' }, { KEY_X, 'x', 'X' },
+    { KEY_Y, 'y', 'Y' }, { KEY_Z, 'z', 'Z' },
+};
+
+// keypad keys.  id is the KeyID with num lock on, other_id without.
+const KeyEntry s_keypad[] = {
+    { KEY_KP0,   kKeyKP_0,       kKeyKP_Insert },
+    { KEY_KP1,   kKeyKP_1,       kKeyKP_End },
+    { KEY_KP2,   kKeyKP_2,       kKeyKP_Down },
+    { KEY_KP3,   kKeyKP_3,       kKeyKP_PageDown },
+    { KEY_KP4,   kKeyKP_4,       kKeyKP_Left },
+    { KEY_KP5,   kKeyKP_5,       kKeyKP_Begin },
+    { KEY_KP6,   kKeyKP_6,       kKeyKP_Right },
+    { KEY_KP7,   kKeyKP_7,       kKeyKP_Home },
+    { KEY_KP8,   kKeyKP_8,       kKeyKP_Up },
+    { KEY_KP9,   kKeyKP_9,       kKeyKP_PageUp },
+    { KEY_KPDOT, kKeyKP_Decimal, kKeyKP_Delete },
+};
+
+// everything else.  other_id is the KeyID with shift or kKeyNone if shift
+// makes no difference.
+const KeyEntry s_keys[] = {
+    { KEY_1,          '1',  '!' },
+    { KEY_2,          '2',  '@' },
+    { KEY_3,          '3',  '#' },
+    { KEY_4,          '4',  '$' },
+    { KEY_5,          '5',  '%' },
+    { KEY_6,          '6',  '^' },
+    { KEY_7,          '7',  '&' },
+    { KEY_8,          '8',  '*' },
+    { KEY_9,          '9',  '(' },
+    { KEY_0,          '0',  ')' },
+    { KEY_MINUS,      '-',  '_' },
+    { KEY_EQUAL,      '=',  '+' },
+    { KEY_LEFTBRACE,  '[',  '{' },
+    { KEY_RIGHTBRACE, ']',  '}' },
+    { KEY_SEMICOLON,  ';',  ':' },
+    { KEY_APOSTROPHE, '\'', '"' },
+    { KEY_GRAVE,      '`',  '~' },
+    { KEY_BACKSLASH,  '\\', '|' },
+    { KEY_COMMA,      ',',  '<' },
+    { KEY_DOT,        '.',  '>' },
+    { KEY_SLASH,      '/',  '?' },
+    { KEY_102ND,      '<',  '>' },
+    { KEY_SPACE,      ' ',  kKeyNone },
+    { KEY_TAB,        kKeyTab, kKeyLeftTab },
+
+    { KEY_ESC,        kKeyEscape,     kKeyNone },
+    { KEY_BACKSPACE,  kKeyBackSpace,  kKeyNone },
+    { KEY_ENTER,      kKeyReturn,     kKeyNone },
+    { KEY_INSERT,     kKeyInsert,     kKeyNone },
+    { KEY_DELETE,     kKeyDelete,     kKeyNone },
+    { KEY_HOME,       kKeyHome,       kKeyNone },
+    { KEY_END,        kKeyEnd,        kKeyNone },
+    { KEY_PAGEUP,     kKeyPageUp,     kKeyNone },
+    { KEY_PAGEDOWN,   kKeyPageDown,   kKeyNone },
+    { KEY_LEFT,       kKeyLeft,       kKeyNone },
+    { KEY_RIGHT,      kKeyRight,      kKeyNone },
+    { KEY_UP,         kKeyUp,         kKeyNone },
+    { KEY_DOWN,       kKeyDown,       kKeyNone },
+    { KEY_SYSRQ,      kKeyPrint,      kKeyNone },
+    { KEY_PAUSE,      kKeyPause,      kKeyNone },
+    { KEY_COMPOSE,    kKeyMenu,       kKeyNone },
+
+    { KEY_F1,  kKeyF1,  kKeyNone }, { KEY_F2,  kKeyF2,  kKeyNone },
+    { KEY_F3,  kKeyF3,  kKeyNone }, { KEY_F4,  kKeyF4,  kKeyNone },
+    { KEY_F5,  kKeyF5,  kKeyNone }, { KEY_F6,  kKeyF6,  kKeyNone },
+    { KEY_F7,  kKeyF7,  kKeyNone }, { KEY_F8,  kKeyF8,  kKeyNone },
+    { KEY_F9,  kKeyF9,  kKeyNone }, { KEY_F10, kKeyF10, kKeyNone },
+    { KEY_F11, kKeyF11, kKeyNone }, { KEY_F12, kKeyF12, kKeyNone },
+    { KEY_F13, kKeyF13, kKeyNone }, { KEY_F14, kKeyF14, kKeyNone },
+    { KEY_F15, kKeyF15, kKeyNone }, { KEY_F16, kKeyF16, kKeyNone },
+    { KEY_F17, kKeyF17, kKeyNone }, { KEY_F18, kKeyF18, kKeyNone },
+    { KEY_F19, kKeyF19, kKeyNone }, { KEY_F20, kKeyF20, kKeyNone },
+    { KEY_F21, kKeyF21, kKeyNone }, { KEY_F22, kKeyF22, kKeyNone },
+    { KEY_F23, kKeyF23, kKeyNone }, { KEY_F24, kKeyF24, kKeyNone },
+
+    { KEY_LEFTSHIFT,  kKeyShift_L,    kKeyNone },
+    { KEY_RIGHTSHIFT, kKeyShift_R,    kKeyNone },
+    { KEY_LEFTCTRL,   kKeyControl_L,  kKeyNone },
+    { KEY_RIGHTCTRL,  kKeyControl_R,  kKeyNone },
+    { KEY_LEFTALT,    kKeyAlt_L,      kKeyNone },
+    { KEY_RIGHTALT,   kKeyAlt_R,      kKeyNone },
+    { KEY_LEFTMETA,   kKeySuper_L,    kKeyNone },
+    { KEY_RIGHTMETA,  kKeySuper_R,    kKeyNone },
+    { KEY_CAPSLOCK,   kKeyCapsLock,   kKeyNone },
+    { KEY_NUMLOCK,    kKeyNumLock,    kKeyNone },
+    { KEY_SCROLLLOCK, kKeyScrollLock, kKeyNone },
+
+    { KEY_KPSLASH,    kKeyKP_Divide,   kKeyNone },
+    { KEY_KPASTERISK, kKeyKP_Multiply, kKeyNone },
+    { KEY_KPMINUS,    kKeyKP_Subtract, kKeyNone },
+    { KEY_KPPLUS,     kKeyKP_Add,      kKeyNone },
+    { KEY_KPENTER,    kKeyKP_Enter,    kKeyNone },
+    { KEY_KPEQUAL,    kKeyKP_Equal,    kKeyNone },
+
+    { KEY_MUHENKAN,         kKeyMuhenkan,          kKeyNone },
+    { KEY_HENKAN,           kKeyHenkan,            kKeyNone },
+    { KEY_KATAKANAHIRAGANA, kKeyHiraganaKatakana,  kKeyNone },
+    { KEY_ZENKAKUHANKAKU,   kKeyZenkaku,           kKeyNone },
+    { KEY_HANGEUL,          kKeyHangul,            kKeyNone },
+    { KEY_HANJA,            kKeyHanja,             kKeyNone },
+
+    { KEY_HELP,       kKeyHelp,  kKeyNone },
+    { KEY_UNDO,       kKeyUndo,  kKeyNone },
+    { KEY_REDO,       kKeyRedo,  kKeyNone },
+    { KEY_FIND,       kKeyFind,  kKeyNone },
+    { KEY_CANCEL,     kKeyCancel, kKeyNone },
+    { KEY_COPY,       kKeyCopy,  kKeyNone },
+    { KEY_CUT,        kKeyCut,   kKeyNone },
+    { KEY_PASTE,      kKeyPaste, kKeyNone },
+    { KEY_OPEN,       kKeyOpen,  kKeyNone },
+    { KEY_PROPS,      kKeyProps, kKeyNone },
+    { KEY_FRONT,      kKeyFront, kKeyNone },
+
+    { KEY_MUTE,           kKeyAudioMute,         kKeyNone },
+    { KEY_VOLUMEDOWN,     kKeyAudioDown,         kKeyNone },
+    { KEY_VOLUMEUP,       kKeyAudioUp,           kKeyNone },
+    { KEY_NEXTSONG,       kKeyAudioNext,         kKeyNone },
+    { KEY_PREVIOUSSONG,   kKeyAudioPrev,         kKeyNone },
+    { KEY_STOPCD,         kKeyAudioStop,         kKeyNone },
+    { KEY_PLAYPAUSE,      kKeyAudioPlay,         kKeyNone },
+    { KEY_EJECTCD,        kKeyEject,             kKeyNone },
+    { KEY_SLEEP,          kKeySleep,             kKeyNone },
+    { KEY_BACK,           kKeyWWWBack,           kKeyNone },
+    { KEY_FORWARD,        kKeyWWWForward,        kKeyNone },
+    { KEY_REFRESH,        kKeyWWWRefresh,        kKeyNone },
+    { KEY_STOP,           kKeyWWWStop,           kKeyNone },
+    { KEY_SEARCH,         kKeyWWWSearch,         kKeyNone },
+    { KEY_BOOKMARKS,      kKeyWWWFavorites,      kKeyNone },
+    { KEY_HOMEPAGE,       kKeyWWWHome,           kKeyNone },
+    { KEY_MAIL,           kKeyAppMail,           kKeyNone },
+    { KEY_MEDIA,          kKeyAppMedia,          kKeyNone },
+    { KEY_BRIGHTNESSDOWN, kKeyBrightnessDown,    kKeyNone },
+    { KEY_BRIGHTNESSUP,   kKeyBrightnessUp,      kKeyNone },
+    { KEY_KBDILLUMDOWN,   kKeyKbdBrightnessDown, kKeyNone },
+    { KEY_KBDILLUMUP,     kKeyKbdBrightnessUp,   kKeyNone },
+};
+
+enum KeyKind {
+    kNotMapped,
+    kLetter,
+    kKeypad,
+    kOther
+};
+
+struct CodeEntry {
+    KeyKind kind = kNotMapped;
+    const KeyEntry* entry = nullptr;
+};
+
+// the tables indexed by keycode, for mapping key events as they arrive
+class CodeTable {
+public:
+    CodeTable()
+    {
+        add(s_letters, sizeof(s_letters) / sizeof(s_letters[0]), kLetter);
+        add(s_keypad, sizeof(s_keypad) / sizeof(s_keypad[0]), kKeypad);
+        add(s_keys, sizeof(s_keys) / sizeof(s_keys[0]), kOther);
+    }
+
+    const CodeEntry& get(std::uint16_t code) const
+    {
+        static const CodeEntry s_none;
+        return code < KEY_CNT ? m_entries[code] : s_none;
+    }
+
+private:
+    void add(const KeyEntry* keys, std::size_t count, KeyKind kind)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            m_entries[keys[i].code].kind = kind;
+            m_entries[keys[i].code].entry = &keys[i];
+        }
+    }
+
+private:
+    CodeEntry m_entries[KEY_CNT];
+};
+
+void add_entry(KeyMap& keyMap, KeyMap::KeyItem& item, KeyID id, KeyModifierMask required)
+{
+    item.m_id = id;
+    item.m_required = required;
+    keyMap.addKeyEntry(item);
+}
+
+} // namespace
+
+void EvdevKeyTable::fill_key_map(KeyMap& keyMap)
+{
+    KeyMap::KeyItem item;
+    item.m_group = 0;
+    item.m_dead = false;
+    item.m_generates = 0;
+    item.m_lock = false;
+
+    // letters follow caps lock as well as shift
+    item.m_sensitive = KeyModifierShift | KeyModifierCapsLock;
+    for (const auto& key : s_letters) {
+        item.m_button = key.code;
+        item.m_client = key.code;
+        add_entry(keyMap, item, key.id, 0);
+        add_entry(keyMap, item, key.other_id, KeyModifierShift);
+        add_entry(keyMap, item, key.other_id, KeyModifierCapsLock);
+        add_entry(keyMap, item, key.id, KeyModifierShift | KeyModifierCapsLock);
+    }
+
+    // the keypad types digits only with num lock on
+    for (const auto& key : s_keypad) {
+        item.m_button = key.code;
+        item.m_client = key.code;
+        item.m_sensitive = KeyModifierNumLock | KeyModifierShift;
+        add_entry(keyMap, item, key.id, KeyModifierNumLock);
+        item.m_sensitive = KeyModifierNumLock;
+        add_entry(keyMap, item, key.other_id, 0);
+    }
+
+    for (const auto& key : s_keys) {
+        item.m_button = key.code;
+        item.m_client = key.code;
+        item.m_id = key.id;
+        KeyMap::initModifierKey(item);
+        item.m_sensitive = key.other_id != kKeyNone ? KeyModifierShift : 0;
+        add_entry(keyMap, item, key.id, 0);
+        if (key.other_id != kKeyNone) {
+            add_entry(keyMap, item, key.other_id, KeyModifierShift);
+        }
+    }
+}
+
+KeyID EvdevKeyTable::map_code(std::uint16_t code, KeyModifierMask mask)
+{
+    static const CodeTable s_table;
+    const CodeEntry& code_entry = s_table.get(code);
+    if (code_entry.kind == kNotMapped) {
+        return kKeyNone;
+    }
+
+    const KeyEntry& key = *code_entry.entry;
+    bool shift = (mask & KeyModifierShift) != 0;
+    switch (code_entry.kind) {
+    case kLetter:
+        return shift != ((mask & KeyModifierCapsLock) != 0) ? key.other_id : key.id;
+
+    case kKeypad:
+        return ((mask & KeyModifierNumLock) != 0 && !shift) ? key.id : key.other_id;
+
+    default:
+        return (shift && key.other_id != kKeyNone) ? key.other_id : key.id;
+    }
+}
+
+KeyModifierMask EvdevKeyTable::get_modifier(std::uint16_t code)
+{
+    switch (code) {
+    case KEY_LEFTSHIFT:
+    case KEY_RIGHTSHIFT:
+        return KeyModifierShift;
+
+    case KEY_LEFTCTRL:
+    case KEY_RIGHTCTRL:
+        return KeyModifierControl;
+
+    case KEY_LEFTALT:
+    case KEY_RIGHTALT:
+        return KeyModifierAlt;
+
+    case KEY_LEFTMETA:
+    case KEY_RIGHTMETA:
+        return KeyModifierSuper;
+
+    case KEY_CAPSLOCK:
+        return KeyModifierCapsLock;
+
+    case KEY_NUMLOCK:
+        return KeyModifierNumLock;
+
+    case KEY_SCROLLLOCK:
+        return KeyModifierScrollLock;
+
+    default:
+        return 0;
+    }
+}
+
+std::vector<std::uint16_t> EvdevKeyTable::get_codes()
+{
+    std::vector<std::uint16_t> codes;
+    for (const auto& key : s_letters) {
+        codes.push_back(key.code);
+    }
+    for (const auto& key : s_keypad) {
+        codes.push_back(key.code);
+    }
+    for (const auto& key : s_keys) {
+        codes.push_back(key.code);
+    }
+    return codes;
+}
+
+} // namespace inputleap
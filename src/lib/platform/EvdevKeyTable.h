@@ -0,0 +1,65 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "inputleap/KeyMap.h"
+#include "inputleap/key_types.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace inputleap {
+
+//! Built-in keyboard layout for evdev keycodes
+/*!
+Without a display server there's no keymap to ask, so Linux screens
+that talk to evdev directly use this US layout.  Keycodes are the
+\c KEY_* codes from \c linux/input-event-codes.h and are used as
+\c KeyButton values as is.
+*/
+class EvdevKeyTable {
+public:
+    //! Fill a key map
+    /*!
+    Adds an entry to \p keyMap for every KeyID the layout can produce.
+    The keycode is used as both the button and the client data.
+    */
+    static void fill_key_map(KeyMap& keyMap);
+
+    //! Map a keycode
+    /*!
+    Returns the KeyID the key with keycode \p code produces with the
+    modifiers in \p mask active, or \c kKeyNone if it isn't in the
+    layout.
+    */
+    static KeyID map_code(std::uint16_t code, KeyModifierMask mask);
+
+    //! Get the modifier a key generates
+    /*!
+    Returns the modifier generated by the key with keycode \p code, or 0
+    if it isn't a modifier key.
+    */
+    static KeyModifierMask get_modifier(std::uint16_t code);
+
+    //! Get all keycodes
+    /*!
+    Returns every keycode that appears in the layout.
+    */
+    static std::vector<std::uint16_t> get_codes();
+};
+
+} // namespace inputleap
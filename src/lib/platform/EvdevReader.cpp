@@ -0,0 +1,506 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/EvdevReader.h"
+
+#include "base/Log.h"
+#include "base/Time.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace inputleap {
+
+namespace {
+
+// wheel units per notch
+const std::int32_t kWheelNotch = 120;
+
+// priority of the reader thread when it may use SCHED_FIFO.  low enough
+// to stay out of the way of the kernel's own threads.
+const int kReaderPriority = 10;
+
+bool test_bit(const std::uint8_t* bits, unsigned bit)
+{
+    return (bits[bit / 8] & (1u << (bit % 8))) != 0;
+}
+
+} // namespace
+
+//
+// EvdevReader::Frame
+//
+
+bool EvdevReader::Frame::empty() const
+{
+    return dx == 0 && dy == 0 && wheel_x == 0 && wheel_y == 0 && keys.empty();
+}
+
+//
+// EvdevReader::FrameBuilder
+//
+
+bool EvdevReader::FrameBuilder::add(const input_event& event, Frame& frame)
+{
+    switch (event.type) {
+    case EV_REL:
+        switch (event.code) {
+        case REL_X:
+            frame_.dx += event.value;
+            break;
+
+        case REL_Y:
+            frame_.dy += event.value;
+            break;
+
+        case REL_WHEEL:
+            frame_.wheel_y += event.value * kWheelNotch;
+            break;
+
+        case REL_HWHEEL:
+            frame_.wheel_x += event.value * kWheelNotch;
+            break;
+
+#ifdef REL_WHEEL_HI_RES
+        case REL_WHEEL_HI_RES:
+            hi_res_y_ += event.value;
+            has_hi_res_y_ = true;
+            break;
+
+        case REL_HWHEEL_HI_RES:
+            hi_res_x_ += event.value;
+            has_hi_res_x_ = true;
+            break;
+#endif
+        }
+        return false;
+
+    case EV_KEY:
+        frame_.keys.push_back({ event.code, event.value });
+        return false;
+
+    case EV_SYN:
+        break;
+
+    default:
+        return false;
+    }
+
+    bool complete = false;
+    if (event.code == SYN_DROPPED) {
+        // the kernel's buffer overflowed.  throw away everything up to
+        // and including the next SYN_REPORT.
+        dropped_ = true;
+    }
+    else if (event.code == SYN_REPORT) {
+        if (dropped_) {
+            dropped_ = false;
+        }
+        else {
+            if (has_hi_res_x_) {
+                frame_.wheel_x = hi_res_x_;
+            }
+            if (has_hi_res_y_) {
+                frame_.wheel_y = hi_res_y_;
+            }
+            complete = !frame_.empty();
+            if (complete) {
+                frame = std::move(frame_);
+            }
+        }
+    }
+    else {
+        return false;
+    }
+
+    frame_ = Frame();
+    hi_res_x_ = 0;
+    hi_res_y_ = 0;
+    has_hi_res_x_ = false;
+    has_hi_res_y_ = false;
+    return complete;
+}
+
+//
+// EvdevReader
+//
+
+EvdevReader::EvdevReader(const std::vector<std::string>& paths, const std::string& input_dir) :
+    paths_(paths),
+    input_dir_(input_dir)
+{
+    // do nothing
+}
+
+EvdevReader::~EvdevReader()
+{
+    stop();
+}
+
+void EvdevReader::start(const std::function<void()>& notify)
+{
+    if (thread_.joinable()) {
+        return;
+    }
+    notify_ = notify;
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    inotify_fd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (epoll_fd_ < 0 || wake_fd_ < 0 || inotify_fd_ < 0) {
+        LOG_ERR("cannot watch input devices: %s", strerror(errno));
+    }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+    if (inotify_add_watch(inotify_fd_, input_dir_.c_str(), IN_CREATE | IN_ATTRIB) >= 0) {
+        event.data.fd = inotify_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, inotify_fd_, &event);
+    }
+    else {
+        LOG_WARN("cannot watch %s for new devices: %s", input_dir_.c_str(), strerror(errno));
+    }
+
+    open_devices();
+    thread_ = std::thread([this]() { reader_thread(); });
+}
+
+void EvdevReader::stop()
+{
+    if (thread_.joinable()) {
+        std::uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) {
+            LOG_WARN("cannot stop input thread: %s", strerror(errno));
+        }
+        thread_.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(devices_mutex_);
+        for (auto& device : devices_) {
+            close(device.first);
+        }
+        devices_.clear();
+    }
+
+    for (int* fd : { &epoll_fd_, &wake_fd_, &inotify_fd_ }) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void EvdevReader::set_grabbed(bool grabbed)
+{
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    if (grabbed_ == grabbed) {
+        return;
+    }
+    grabbed_ = grabbed;
+    for (auto& device : devices_) {
+        if (ioctl(device.first, EVIOCGRAB, grabbed ? 1 : 0) != 0) {
+            LOG_WARN("cannot %s %s: %s", grabbed ? "grab" : "release",
+                     device.second->path.c_str(), strerror(errno));
+        }
+    }
+}
+
+void EvdevReader::push_frame(Frame&& frame)
+{
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(frames_mutex_);
+        was_empty = frames_.empty();
+        frames_.push_back(std::move(frame));
+    }
+
+    // the main thread takes all queued frames at once so it only needs
+    // waking for the first
+    if (was_empty && notify_) {
+        notify_();
+    }
+}
+
+bool EvdevReader::pop_frames(std::vector<Frame>& frames)
+{
+    frames.clear();
+    std::lock_guard<std::mutex> lock(frames_mutex_);
+    frames.swap(frames_);
+    return !frames.empty();
+}
+
+void EvdevReader::reader_thread()
+{
+    raise_priority();
+
+    epoll_event events[16];
+    for (;;) {
+        int n = epoll_wait(epoll_fd_, events, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERR("cannot wait for input: %s", strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                return;
+            }
+            else if (fd == inotify_fd_) {
+                read_inotify();
+            }
+            else {
+                read_device(fd);
+            }
+        }
+    }
+}
+
+void EvdevReader::raise_priority()
+{
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = kReaderPriority;
+    int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (result == 0) {
+        LOG_DEBUG("input thread using SCHED_FIFO priority %d", kReaderPriority);
+        return;
+    }
+
+    // without CAP_SYS_NICE settle for the best nice level we can have
+    LOG_DEBUG("cannot use SCHED_FIFO for input thread: %s", strerror(result));
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    for (int nice = -20; nice < 0; ++nice) {
+        if (setpriority(PRIO_PROCESS, tid, nice) == 0) {
+            LOG_DEBUG("input thread using nice level %d", nice);
+            break;
+        }
+    }
+}
+
+void EvdevReader::open_devices()
+{
+    if (!paths_.empty()) {
+        for (const auto& path : paths_) {
+            open_device(path);
+        }
+        return;
+    }
+
+    DIR* dir = opendir(input_dir_.c_str());
+    if (dir == nullptr) {
+        LOG_ERR("cannot read %s: %s", input_dir_.c_str(), strerror(errno));
+        return;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (strncmp(entry->d_name, "event", 5) == 0) {
+            open_device(input_dir_ + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+}
+
+void EvdevReader::open_device(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(devices_mutex_);
+        for (const auto& device : devices_) {
+            if (device.second->path == path) {
+                return;
+            }
+        }
+    }
+
+    if (!paths_.empty() && std::find(paths_.begin(), paths_.end(), path) == paths_.end()) {
+        return;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        // new nodes are often not readable until udev has set them up,
+        // we'll try again when their attributes change
+        LOG_DEBUG1("cannot open %s: %s", path.c_str(), strerror(errno));
+        return;
+    }
+    if (!is_wanted(fd)) {
+        close(fd);
+        return;
+    }
+
+    std::unique_ptr<Device> device(new Device);
+    device->path = path;
+    device->fd = fd;
+
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    if (grabbed_ && ioctl(fd, EVIOCGRAB, 1) != 0) {
+        LOG_WARN("cannot grab %s: %s", path.c_str(), strerror(errno));
+    }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        LOG_WARN("cannot read %s: %s", path.c_str(), strerror(errno));
+        close(fd);
+        return;
+    }
+
+    LOG_INFO("reading input from %s", path.c_str());
+    devices_[fd] = std::move(device);
+}
+
+bool EvdevReader::is_wanted(int fd) const
+{
+    // never read back the devices we create to inject input
+    char name[256] = {};
+    ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name);
+    if (strncmp(name, "InputLeap virtual", 17) == 0) {
+        return false;
+    }
+
+    if (!paths_.empty()) {
+        return true;
+    }
+
+    // otherwise take keyboards and mice
+    std::uint8_t keys[KEY_MAX / 8 + 1] = {};
+    std::uint8_t rels[REL_MAX / 8 + 1] = {};
+    ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys);
+    ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rels)), rels);
+    bool keyboard = test_bit(keys, KEY_A) && test_bit(keys, KEY_SPACE);
+    bool mouse = test_bit(rels, REL_X) && test_bit(rels, REL_Y) && test_bit(keys, BTN_LEFT);
+    return keyboard || mouse;
+}
+
+void EvdevReader::close_device(int fd)
+{
+    Frame releases;
+    {
+        std::lock_guard<std::mutex> lock(devices_mutex_);
+        auto i = devices_.find(fd);
+        if (i == devices_.end()) {
+            return;
+        }
+        LOG_INFO("stopped reading input from %s", i->second->path.c_str());
+
+        // release whatever was held on the device so nothing is stuck
+        for (std::uint16_t code : i->second->keys_down) {
+            releases.keys.push_back({ code, 0 });
+        }
+        devices_.erase(i);
+    }
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    if (!releases.empty()) {
+        push_frame(std::move(releases));
+    }
+}
+
+void EvdevReader::read_device(int fd)
+{
+    Device* device;
+    {
+        std::lock_guard<std::mutex> lock(devices_mutex_);
+        auto i = devices_.find(fd);
+        if (i == devices_.end()) {
+            return;
+        }
+        device = i->second.get();
+    }
+
+    // only this thread removes devices, so the device stays valid
+    input_event events[64];
+    for (;;) {
+        ssize_t n = read(fd, events, sizeof(events));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                // ENODEV when unplugged
+                close_device(fd);
+            }
+            return;
+        }
+        if (n == 0) {
+            // nothing will ever come again
+            close_device(fd);
+            return;
+        }
+
+        std::size_t count = static_cast<std::size_t>(n) / sizeof(input_event);
+        for (std::size_t i = 0; i < count; ++i) {
+            Frame frame;
+            if (device->builder.add(events[i], frame)) {
+                for (const auto& key : frame.keys) {
+                    if (key.value == 0) {
+                        device->keys_down.erase(key.code);
+                    }
+                    else {
+                        device->keys_down.insert(key.code);
+                    }
+                }
+                frame.time = current_time_seconds();
+                push_frame(std::move(frame));
+            }
+        }
+        if (count < sizeof(events) / sizeof(events[0])) {
+            return;
+        }
+    }
+}
+
+void EvdevReader::read_inotify()
+{
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t n = read(inotify_fd_, buffer, sizeof(buffer));
+        if (n <= 0) {
+            return;
+        }
+
+        for (char* p = buffer; p < buffer + n; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            if (event->len > 0 && strncmp(event->name, "event", 5) == 0) {
+                open_device(input_dir_ + "/" + event->name);
+            }
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+
+} // namespace inputleap
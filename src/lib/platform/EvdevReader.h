@@ -0,0 +1,164 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/input.h>
+
+namespace inputleap {
+
+//! Reads input from evdev devices
+/*!
+Reads the keyboards and mice under \c /dev/input on a thread of its
+own, running at real time priority if the process is allowed to.  The
+events of each device are collected into one \c Frame per
+\c SYN_REPORT and queued for the main thread, which is notified
+through the callback given to \c start() whenever the queue stops being
+empty.  Devices that show up later are picked up through inotify.
+*/
+class EvdevReader {
+public:
+    //! A key or button going down, up or repeating
+    struct KeyChange {
+        std::uint16_t code;
+        std::int32_t value;
+    };
+
+    //! The input of one device between two \c SYN_REPORTs
+    struct Frame {
+        std::int32_t dx = 0;
+        std::int32_t dy = 0;
+        // in 120ths of a notch
+        std::int32_t wheel_x = 0;
+        std::int32_t wheel_y = 0;
+        std::vector<KeyChange> keys;
+        //! Time the frame was read, as returned by \c current_time_seconds()
+        double time = 0.0;
+
+        bool empty() const;
+    };
+
+    //! Collects the events of one device into frames
+    class FrameBuilder {
+    public:
+        //! Add an event
+        /*!
+        Returns true and fills \p frame when \p event completes a frame
+        that isn't empty.
+        */
+        bool add(const input_event& event, Frame& frame);
+
+    private:
+        Frame frame_;
+        // devices with high resolution wheels send both axes, the plain
+        // one only once a whole notch is done
+        std::int32_t hi_res_x_ = 0;
+        std::int32_t hi_res_y_ = 0;
+        bool has_hi_res_x_ = false;
+        bool has_hi_res_y_ = false;
+        bool dropped_ = false;
+    };
+
+    /*!
+    Reads the devices in \p paths, or every keyboard and mouse if
+    \p paths is empty.  Devices are looked for in \p input_dir, which
+    tests may point at a directory of their own.
+    */
+    explicit EvdevReader(const std::vector<std::string>& paths,
+                         const std::string& input_dir = "/dev/input");
+    EvdevReader(const EvdevReader&) = delete;
+    EvdevReader& operator=(const EvdevReader&) = delete;
+    ~EvdevReader();
+
+    //! @name manipulators
+    //@{
+
+    //! Start reading
+    /*!
+    Opens the devices and starts the reader thread.  \p notify is
+    called on the reader thread when frames are queued.
+    */
+    void start(const std::function<void()>& notify);
+
+    //! Stop reading
+    void stop();
+
+    //! Grab the devices
+    /*!
+    While grabbed, nothing but this reader gets input from the devices.
+    */
+    void set_grabbed(bool grabbed);
+
+    //! Queue a frame
+    void push_frame(Frame&& frame);
+
+    //! Take the queued frames
+    /*!
+    Moves the queued frames to \p frames.  Returns false if there were
+    none.
+    */
+    bool pop_frames(std::vector<Frame>& frames);
+
+    //@}
+
+private:
+    struct Device {
+        std::string path;
+        int fd;
+        FrameBuilder builder;
+        std::set<std::uint16_t> keys_down;
+    };
+
+    void reader_thread();
+    void raise_priority();
+    void open_devices();
+    void open_device(const std::string& path);
+    void close_device(int fd);
+    void read_device(int fd);
+    void read_inotify();
+    bool is_wanted(int fd) const;
+
+private:
+    std::vector<std::string> paths_;
+    std::string input_dir_;
+    std::function<void()> notify_;
+
+    int epoll_fd_ = -1;
+    int inotify_fd_ = -1;
+    int wake_fd_ = -1;
+    std::thread thread_;
+
+    // the devices are added and removed by the reader thread and grabbed
+    // by the main thread
+    std::mutex devices_mutex_;
+    std::map<int, std::unique_ptr<Device>> devices_;
+    bool grabbed_ = false;
+
+    std::mutex frames_mutex_;
+    std::vector<Frame> frames_;
+};
+
+} // namespace inputleap
@@ -0,0 +1,302 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/EvdevScreen.h"
+
+#include "platform/EvdevKeyTable.h"
+#include "platform/EvdevReader.h"
+#include "platform/UinputDevice.h"
+#include "platform/UinputKeyState.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+
+#include <algorithm>
+
+#include <linux/input-event-codes.h>
+
+namespace inputleap {
+
+namespace {
+
+// modifiers that take part in hot keys
+const KeyModifierMask kHotKeyModifiers = KeyModifierShift | KeyModifierControl |
+                                         KeyModifierAlt | KeyModifierMeta |
+                                         KeyModifierSuper | KeyModifierAltGr;
+
+ButtonID get_button_id(std::uint16_t code)
+{
+    switch (code) {
+    case BTN_LEFT:
+        return kButtonLeft;
+
+    case BTN_MIDDLE:
+        return kButtonMiddle;
+
+    case BTN_RIGHT:
+        return kButtonRight;
+
+    case BTN_SIDE:
+        return kButtonExtra0;
+
+    case BTN_EXTRA:
+        return kButtonExtra1;
+
+    default:
+        return kButtonNone;
+    }
+}
+
+// hot keys are matched without shift, so compare letters in lower case
+KeyID fold_case(KeyID id)
+{
+    return (id >= 'A' && id <= 'Z') ? id - 'A' + 'a' : id;
+}
+
+} // namespace
+
+EvdevScreen::EvdevScreen(const std::vector<std::string>& devices, std::int32_t width,
+                         std::int32_t height, IEventQueue* events) :
+    EvdevScreen(std::make_unique<EvdevReader>(devices), std::make_unique<UinputDevice>(),
+                std::make_unique<UinputDevice>(), width, height, events)
+{
+    // do nothing
+}
+
+EvdevScreen::EvdevScreen(std::unique_ptr<EvdevReader> reader,
+                         std::unique_ptr<UinputDevice> keyboard,
+                         std::unique_ptr<UinputDevice> pointer,
+                         std::int32_t width, std::int32_t height, IEventQueue* events) :
+    UinputScreen(std::move(keyboard), std::move(pointer), width, height, events),
+    reader_(std::move(reader))
+{
+    // do nothing
+}
+
+EvdevScreen::~EvdevScreen()
+{
+    reader_->stop();
+}
+
+void EvdevScreen::warpCursor(std::int32_t x, std::int32_t y)
+{
+    // move the real cursor too so that it agrees with our idea of it
+    UinputScreen::fakeMouseMove(x, y);
+}
+
+std::uint32_t EvdevScreen::registerHotKey(KeyID key, KeyModifierMask mask)
+{
+    if (key == kKeyNone) {
+        LOG_WARN("modifier only hot keys are not supported");
+        return 0;
+    }
+
+    std::uint32_t id = next_hot_key_id_++;
+    hot_keys_[id] = HotKey{ fold_case(key), mask & kHotKeyModifiers };
+    LOG_DEBUG("registered hotkey %x with mask %x as id=%d", key, mask, id);
+    return id;
+}
+
+void EvdevScreen::unregisterHotKey(std::uint32_t id)
+{
+    hot_keys_.erase(id);
+    for (auto i = hot_keys_down_.begin(); i != hot_keys_down_.end(); ) {
+        if (i->second == id) {
+            i = hot_keys_down_.erase(i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+std::int32_t EvdevScreen::getJumpZoneSize() const
+{
+    return 1;
+}
+
+void EvdevScreen::enable()
+{
+    events_->add_handler(EventType::PRIMARY_SCREEN_INPUT_READY, get_event_target(),
+                         [this](const auto& e) { handle_system_event(e); });
+
+    // the reader thread only wakes us up, the frames are taken from the
+    // reader on this thread
+    reader_->start([this]() {
+        events_->add_event(EventType::PRIMARY_SCREEN_INPUT_READY, get_event_target());
+    });
+}
+
+void EvdevScreen::disable()
+{
+    reader_->stop();
+    events_->remove_handler(EventType::PRIMARY_SCREEN_INPUT_READY, get_event_target());
+}
+
+void EvdevScreen::enter()
+{
+    reader_->set_grabbed(false);
+    is_on_screen_ = true;
+}
+
+void EvdevScreen::leave()
+{
+    // take the input away from the local desktop while it's being sent
+    // to another screen
+    reader_->set_grabbed(true);
+    is_on_screen_ = false;
+}
+
+bool EvdevScreen::isPrimary() const
+{
+    return true;
+}
+
+void EvdevScreen::handle_system_event(const Event&)
+{
+    std::vector<EvdevReader::Frame> frames;
+    if (!reader_->pop_frames(frames)) {
+        return;
+    }
+
+    for (const auto& frame : frames) {
+        if (frame.dx != 0 || frame.dy != 0) {
+            on_motion(frame.dx, frame.dy, frame.time);
+        }
+        if (frame.wheel_x != 0 || frame.wheel_y != 0) {
+            LOG_DEBUG1("event: button wheel delta=%+d,%+d", frame.wheel_x, frame.wheel_y);
+            send_event(EventType::PRIMARY_SCREEN_WHEEL,
+                       create_event_data<WheelInfo>(WheelInfo{frame.wheel_x, frame.wheel_y}));
+        }
+        for (const auto& key : frame.keys) {
+            if (key.code >= BTN_MOUSE && key.code < BTN_JOYSTICK) {
+                if (key.value != 2) {
+                    on_button(key.code, key.value != 0);
+                }
+            }
+            else {
+                on_key(key.code, key.value);
+            }
+        }
+    }
+}
+
+void EvdevScreen::on_motion(std::int32_t dx, std::int32_t dy, double time)
+{
+    if (is_on_screen_) {
+        // the desktop moves the real cursor, we follow it without any
+        // pointer acceleration
+        x_ = std::max(0, std::min(x_ + dx, width_ - 1));
+        y_ = std::max(0, std::min(y_ + dy, height_ - 1));
+        send_event(EventType::PRIMARY_SCREEN_MOTION_ON_PRIMARY,
+                   create_event_data<MotionInfo>(MotionInfo{x_, y_, time}));
+    }
+    else {
+        send_event(EventType::PRIMARY_SCREEN_MOTION_ON_SECONDARY,
+                   create_event_data<MotionInfo>(MotionInfo{dx, dy, time}));
+    }
+}
+
+void EvdevScreen::on_button(std::uint16_t code, bool press)
+{
+    ButtonID button = get_button_id(code);
+    if (button == kButtonNone) {
+        return;
+    }
+
+    if (press) {
+        buttons_ |= 1u << button;
+    }
+    else {
+        buttons_ &= ~(1u << button);
+    }
+
+    KeyModifierMask mask = key_state_->getActiveModifiers();
+    if (press) {
+        LOG_DEBUG1("event: button press button=%d", button);
+        send_event(EventType::PRIMARY_SCREEN_BUTTON_DOWN,
+                   create_event_data<ButtonInfo>(ButtonInfo{button, mask}));
+    }
+    else {
+        LOG_DEBUG1("event: button release button=%d", button);
+        send_event(EventType::PRIMARY_SCREEN_BUTTON_UP,
+                   create_event_data<ButtonInfo>(ButtonInfo{button, mask}));
+    }
+}
+
+void EvdevScreen::on_key(std::uint16_t code, std::int32_t value)
+{
+    LOG_DEBUG1("event: key code=%d value=%d", code, value);
+
+    KeyButton button = code;
+    bool press = value != 0;
+    bool repeat = value == 2;
+
+    // record keyboard state
+    if (!repeat) {
+        key_state_->record_key(button, press);
+    }
+    KeyModifierMask state = key_state_->pollActiveModifiers();
+    key_state_->onKey(button, press, state);
+
+    if (on_hot_key(code, press, repeat, state)) {
+        return;
+    }
+
+    KeyID key = EvdevKeyTable::map_code(code, state);
+    if (key == kKeyNone) {
+        LOG_DEBUG1("cannot map key");
+        return;
+    }
+    key_state_->sendKeyEvent(get_event_target(), press, repeat, key, state, 1, button);
+}
+
+bool EvdevScreen::on_hot_key(std::uint16_t code, bool press, bool repeat,
+                             KeyModifierMask state)
+{
+    auto down = hot_keys_down_.find(code);
+    if (down != hot_keys_down_.end()) {
+        if (!press) {
+            send_event(EventType::PRIMARY_SCREEN_HOTKEY_UP,
+                       create_event_data<HotKeyInfo>(HotKeyInfo{down->second}));
+            hot_keys_down_.erase(down);
+        }
+
+        // ignore key repeats but it counts as a hot key
+        return true;
+    }
+    if (!press || repeat || hot_keys_.empty()) {
+        return false;
+    }
+
+    KeyID key = fold_case(EvdevKeyTable::map_code(code, 0));
+    KeyModifierMask mask = state & kHotKeyModifiers;
+    for (const auto& hot_key : hot_keys_) {
+        if (hot_key.second.key == key && hot_key.second.mask == mask) {
+            hot_keys_down_[code] = hot_key.first;
+            send_event(EventType::PRIMARY_SCREEN_HOTKEY_DOWN,
+                       create_event_data<HotKeyInfo>(HotKeyInfo{hot_key.first}));
+            return true;
+        }
+    }
+    return false;
+}
+
+void EvdevScreen::send_event(EventType type, EventDataBase* data)
+{
+    events_->add_event(type, get_event_target(), data);
+}
+
+} // namespace inputleap
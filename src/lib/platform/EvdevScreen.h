@@ -0,0 +1,89 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "platform/UinputScreen.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace inputleap {
+
+class EvdevReader;
+
+//! Implementation of IPlatformScreen for a Linux primary screen
+/*!
+Captures the local keyboards and mice with an EvdevReader and grabs
+them while the cursor is on another screen.  Evdev only reports motion,
+so the cursor position on this screen is tracked from the deltas and
+warps are done with the uinput pointer.
+*/
+class EvdevScreen : public UinputScreen {
+public:
+    EvdevScreen(const std::vector<std::string>& devices, std::int32_t width, std::int32_t height,
+                IEventQueue* events);
+    EvdevScreen(std::unique_ptr<EvdevReader> reader, std::unique_ptr<UinputDevice> keyboard,
+                std::unique_ptr<UinputDevice> pointer, std::int32_t width, std::int32_t height,
+                IEventQueue* events);
+    ~EvdevScreen() override;
+
+    // IPrimaryScreen overrides
+    void warpCursor(std::int32_t x, std::int32_t y) override;
+    std::uint32_t registerHotKey(KeyID key, KeyModifierMask mask) override;
+    void unregisterHotKey(std::uint32_t id) override;
+    std::int32_t getJumpZoneSize() const override;
+
+    // IPlatformScreen overrides
+    void enable() override;
+    void disable() override;
+    void enter() override;
+    void leave() override;
+    bool isPrimary() const override;
+
+protected:
+    // IPlatformScreen overrides
+    void handle_system_event(const Event& event) override;
+
+private:
+    struct HotKey {
+        KeyID key;
+        KeyModifierMask mask;
+    };
+
+    void on_motion(std::int32_t dx, std::int32_t dy, double time);
+    void on_button(std::uint16_t code, bool press);
+    void on_key(std::uint16_t code, std::int32_t value);
+
+    // send a hot key event if the key is part of one.  returns true if
+    // it was.
+    bool on_hot_key(std::uint16_t code, bool press, bool repeat, KeyModifierMask state);
+
+    void send_event(EventType type, EventDataBase* data = nullptr);
+
+private:
+    std::unique_ptr<EvdevReader> reader_;
+    bool is_on_screen_ = true;
+
+    std::map<std::uint32_t, HotKey> hot_keys_;
+    std::uint32_t next_hot_key_id_ = 1;
+
+    // keys that went down as a hot key, and which one
+    std::map<std::uint16_t, std::uint32_t> hot_keys_down_;
+};
+
+} // namespace inputleap
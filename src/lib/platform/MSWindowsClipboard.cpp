@@ -115,6 +115,43 @@ MSWindowsClipboard::add(EFormat format, const std::string& data)
     }
 }
 
+void MSWindowsClipboard::add_delayed(EFormat format)
+{
+    LOG_DEBUG("add delayed clipboard format: %d", format);
+
+    for (auto index = m_converters.begin(); index != m_converters.end(); ++index) {
+        IMSWindowsClipboardConverter* converter = *index;
+        if (converter->getFormat() == format) {
+            m_facade->write(nullptr, converter->getWin32Format());
+        }
+    }
+}
+
+bool MSWindowsClipboard::render(UINT win32Format, const IClipboard* src)
+{
+    for (auto index = m_converters.begin(); index != m_converters.end(); ++index) {
+        IMSWindowsClipboardConverter* converter = *index;
+        if (converter->getWin32Format() != win32Format) {
+            continue;
+        }
+
+        HANDLE win32Data = nullptr;
+        if (src->open(0)) {
+            if (src->has(converter->getFormat())) {
+                win32Data = converter->fromIClipboard(src->get(converter->getFormat()));
+            }
+            src->close();
+        }
+        if (win32Data == nullptr) {
+            return false;
+        }
+        LOG_DEBUG("render clipboard format: %d", converter->getFormat());
+        m_facade->write(win32Data, win32Format);
+        return true;
+    }
+    return false;
+}
+
 bool
 MSWindowsClipboard::open(Time time) const
 {
@@ -56,6 +56,22 @@ public:
     //! Test if clipboard is owned by InputLeap
     static bool is_owned_by_us();
 
+    //! Add format without data
+    /*!
+    Offer \p format on the clipboard without its data.  The window gets
+    WM_RENDERFORMAT when an application asks for it.  May only be called
+    after a successful clear().
+    */
+    void add_delayed(EFormat format);
+
+    //! Render delayed format
+    /*!
+    Put the data of \p src on the clipboard in the win32 format
+    \p win32Format, in reply to WM_RENDERFORMAT.  The clipboard must not
+    be opened for this.  Returns false if \p src has no data for it.
+    */
+    bool render(UINT win32Format, const IClipboard* src);
+
     // IClipboard overrides
     virtual bool clear();
     virtual void add(EFormat, const std::string& data);
@@ -18,6 +18,8 @@
 
 #include "platform/MSWindowsClipboardAnyTextConverter.h"
 
+#include "inputleap/ClipboardCodec.h"
+
 namespace inputleap {
 
 MSWindowsClipboardAnyTextConverter::MSWindowsClipboardAnyTextConverter()
@@ -39,7 +41,7 @@ MSWindowsClipboardAnyTextConverter::getFormat() const
 HANDLE MSWindowsClipboardAnyTextConverter::fromIClipboard(const std::string& data) const
 {
     // convert linefeeds and then convert to desired encoding
-    std::string text = doFromIClipboard(convertLinefeedToWin32(data));
+    std::string text = doFromIClipboard(clipboard_codec::lf_to_crlf(data));
     std::uint32_t size = (std::uint32_t)text.size();
 
     // copy to memory handle
@@ -76,68 +78,7 @@ std::string MSWindowsClipboardAnyTextConverter::toIClipboard(HANDLE data) const
     GlobalUnlock(data);
 
     // convert newlines
-    return convertLinefeedToUnix(text);
-}
-
-std::string MSWindowsClipboardAnyTextConverter::convertLinefeedToWin32(const std::string& src) const
-{
-    // note -- we assume src is a valid UTF-8 string
-
-    // count newlines in string
-    std::uint32_t numNewlines = 0;
-    std::uint32_t n = (std::uint32_t)src.size();
-    for (const char* scan = src.c_str(); n > 0; ++scan, --n) {
-        if (*scan == '\n') {
-            ++numNewlines;
-        }
-    }
-    if (numNewlines == 0) {
-        return src;
-    }
-
-    // allocate new string
-    std::string dst;
-    dst.reserve(src.size() + numNewlines);
-
-    // copy string, converting newlines
-    n = (std::uint32_t)src.size();
-    for (const char* scan = src.c_str(); n > 0; ++scan, --n) {
-        if (scan[0] == '\n') {
-            dst += '\r';
-        }
-        dst += scan[0];
-    }
-
-    return dst;
-}
-
-std::string MSWindowsClipboardAnyTextConverter::convertLinefeedToUnix(const std::string& src) const
-{
-    // count newlines in string
-    std::uint32_t numNewlines = 0;
-    std::uint32_t n = (std::uint32_t)src.size();
-    for (const char* scan = src.c_str(); n > 0; ++scan, --n) {
-        if (scan[0] == '\r' && scan[1] == '\n') {
-            ++numNewlines;
-        }
-    }
-    if (numNewlines == 0) {
-        return src;
-    }
-
-    // allocate new string
-    std::string dst;
-    dst.reserve(src.size());
-
-    // copy string, converting newlines
-    n = (std::uint32_t)src.size();
-    for (const char* scan = src.c_str(); n > 0; ++scan, --n) {
-        if (scan[0] != '\r' || scan[1] != '\n') {
-            dst += scan[0];
-        }
-    }
-
-    return dst;
+    return clipboard_codec::crlf_to_lf(std::move(text));
 }
 
 } // namespace inputleap
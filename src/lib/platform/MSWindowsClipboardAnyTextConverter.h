@@ -51,10 +51,6 @@ protected:
     linefeed conversion is done by this class.
     */
     virtual std::string doToIClipboard(const std::string&) const = 0;
-
-private:
-    std::string convertLinefeedToWin32(const std::string&) const;
-    std::string convertLinefeedToUnix(const std::string&) const;
 };
 
 } // namespace inputleap
@@ -18,6 +18,7 @@
 
 #include "platform/MSWindowsClipboardBitmapConverter.h"
 
+#include "inputleap/ClipboardCodec.h"
 #include "base/Log.h"
 
 namespace inputleap {
@@ -78,12 +79,14 @@ std::string MSWindowsClipboardBitmapConverter::toIClipboard(HANDLE data) const
     LOG_INFO("bitmap: %dx%d %d", bitmap->bmiHeader.biWidth, bitmap->bmiHeader.biHeight, (int)bitmap->bmiHeader.biBitCount);
     if (bitmap->bmiHeader.biPlanes == 1 &&
         (bitmap->bmiHeader.biBitCount == 24 ||
-        bitmap->bmiHeader.biBitCount == 32) &&
-        bitmap->bmiHeader.biCompression == BI_RGB) {
-        // already in canonical form
-        std::string image(static_cast<char const*>(src), srcSize);
-        GlobalUnlock(data);
-        return image;
+        bitmap->bmiHeader.biBitCount == 32)) {
+        // canonical form or close enough to convert without GDI
+        std::string image = clipboard_codec::convert_dib(
+            std::string(static_cast<char const*>(src), srcSize), bitmap->bmiHeader.biBitCount);
+        if (!image.empty()) {
+            GlobalUnlock(data);
+            return image;
+        }
     }
 
     // create a destination DIB section
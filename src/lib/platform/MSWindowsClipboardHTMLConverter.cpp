@@ -18,7 +18,7 @@
 
 #include "platform/MSWindowsClipboardHTMLConverter.h"
 
-#include "base/String.h"
+#include "inputleap/ClipboardCodec.h"
 
 namespace inputleap {
 
@@ -46,72 +46,12 @@ MSWindowsClipboardHTMLConverter::getWin32Format() const
 
 std::string MSWindowsClipboardHTMLConverter::doFromIClipboard(const std::string& data) const
 {
-    // prepare to CF_HTML format prefix and suffix
-    std::string prefix("Version:0.9\r\nStartHTML:0000000105\r\n"
-                    "EndHTML:ZZZZZZZZZZ\r\n"
-                    "StartFragment:XXXXXXXXXX\r\nEndFragment:YYYYYYYYYY\r\n"
-                    "<!DOCTYPE><HTML><BODY><!--StartFragment-->");
-    std::string suffix("<!--EndFragment--></BODY></HTML>\r\n");
-
-    // Get byte offsets for header
-    std::uint32_t StartFragment = (std::uint32_t)prefix.size();
-    std::uint32_t EndFragment = StartFragment + (std::uint32_t)data.size();
-    // StartHTML is constant by the design of the prefix
-    std::uint32_t EndHTML = EndFragment + (std::uint32_t)suffix.size();
-
-    prefix.replace(prefix.find("XXXXXXXXXX"), 10,
-                            inputleap::string::sprintf("%010u", StartFragment));
-    prefix.replace(prefix.find("YYYYYYYYYY"), 10,
-                            inputleap::string::sprintf("%010u", EndFragment));
-    prefix.replace(prefix.find("ZZZZZZZZZZ"), 10,
-                            inputleap::string::sprintf("%010u", EndHTML));
-
-    // concatenate
-    prefix += data;
-    prefix += suffix;
-    return prefix;
+    return clipboard_codec::html_to_cf_html(data);
 }
 
 std::string MSWindowsClipboardHTMLConverter::doToIClipboard(const std::string& data) const
 {
-    // get fragment start/end args
-    std::string startArg = findArg(data, "StartFragment");
-    std::string endArg   = findArg(data, "EndFragment");
-    if (startArg.empty() || endArg.empty()) {
-        return std::string();
-    }
-
-    // convert args to integers
-    std::int32_t start = (std::int32_t)atoi(startArg.c_str());
-    std::int32_t end   = (std::int32_t)atoi(endArg.c_str());
-    if (start <= 0 || end <= 0 || start >= end) {
-        return std::string();
-    }
-
-    // extract the fragment
-    return data.substr(start, end - start);
-}
-
-std::string MSWindowsClipboardHTMLConverter::findArg(const std::string& data,
-                                                     const std::string& name) const
-{
-    std::string::size_type i = data.find(name);
-    if (i == std::string::npos) {
-        return std::string();
-    }
-    i = data.find_first_of(":\r\n", i);
-    if (i == std::string::npos || data[i] != ':') {
-        return std::string();
-    }
-    i = data.find_first_of("0123456789\r\n", i + 1);
-    if (i == std::string::npos || data[i] == '\r' || data[i] == '\n') {
-        return std::string();
-    }
-    std::string::size_type j = data.find_first_not_of("0123456789", i);
-    if (j == std::string::npos) {
-        j = data.size();
-    }
-    return data.substr(i, j - i);
+    return clipboard_codec::cf_html_to_html(data);
 }
 
 } // namespace inputleap
@@ -38,9 +38,6 @@ protected:
     virtual std::string doFromIClipboard(const std::string&) const;
     virtual std::string doToIClipboard(const std::string&) const;
 
-private:
-    std::string findArg(const std::string& data, const std::string& name) const;
-
 private:
     UINT m_format;
 };
@@ -90,6 +90,8 @@ namespace inputleap {
 #define INPUTLEAP_MSG_FAKE_REL_MOVE INPUTLEAP_HOOK_LAST_MSG + 11
 // enable; <unused>
 #define INPUTLEAP_MSG_FAKE_INPUT INPUTLEAP_HOOK_LAST_MSG + 12
+// std::vector<INPUT>*; <unused>
+#define INPUTLEAP_MSG_FAKE_KEYS INPUTLEAP_HOOK_LAST_MSG + 13
 
 //
 // MSWindowsDesks
@@ -257,6 +259,35 @@ MSWindowsDesks::fakeKeyEvent(
                                 static_cast<BYTE>(virtualKey & 0xffu)));
 }
 
+void
+MSWindowsDesks::fakeKeyEvents(const std::vector<KeyEvent>& events) const
+{
+    if (events.empty()) {
+        return;
+    }
+
+    // same as fakeKeyEvent() but for SendInput()
+    std::vector<INPUT> inputs(events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        const KeyEvent& event = events[i];
+        INPUT& input = inputs[i];
+        memset(&input, 0, sizeof(input));
+        input.type       = INPUT_KEYBOARD;
+        input.ki.wVk     = static_cast<WORD>(event.m_virtualKey & 0xffu);
+        input.ki.wScan   = static_cast<WORD>(event.m_button & 0xffu);
+        input.ki.dwFlags = 0;
+        if (((event.m_button & 0x100u) != 0)) {
+            input.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+        }
+        if (!event.m_press) {
+            input.ki.dwFlags |= KEYEVENTF_KEYUP;
+        }
+    }
+
+    // the desk thread is done with inputs when sendMessage() returns
+    sendMessage(INPUTLEAP_MSG_FAKE_KEYS, reinterpret_cast<WPARAM>(&inputs), 0);
+}
+
 void
 MSWindowsDesks::fakeMouseButton(ButtonID button, bool press)
 {
@@ -658,6 +689,12 @@ void MSWindowsDesks::desk_thread(Desk* desk)
             keybd_event(HIBYTE(msg.lParam), LOBYTE(msg.lParam), (DWORD)msg.wParam, 0);
             break;
 
+        case INPUTLEAP_MSG_FAKE_KEYS: {
+            std::vector<INPUT>* inputs = reinterpret_cast<std::vector<INPUT>*>(msg.wParam);
+            SendInput(static_cast<UINT>(inputs->size()), inputs->data(), sizeof(INPUT));
+            break;
+        }
+
         case INPUTLEAP_MSG_FAKE_BUTTON:
             if (msg.wParam != 0) {
                 mouse_event((DWORD)msg.wParam, 0, 0, (DWORD)msg.lParam, 0);
@@ -29,6 +29,7 @@
 #include <functional>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -57,6 +58,13 @@ object don't have to know anything about desks.
 */
 class MSWindowsDesks {
 public:
+    //! A synthesized key press or release
+    struct KeyEvent {
+        KeyButton m_button;
+        UINT m_virtualKey;
+        bool m_press;
+    };
+
     //! Constructor
     /*!
     \p isPrimary is true iff the desk is for a primary screen.
@@ -166,6 +174,13 @@ public:
     void fakeKeyEvent(KeyButton button, UINT virtualKey,
                             bool press, bool isAutoRepeat) const;
 
+    //! Fake a sequence of key presses/releases
+    /*!
+    Synthesize the presses and releases in \c events, in order, with a
+    single call to the system.
+    */
+    void fakeKeyEvents(const std::vector<KeyEvent>& events) const;
+
     //! Fake mouse press/release
     /*!
     Synthesize a press or release of mouse button \c id.
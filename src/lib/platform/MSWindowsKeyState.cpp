@@ -1203,35 +1203,12 @@ MSWindowsKeyState::fakeKey(const Keystroke& keystroke)
 {
 	switch (keystroke.m_type) {
 	case Keystroke::kButton: {
-		LOG_DEBUG1("  %03x (%08x) %s", keystroke.m_data.m_button.m_button, keystroke.m_data.m_button.m_client, keystroke.m_data.m_button.m_press ? "down" : "up");
-		KeyButton button = keystroke.m_data.m_button.m_button;
-
-		// windows doesn't send key ups for key repeats
-		if (keystroke.m_data.m_button.m_repeat &&
-			!keystroke.m_data.m_button.m_press) {
-			LOG_DEBUG1("  discard key repeat release");
-			break;
+		MSWindowsDesks::KeyEvent event;
+		if (getKeyEvent(keystroke, event)) {
+			m_desks->fakeKeyEvent(event.m_button, event.m_virtualKey,
+									event.m_press,
+									keystroke.m_data.m_button.m_repeat);
 		}
-
-		// get the virtual key for the button
-		UINT vk = keystroke.m_data.m_button.m_client;
-
-		// special handling of VK_SNAPSHOT
-		if (vk == VK_SNAPSHOT) {
-			if ((getActiveModifiers() & KeyModifierAlt) != 0) {
-				// snapshot active window
-				button = 1;
-			}
-			else {
-				// snapshot full screen
-				button = 0;
-			}
-		}
-
-		// synthesize event
-		m_desks->fakeKeyEvent(button, vk,
-								keystroke.m_data.m_button.m_press,
-								keystroke.m_data.m_button.m_repeat);
 		break;
 	}
 
@@ -1254,6 +1231,65 @@ MSWindowsKeyState::fakeKey(const Keystroke& keystroke)
 	}
 }
 
+void
+MSWindowsKeyState::fakeKeyBatch(const Keystroke* keystrokes, std::size_t count)
+{
+	// send runs of key events to the desk with one SendInput().  group
+	// changes must be done in between.
+	std::vector<MSWindowsDesks::KeyEvent> events;
+	events.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		const Keystroke& keystroke = keystrokes[i];
+		if (keystroke.m_type != Keystroke::kButton) {
+			m_desks->fakeKeyEvents(events);
+			events.clear();
+			fakeKey(keystroke);
+			continue;
+		}
+
+		MSWindowsDesks::KeyEvent event;
+		if (getKeyEvent(keystroke, event)) {
+			events.push_back(event);
+		}
+	}
+	m_desks->fakeKeyEvents(events);
+}
+
+bool
+MSWindowsKeyState::getKeyEvent(const Keystroke& keystroke,
+				MSWindowsDesks::KeyEvent& event) const
+{
+	LOG_DEBUG1("  %03x (%08x) %s", keystroke.m_data.m_button.m_button, keystroke.m_data.m_button.m_client, keystroke.m_data.m_button.m_press ? "down" : "up");
+	KeyButton button = keystroke.m_data.m_button.m_button;
+
+	// windows doesn't send key ups for key repeats
+	if (keystroke.m_data.m_button.m_repeat &&
+		!keystroke.m_data.m_button.m_press) {
+		LOG_DEBUG1("  discard key repeat release");
+		return false;
+	}
+
+	// get the virtual key for the button
+	UINT vk = keystroke.m_data.m_button.m_client;
+
+	// special handling of VK_SNAPSHOT
+	if (vk == VK_SNAPSHOT) {
+		if ((getActiveModifiers() & KeyModifierAlt) != 0) {
+			// snapshot active window
+			button = 1;
+		}
+		else {
+			// snapshot full screen
+			button = 0;
+		}
+	}
+
+	event.m_button     = button;
+	event.m_virtualKey = vk;
+	event.m_press      = keystroke.m_data.m_button.m_press;
+	return true;
+}
+
 KeyModifierMask&
 MSWindowsKeyState::getActiveModifiersRValue()
 {
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "platform/MSWindowsDesks.h"
 #include "base/Fwd.h"
 #include "inputleap/KeyState.h"
 
@@ -28,8 +29,6 @@
 
 namespace inputleap {
 
-class MSWindowsDesks;
-
 //! Microsoft Windows key mapper
 /*!
 This class maps KeyIDs to keystrokes.
@@ -162,6 +161,7 @@ protected:
 	// KeyState overrides
 	virtual void		getKeyMap(inputleap::KeyMap& keyMap);
 	virtual void		fakeKey(const Keystroke& keystroke);
+	void fakeKeyBatch(const Keystroke* keystrokes, std::size_t count) override;
 	virtual KeyModifierMask&
 						getActiveModifiersRValue();
 
@@ -180,6 +180,10 @@ private:
 
 	void				addKeyEntry(inputleap::KeyMap& keyMap, inputleap::KeyMap::KeyItem& item);
 
+	// converts a button keystroke to the event to synthesize.  returns
+	// false if the keystroke should be discarded.
+	bool getKeyEvent(const Keystroke& keystroke, MSWindowsDesks::KeyEvent& event) const;
+
 	void				init();
 
 private:
@@ -38,6 +38,8 @@
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 #include "base/EventQueueTimer.h"
+#include "base/NestedEventLoop.h"
+#include "base/Stopwatch.h"
 #include "base/Time.h"
 
 #include <string.h>
@@ -83,6 +85,10 @@
 
 namespace inputleap {
 
+// time an application pasting a clipboard offered by its formats waits for
+// the data to arrive (in seconds)
+static const double kClipboardRenderTimeout = 5.0;
+
 HINSTANCE MSWindowsScreen::s_windowInstance = nullptr;
 MSWindowsScreen* MSWindowsScreen::s_screen  = nullptr;
 
@@ -382,8 +388,18 @@ void MSWindowsScreen::send_drag_thread()
 }
 
 bool
-MSWindowsScreen::setClipboard(ClipboardID, const IClipboard* src)
-{
+MSWindowsScreen::setClipboard(ClipboardID id, const IClipboard* src)
+{
+    // the data of the clipboard offered by its formats, rendered when
+    // applications paste it
+    if (src != nullptr && lazy_clipboard_ && lazy_clipboard_requested_ &&
+            id == lazy_clipboard_id_) {
+        Clipboard::copy(&lazy_clipboard_data_, src);
+        lazy_clipboard_requested_ = false;
+        lazy_clipboard_received_ = true;
+        return true;
+    }
+
     MSWindowsClipboard dst(m_window);
     if (src != nullptr) {
         // save clipboard data
@@ -400,6 +416,91 @@ MSWindowsScreen::setClipboard(ClipboardID, const IClipboard* src)
     }
 }
 
+bool MSWindowsScreen::set_clipboard_formats(ClipboardID id,
+                                            const std::vector<IClipboard::EFormat>& formats)
+{
+    // emptying the clipboard drops the formats offered before
+    MSWindowsClipboard dst(m_window);
+    if (!dst.open(0)) {
+        return false;
+    }
+    bool offered = dst.clear();
+    if (offered) {
+        for (auto format : formats) {
+            dst.add_delayed(format);
+        }
+    }
+    dst.close();
+    if (!offered) {
+        return false;
+    }
+
+    lazy_clipboard_ = true;
+    ++lazy_clipboard_offer_;
+    lazy_clipboard_id_ = id;
+    lazy_clipboard_requested_ = false;
+    lazy_clipboard_received_ = false;
+    return true;
+}
+
+void MSWindowsScreen::render_clipboard(UINT win32Format)
+{
+    if (!lazy_clipboard_) {
+        return;
+    }
+
+    // the application waits until we return and the data comes in through
+    // the event loop we were called from, so handle events until the data
+    // arrived.  that runs handlers re-entrantly, see
+    // run_nested_event_loop():  another WM_RENDERFORMAT meanwhile gets
+    // nothing, and if the clipboard is emptied or offered anew while
+    // waiting this paste gets nothing either.
+    if (!lazy_clipboard_received_ && !lazy_clipboard_requested_) {
+        LOG_DEBUG("clipboard pasted, asking for its data");
+        lazy_clipboard_requested_ = true;
+        sendClipboardEvent(EventType::CLIPBOARD_REQUESTED, lazy_clipboard_id_);
+
+        std::uint32_t offer = lazy_clipboard_offer_;
+        bool done = run_nested_event_loop(m_events, kClipboardRenderTimeout, [&]() {
+            return !lazy_clipboard_ || lazy_clipboard_received_ ||
+                    lazy_clipboard_offer_ != offer;
+        });
+        if (!done) {
+            // keep waiting for it in the background, later pastes get it
+            LOG_WARN("clipboard data didn't arrive in time");
+            return;
+        }
+        if (lazy_clipboard_offer_ != offer) {
+            return;
+        }
+    }
+
+    if (lazy_clipboard_received_) {
+        MSWindowsClipboard dst(m_window);
+        dst.render(win32Format, &lazy_clipboard_data_);
+    }
+}
+
+void MSWindowsScreen::render_all_clipboard_formats()
+{
+    // we're going away.  leave what we have on the clipboard, formats
+    // without data are dropped.
+    if (!lazy_clipboard_ || !lazy_clipboard_received_ || !OpenClipboard(m_window)) {
+        return;
+    }
+    if (GetClipboardOwner() == m_window && lazy_clipboard_data_.open(0)) {
+        MSWindowsClipboard dst(m_window);
+        for (std::int32_t format = 0; format != IClipboard::kNumFormats; ++format) {
+            IClipboard::EFormat eFormat = static_cast<IClipboard::EFormat>(format);
+            if (lazy_clipboard_data_.has(eFormat)) {
+                dst.add(eFormat, lazy_clipboard_data_.get(eFormat));
+            }
+        }
+        lazy_clipboard_data_.close();
+    }
+    CloseClipboard();
+}
+
 void
 MSWindowsScreen::checkClipboards()
 {
@@ -1018,6 +1119,22 @@ MSWindowsScreen::onEvent(HWND, UINT msg,
         // now handle the message
         return onClipboardChange();
 
+    case WM_RENDERFORMAT:
+        render_clipboard(static_cast<UINT>(wParam));
+        return true;
+
+    case WM_RENDERALLFORMATS:
+        render_all_clipboard_formats();
+        return true;
+
+    case WM_DESTROYCLIPBOARD:
+        // somebody emptied the clipboard, the offered formats are gone
+        lazy_clipboard_ = false;
+        ++lazy_clipboard_offer_;
+        lazy_clipboard_requested_ = false;
+        lazy_clipboard_received_ = false;
+        return true;
+
     case WM_CHANGECBCHAIN:
         if (m_nextClipboardWindow == (HWND)wParam) {
             m_nextClipboardWindow = (HWND)lParam;
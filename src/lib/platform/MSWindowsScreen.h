@@ -22,6 +22,7 @@
 #include "base/Fwd.h"
 #include "platform/MSWindowsHook.h"
 #include "inputleap/PlatformScreen.h"
+#include "inputleap/Clipboard.h"
 #include "inputleap/DragInformation.h"
 #include "platform/synwinhk.h"
 #include <map>
@@ -111,6 +112,8 @@ public:
     virtual bool canLeave();
     virtual void leave();
     virtual bool setClipboard(ClipboardID, const IClipboard*);
+    bool set_clipboard_formats(ClipboardID id,
+                               const std::vector<IClipboard::EFormat>& formats) override;
     virtual void checkClipboards();
     virtual void openScreensaver(bool notify);
     virtual void closeScreensaver();
@@ -173,6 +176,11 @@ private: // HACK
     bool onDisplayChange();
     bool onClipboardChange();
 
+    // put the data of a clipboard offered by its formats on the clipboard
+    // in reply to WM_RENDERFORMAT, asking for the data first if needed
+    void render_clipboard(UINT win32Format);
+    void render_all_clipboard_formats();
+
     // warp cursor without discarding queued events
     void warpCursorNoFlush(std::int32_t x, std::int32_t y);
 
@@ -296,6 +304,19 @@ private:
     HWND m_nextClipboardWindow;
     bool m_ownClipboard;
 
+    // clipboard offered by its formats with set_clipboard_formats().  its
+    // data is asked for the first time an application pastes and kept to
+    // render the other formats.  only the server defers clipboards, this
+    // screen's own clipboard always goes to the server in full.
+    // lazy_clipboard_offer_ changes whenever the offer is replaced or
+    // dropped, so a paste waiting for the data notices.
+    bool lazy_clipboard_ = false;
+    std::uint32_t lazy_clipboard_offer_ = 0;
+    ClipboardID lazy_clipboard_id_ = kClipboardClipboard;
+    bool lazy_clipboard_requested_ = false;
+    bool lazy_clipboard_received_ = false;
+    Clipboard lazy_clipboard_data_;
+
     // one desk per desktop and a cond var to communicate with it
     MSWindowsDesks* m_desks;
 
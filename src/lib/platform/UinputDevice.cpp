@@ -0,0 +1,145 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/UinputDevice.h"
+
+#include "inputleap/XScreen.h"
+#include "base/Log.h"
+
+#include <linux/uinput.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace inputleap {
+
+UinputDevice::UinputDevice(const std::string& path) :
+    path_(path)
+{
+    // do nothing
+}
+
+UinputDevice::~UinputDevice()
+{
+    if (fd_ >= 0) {
+        ioctl(fd_, UI_DEV_DESTROY);
+        close(fd_);
+    }
+}
+
+void UinputDevice::create(const Setup& setup)
+{
+    fd_ = open(path_.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ < 0) {
+        LOG_ERR("cannot open %s: %s", path_.c_str(), strerror(errno));
+        throw XScreenOpenFailure();
+    }
+
+    if (!configure(fd_, setup)) {
+        LOG_ERR("cannot create uinput device \"%s\": %s", setup.name.c_str(), strerror(errno));
+        close(fd_);
+        fd_ = -1;
+        throw XScreenOpenFailure();
+    }
+    LOG_DEBUG("created uinput device \"%s\"", setup.name.c_str());
+}
+
+bool UinputDevice::configure(int fd, const Setup& setup)
+{
+    bool ok = true;
+    if (!setup.keys.empty()) {
+        ok = ok && ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0;
+        for (auto code : setup.keys) {
+            ok = ok && ioctl(fd, UI_SET_KEYBIT, code) == 0;
+        }
+    }
+    if (!setup.rel_axes.empty()) {
+        ok = ok && ioctl(fd, UI_SET_EVBIT, EV_REL) == 0;
+        for (auto code : setup.rel_axes) {
+            ok = ok && ioctl(fd, UI_SET_RELBIT, code) == 0;
+        }
+    }
+    if (!setup.abs_axes.empty()) {
+        ok = ok && ioctl(fd, UI_SET_EVBIT, EV_ABS) == 0;
+        for (const auto& axis : setup.abs_axes) {
+            uinput_abs_setup abs;
+            memset(&abs, 0, sizeof(abs));
+            abs.code = axis.code;
+            abs.absinfo.minimum = axis.min;
+            abs.absinfo.maximum = axis.max;
+            ok = ok && ioctl(fd, UI_SET_ABSBIT, axis.code) == 0;
+            ok = ok && ioctl(fd, UI_ABS_SETUP, &abs) == 0;
+        }
+    }
+
+    uinput_setup dev;
+    memset(&dev, 0, sizeof(dev));
+    dev.id.bustype = BUS_VIRTUAL;
+    strncpy(dev.name, setup.name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+    ok = ok && ioctl(fd, UI_DEV_SETUP, &dev) == 0;
+    ok = ok && ioctl(fd, UI_DEV_CREATE) == 0;
+    return ok;
+}
+
+void UinputDevice::emit(std::uint16_t type, std::uint16_t code, std::int32_t value)
+{
+    input_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    pending_.push_back(event);
+}
+
+void UinputDevice::sync()
+{
+    if (pending_.empty()) {
+        return;
+    }
+    emit(EV_SYN, SYN_REPORT, 0);
+    write_events(pending_.data(), pending_.size());
+    pending_.clear();
+}
+
+void UinputDevice::write_events(const input_event* events, std::size_t count)
+{
+    if (fd_ < 0) {
+        return;
+    }
+
+    // the kernel takes whole events, so a short write can only happen
+    // between events
+    const char* data = reinterpret_cast<const char*>(events);
+    std::size_t size = count * sizeof(input_event);
+    while (size > 0) {
+        ssize_t n = write(fd_, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_WARN("dropped %d input events: %s",
+                     static_cast<int>(size / sizeof(input_event)), strerror(errno));
+            return;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+} // namespace inputleap
@@ -0,0 +1,109 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <linux/input.h>
+
+namespace inputleap {
+
+//! Virtual input device
+/*!
+A virtual evdev device created through \c /dev/uinput.  Events are
+queued with \c emit() and written to the kernel together by \c sync(),
+which terminates them with a \c SYN_REPORT so that readers see the
+whole frame at once.  Tests may override \c configure() to stand in a
+plain file for the uinput node, which then records what was sent, or
+\c create() and \c write_events() to not open anything at all.
+*/
+class UinputDevice {
+public:
+    //! Range of an absolute axis
+    struct AbsAxis {
+        std::uint16_t code;
+        std::int32_t min;
+        std::int32_t max;
+    };
+
+    //! Capabilities of a device
+    struct Setup {
+        std::string name;
+        std::vector<std::uint16_t> keys;
+        std::vector<std::uint16_t> rel_axes;
+        std::vector<AbsAxis> abs_axes;
+    };
+
+    explicit UinputDevice(const std::string& path = "/dev/uinput");
+    UinputDevice(const UinputDevice&) = delete;
+    UinputDevice& operator=(const UinputDevice&) = delete;
+    virtual ~UinputDevice();
+
+    //! @name manipulators
+    //@{
+
+    //! Create the device
+    /*!
+    Opens the uinput node and creates a device with the capabilities
+    in \p setup.  Throws \c XScreenOpenFailure if that isn't possible.
+    */
+    virtual void create(const Setup& setup);
+
+    //! Queue an event
+    /*!
+    Adds an event to the current frame.  Nothing is sent until
+    \c sync() is called.
+    */
+    void emit(std::uint16_t type, std::uint16_t code, std::int32_t value);
+
+    //! Send the current frame
+    /*!
+    Terminates the queued events with a \c SYN_REPORT and sends them
+    with a single write.  Does nothing if no events are queued.
+    */
+    void sync();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of queued events
+    std::size_t pending() const { return pending_.size(); }
+
+    //@}
+
+protected:
+    //! Set up the device
+    /*!
+    Gives the device opened as \p fd the capabilities in \p setup and
+    creates it.  Returns false if the kernel refused any of it.
+    */
+    virtual bool configure(int fd, const Setup& setup);
+
+    //! Write events to the device
+    virtual void write_events(const input_event* events, std::size_t count);
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    std::vector<input_event> pending_;
+};
+
+} // namespace inputleap
@@ -0,0 +1,134 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/UinputKeyState.h"
+
+#include "platform/EvdevKeyTable.h"
+#include "platform/UinputDevice.h"
+#include "base/Log.h"
+
+#include <linux/input-event-codes.h>
+
+namespace inputleap {
+
+UinputKeyState::UinputKeyState(UinputDevice* keyboard, IEventQueue* events) :
+    KeyState(events),
+    keyboard_(keyboard)
+{
+    // do nothing
+}
+
+UinputKeyState::UinputKeyState(UinputDevice* keyboard, IEventQueue* events, KeyMap& keyMap) :
+    KeyState(events, keyMap),
+    keyboard_(keyboard)
+{
+    // do nothing
+}
+
+UinputKeyState::~UinputKeyState()
+{
+    // do nothing
+}
+
+void UinputKeyState::record_key(KeyButton button, bool press)
+{
+    if (press) {
+        if (pressed_.insert(button).second) {
+            locked_ ^= EvdevKeyTable::get_modifier(button) &
+                        (KeyModifierCapsLock | KeyModifierNumLock | KeyModifierScrollLock);
+        }
+    }
+    else {
+        pressed_.erase(button);
+    }
+}
+
+bool UinputKeyState::fakeCtrlAltDel()
+{
+    // nothing intercepts ctrl+alt+del here, so send the keys as usual
+    return false;
+}
+
+KeyModifierMask UinputKeyState::pollActiveModifiers() const
+{
+    KeyModifierMask mask = locked_;
+    for (KeyButton button : pressed_) {
+        KeyModifierMask modifier = EvdevKeyTable::get_modifier(button);
+        if ((modifier & (KeyModifierCapsLock | KeyModifierNumLock | KeyModifierScrollLock)) == 0) {
+            mask |= modifier;
+        }
+    }
+    return mask;
+}
+
+std::int32_t UinputKeyState::pollActiveGroup() const
+{
+    return 0;
+}
+
+void UinputKeyState::pollPressedKeys(KeyButtonSet& pressedKeys) const
+{
+    pressedKeys.insert(pressed_.begin(), pressed_.end());
+}
+
+void UinputKeyState::getKeyMap(KeyMap& keyMap)
+{
+    EvdevKeyTable::fill_key_map(keyMap);
+}
+
+void UinputKeyState::fakeKey(const Keystroke& keystroke)
+{
+    fakeKeyBatch(&keystroke, 1);
+}
+
+void UinputKeyState::fakeKeyBatch(const Keystroke* keystrokes, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const Keystroke& keystroke = keystrokes[i];
+        if (keystroke.m_type == Keystroke::kButton) {
+            emit_key(keystroke);
+        }
+        else {
+            // there's only one group
+            LOG_DEBUG1("ignoring group change to %d", keystroke.m_data.m_group.m_group);
+        }
+    }
+    keyboard_->sync();
+}
+
+void UinputKeyState::emit_key(const Keystroke& keystroke)
+{
+    const Keystroke::Button& key = keystroke.m_data.m_button;
+    LOG_DEBUG1("  %03x (%08x) %s", key.m_button, key.m_client,
+               key.m_press ? "down" : "up");
+
+    // evdev reports a repeat as a single event with value 2
+    std::int32_t value = 0;
+    if (key.m_repeat) {
+        if (!key.m_press) {
+            LOG_DEBUG1("  discard key repeat release");
+            return;
+        }
+        value = 2;
+    }
+    else {
+        value = key.m_press ? 1 : 0;
+        record_key(key.m_button, key.m_press);
+    }
+    keyboard_->emit(EV_KEY, key.m_button, value);
+}
+
+} // namespace inputleap
@@ -0,0 +1,75 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "base/Fwd.h"
+#include "inputleap/KeyState.h"
+
+#include <set>
+
+namespace inputleap {
+
+class UinputDevice;
+
+//! Key state for a uinput keyboard
+/*!
+Synthesizes keystrokes on a uinput keyboard using the built-in evdev
+layout.  The device doesn't report anything back, so the pressed keys
+and lock states are whatever this object last sent.
+*/
+class UinputKeyState : public KeyState {
+public:
+    UinputKeyState(UinputDevice* keyboard, IEventQueue* events);
+    UinputKeyState(UinputDevice* keyboard, IEventQueue* events, KeyMap& keyMap);
+    ~UinputKeyState() override;
+
+    //! @name manipulators
+    //@{
+
+    //! Record a key event
+    /*!
+    Updates the pressed keys and lock states for \p button going down or
+    up.  Primary screens call this for keys read from the physical
+    keyboards, which this object doesn't see otherwise.
+    */
+    void record_key(KeyButton button, bool press);
+
+    //@}
+
+    // IKeyState overrides
+    bool fakeCtrlAltDel() override;
+    KeyModifierMask pollActiveModifiers() const override;
+    std::int32_t pollActiveGroup() const override;
+    void pollPressedKeys(KeyButtonSet& pressedKeys) const override;
+
+protected:
+    // KeyState overrides
+    void getKeyMap(KeyMap& keyMap) override;
+    void fakeKey(const Keystroke& keystroke) override;
+    void fakeKeyBatch(const Keystroke* keystrokes, std::size_t count) override;
+
+private:
+    // queue the event for a button keystroke
+    void emit_key(const Keystroke& keystroke);
+
+private:
+    UinputDevice* keyboard_;
+    std::set<KeyButton> pressed_;
+    KeyModifierMask locked_ = 0;
+};
+
+} // namespace inputleap
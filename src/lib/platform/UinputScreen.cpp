@@ -0,0 +1,350 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/UinputScreen.h"
+
+#include "platform/EvdevKeyTable.h"
+#include "platform/UinputDevice.h"
+#include "platform/UinputKeyState.h"
+#include "base/Log.h"
+
+#include <algorithm>
+
+#include <linux/input-event-codes.h>
+
+namespace inputleap {
+
+namespace {
+
+// wheel units per notch, same as WHEEL_DELTA on windows
+const std::int32_t kWheelNotch = 120;
+
+std::uint16_t get_button_code(ButtonID id)
+{
+    switch (id) {
+    case kButtonLeft:
+        return BTN_LEFT;
+
+    case kButtonMiddle:
+        return BTN_MIDDLE;
+
+    case kButtonRight:
+        return BTN_RIGHT;
+
+    case kButtonExtra0:
+        return BTN_SIDE;
+
+    case kButtonExtra1:
+        return BTN_EXTRA;
+
+    default:
+        return 0;
+    }
+}
+
+} // namespace
+
+UinputScreen::UinputScreen(std::int32_t width, std::int32_t height, IEventQueue* events) :
+    UinputScreen(std::make_unique<UinputDevice>(), std::make_unique<UinputDevice>(),
+                 width, height, events)
+{
+    // do nothing
+}
+
+UinputScreen::UinputScreen(std::unique_ptr<UinputDevice> keyboard,
+                           std::unique_ptr<UinputDevice> pointer,
+                           std::int32_t width, std::int32_t height, IEventQueue* events) :
+    keyboard_(std::move(keyboard)),
+    pointer_(std::move(pointer)),
+    width_(width),
+    height_(height),
+    events_(events)
+{
+    create_devices();
+    key_state_ = std::make_unique<UinputKeyState>(keyboard_.get(), events_);
+
+    x_ = width_ / 2;
+    y_ = height_ / 2;
+
+    LOG_DEBUG("screen shape: 0,0 %dx%d", width_, height_);
+}
+
+UinputScreen::~UinputScreen()
+{
+    // do nothing
+}
+
+void UinputScreen::create_devices()
+{
+    UinputDevice::Setup keyboard;
+    keyboard.name = "InputLeap virtual keyboard";
+    keyboard.keys = EvdevKeyTable::get_codes();
+    keyboard_->create(keyboard);
+
+    // separate devices so that the pointer isn't taken for a tablet with
+    // a keyboard attached
+    UinputDevice::Setup pointer;
+    pointer.name = "InputLeap virtual pointer";
+    pointer.keys = { BTN_LEFT, BTN_RIGHT, BTN_MIDDLE, BTN_SIDE, BTN_EXTRA };
+    pointer.rel_axes = { REL_WHEEL, REL_HWHEEL };
+#ifdef REL_WHEEL_HI_RES
+    pointer.rel_axes.push_back(REL_WHEEL_HI_RES);
+    pointer.rel_axes.push_back(REL_HWHEEL_HI_RES);
+#endif
+    pointer.abs_axes = {
+        { ABS_X, 0, std::max(width_ - 1, 0) },
+        { ABS_Y, 0, std::max(height_ - 1, 0) },
+    };
+    pointer_->create(pointer);
+}
+
+const EventTarget* UinputScreen::get_event_target() const
+{
+    return this;
+}
+
+bool UinputScreen::getClipboard(ClipboardID id, IClipboard* clipboard) const
+{
+    return Clipboard::copy(clipboard, &clipboards_[id]);
+}
+
+void UinputScreen::getShape(std::int32_t& x, std::int32_t& y, std::int32_t& width,
+                            std::int32_t& height) const
+{
+    x = 0;
+    y = 0;
+    width = width_;
+    height = height_;
+}
+
+void UinputScreen::getCursorPos(std::int32_t& x, std::int32_t& y) const
+{
+    x = x_;
+    y = y_;
+}
+
+void UinputScreen::reconfigure(std::uint32_t)
+{
+    // do nothing
+}
+
+void UinputScreen::warpCursor(std::int32_t x, std::int32_t y)
+{
+    fakeMouseMove(x, y);
+}
+
+std::uint32_t UinputScreen::registerHotKey(KeyID, KeyModifierMask)
+{
+    // only a primary screen has hot keys
+    return 0;
+}
+
+void UinputScreen::unregisterHotKey(std::uint32_t)
+{
+    // do nothing
+}
+
+void UinputScreen::fakeInputBegin()
+{
+    // do nothing
+}
+
+void UinputScreen::fakeInputEnd()
+{
+    // do nothing
+}
+
+std::int32_t UinputScreen::getJumpZoneSize() const
+{
+    return 0;
+}
+
+bool UinputScreen::isAnyMouseButtonDown(std::uint32_t& buttonID) const
+{
+    for (ButtonID id = kButtonLeft; id <= kButtonExtra1; ++id) {
+        if ((buttons_ & (1u << id)) != 0) {
+            buttonID = id;
+            return true;
+        }
+    }
+    return false;
+}
+
+void UinputScreen::getCursorCenter(std::int32_t& x, std::int32_t& y) const
+{
+    x = width_ / 2;
+    y = height_ / 2;
+}
+
+void UinputScreen::fakeMouseButton(ButtonID id, bool press)
+{
+    std::uint16_t code = get_button_code(id);
+    if (code == 0) {
+        LOG_DEBUG1("ignoring unknown button %d", id);
+        return;
+    }
+
+    if (press) {
+        buttons_ |= 1u << id;
+    }
+    else {
+        buttons_ &= ~(1u << id);
+    }
+    pointer_->emit(EV_KEY, code, press ? 1 : 0);
+    pointer_->sync();
+}
+
+void UinputScreen::fakeMouseMove(std::int32_t x, std::int32_t y)
+{
+    x_ = x;
+    y_ = y;
+    send_cursor_pos();
+}
+
+void UinputScreen::fakeMouseRelativeMove(std::int32_t dx, std::int32_t dy) const
+{
+    x_ += dx;
+    y_ += dy;
+    send_cursor_pos();
+}
+
+void UinputScreen::fakeMouseWheel(std::int32_t xDelta, std::int32_t yDelta) const
+{
+    // the high resolution axes count in 120ths of a notch, like our
+    // deltas.  the plain axes get whole notches as they add up.
+    wheel_x_ += xDelta;
+    wheel_y_ += yDelta;
+    std::int32_t notches_x = wheel_x_ / kWheelNotch;
+    std::int32_t notches_y = wheel_y_ / kWheelNotch;
+    wheel_x_ -= notches_x * kWheelNotch;
+    wheel_y_ -= notches_y * kWheelNotch;
+
+#ifdef REL_WHEEL_HI_RES
+    if (yDelta != 0) {
+        pointer_->emit(EV_REL, REL_WHEEL_HI_RES, yDelta);
+    }
+    if (xDelta != 0) {
+        pointer_->emit(EV_REL, REL_HWHEEL_HI_RES, xDelta);
+    }
+#endif
+    if (notches_y != 0) {
+        pointer_->emit(EV_REL, REL_WHEEL, notches_y);
+    }
+    if (notches_x != 0) {
+        pointer_->emit(EV_REL, REL_HWHEEL, notches_x);
+    }
+    pointer_->sync();
+}
+
+void UinputScreen::send_cursor_pos() const
+{
+    x_ = std::max(0, std::min(x_, width_ - 1));
+    y_ = std::max(0, std::min(y_, height_ - 1));
+    pointer_->emit(EV_ABS, ABS_X, x_);
+    pointer_->emit(EV_ABS, ABS_Y, y_);
+    pointer_->sync();
+}
+
+void UinputScreen::enable()
+{
+    // do nothing
+}
+
+void UinputScreen::disable()
+{
+    // do nothing
+}
+
+void UinputScreen::enter()
+{
+    // do nothing
+}
+
+bool UinputScreen::canLeave()
+{
+    return true;
+}
+
+void UinputScreen::leave()
+{
+    // do nothing
+}
+
+bool UinputScreen::setClipboard(ClipboardID id, const IClipboard* clipboard)
+{
+    // there's no system clipboard to hand this to, so just keep it
+    if (clipboard == nullptr) {
+        return true;
+    }
+    return Clipboard::copy(&clipboards_[id], clipboard);
+}
+
+void UinputScreen::checkClipboards()
+{
+    // do nothing, we're always up to date
+}
+
+void UinputScreen::openScreensaver(bool)
+{
+    // do nothing
+}
+
+void UinputScreen::closeScreensaver()
+{
+    // do nothing
+}
+
+void UinputScreen::screensaver(bool)
+{
+    // do nothing
+}
+
+void UinputScreen::resetOptions()
+{
+    // no options
+}
+
+void UinputScreen::setOptions(const OptionsList&)
+{
+    // no options
+}
+
+void UinputScreen::setSequenceNumber(std::uint32_t seqNum)
+{
+    sequence_number_ = seqNum;
+}
+
+bool UinputScreen::isPrimary() const
+{
+    return false;
+}
+
+void UinputScreen::handle_system_event(const Event&)
+{
+    // do nothing
+}
+
+void UinputScreen::updateButtons()
+{
+    // do nothing
+}
+
+IKeyState* UinputScreen::getKeyState() const
+{
+    return key_state_.get();
+}
+
+} // namespace inputleap
@@ -0,0 +1,123 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "base/Fwd.h"
+#include "inputleap/Clipboard.h"
+#include "inputleap/PlatformScreen.h"
+
+#include <memory>
+
+namespace inputleap {
+
+class UinputDevice;
+class UinputKeyState;
+
+//! Implementation of IPlatformScreen for Linux uinput
+/*!
+A secondary screen that injects input through virtual uinput devices,
+so it works without a display server or desktop session.  The pointer
+is an absolute device whose axes cover the configured screen size; the
+keyboard uses the built-in evdev layout.
+*/
+class UinputScreen : public PlatformScreen {
+public:
+    UinputScreen(std::int32_t width, std::int32_t height, IEventQueue* events);
+    UinputScreen(std::unique_ptr<UinputDevice> keyboard, std::unique_ptr<UinputDevice> pointer,
+                 std::int32_t width, std::int32_t height, IEventQueue* events);
+    ~UinputScreen() override;
+
+    // IScreen overrides
+    const EventTarget* get_event_target() const override;
+    bool getClipboard(ClipboardID id, IClipboard*) const override;
+    void getShape(std::int32_t& x, std::int32_t& y, std::int32_t& width,
+                  std::int32_t& height) const override;
+    void getCursorPos(std::int32_t& x, std::int32_t& y) const override;
+
+    // IPrimaryScreen overrides
+    void reconfigure(std::uint32_t activeSides) override;
+    void warpCursor(std::int32_t x, std::int32_t y) override;
+    std::uint32_t registerHotKey(KeyID key, KeyModifierMask mask) override;
+    void unregisterHotKey(std::uint32_t id) override;
+    void fakeInputBegin() override;
+    void fakeInputEnd() override;
+    std::int32_t getJumpZoneSize() const override;
+    bool isAnyMouseButtonDown(std::uint32_t& buttonID) const override;
+    void getCursorCenter(std::int32_t& x, std::int32_t& y) const override;
+
+    // ISecondaryScreen overrides
+    void fakeMouseButton(ButtonID id, bool press) override;
+    void fakeMouseMove(std::int32_t x, std::int32_t y) override;
+    void fakeMouseRelativeMove(std::int32_t dx, std::int32_t dy) const override;
+    void fakeMouseWheel(std::int32_t xDelta, std::int32_t yDelta) const override;
+
+    // IPlatformScreen overrides
+    void enable() override;
+    void disable() override;
+    void enter() override;
+    bool canLeave() override;
+    void leave() override;
+    bool setClipboard(ClipboardID, const IClipboard*) override;
+    void checkClipboards() override;
+    void openScreensaver(bool notify) override;
+    void closeScreensaver() override;
+    void screensaver(bool activate) override;
+    void resetOptions() override;
+    void setOptions(const OptionsList& options) override;
+    void setSequenceNumber(std::uint32_t) override;
+    bool isPrimary() const override;
+
+protected:
+    // IPlatformScreen overrides
+    void handle_system_event(const Event& event) override;
+    void updateButtons() override;
+    IKeyState* getKeyState() const override;
+
+private:
+    // create the virtual devices
+    void create_devices();
+
+    // move the pointer to the cursor position
+    void send_cursor_pos() const;
+
+private:
+    std::unique_ptr<UinputDevice> keyboard_;
+    std::unique_ptr<UinputDevice> pointer_;
+
+protected:
+    std::unique_ptr<UinputKeyState> key_state_;
+
+    std::int32_t width_;
+    std::int32_t height_;
+
+    // the devices can't be read back, so these are what was last sent
+    mutable std::int32_t x_ = 0;
+    mutable std::int32_t y_ = 0;
+    std::uint32_t buttons_ = 0;
+
+    IEventQueue* events_;
+
+private:
+    // wheel motion that didn't add up to a whole notch yet
+    mutable std::int32_t wheel_x_ = 0;
+    mutable std::int32_t wheel_y_ = 0;
+
+    Clipboard clipboards_[kClipboardEnd];
+    std::uint32_t sequence_number_ = 0;
+};
+
+} // namespace inputleap
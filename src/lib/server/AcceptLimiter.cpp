@@ -0,0 +1,77 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/AcceptLimiter.h"
+
+#include <algorithm>
+
+namespace inputleap {
+
+AcceptLimiter::AcceptLimiter(double burst, double rate) :
+    burst_{burst},
+    rate_{rate}
+{
+}
+
+bool AcceptLimiter::try_acquire(const std::string& source, double now)
+{
+    auto i = buckets_.find(source);
+    if (i == buckets_.end()) {
+        if (buckets_.size() >= kMaxSources) {
+            prune(now);
+        }
+        i = buckets_.emplace(source, Bucket{burst_, now}).first;
+    }
+
+    Bucket& bucket = i->second;
+    if (refill(bucket, now) < 1.0) {
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+double AcceptLimiter::refill(Bucket& bucket, double now) const
+{
+    if (now > bucket.updated) {
+        bucket.tokens = std::min(burst_, bucket.tokens + (now - bucket.updated) * rate_);
+        bucket.updated = now;
+    }
+    return bucket.tokens;
+}
+
+void AcceptLimiter::prune(double now)
+{
+    // a full bucket is the same as no bucket
+    for (auto i = buckets_.begin(); i != buckets_.end();) {
+        if (refill(i->second, now) >= burst_) {
+            i = buckets_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    // everyone is busy, forget the host that was quiet the longest
+    if (buckets_.size() >= kMaxSources) {
+        auto oldest = std::min_element(buckets_.begin(), buckets_.end(),
+                                       [](const auto& a, const auto& b) {
+                                           return a.second.updated < b.second.updated;
+                                       });
+        buckets_.erase(oldest);
+    }
+}
+
+} // namespace inputleap
@@ -0,0 +1,81 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace inputleap {
+
+//! Limits the rate of incoming connections
+/*!
+Keeps a token bucket per source address.  Each connection takes a token
+and tokens come back at a fixed rate up to the burst size, so a host that
+opens connections faster than any client would is turned away while other
+hosts are unaffected.  Times are in seconds as returned by
+\c current_time_seconds().
+*/
+class AcceptLimiter {
+public:
+    //! Default number of connections a host may open at once
+    static constexpr double kDefaultBurst = 8.0;
+
+    //! Default number of connections per second a host may open over time
+    static constexpr double kDefaultRate = 2.0;
+
+    //! Number of hosts tracked before full buckets are dropped
+    static constexpr std::size_t kMaxSources = 1024;
+
+    AcceptLimiter(double burst = kDefaultBurst, double rate = kDefaultRate);
+
+    //! @name manipulators
+    //@{
+
+    //! Take a token
+    /*!
+    Returns true and takes a token from the bucket of \p source if it has
+    one at time \p now, otherwise returns false.
+    */
+    bool try_acquire(const std::string& source, double now);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of hosts tracked
+    std::size_t get_source_count() const { return buckets_.size(); }
+
+    //@}
+
+private:
+    struct Bucket {
+        double tokens;
+        double updated;
+    };
+
+    double refill(Bucket& bucket, double now) const;
+    void prune(double now);
+
+private:
+    double burst_;
+    double rate_;
+    std::map<std::string, Bucket> buckets_;
+};
+
+} // namespace inputleap
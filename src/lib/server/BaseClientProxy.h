@@ -21,6 +21,8 @@
 #include "base/EventTarget.h"
 #include "inputleap/Fwd.h"
 #include "inputleap/IClient.h"
+#include "server/ScreenNameTable.h"
+#include <memory>
 
 namespace inputleap {
 
@@ -45,6 +47,21 @@ public:
     */
     void setJumpCursorPos(std::int32_t x, std::int32_t y);
 
+    //! Set screen id
+    /*!
+    Set the id the server interned the client's canonical name as.
+    */
+    void set_screen_id(ScreenId id) { screen_id_ = id; }
+
+    //! Resume the session over a new connection
+    /*!
+    Continues the session identified by \p token over \p conn if the
+    client can resume it after receiving \p received messages.  On success
+    \p conn is taken over and true is returned.
+    */
+    virtual bool resume_session(const std::string& token, std::uint32_t received,
+                                std::unique_ptr<IClientConnection>& conn) { return false; }
+
     //@}
     //! @name accessors
     //@{
@@ -55,12 +72,33 @@ public:
     */
     void getJumpCursorPos(std::int32_t& x, std::int32_t& y) const;
 
+    //! Get screen id
+    /*!
+    Returns the id of the client's canonical name or \c kInvalidScreenId
+    if the server hasn't accepted the client yet.
+    */
+    ScreenId get_screen_id() const { return screen_id_; }
+
     //! Get cursor position
     /*!
     Return if this proxy is for client or primary.
     */
     virtual bool isPrimary() const { return false; }
 
+    //! Get hook-to-send latency
+    /*!
+    Returns the latencies from the primary screen capturing input to
+    sending it to this client, or nullptr if they aren't recorded.
+    */
+    virtual const LatencyHistogram* get_hook_to_send_latency() const { return nullptr; }
+
+    //! Get keep alive round trip times
+    /*!
+    Returns the keep alive round trip times to this client, or nullptr if
+    they aren't measured.
+    */
+    virtual const LatencyHistogram* get_round_trip_latency() const { return nullptr; }
+
     //@}
 
     // IClient overrides
@@ -72,6 +110,7 @@ public:
 private:
     std::string m_name;
     std::int32_t m_x, m_y;
+    ScreenId screen_id_ = kInvalidScreenId;
 };
 
 } // namespace inputleap
@@ -18,6 +18,7 @@
 #include "base/Log.h"
 #include "inputleap/ClipboardChunk.h"
 #include "inputleap/FileChunk.h"
+#include "inputleap/MotionDatagram.h"
 #include "inputleap/ProtocolUtil.h"
 #include "inputleap/protocol_types.h"
 #include "io/IStream.h"
@@ -87,6 +88,21 @@ void ClientConnectionByStream::send_mouse_relative_move_1_6(std::int32_t x_rel,
     ProtocolUtil::writef(stream_.get(), kMsgDMouseRelMove, x_rel, y_rel);
 }
 
+void ClientConnectionByStream::send_mouse_move_timed_1_6(std::int32_t x_abs, std::int32_t y_abs,
+                                                         std::uint32_t captured,
+                                                         std::uint32_t sent)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgDMouseMoveTimed, x_abs, y_abs, captured, sent);
+}
+
+void ClientConnectionByStream::send_mouse_relative_move_timed_1_6(std::int32_t x_rel,
+                                                                  std::int32_t y_rel,
+                                                                  std::uint32_t captured,
+                                                                  std::uint32_t sent)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgDMouseRelMoveTimed, x_rel, y_rel, captured, sent);
+}
+
 void ClientConnectionByStream::send_mouse_wheel_1_6(std::int32_t x_delta, std::int32_t y_delta)
 {
     ProtocolUtil::writef(stream_.get(), kMsgDMouseWheel, x_delta, y_delta);
@@ -122,6 +138,44 @@ void ClientConnectionByStream::send_keep_alive_1_6()
     ProtocolUtil::writef(stream_.get(), kMsgCKeepAlive);
 }
 
+void ClientConnectionByStream::send_keep_alive_timed_1_6(std::uint32_t time,
+                                                         std::uint32_t timeout_ms)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgCKeepAliveTimed, time, timeout_ms);
+}
+
+void ClientConnectionByStream::send_datagram_offer_1_6(std::uint16_t port, std::uint32_t session,
+                                                       const std::string& key)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgCDatagramOffer, port, session, &key);
+}
+
+void ClientConnectionByStream::send_motion_sync_1_6(const MotionDatagram& sync)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgDMotionSync, sync.seq, sync.flags, sync.x, sync.y,
+                         sync.dx_total, sync.dy_total);
+}
+
+void ClientConnectionByStream::send_clock_1_6(std::uint32_t query_time, std::uint32_t time)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgCClock, query_time, time);
+}
+
+void ClientConnectionByStream::send_noop_1_6()
+{
+    ProtocolUtil::writef(stream_.get(), kMsgCNoop);
+}
+
+void ClientConnectionByStream::send_session_1_6(const std::string& token)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgCSession, &token);
+}
+
+void ClientConnectionByStream::send_resume_1_6(bool resumed)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgCResume, resumed ? 1 : 0);
+}
+
 void ClientConnectionByStream::send_close_1_6(const char* msg)
 {
     ProtocolUtil::writef(stream_.get(), msg);
@@ -133,6 +187,18 @@ void ClientConnectionByStream::send_clipboard_chunk_1_6(const ClipboardChunk& ch
                          &chunk.data_);
 }
 
+void ClientConnectionByStream::send_clipboard_cached_1_6(ClipboardID id, std::uint32_t sequence,
+                                                         const std::string& hash)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgDClipboardCached, id, sequence, &hash);
+}
+
+void ClientConnectionByStream::send_clipboard_formats_1_6(ClipboardID id, std::uint32_t sequence,
+                                                          const std::vector<std::uint32_t>& formats)
+{
+    ProtocolUtil::writef(stream_.get(), kMsgDClipboardFormats, id, sequence, &formats);
+}
+
 void ClientConnectionByStream::send_file_chunk_1_6(const FileChunk& chunk)
 {
     ProtocolUtil::writef(stream_.get(), kMsgDFileTransfer, chunk.mark_, &chunk.data_);
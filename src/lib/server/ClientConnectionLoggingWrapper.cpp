@@ -18,6 +18,7 @@
 #include "base/Log.h"
 #include "inputleap/ClipboardChunk.h"
 #include "inputleap/FileChunk.h"
+#include "inputleap/MotionDatagram.h"
 #include "inputleap/ProtocolUtil.h"
 #include "inputleap/protocol_types.h"
 #include "io/IStream.h"
@@ -111,6 +112,26 @@ void ClientConnectionLoggingWrapper::send_mouse_relative_move_1_6(std::int32_t x
     conn_->send_mouse_relative_move_1_6(x_rel, y_rel);
 }
 
+void ClientConnectionLoggingWrapper::send_mouse_move_timed_1_6(std::int32_t x_abs,
+                                                               std::int32_t y_abs,
+                                                               std::uint32_t captured,
+                                                               std::uint32_t sent)
+{
+    LOG_DEBUG2("send mouse move to \"%s\" %d,%d captured=%u sent=%u", name_.c_str(), x_abs,
+               y_abs, captured, sent);
+    conn_->send_mouse_move_timed_1_6(x_abs, y_abs, captured, sent);
+}
+
+void ClientConnectionLoggingWrapper::send_mouse_relative_move_timed_1_6(std::int32_t x_rel,
+                                                                        std::int32_t y_rel,
+                                                                        std::uint32_t captured,
+                                                                        std::uint32_t sent)
+{
+    LOG_DEBUG2("send mouse relative move to \"%s\" %d,%d captured=%u sent=%u", name_.c_str(),
+               x_rel, y_rel, captured, sent);
+    conn_->send_mouse_relative_move_timed_1_6(x_rel, y_rel, captured, sent);
+}
+
 void ClientConnectionLoggingWrapper::send_mouse_wheel_1_6(std::int32_t x_delta, std::int32_t y_delta)
 {
     LOG_DEBUG2("send mouse wheel to \"%s\" %+d,%+d", name_.c_str(), x_delta, y_delta);
@@ -153,6 +174,51 @@ void ClientConnectionLoggingWrapper::send_keep_alive_1_6()
     conn_->send_keep_alive_1_6();
 }
 
+void ClientConnectionLoggingWrapper::send_keep_alive_timed_1_6(std::uint32_t time,
+                                                               std::uint32_t timeout_ms)
+{
+    conn_->send_keep_alive_timed_1_6(time, timeout_ms);
+}
+
+void ClientConnectionLoggingWrapper::send_datagram_offer_1_6(std::uint16_t port,
+                                                             std::uint32_t session,
+                                                             const std::string& key)
+{
+    LOG_DEBUG1("send motion datagram offer to \"%s\" port=%d session=%08x", name_.c_str(),
+               port, session);
+    conn_->send_datagram_offer_1_6(port, session, key);
+}
+
+void ClientConnectionLoggingWrapper::send_motion_sync_1_6(const MotionDatagram& sync)
+{
+    LOG_DEBUG2("send motion sync to \"%s\" seq=%u %d,%d", name_.c_str(), sync.seq, sync.x,
+               sync.y);
+    conn_->send_motion_sync_1_6(sync);
+}
+
+void ClientConnectionLoggingWrapper::send_clock_1_6(std::uint32_t query_time,
+                                                    std::uint32_t time)
+{
+    conn_->send_clock_1_6(query_time, time);
+}
+
+void ClientConnectionLoggingWrapper::send_noop_1_6()
+{
+    conn_->send_noop_1_6();
+}
+
+void ClientConnectionLoggingWrapper::send_session_1_6(const std::string& token)
+{
+    LOG_DEBUG1("send session token to \"%s\"", name_.c_str());
+    conn_->send_session_1_6(token);
+}
+
+void ClientConnectionLoggingWrapper::send_resume_1_6(bool resumed)
+{
+    LOG_DEBUG1("send resume to \"%s\" resumed=%d", name_.c_str(), resumed ? 1 : 0);
+    conn_->send_resume_1_6(resumed);
+}
+
 void ClientConnectionLoggingWrapper::send_close_1_6(const char* msg)
 {
     LOG_DEBUG1("send close \"%s\" to \"%s\"", msg, name_.c_str());
@@ -180,6 +246,22 @@ void ClientConnectionLoggingWrapper::send_clipboard_chunk_1_6(const ClipboardChu
     conn_->send_clipboard_chunk_1_6(chunk);
 }
 
+void ClientConnectionLoggingWrapper::send_clipboard_cached_1_6(ClipboardID id,
+                                                               std::uint32_t sequence,
+                                                               const std::string& hash)
+{
+    LOG_DEBUG1("sending cached clipboard %d to \"%s\"", id, name_.c_str());
+    conn_->send_clipboard_cached_1_6(id, sequence, hash);
+}
+
+void ClientConnectionLoggingWrapper::send_clipboard_formats_1_6(ClipboardID id,
+                                                                std::uint32_t sequence,
+                                                                const std::vector<std::uint32_t>& formats)
+{
+    LOG_DEBUG1("sending clipboard %d formats to \"%s\"", id, name_.c_str());
+    conn_->send_clipboard_formats_1_6(id, sequence, formats);
+}
+
 void ClientConnectionLoggingWrapper::send_file_chunk_1_6(const FileChunk& chunk)
 {
     switch (chunk.mark_) {
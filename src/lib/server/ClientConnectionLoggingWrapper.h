@@ -46,6 +46,10 @@ public:
     void send_mouse_up_1_6(ButtonID button) override;
     void send_mouse_move_1_6(std::int32_t x_abs, std::int32_t y_abs) override;
     void send_mouse_relative_move_1_6(std::int32_t x_rel, std::int32_t y_rel) override;
+    void send_mouse_move_timed_1_6(std::int32_t x_abs, std::int32_t y_abs,
+                                   std::uint32_t captured, std::uint32_t sent) override;
+    void send_mouse_relative_move_timed_1_6(std::int32_t x_rel, std::int32_t y_rel,
+                                            std::uint32_t captured, std::uint32_t sent) override;
     void send_mouse_wheel_1_6(std::int32_t x_delta, std::int32_t y_delta) override;
     void send_drag_info_1_6(std::uint32_t file_count, const std::string& data) override;
     void send_screensaver_1_6(bool on) override;
@@ -53,9 +57,21 @@ public:
     void send_set_options_1_6(const OptionsList& options) override;
     void send_info_ack_1_6() override;
     void send_keep_alive_1_6() override;
+    void send_keep_alive_timed_1_6(std::uint32_t time, std::uint32_t timeout_ms) override;
+    void send_datagram_offer_1_6(std::uint16_t port, std::uint32_t session,
+                                 const std::string& key) override;
+    void send_motion_sync_1_6(const MotionDatagram& sync) override;
+    void send_clock_1_6(std::uint32_t query_time, std::uint32_t time) override;
+    void send_noop_1_6() override;
+    void send_session_1_6(const std::string& token) override;
+    void send_resume_1_6(bool resumed) override;
     void send_close_1_6(const char* msg) override;
 
     void send_clipboard_chunk_1_6(const ClipboardChunk& chunk) override;
+    void send_clipboard_cached_1_6(ClipboardID id, std::uint32_t sequence,
+                                   const std::string& hash) override;
+    void send_clipboard_formats_1_6(ClipboardID id, std::uint32_t sequence,
+                                    const std::vector<std::uint32_t>& formats) override;
     void send_file_chunk_1_6(const FileChunk& chunk) override;
     void send_grab_clipboard(ClipboardID id) override;
 
@@ -0,0 +1,381 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ClientConnectionSession.h"
+#include "inputleap/ClipboardChunk.h"
+#include "inputleap/FileChunk.h"
+#include "inputleap/MotionDatagram.h"
+#include <cassert>
+
+namespace inputleap {
+
+namespace {
+
+// limits on the messages kept for a client that doesn't acknowledge them.
+// at a high mouse rate a few seconds of motion fit, as well as a clipboard
+// of the default maximum size.
+const std::size_t kMaxKeptMessages = 8192;
+const std::size_t kMaxKeptSize = 4 * 1024 * 1024;
+
+} // namespace
+
+ClientConnectionSession::ClientConnectionSession(std::unique_ptr<IClientConnection> conn) :
+    conn_{std::move(conn)}
+{}
+
+ClientConnectionSession::~ClientConnectionSession() = default;
+
+void ClientConnectionSession::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    started_ = true;
+    sent_ = 0;
+    kept_.clear();
+    kept_size_ = 0;
+}
+
+bool ClientConnectionSession::is_started() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return started_;
+}
+
+bool ClientConnectionSession::is_attached() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return conn_ != nullptr;
+}
+
+std::uint32_t ClientConnectionSession::get_sent() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sent_;
+}
+
+std::size_t ClientConnectionSession::get_kept() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return kept_.size();
+}
+
+bool ClientConnectionSession::can_resume(std::uint32_t received) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return is_kept(received);
+}
+
+bool ClientConnectionSession::is_kept(std::uint32_t received) const
+{
+    // the kept messages are the last ones sent.  this also rejects numbers
+    // past the messages sent, counts wrap around.
+    std::uint32_t first_kept = sent_ - static_cast<std::uint32_t>(kept_.size());
+    return started_ && received - first_kept <= kept_.size();
+}
+
+void ClientConnectionSession::acknowledge(std::uint32_t received)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_kept(received)) {
+        drop_received(received);
+    }
+}
+
+void ClientConnectionSession::drop_received(std::uint32_t received)
+{
+    std::uint32_t first_kept = sent_ - static_cast<std::uint32_t>(kept_.size());
+    for (std::uint32_t n = received - first_kept; n > 0; --n) {
+        kept_size_ -= kept_.front().size;
+        kept_.pop_front();
+    }
+}
+
+std::unique_ptr<IClientConnection> ClientConnectionSession::detach()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::move(conn_);
+}
+
+void ClientConnectionSession::attach(std::unique_ptr<IClientConnection> conn,
+                                     std::uint32_t received)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    assert(is_kept(received));
+
+    drop_received(received);
+    conn_ = std::move(conn);
+    for (const auto& message : kept_) {
+        message.send(*conn_);
+    }
+}
+
+void ClientConnectionSession::send(Sender sender, std::size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (conn_) {
+        sender(*conn_);
+    }
+    if (started_) {
+        keep(std::move(sender), size);
+    }
+}
+
+void ClientConnectionSession::send_once(const Sender& sender)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (conn_) {
+        sender(*conn_);
+    }
+    if (started_) {
+        // the client still has to count it
+        keep([](IClientConnection& conn) { conn.send_noop_1_6(); }, kMessageSize);
+    }
+}
+
+void ClientConnectionSession::keep(Sender sender, std::size_t size)
+{
+    ++sent_;
+    kept_.push_back({std::move(sender), size});
+    kept_size_ += size;
+
+    // drop the oldest messages.  the client can't resume the session until
+    // it acknowledges them.
+    while (kept_.size() > kMaxKeptMessages || kept_size_ > kMaxKeptSize) {
+        kept_size_ -= kept_.front().size;
+        kept_.pop_front();
+    }
+}
+
+const EventTarget* ClientConnectionSession::get_event_target()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return conn_ ? conn_->get_event_target() : nullptr;
+}
+
+IStream* ClientConnectionSession::get_stream()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return conn_ ? conn_->get_stream() : nullptr;
+}
+
+void ClientConnectionSession::send_query_info_1_6()
+{
+    send([](IClientConnection& conn) { conn.send_query_info_1_6(); });
+}
+
+void ClientConnectionSession::send_enter_1_6(std::int32_t x_abs, std::int32_t y_abs,
+                                             std::uint32_t seq_num, KeyModifierMask mask)
+{
+    send([=](IClientConnection& conn) { conn.send_enter_1_6(x_abs, y_abs, seq_num, mask); });
+}
+
+void ClientConnectionSession::send_leave_1_6()
+{
+    send([](IClientConnection& conn) { conn.send_leave_1_6(); });
+}
+
+void ClientConnectionSession::send_key_down_1_6(KeyID key, KeyModifierMask mask,
+                                                KeyButton button)
+{
+    send([=](IClientConnection& conn) { conn.send_key_down_1_6(key, mask, button); });
+}
+
+void ClientConnectionSession::send_key_up_1_6(KeyID key, KeyModifierMask mask,
+                                              KeyButton button)
+{
+    send([=](IClientConnection& conn) { conn.send_key_up_1_6(key, mask, button); });
+}
+
+void ClientConnectionSession::send_key_repeat_1_6(KeyID key, KeyModifierMask mask,
+                                                  std::int32_t count, KeyButton button)
+{
+    send([=](IClientConnection& conn) { conn.send_key_repeat_1_6(key, mask, count, button); });
+}
+
+void ClientConnectionSession::send_mouse_down_1_6(ButtonID button)
+{
+    send([=](IClientConnection& conn) { conn.send_mouse_down_1_6(button); });
+}
+
+void ClientConnectionSession::send_mouse_up_1_6(ButtonID button)
+{
+    send([=](IClientConnection& conn) { conn.send_mouse_up_1_6(button); });
+}
+
+void ClientConnectionSession::send_mouse_move_1_6(std::int32_t x_abs, std::int32_t y_abs)
+{
+    send([=](IClientConnection& conn) { conn.send_mouse_move_1_6(x_abs, y_abs); });
+}
+
+void ClientConnectionSession::send_mouse_relative_move_1_6(std::int32_t x_rel, std::int32_t y_rel)
+{
+    send([=](IClientConnection& conn) { conn.send_mouse_relative_move_1_6(x_rel, y_rel); });
+}
+
+void ClientConnectionSession::send_mouse_move_timed_1_6(std::int32_t x_abs, std::int32_t y_abs,
+                                                        std::uint32_t captured,
+                                                        std::uint32_t sent)
+{
+    send([=](IClientConnection& conn)
+    {
+        conn.send_mouse_move_timed_1_6(x_abs, y_abs, captured, sent);
+    });
+}
+
+void ClientConnectionSession::send_mouse_relative_move_timed_1_6(std::int32_t x_rel,
+                                                                 std::int32_t y_rel,
+                                                                 std::uint32_t captured,
+                                                                 std::uint32_t sent)
+{
+    send([=](IClientConnection& conn)
+    {
+        conn.send_mouse_relative_move_timed_1_6(x_rel, y_rel, captured, sent);
+    });
+}
+
+void ClientConnectionSession::send_mouse_wheel_1_6(std::int32_t x_delta, std::int32_t y_delta)
+{
+    send([=](IClientConnection& conn) { conn.send_mouse_wheel_1_6(x_delta, y_delta); });
+}
+
+void ClientConnectionSession::send_drag_info_1_6(std::uint32_t file_count,
+                                                 const std::string& data)
+{
+    send([=](IClientConnection& conn) { conn.send_drag_info_1_6(file_count, data); },
+         kMessageSize + data.size());
+}
+
+void ClientConnectionSession::send_screensaver_1_6(bool on)
+{
+    send([=](IClientConnection& conn) { conn.send_screensaver_1_6(on); });
+}
+
+void ClientConnectionSession::send_reset_options_1_6()
+{
+    send([](IClientConnection& conn) { conn.send_reset_options_1_6(); });
+}
+
+void ClientConnectionSession::send_set_options_1_6(const OptionsList& options)
+{
+    send([=](IClientConnection& conn) { conn.send_set_options_1_6(options); },
+         kMessageSize + 4 * options.size());
+}
+
+void ClientConnectionSession::send_info_ack_1_6()
+{
+    send([](IClientConnection& conn) { conn.send_info_ack_1_6(); });
+}
+
+void ClientConnectionSession::send_keep_alive_1_6()
+{
+    send_once([](IClientConnection& conn) { conn.send_keep_alive_1_6(); });
+}
+
+void ClientConnectionSession::send_keep_alive_timed_1_6(std::uint32_t time,
+                                                        std::uint32_t timeout_ms)
+{
+    send_once([=](IClientConnection& conn) { conn.send_keep_alive_timed_1_6(time, timeout_ms); });
+}
+
+void ClientConnectionSession::send_datagram_offer_1_6(std::uint16_t port, std::uint32_t session,
+                                                      const std::string& key)
+{
+    send([=](IClientConnection& conn) { conn.send_datagram_offer_1_6(port, session, key); });
+}
+
+void ClientConnectionSession::send_motion_sync_1_6(const MotionDatagram& sync)
+{
+    send([=](IClientConnection& conn) { conn.send_motion_sync_1_6(sync); });
+}
+
+void ClientConnectionSession::send_clock_1_6(std::uint32_t query_time, std::uint32_t time)
+{
+    send_once([=](IClientConnection& conn) { conn.send_clock_1_6(query_time, time); });
+}
+
+void ClientConnectionSession::send_noop_1_6()
+{
+    send([](IClientConnection& conn) { conn.send_noop_1_6(); });
+}
+
+void ClientConnectionSession::send_session_1_6(const std::string& token)
+{
+    // precedes the counted messages
+    if (conn_) {
+        conn_->send_session_1_6(token);
+    }
+}
+
+void ClientConnectionSession::send_resume_1_6(bool resumed)
+{
+    // precedes the messages sent again
+    if (conn_) {
+        conn_->send_resume_1_6(resumed);
+    }
+}
+
+void ClientConnectionSession::send_close_1_6(const char* msg)
+{
+    send_once([=](IClientConnection& conn) { conn.send_close_1_6(msg); });
+}
+
+void ClientConnectionSession::send_clipboard_chunk_1_6(const ClipboardChunk& chunk)
+{
+    send([=](IClientConnection& conn) { conn.send_clipboard_chunk_1_6(chunk); },
+         kMessageSize + chunk.data_.size());
+}
+
+void ClientConnectionSession::send_clipboard_cached_1_6(ClipboardID id, std::uint32_t sequence,
+                                                        const std::string& hash)
+{
+    send([=](IClientConnection& conn) { conn.send_clipboard_cached_1_6(id, sequence, hash); },
+         kMessageSize + hash.size());
+}
+
+void ClientConnectionSession::send_clipboard_formats_1_6(ClipboardID id, std::uint32_t sequence,
+                                                         const std::vector<std::uint32_t>& formats)
+{
+    send([=](IClientConnection& conn) { conn.send_clipboard_formats_1_6(id, sequence, formats); },
+         kMessageSize + 4 * formats.size());
+}
+
+void ClientConnectionSession::send_file_chunk_1_6(const FileChunk& chunk)
+{
+    send([=](IClientConnection& conn) { conn.send_file_chunk_1_6(chunk); },
+         kMessageSize + chunk.data_.size());
+}
+
+void ClientConnectionSession::send_grab_clipboard(ClipboardID id)
+{
+    send([=](IClientConnection& conn) { conn.send_grab_clipboard(id); });
+}
+
+void ClientConnectionSession::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (conn_) {
+        conn_->flush();
+    }
+}
+
+void ClientConnectionSession::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (conn_) {
+        conn_->close();
+    }
+}
+
+} // namespace inputleap
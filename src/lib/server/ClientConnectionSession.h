@@ -0,0 +1,185 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "IClientConnection.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace inputleap {
+
+/// Wraps a IClientConnection and keeps the messages sent to it for resuming the session.
+/*!
+Once started, the messages sent through the session are counted and kept
+until the client acknowledges them.  When the connection is lost it can
+be detached, in which case messages are only kept, and later a new
+connection can be attached.  The messages that the client didn't receive
+on the old connection are then sent again on the new one.
+
+Keep alives and clock replies are only meaningful when they are sent, so
+they are replaced by no-ops when sent again.  The number of kept messages
+is bounded; if the client falls too far behind the oldest messages are
+dropped and the session can't be resumed until the client acknowledges
+past them.
+
+Messages may be sent from any thread.  They are counted in the order they
+are written to the connection.
+*/
+class ClientConnectionSession : public IClientConnection {
+public:
+    ClientConnectionSession(std::unique_ptr<IClientConnection> conn);
+    ~ClientConnectionSession() override;
+
+    //! @name manipulators
+    //@{
+
+    //! Start counting and keeping messages
+    void start();
+
+    //! Drop messages that the client received
+    /*!
+    \p received is the number of messages the client received since the
+    session was started.  Invalid numbers are ignored.
+    */
+    void acknowledge(std::uint32_t received);
+
+    //! Detach the connection
+    /*!
+    Returns the connection, if any.  Messages are kept but not sent until a
+    connection is attached.
+    */
+    std::unique_ptr<IClientConnection> detach();
+
+    //! Attach a connection
+    /*!
+    Uses \p conn for the session and sends it the messages following the
+    first \p received.  \c can_resume(received) must be true.
+    */
+    void attach(std::unique_ptr<IClientConnection> conn, std::uint32_t received);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Check if messages are counted and kept
+    bool is_started() const;
+
+    //! Check if there's a connection
+    bool is_attached() const;
+
+    //! Check if a client can resume the session
+    /*!
+    Returns true if the session was started and all messages following the
+    first \p received are kept.
+    */
+    bool can_resume(std::uint32_t received) const;
+
+    //! Get the number of messages sent since the session was started
+    std::uint32_t get_sent() const;
+
+    //! Get the number of kept messages
+    std::size_t get_kept() const;
+
+    //@}
+
+    // IClientConnection overrides
+    const EventTarget* get_event_target() override;
+    IStream* get_stream() override;
+
+    void send_query_info_1_6() override;
+    void send_enter_1_6(std::int32_t x_abs, std::int32_t y_abs, std::uint32_t seq_num,
+                        KeyModifierMask mask) override;
+    void send_leave_1_6() override;
+    void send_key_down_1_6(KeyID key, KeyModifierMask mask, KeyButton button) override;
+    void send_key_up_1_6(KeyID key, KeyModifierMask mask, KeyButton button) override;
+    void send_key_repeat_1_6(KeyID key, KeyModifierMask mask, std::int32_t count,
+                             KeyButton button) override;
+    void send_mouse_down_1_6(ButtonID button) override;
+    void send_mouse_up_1_6(ButtonID button) override;
+    void send_mouse_move_1_6(std::int32_t x_abs, std::int32_t y_abs) override;
+    void send_mouse_relative_move_1_6(std::int32_t x_rel, std::int32_t y_rel) override;
+    void send_mouse_move_timed_1_6(std::int32_t x_abs, std::int32_t y_abs,
+                                   std::uint32_t captured, std::uint32_t sent) override;
+    void send_mouse_relative_move_timed_1_6(std::int32_t x_rel, std::int32_t y_rel,
+                                            std::uint32_t captured, std::uint32_t sent) override;
+    void send_mouse_wheel_1_6(std::int32_t x_delta, std::int32_t y_delta) override;
+    void send_drag_info_1_6(std::uint32_t file_count, const std::string& data) override;
+    void send_screensaver_1_6(bool on) override;
+    void send_reset_options_1_6() override;
+    void send_set_options_1_6(const OptionsList& options) override;
+    void send_info_ack_1_6() override;
+    void send_keep_alive_1_6() override;
+    void send_keep_alive_timed_1_6(std::uint32_t time, std::uint32_t timeout_ms) override;
+    void send_datagram_offer_1_6(std::uint16_t port, std::uint32_t session,
+                                 const std::string& key) override;
+    void send_motion_sync_1_6(const MotionDatagram& sync) override;
+    void send_clock_1_6(std::uint32_t query_time, std::uint32_t time) override;
+    void send_noop_1_6() override;
+    void send_session_1_6(const std::string& token) override;
+    void send_resume_1_6(bool resumed) override;
+    void send_close_1_6(const char* msg) override;
+
+    void send_clipboard_chunk_1_6(const ClipboardChunk& chunk) override;
+    void send_clipboard_cached_1_6(ClipboardID id, std::uint32_t sequence,
+                                   const std::string& hash) override;
+    void send_clipboard_formats_1_6(ClipboardID id, std::uint32_t sequence,
+                                    const std::vector<std::uint32_t>& formats) override;
+    void send_file_chunk_1_6(const FileChunk& chunk) override;
+    void send_grab_clipboard(ClipboardID id) override;
+
+    void flush() override;
+    void close() override;
+
+private:
+    typedef std::function<void(IClientConnection&)> Sender;
+
+    struct Message {
+        Sender send;
+        std::size_t size;
+    };
+
+    // send a message and keep it.  size is roughly its size on the wire.
+    void send(Sender sender, std::size_t size = kMessageSize);
+
+    // send a message that is replaced by a no-op when sent again
+    void send_once(const Sender& sender);
+
+    // count and keep a message
+    void keep(Sender sender, std::size_t size);
+
+    // can_resume() and acknowledge() with mutex_ locked
+    bool is_kept(std::uint32_t received) const;
+    void drop_received(std::uint32_t received);
+
+private:
+    static const std::size_t kMessageSize = 16;
+
+    // guards everything below.  held while writing to the connection so
+    // messages go out in the order they are counted.
+    mutable std::mutex mutex_;
+    std::unique_ptr<IClientConnection> conn_;
+    bool started_ = false;
+    std::uint32_t sent_ = 0;
+    std::deque<Message> kept_;
+    std::size_t kept_size_ = 0;
+};
+
+} // namespace inputleap
@@ -20,13 +20,18 @@
 
 #include "server/ClientProxy.h"
 #include "server/ClientProxyUnknown.h"
+#include "server/MotionDatagramListener.h"
 #include "inputleap/PacketStreamFilter.h"
+#include "inputleap/protocol_types.h"
 #include "net/IDataSocket.h"
 #include "net/IListenSocket.h"
 #include "net/ISocketFactory.h"
+#include "net/UDPSocket.h"
 #include "net/XSocket.h"
 #include "base/Log.h"
+#include "base/EventQueueTimer.h"
 #include "base/IEventQueue.h"
+#include "base/Time.h"
 
 namespace inputleap {
 
@@ -37,7 +42,8 @@ ClientListener::ClientListener(const NetworkAddress& address,
     socket_factory_{std::move(socket_factory)},
     m_server(nullptr),
     m_events(events),
-    security_level_{security_level}
+    security_level_{security_level},
+    address_{address}
 {
     try {
         listen_ = socket_factory_->create_listen(ARCH->getAddrFamily(address.getAddress()),
@@ -46,6 +52,9 @@ ClientListener::ClientListener(const NetworkAddress& address,
         // setup event handler
         m_events->add_handler(EventType::LISTEN_SOCKET_CONNECTING, listen_->get_event_target(),
                               [this](const auto& e){ handle_client_connecting(); });
+        listen_->set_admission_filter([this](const NetworkAddress& peer) {
+            return admit(peer);
+        });
 
         // bind listen address
         LOG_DEBUG1("binding listen socket");
@@ -62,15 +71,22 @@ ClientListener::ClientListener(const NetworkAddress& address,
         throw;
     }
     LOG_DEBUG1("listening for clients");
+
+    sweep_timer_ = m_events->newTimer(1.0, nullptr);
+    m_events->add_handler(EventType::TIMER, sweep_timer_,
+                          [this](const auto& e){ handle_sweep(); });
 }
 
 ClientListener::~ClientListener()
 {
     LOG_DEBUG1("stop listening for clients");
 
+    m_events->remove_handler(EventType::TIMER, sweep_timer_);
+    m_events->deleteTimer(sweep_timer_);
+
     // discard already connected clients
     for (auto index = m_newClients.begin(); index != m_newClients.end(); ++index) {
-        ClientProxyUnknown* client = *index;
+        ClientProxyUnknown* client = index->first;
         m_events->remove_handler(EventType::CLIENT_PROXY_UNKNOWN_SUCCESS, client);
         m_events->remove_handler(EventType::CLIENT_PROXY_UNKNOWN_FAILURE, client);
         m_events->remove_handler(EventType::CLIENT_PROXY_DISCONNECTED, client);
@@ -86,6 +102,7 @@ ClientListener::~ClientListener()
 
     cleanupListenSocket();
     cleanupClientSockets();
+    datagrams_.reset();
 }
 
 void
@@ -95,6 +112,36 @@ ClientListener::setServer(Server* server)
     m_server = server;
 }
 
+std::unique_ptr<MotionDatagramLane>
+ClientListener::create_motion_datagram_lane(const std::string& name)
+{
+    if (!datagrams_ && !datagrams_failed_) {
+        try {
+            auto socket = socket_factory_->create_datagram(
+                        ARCH->getAddrFamily(address_.getAddress()));
+            socket->bind(address_);
+            datagrams_ = std::make_unique<MotionDatagramListener>(m_events, std::move(socket),
+                                                                  address_.getPort());
+            LOG_DEBUG1("listening for motion datagrams");
+        }
+        catch (XBase& e) {
+            // don't retry for every client, motion just keeps using the stream
+            LOG_WARN("cannot listen for motion datagrams: %s", e.what());
+            datagrams_failed_ = true;
+        }
+    }
+
+    if (!datagrams_) {
+        return {};
+    }
+    return datagrams_->create_lane(name);
+}
+
+std::size_t ClientListener::get_pending_count() const
+{
+    return accept_times_.size() + m_newClients.size();
+}
+
 ClientProxy*
 ClientListener::getNextClient()
 {
@@ -118,6 +165,7 @@ void ClientListener::handle_client_connecting()
 
     auto socket_ptr = socket.get();
     client_sockets_.insert(std::move(socket));
+    accept_times_[socket_ptr] = current_time_seconds();
 
     m_events->add_handler(EventType::CLIENT_LISTENER_ACCEPTED, socket_ptr->get_event_target(),
                           [this, socket_ptr](const auto& e)
@@ -139,6 +187,12 @@ void ClientListener::handle_client_accepted(IDataSocket* socket_ptr)
     if (!socket) {
         throw std::runtime_error("Got more than one CLIENT_LISTENER_ACCEPTED event");
     }
+    double accepted = accept_times_[socket_ptr];
+    accept_times_.erase(socket_ptr);
+
+    // find packet boundaries on the socket's worker thread so the event
+    // loop only wakes up for whole messages
+    socket->set_packet_framing(PROTOCOL_MAX_MESSAGE_LENGTH);
 
     // filter socket messages, including a packetizing filter
     auto stream = std::make_unique<PacketStreamFilter>(m_events, std::move(socket));
@@ -148,7 +202,7 @@ void ClientListener::handle_client_accepted(IDataSocket* socket_ptr)
     ClientProxyUnknown* client = new ClientProxyUnknown(std::move(stream), 30.0, m_server,
                                                         m_events);
 
-    m_newClients.insert(client);
+    m_newClients[client] = accepted;
 
     // watch for events from unknown client
     m_events->add_handler(EventType::CLIENT_PROXY_UNKNOWN_SUCCESS, client,
@@ -203,6 +257,127 @@ void ClientListener::handle_client_disconnected(ClientProxy* client)
     }
 }
 
+void ClientListener::handle_sweep()
+{
+    shed_idle(current_time_seconds(), false);
+
+    std::uint64_t rejected = counters_.rejected_rate + counters_.rejected_full;
+    std::uint64_t shed = counters_.shed_idle;
+
+    // a flood is worth knowing about but not worth a line per connection
+    if (rejected + shed > reported_rejections_) {
+        LOG_NOTE("turned away %llu connections; so far %llu accepted, %llu connected too "
+                 "often, %llu found the handshake queue full, %llu were silent",
+                 static_cast<unsigned long long>(rejected + shed - reported_rejections_),
+                 static_cast<unsigned long long>(counters_.accepted),
+                 static_cast<unsigned long long>(counters_.rejected_rate),
+                 static_cast<unsigned long long>(counters_.rejected_full),
+                 static_cast<unsigned long long>(counters_.shed_idle));
+        reported_rejections_ = rejected + shed;
+    }
+}
+
+bool ClientListener::admit(const NetworkAddress& peer)
+{
+    double now = current_time_seconds();
+    std::string source = peer.getHostname();
+
+    if (!limiter_.try_acquire(source, now)) {
+        ++counters_.rejected_rate;
+        LOG_DEBUG1("rejecting connection from %s: connecting too often", source.c_str());
+        return false;
+    }
+
+    if (get_pending_count() >= kMaxPendingHandshakes && shed_idle(now, true) == 0) {
+        ++counters_.rejected_full;
+        LOG_DEBUG1("rejecting connection from %s: too many handshakes in progress",
+                   source.c_str());
+        return false;
+    }
+
+    ++counters_.accepted;
+    return true;
+}
+
+std::size_t ClientListener::shed_idle(double now, bool make_room)
+{
+    std::size_t shed = 0;
+    double oldest_time = now;
+    IDataSocket* oldest_socket = nullptr;
+    ClientProxyUnknown* oldest_client = nullptr;
+
+    // sockets still in the TLS handshake haven't said anything yet
+    for (auto i = accept_times_.begin(); i != accept_times_.end();) {
+        IDataSocket* socket = i->first;
+        double accepted = i->second;
+        ++i;
+        if (now - accepted >= kPendingIdleTimeout) {
+            close_socket(socket);
+            ++shed;
+        }
+        else if (accepted < oldest_time) {
+            oldest_time = accepted;
+            oldest_socket = socket;
+            oldest_client = nullptr;
+        }
+    }
+
+    for (auto i = m_newClients.begin(); i != m_newClients.end();) {
+        ClientProxyUnknown* client = i->first;
+        double accepted = i->second;
+        ++i;
+        if (client->has_received_data()) {
+            continue;
+        }
+        if (now - accepted >= kPendingIdleTimeout) {
+            close_unknown_client(client);
+            ++shed;
+        }
+        else if (accepted < oldest_time) {
+            oldest_time = accepted;
+            oldest_socket = nullptr;
+            oldest_client = client;
+        }
+    }
+
+    if (make_room && shed == 0 && now - oldest_time >= kEvictGracePeriod) {
+        if (oldest_socket != nullptr) {
+            close_socket(oldest_socket);
+            ++shed;
+        }
+        else if (oldest_client != nullptr) {
+            close_unknown_client(oldest_client);
+            ++shed;
+        }
+    }
+
+    if (shed != 0) {
+        LOG_DEBUG1("closed %u silent connections", static_cast<unsigned>(shed));
+    }
+    counters_.shed_idle += shed;
+    return shed;
+}
+
+void ClientListener::close_socket(IDataSocket* socket)
+{
+    m_events->remove_handler(EventType::CLIENT_LISTENER_ACCEPTED, socket->get_event_target());
+    accept_times_.erase(socket);
+    client_sockets_.erase(socket);
+}
+
+void ClientListener::close_unknown_client(ClientProxyUnknown* client)
+{
+    m_events->remove_handler(EventType::CLIENT_PROXY_UNKNOWN_SUCCESS, client);
+    m_events->remove_handler(EventType::CLIENT_PROXY_UNKNOWN_FAILURE, client);
+
+    auto* stream = client->getStream();
+    if (stream) {
+        stream->close();
+    }
+    m_newClients.erase(client);
+    delete client;
+}
+
 void
 ClientListener::cleanupListenSocket()
 {
@@ -214,6 +389,7 @@ void
 ClientListener::cleanupClientSockets()
 {
     client_sockets_.clear();
+    accept_times_.clear();
 }
 
 } // namespace inputleap
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "server/AcceptLimiter.h"
 #include "server/Config.h"
 #include "base/EventTarget.h"
 #include "base/EventTypes.h"
@@ -25,18 +26,45 @@
 #include "base/UniquePtrContainer.h"
 #include "net/ConnectionSecurityLevel.h"
 #include "net/Fwd.h"
+#include "net/NetworkAddress.h"
+#include <cstdint>
 #include <deque>
+#include <map>
 #include <memory>
-#include <set>
 
 namespace inputleap {
 
 class ClientProxy;
 class ClientProxyUnknown;
+class MotionDatagramLane;
+class MotionDatagramListener;
 class Server;
 
 class ClientListener : public EventTarget {
 public:
+    //! Connection counters
+    struct Counters {
+        std::uint64_t accepted = 0;
+        std::uint64_t rejected_rate = 0;    // the source connected too often
+        std::uint64_t rejected_full = 0;    // too many handshakes in progress
+        std::uint64_t shed_idle = 0;        // closed before replying to the hello
+    };
+
+    //! Maximum number of connections still in the handshake
+    static constexpr std::size_t kMaxPendingHandshakes = 32;
+
+    //! Seconds a connection may stay silent before it is closed
+    static constexpr double kPendingIdleTimeout = 5.0;
+
+    //! Seconds a silent connection is safe from being closed to make room
+    /*!
+    When the handshake queue is full the oldest silent connection makes
+    room for a new one, but only once it is older than this.  Otherwise
+    the new connection is turned away, so a flood can't push out clients
+    that are still in the middle of their TLS handshake.
+    */
+    static constexpr double kEvictGracePeriod = 1.0;
+
     // The factories are adopted.
     ClientListener(const NetworkAddress&,
                    std::unique_ptr<ISocketFactory> socket_factory, IEventQueue* events,
@@ -48,6 +76,14 @@ public:
 
     void setServer(Server* server);
 
+    //! Create a motion datagram lane
+    /*!
+    Returns a lane for the client named \p name, or nullptr if datagrams
+    can't be received on the listen address.  The datagram socket is
+    opened on first use.
+    */
+    std::unique_ptr<MotionDatagramLane> create_motion_datagram_lane(const std::string& name);
+
     //@}
 
     //! @name accessors
@@ -64,6 +100,12 @@ public:
     //! Get server which owns this listener
     Server* getServer() { return m_server; }
 
+    //! Get the connection counters
+    const Counters& get_counters() const { return counters_; }
+
+    //! Get the number of connections still in the handshake
+    std::size_t get_pending_count() const;
+
     //@}
 
 private:
@@ -72,12 +114,25 @@ private:
     void handle_client_accepted(IDataSocket* socket_ptr);
     void handle_unknown_client(ClientProxyUnknown* client);
     void handle_client_disconnected(ClientProxy* client);
+    void handle_sweep();
+
+    // decides if a connection from peer is set up at all
+    bool admit(const NetworkAddress& peer);
+
+    // closes connections that were silent for too long, or the oldest
+    // silent one past the grace period if make_room is true.  returns the
+    // number closed.
+    std::size_t shed_idle(double now, bool make_room);
+    void close_socket(IDataSocket* socket);
+    void close_unknown_client(ClientProxyUnknown* client);
 
     void cleanupListenSocket();
     void cleanupClientSockets();
 
 private:
-    typedef std::set<ClientProxyUnknown*> NewClients;
+    // the values are the times the connections were accepted
+    typedef std::map<ClientProxyUnknown*, double> NewClients;
+    typedef std::map<IDataSocket*, double> AcceptedSockets;
     typedef std::deque<ClientProxy*> WaitingClients;
 
     std::unique_ptr<IListenSocket> listen_;
@@ -88,6 +143,14 @@ private:
     IEventQueue* m_events;
     ConnectionSecurityLevel security_level_;
     UniquePtrContainer<IDataSocket> client_sockets_;
+    AcceptedSockets accept_times_;
+    AcceptLimiter limiter_;
+    Counters counters_;
+    EventQueueTimer* sweep_timer_ = nullptr;
+    std::uint64_t reported_rejections_ = 0;
+    NetworkAddress address_;
+    std::unique_ptr<MotionDatagramListener> datagrams_;
+    bool datagrams_failed_ = false;
 };
 
 } // namespace inputleap
@@ -18,44 +18,43 @@
 
 #include "server/ClientProxy1_6.h"
 #include "ClientConnectionByStream.h"
+#include "ClientConnectionSession.h"
 
 #include "inputleap/ProtocolUtil.h"
+#include "inputleap/ClipboardCache.h"
 #include "inputleap/ClipboardChunk.h"
 #include "inputleap/Exceptions.h"
 #include "inputleap/FileChunk.h"
 #include "inputleap/StreamChunker.h"
+#include "server/MotionDatagramListener.h"
 #include "server/Server.h"
 #include "io/IStream.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 #include "base/EventQueueTimer.h"
+#include "base/Time.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <random>
 
 namespace inputleap {
 
 ClientProxy1_6::ClientProxy1_6(const std::string& name,
                                std::unique_ptr<IClientConnection> backend,
                                Server* server, IEventQueue* events) :
-    ClientProxy(name, std::move(backend)),
+    ClientProxy(name, std::make_unique<ClientConnectionSession>(std::move(backend))),
     m_heartbeatTimer(nullptr),
     m_parser(&ClientProxy1_6::parseHandshakeMessage),
     m_events(events),
     m_keepAliveRate(kKeepAliveRate),
     m_keepAliveTimer(nullptr),
-    m_server{server}
+    m_server{server},
+    session_{static_cast<ClientConnectionSession*>(&get_conn())}
 {
     // install event handlers
-    m_events->add_handler(EventType::STREAM_INPUT_READY, get_conn().get_event_target(),
-                          [this](const auto& e){ handle_data(); });
-    m_events->add_handler(EventType::STREAM_OUTPUT_ERROR, get_conn().get_event_target(),
-                          [this](const auto& e){ handle_write_error(); });
-    m_events->add_handler(EventType::STREAM_INPUT_SHUTDOWN, get_conn().get_event_target(),
-                          [this](const auto& e){ handle_disconnect(); });
-    m_events->add_handler(EventType::STREAM_INPUT_FORMAT_ERROR, get_conn().get_event_target(),
-                          [this](const auto& e){ handle_disconnect(); });
-    m_events->add_handler(EventType::STREAM_OUTPUT_SHUTDOWN, get_conn().get_event_target(),
-                          [this](const auto& e){ handle_write_error(); });
+    add_stream_handlers();
     m_events->add_handler(EventType::FILE_KEEPALIVE, this,
                           [this](const auto& e){ keepAlive(); });
     m_events->add_handler(EventType::CLIPBOARD_SENDING, this,
@@ -72,6 +71,28 @@ ClientProxy1_6::ClientProxy1_6(const std::string& name,
 
 ClientProxy1_6::~ClientProxy1_6()
 {
+    if (hook_to_send_.get_count() != 0) {
+        auto latency = hook_to_send_.get_summary();
+        LOG_DEBUG("input latency to \"%s\" from capture to send: p50=%uus p99=%uus p999=%uus",
+                  getName().c_str(), latency.p50, latency.p99, latency.p999);
+    }
+    if (clipboard_offers_ != 0) {
+        LOG_DEBUG("cached clipboards for \"%s\": offered=%llu missed=%llu bytes not sent=%llu",
+                  getName().c_str(), static_cast<unsigned long long>(clipboard_offers_),
+                  static_cast<unsigned long long>(clipboard_misses_),
+                  static_cast<unsigned long long>(clipboard_bytes_offered_));
+    }
+    if (clipboard_formats_sent_ != 0) {
+        LOG_DEBUG("lazy clipboards for \"%s\": announced=%u bytes deferred=%llu fetched=%llu",
+                  getName().c_str(), clipboard_formats_sent_,
+                  static_cast<unsigned long long>(clipboard_bytes_deferred_),
+                  static_cast<unsigned long long>(clipboard_bytes_fetched_));
+    }
+    if (round_trip_latency_.get_count() != 0) {
+        auto latency = round_trip_latency_.get_summary();
+        LOG_DEBUG("round trip to \"%s\": p50=%uus p99=%uus p999=%uus",
+                  getName().c_str(), latency.p50, latency.p99, latency.p999);
+    }
     remove_handlers();
 }
 
@@ -87,20 +108,48 @@ void ClientProxy1_6::disconnect()
     m_events->add_event(EventType::CLIENT_PROXY_DISCONNECTED, get_event_target());
 }
 
-void ClientProxy1_6::remove_handlers()
+void ClientProxy1_6::add_stream_handlers()
 {
-    // uninstall event handlers
+    m_events->add_handler(EventType::STREAM_INPUT_READY, get_conn().get_event_target(),
+                          [this](const auto& e){ handle_data(); });
+    m_events->add_handler(EventType::STREAM_OUTPUT_ERROR, get_conn().get_event_target(),
+                          [this](const auto& e){ handle_write_error(); });
+    m_events->add_handler(EventType::STREAM_INPUT_SHUTDOWN, get_conn().get_event_target(),
+                          [this](const auto& e){ handle_disconnect(); });
+    m_events->add_handler(EventType::STREAM_INPUT_FORMAT_ERROR, get_conn().get_event_target(),
+                          [this](const auto& e){ handle_disconnect(); });
+    m_events->add_handler(EventType::STREAM_OUTPUT_SHUTDOWN, get_conn().get_event_target(),
+                          [this](const auto& e){ handle_write_error(); });
+}
+
+void ClientProxy1_6::remove_stream_handlers()
+{
+    // there's no stream while the session is suspended
+    if (!session_->is_attached()) {
+        return;
+    }
     m_events->remove_handler(EventType::STREAM_INPUT_READY, get_conn().get_event_target());
     m_events->remove_handler(EventType::STREAM_OUTPUT_ERROR, get_conn().get_event_target());
     m_events->remove_handler(EventType::STREAM_INPUT_SHUTDOWN, get_conn().get_event_target());
     m_events->remove_handler(EventType::STREAM_OUTPUT_SHUTDOWN, get_conn().get_event_target());
     m_events->remove_handler(EventType::STREAM_INPUT_FORMAT_ERROR, get_conn().get_event_target());
+}
+
+void ClientProxy1_6::remove_handlers()
+{
+    // uninstall event handlers
+    remove_stream_handlers();
     m_events->remove_handler(EventType::FILE_KEEPALIVE, this);
     m_events->remove_handler(EventType::CLIPBOARD_SENDING, this);
     m_events->remove_handler(EventType::TIMER, this);
 
-    // remove timer
+    // remove timers
     removeHeartbeatTimer();
+    if (session_timer_ != nullptr) {
+        m_events->remove_handler(EventType::TIMER, session_timer_);
+        m_events->deleteTimer(session_timer_);
+        session_timer_ = nullptr;
+    }
 }
 
 void ClientProxy1_6::addHeartbeatTimer()
@@ -145,6 +194,7 @@ void ClientProxy1_6::resetHeartbeatTimer()
 
 void ClientProxy1_6::resetHeartbeatRate()
 {
+    configured_keep_alive_rate_ = kKeepAliveRate;
     setHeartbeatRate(kKeepAliveRate, kKeepAliveRate * kKeepAlivesUntilDeath);
 }
 
@@ -156,11 +206,14 @@ void ClientProxy1_6::setHeartbeatRate(double rate, double alarm)
 
 void ClientProxy1_6::handle_data()
 {
-    // handle messages until there are no more.  first read message code.
-    std::uint8_t code[4];
-    std::uint32_t n = getStream()->read(code, 4);
-    while (n != 0) {
+    // handle messages until there are no more or the budget runs out.
+    // each message is taken off the stream whole and parsed from memory.
+    frames_.set_stream(getStream());
+    read_budget_.start(current_time_seconds());
+    while (frames_.read_frame()) {
         // verify we got an entire code
+        std::uint8_t code[4];
+        std::uint32_t n = frames_.read(code, 4);
         if (n != 4) {
             LOG_ERR("incomplete message from \"%s\": %d bytes", getName().c_str(), n);
             disconnect();
@@ -184,8 +237,18 @@ void ClientProxy1_6::handle_data()
             return;
         }
 
-        // next message
-        n = getStream()->read(code, 4);
+        // the connection was handed over to another proxy
+        if (!session_->is_attached()) {
+            return;
+        }
+
+        // don't hold up the other screens if this one has fallen behind
+        if (!read_budget_.consume(current_time_seconds()) && getStream()->isReady()) {
+            LOG_DEBUG2("yielding after %u messages from \"%s\"", read_budget_.get_count(),
+                       getName().c_str());
+            m_events->add_event(EventType::STREAM_INPUT_READY, get_conn().get_event_target());
+            break;
+        }
     }
 
     // restart heartbeat timer
@@ -210,6 +273,9 @@ bool ClientProxy1_6::parseHandshakeMessage(const std::uint8_t* code)
             return true;
         }
     }
+    else if (memcmp(code, kMsgQResume, 4) == 0) {
+        return recvResume();
+    }
     return false;
 }
 
@@ -225,6 +291,8 @@ bool ClientProxy1_6::parseMessage(const std::uint8_t* code)
         // reset alarm
         resetHeartbeatTimer();
         return true;
+    } else if (memcmp(code, kMsgCKeepAliveEcho, 4) == 0) {
+        return recvKeepAliveEcho();
     } else if (memcmp(code, kMsgDInfo, 4) == 0) {
         if (recvInfo()) {
             m_events->add_event(EventType::SCREEN_SHAPE_CHANGED, get_event_target());
@@ -243,25 +311,54 @@ bool ClientProxy1_6::parseMessage(const std::uint8_t* code)
     else if (memcmp(code, kMsgDClipboard, 4) == 0) {
         return recvClipboard();
     }
+    else if (memcmp(code, kMsgCFeatures, 4) == 0) {
+        return recvFeatures();
+    }
+    else if (memcmp(code, kMsgQClock, 4) == 0) {
+        return recvClockQuery();
+    }
+    else if (memcmp(code, kMsgCSessionAck, 4) == 0) {
+        return recvSessionAck();
+    }
+    else if (memcmp(code, kMsgCClipboardMiss, 4) == 0) {
+        return recvClipboardMiss();
+    }
+    else if (memcmp(code, kMsgQClipboard, 4) == 0) {
+        return recvClipboardQuery();
+    }
     return false;
 }
 
 void ClientProxy1_6::handle_disconnect()
 {
     LOG_NOTE("client \"%s\" has disconnected", getName().c_str());
-    disconnect();
+    if (!suspendSession()) {
+        disconnect();
+    }
 }
 
 void ClientProxy1_6::handle_write_error()
 {
     LOG_WARN("error writing to client \"%s\"", getName().c_str());
-    disconnect();
+    if (!suspendSession()) {
+        disconnect();
+    }
 }
 
 void ClientProxy1_6::handle_flatline()
 {
     // didn't get a heartbeat fast enough.  assume client is dead.
-    LOG_NOTE("client \"%s\" is dead", getName().c_str());
+    LOG_NOTE("client \"%s\" is dead, nothing received for %.1fs", getName().c_str(),
+             m_heartbeatAlarm);
+    if (!suspendSession()) {
+        disconnect();
+    }
+}
+
+void ClientProxy1_6::handle_session_expired()
+{
+    LOG_NOTE("client \"%s\" did not resume its session within %.1fs", getName().c_str(),
+             kSessionGracePeriod);
     disconnect();
 }
 
@@ -295,11 +392,13 @@ void ClientProxy1_6::getCursorPos(std::int32_t& x, std::int32_t& y) const
 void ClientProxy1_6::enter(std::int32_t xAbs, std::int32_t yAbs, std::uint32_t seqNum,
                            KeyModifierMask mask, bool)
 {
+    syncMotion();
     get_conn().send_enter_1_6(xAbs, yAbs, seqNum, mask);
 }
 
 bool ClientProxy1_6::leave()
 {
+    syncMotion();
     get_conn().send_leave_1_6();
     // we can never prevent the user from leaving
     return true;
@@ -313,13 +412,47 @@ void ClientProxy1_6::setClipboard(ClipboardID id, const IClipboard* clipboard)
         m_clipboard[id].m_dirty = false;
         Clipboard::copy(&m_clipboard[id].m_clipboard, clipboard);
 
+        m_clipboard[id].m_deferred = false;
+        m_clipboard[id].m_hash.clear();
+
         std::string data = m_clipboard[id].m_clipboard.marshall();
 
-        size_t size = data.size();
-        LOG_DEBUG("sending clipboard %d to \"%s\"", id, getName().c_str());
+        // let the client take content it has seen before from its cache
+        if (clipboard_cache_ && data.size() >= ClipboardCache::kMinSize) {
+            const std::string& hash = get_clipboard_hash(id, data);
+            if (has_client_clipboard(hash)) {
+                LOG_DEBUG("offering cached clipboard %d to \"%s\"", id, getName().c_str());
+                ++clipboard_offers_;
+                clipboard_bytes_offered_ += data.size();
+                get_conn().send_clipboard_cached_1_6(id, 0, hash);
+                return;
+            }
+        }
+
+        // only tell the client what's there, it asks for the data when
+        // it's pasted
+        if (lazy_clipboard_ && data.size() >= kLazyClipboardMinSize) {
+            LOG_DEBUG("sending clipboard %d formats to \"%s\"", id, getName().c_str());
+            m_clipboard[id].m_deferred = true;
+            m_clipboard[id].m_deferredSequence = ++clipboard_formats_sent_;
+            clipboard_bytes_deferred_ += data.size();
+            get_conn().send_clipboard_formats_1_6(id, m_clipboard[id].m_deferredSequence,
+                                                  IClipboard::describe(&m_clipboard[id].m_clipboard));
+            return;
+        }
+
+        sendClipboardData(id, data);
+    }
+}
 
-        StreamChunker::sendClipboard(data, size, id, 0, m_events, this);
+void ClientProxy1_6::sendClipboardData(ClipboardID id, std::string& data)
+{
+    if (clipboard_cache_ && data.size() >= ClipboardCache::kMinSize) {
+        note_client_clipboard(get_clipboard_hash(id, data));
     }
+
+    LOG_DEBUG("sending clipboard %d to \"%s\"", id, getName().c_str());
+    StreamChunker::sendClipboard(data, data.size(), id, 0, m_events, this);
 }
 
 void ClientProxy1_6::grabClipboard(ClipboardID id)
@@ -328,6 +461,7 @@ void ClientProxy1_6::grabClipboard(ClipboardID id)
 
     // this clipboard is now dirty
     m_clipboard[id].m_dirty = true;
+    m_clipboard[id].m_deferred = false;
 }
 
 void ClientProxy1_6::setClipboardDirty(ClipboardID id, bool dirty)
@@ -337,42 +471,76 @@ void ClientProxy1_6::setClipboardDirty(ClipboardID id, bool dirty)
 
 void ClientProxy1_6::keyDown(KeyID key, KeyModifierMask mask, KeyButton button)
 {
+    syncMotion();
     get_conn().send_key_down_1_6(key, mask, button);
 }
 
 void ClientProxy1_6::keyRepeat(KeyID key, KeyModifierMask mask, std::int32_t count,
                                KeyButton button)
 {
+    syncMotion();
     get_conn().send_key_repeat_1_6(key, mask, count, button);
 }
 
 void ClientProxy1_6::keyUp(KeyID key, KeyModifierMask mask, KeyButton button)
 {
+    syncMotion();
     get_conn().send_key_up_1_6(key, mask, button);
 }
 
 void ClientProxy1_6::mouseDown(ButtonID button)
 {
+    syncMotion();
     get_conn().send_mouse_down_1_6(button);
 }
 
 void ClientProxy1_6::mouseUp(ButtonID button)
 {
+    syncMotion();
     get_conn().send_mouse_up_1_6(button);
 }
 
 void ClientProxy1_6::mouseMove(std::int32_t xAbs, std::int32_t yAbs)
 {
-    get_conn().send_mouse_move_1_6(xAbs, yAbs);
+    double now = current_time_seconds();
+    double captured = recordHookToSend(now);
+    if (motion_lane_ && motion_lane_->is_up()) {
+        syncMotionBarrier();
+        motion_lane_->move(xAbs, yAbs);
+        return;
+    }
+    syncMotion();
+    if (timestamps_ && captured > 0.0) {
+        get_conn().send_mouse_move_timed_1_6(xAbs, yAbs, to_wire_time(captured),
+                                             to_wire_time(now));
+    }
+    else {
+        get_conn().send_mouse_move_1_6(xAbs, yAbs);
+    }
 }
 
 void ClientProxy1_6::mouseRelativeMove(std::int32_t xRel, std::int32_t yRel)
 {
-    get_conn().send_mouse_relative_move_1_6(xRel, yRel);
+    double now = current_time_seconds();
+    double captured = recordHookToSend(now);
+    if (motion_lane_ && motion_lane_->is_up()) {
+        syncMotionBarrier();
+        motion_lane_->move_relative(xRel, yRel);
+        return;
+    }
+    syncMotion();
+    if (timestamps_ && captured > 0.0) {
+        get_conn().send_mouse_relative_move_timed_1_6(xRel, yRel, to_wire_time(captured),
+                                                      to_wire_time(now));
+    }
+    else {
+        get_conn().send_mouse_relative_move_1_6(xRel, yRel);
+    }
 }
 
 void ClientProxy1_6::mouseWheel(std::int32_t xDelta, std::int32_t yDelta)
 {
+    syncMotion();
     get_conn().send_mouse_wheel_1_6(xDelta, yDelta);
 }
 
@@ -406,12 +574,18 @@ void ClientProxy1_6::setOptions(const OptionsList& options)
     get_conn().send_set_options_1_6(options);
 
     // check options
+    offered_features_ = 0;
     for (std::uint32_t i = 0, n = static_cast<std::uint32_t>(options.size()); i < n; i += 2) {
-        if (options[i] == kOptionHeartbeat) {
+        if (options[i] == kOptionProtocolFeatures) {
+            // the client answers with kMsgCFeatures
+            offered_features_ = options[i + 1];
+        }
+        else if (options[i] == kOptionHeartbeat) {
             double rate = 1.0e-3 * static_cast<double>(options[i + 1]);
             if (rate <= 0.0) {
                 rate = -1.0;
             }
+            configured_keep_alive_rate_ = rate;
             setHeartbeatRate(rate, rate * kHeartBeatsUntilDeath);
             removeHeartbeatTimer();
             addHeartbeatTimer();
@@ -423,7 +597,7 @@ bool ClientProxy1_6::recvInfo()
 {
     // parse the message
     std::int16_t x, y, w, h, dummy1, mx, my;
-    if (!ProtocolUtil::readf(getStream(), kMsgDInfo + 4,
+    if (!ProtocolUtil::readf(&frames_, kMsgDInfo + 4,
                             &x, &y, &w, &h, &dummy1, &mx, &my)) {
         return false;
     }
@@ -458,7 +632,7 @@ bool ClientProxy1_6::recvClipboard()
     ClipboardID id;
     std::uint32_t seq;
 
-    int r = ClipboardChunk::assemble(getStream(), dataCached, id, seq);
+    int r = ClipboardChunk::assemble(&frames_, dataCached, id, seq);
 
     if (r == kStart) {
         size_t size = ClipboardChunk::getExpectedSize();
@@ -469,6 +643,10 @@ bool ClientProxy1_6::recvClipboard()
         // save clipboard
         m_clipboard[id].m_clipboard.unmarshall(dataCached, 0);
         m_clipboard[id].m_sequenceNumber = seq;
+        m_clipboard[id].m_hash.clear();
+        if (clipboard_cache_ && dataCached.size() >= ClipboardCache::kMinSize) {
+            note_client_clipboard(get_clipboard_hash(id, dataCached));
+        }
 
         // notify
         ClipboardInfo info;
@@ -486,7 +664,7 @@ bool ClientProxy1_6::recvGrabClipboard()
     // parse message
     ClipboardID id;
     std::uint32_t seqNum;
-    if (!ProtocolUtil::readf(getStream(), kMsgCClipboard + 4, &id, &seqNum)) {
+    if (!ProtocolUtil::readf(&frames_, kMsgCClipboard + 4, &id, &seqNum)) {
         return false;
     }
     LOG_DEBUG("received client \"%s\" grabbed clipboard %d seqnum=%d", getName().c_str(), id, seqNum);
@@ -506,15 +684,361 @@ bool ClientProxy1_6::recvGrabClipboard()
     return true;
 }
 
+bool ClientProxy1_6::recvFeatures()
+{
+    // parse message
+    std::uint32_t features;
+    if (!ProtocolUtil::readf(&frames_, kMsgCFeatures + 4, &features)) {
+        return false;
+    }
+    features &= offered_features_ & kProtocolFeaturesSupported;
+    LOG_DEBUG("received client \"%s\" features %08x", getName().c_str(), features);
+
+    timestamps_ = (features & kProtocolFeatureTimestamps) != 0;
+
+    clipboard_cache_ = (features & kProtocolFeatureClipboardCache) != 0;
+    if (!clipboard_cache_) {
+        client_clipboards_.clear();
+    }
+    lazy_clipboard_ = (features & kProtocolFeatureLazyClipboard) != 0;
+
+    bool adaptive_keep_alive = (features & kProtocolFeatureAdaptiveKeepAlive) != 0;
+    if (adaptive_keep_alive_ && !adaptive_keep_alive) {
+        // back to the fixed rate
+        setHeartbeatRate(configured_keep_alive_rate_,
+                         configured_keep_alive_rate_ * kKeepAlivesUntilDeath);
+        removeHeartbeatTimer();
+        addHeartbeatTimer();
+    }
+    bool start_adapting = adaptive_keep_alive && !adaptive_keep_alive_;
+    adaptive_keep_alive_ = adaptive_keep_alive;
+    if (start_adapting && m_keepAliveRate > 0.0) {
+        // measure the round trip time right away
+        keepAlive();
+    }
+
+    if ((features & kProtocolFeatureSessionResume) != 0 && !session_->is_started()) {
+        startSession();
+    }
+
+    if ((features & kProtocolFeatureMotionDatagrams) != 0) {
+        // options may be sent again, keep the lane we already have
+        if (!motion_lane_) {
+            motion_lane_ = m_server->create_motion_datagram_lane(getName());
+            if (motion_lane_) {
+                const MotionDatagramKey& key = motion_lane_->get_key();
+                get_conn().send_datagram_offer_1_6(
+                            static_cast<std::uint16_t>(motion_lane_->get_port()),
+                            motion_lane_->get_session(),
+                            std::string(key.begin(), key.end()));
+            }
+        }
+    }
+    else {
+        syncMotion();
+        motion_lane_.reset();
+    }
+    return true;
+}
+
+bool ClientProxy1_6::recvClockQuery()
+{
+    // parse message
+    std::uint32_t query_time;
+    if (!ProtocolUtil::readf(&frames_, kMsgQClock + 4, &query_time)) {
+        return false;
+    }
+
+    // answer right away, any delay makes the client's estimate worse
+    get_conn().send_clock_1_6(query_time, to_wire_time(current_time_seconds()));
+    return true;
+}
+
+bool ClientProxy1_6::recvKeepAliveEcho()
+{
+    // parse message
+    std::uint32_t time;
+    if (!ProtocolUtil::readf(&frames_, kMsgCKeepAliveEcho + 4, &time)) {
+        return false;
+    }
+
+    // reset alarm
+    resetHeartbeatTimer();
+
+    std::int32_t round_trip_time = wire_time_diff(to_wire_time(current_time_seconds()), time);
+    if (round_trip_time >= 0) {
+        round_trip_.add_sample(1.0e-6 * round_trip_time);
+        round_trip_latency_.record(static_cast<std::uint32_t>(round_trip_time));
+        updateKeepAliveRate();
+    }
+    return true;
+}
+
+bool ClientProxy1_6::recvSessionAck()
+{
+    // parse message
+    std::uint32_t received;
+    if (!ProtocolUtil::readf(&frames_, kMsgCSessionAck + 4, &received)) {
+        return false;
+    }
+
+    session_->acknowledge(received);
+    return true;
+}
+
+bool ClientProxy1_6::recvResume()
+{
+    // parse message
+    std::string token;
+    std::uint32_t received;
+    if (!ProtocolUtil::readf(&frames_, kMsgQResume + 4, &token, &received)) {
+        return false;
+    }
+    LOG_DEBUG("client \"%s\" asks to resume its session after %u messages", getName().c_str(),
+              received);
+
+    // hand the connection over to the proxy that has the session.  this
+    // proxy is done either way.
+    remove_handlers();
+    std::unique_ptr<IClientConnection> conn = session_->detach();
+    if (!m_server->resume_client(getName(), token, received, conn)) {
+        LOG_NOTE("client \"%s\" cannot resume its session", getName().c_str());
+        conn->send_resume_1_6(false);
+        conn->flush();
+        conn->close();
+    }
+    m_events->add_event(EventType::CLIENT_PROXY_DISCONNECTED, get_event_target());
+    return true;
+}
+
+bool ClientProxy1_6::recvClipboardMiss()
+{
+    // parse message
+    ClipboardID id;
+    std::string hash;
+    if (!ProtocolUtil::readf(&frames_, kMsgCClipboardMiss + 4, &id, &hash)) {
+        return false;
+    }
+    if (id >= kClipboardEnd) {
+        return false;
+    }
+    ++clipboard_misses_;
+
+    auto found = std::find(client_clipboards_.begin(), client_clipboards_.end(), hash);
+    if (found != client_clipboards_.end()) {
+        client_clipboards_.erase(found);
+    }
+
+    // a newer clipboard may have been sent since.  content that was
+    // offered by hash has its hash computed already.
+    if (m_clipboard[id].m_hash != hash) {
+        return true;
+    }
+    std::string data = m_clipboard[id].m_clipboard.marshall();
+
+    LOG_DEBUG("client \"%s\" doesn't have clipboard %d cached, sending it", getName().c_str(), id);
+    clipboard_bytes_offered_ -= data.size();
+    sendClipboardData(id, data);
+    return true;
+}
+
+bool ClientProxy1_6::recvClipboardQuery()
+{
+    // parse message
+    ClipboardID id;
+    std::uint32_t seqNum;
+    if (!ProtocolUtil::readf(&frames_, kMsgQClipboard + 4, &id, &seqNum)) {
+        return false;
+    }
+    if (id >= kClipboardEnd) {
+        return false;
+    }
+
+    // the clipboard may have changed since its formats were sent
+    ClientClipboard& clipboard = m_clipboard[id];
+    if (!clipboard.m_deferred || clipboard.m_deferredSequence != seqNum) {
+        LOG_DEBUG("ignoring query for old clipboard %d from \"%s\"", id, getName().c_str());
+        return true;
+    }
+    clipboard.m_deferred = false;
+
+    std::string data = clipboard.m_clipboard.marshall();
+    clipboard_bytes_fetched_ += data.size();
+    sendClipboardData(id, data);
+    return true;
+}
+
+const std::string& ClientProxy1_6::get_clipboard_hash(ClipboardID id, const std::string& data)
+{
+    std::string& hash = m_clipboard[id].m_hash;
+    if (hash.empty()) {
+        hash = ClipboardCache::hash(data);
+    }
+    return hash;
+}
+
+void ClientProxy1_6::note_client_clipboard(const std::string& hash)
+{
+    auto found = std::find(client_clipboards_.begin(), client_clipboards_.end(), hash);
+    if (found != client_clipboards_.end()) {
+        client_clipboards_.erase(found);
+    }
+    client_clipboards_.push_back(hash);
+    if (client_clipboards_.size() > kMaxClientClipboards) {
+        client_clipboards_.pop_front();
+    }
+}
+
+bool ClientProxy1_6::has_client_clipboard(const std::string& hash) const
+{
+    return std::find(client_clipboards_.begin(), client_clipboards_.end(), hash) !=
+            client_clipboards_.end();
+}
+
+bool ClientProxy1_6::resume_session(const std::string& token, std::uint32_t received,
+                                    std::unique_ptr<IClientConnection>& conn)
+{
+    if (session_token_.empty() || token != session_token_ || !session_->can_resume(received)) {
+        return false;
+    }
+
+    // the client may notice the lost connection before we do
+    if (session_->is_attached()) {
+        remove_stream_handlers();
+        session_->detach()->close();
+    }
+    if (session_timer_ != nullptr) {
+        m_events->remove_handler(EventType::TIMER, session_timer_);
+        m_events->deleteTimer(session_timer_);
+        session_timer_ = nullptr;
+    }
+
+    conn->send_resume_1_6(true);
+    session_->attach(std::move(conn), received);
+    add_stream_handlers();
+    removeHeartbeatTimer();
+    addHeartbeatTimer();
+
+    if (suspended_time_ > 0.0) {
+        LOG_NOTE("client \"%s\" resumed its session after %.0fms, %u messages sent again",
+                 getName().c_str(), 1.0e3 * (current_time_seconds() - suspended_time_),
+                 static_cast<unsigned>(session_->get_sent() - received));
+    }
+    else {
+        LOG_NOTE("client \"%s\" resumed its session", getName().c_str());
+    }
+    suspended_time_ = 0.0;
+    return true;
+}
+
+void ClientProxy1_6::startSession()
+{
+    std::random_device random;
+    std::string token;
+    for (int i = 0; i < 16; ++i) {
+        token.push_back(static_cast<char>(random() & 0xff));
+    }
+
+    // the token itself isn't part of the session
+    get_conn().send_session_1_6(token);
+    session_token_ = token;
+    session_->start();
+    LOG_DEBUG1("started session for client \"%s\"", getName().c_str());
+}
+
+bool ClientProxy1_6::suspendSession()
+{
+    if (!session_->is_started() || !session_->is_attached()) {
+        return false;
+    }
+
+    // drop the connection but keep the screen around, the client may come
+    // back on a new connection
+    remove_stream_handlers();
+    removeHeartbeatTimer();
+    session_->detach()->close();
+    suspended_time_ = current_time_seconds();
+
+    session_timer_ = m_events->newOneShotTimer(kSessionGracePeriod, nullptr);
+    m_events->add_handler(EventType::TIMER, session_timer_,
+                          [this](const auto& e){ handle_session_expired(); });
+    LOG_NOTE("keeping session of client \"%s\" for %.1fs", getName().c_str(),
+             kSessionGracePeriod);
+    return true;
+}
+
+void ClientProxy1_6::updateKeepAliveRate()
+{
+    if (!adaptive_keep_alive_ || configured_keep_alive_rate_ <= 0.0) {
+        return;
+    }
+
+    double rate = round_trip_.get_keep_alive_rate(configured_keep_alive_rate_);
+    double alarm = round_trip_.get_death_timeout(rate);
+
+    // the alarm takes effect when it's next reset.  restarting the keep
+    // alive timer is only worth it for a real change of the rate.
+    m_heartbeatAlarm = alarm;
+    if (std::fabs(rate - m_keepAliveRate) < 0.1 * m_keepAliveRate) {
+        return;
+    }
+
+    LOG_DEBUG1("keep alive for \"%s\" every %.2fs, dead after %.2fs (srtt=%.1fms rttvar=%.1fms)",
+               getName().c_str(), rate, alarm, 1.0e3 * round_trip_.get_smoothed(),
+               1.0e3 * round_trip_.get_variation());
+    bool slower = rate > m_keepAliveRate;
+    setHeartbeatRate(rate, alarm);
+    removeHeartbeatTimer();
+    addHeartbeatTimer();
+
+    if (slower) {
+        // the client's alarm is based on the old rate and could go off
+        // before the next keep alive, tell it about the new one right away
+        keepAlive();
+    }
+}
+
+double ClientProxy1_6::recordHookToSend(double now)
+{
+    double captured = m_server->get_input_time();
+    if (captured > 0.0) {
+        hook_to_send_.record_seconds(now - captured);
+    }
+    return captured;
+}
+
+void ClientProxy1_6::syncMotion()
+{
+    MotionDatagram sync;
+    if (motion_lane_ && motion_lane_->take_sync(sync)) {
+        get_conn().send_motion_sync_1_6(sync);
+    }
+}
+
+void ClientProxy1_6::syncMotionBarrier()
+{
+    MotionDatagram barrier;
+    if (motion_lane_->take_barrier(barrier)) {
+        get_conn().send_motion_sync_1_6(barrier);
+    }
+}
+
 void ClientProxy1_6::keepAlive()
 {
-    get_conn().send_keep_alive_1_6();
+    if (adaptive_keep_alive_) {
+        // tell the client how long we'd wait for it, it waits as long for us
+        get_conn().send_keep_alive_timed_1_6(to_wire_time(current_time_seconds()),
+                                             static_cast<std::uint32_t>(1.0e3 * m_heartbeatAlarm));
+    }
+    else {
+        get_conn().send_keep_alive_1_6();
+    }
 }
 
 void ClientProxy1_6::fileChunkReceived()
 {
     Server* server = getServer();
-    int result = FileChunk::assemble(getStream(), server->getReceivedFileData(),
+    int result = FileChunk::assemble(&frames_, server->getReceivedFileData(),
                                      server->getExpectedFileSize());
 
     if (result == kFinish) {
@@ -532,7 +1056,7 @@ void ClientProxy1_6::dragInfoReceived()
     // parse
     std::uint32_t fileNum = 0;
     std::string content;
-    ProtocolUtil::readf(getStream(), kMsgDDragInfo + 4, &fileNum, &content);
+    ProtocolUtil::readf(&frames_, kMsgDDragInfo + 4, &fileNum, &content);
 
     m_server->dragInfoReceived(fileNum, content);
 }
@@ -540,7 +1064,10 @@ void ClientProxy1_6::dragInfoReceived()
 ClientProxy1_6::ClientClipboard::ClientClipboard() :
     m_clipboard(),
     m_sequenceNumber(0),
-    m_dirty(true)
+    m_dirty(true),
+    m_deferred(false),
+    m_deferredSequence(0),
+    m_hash()
 {
     // do nothing
 }
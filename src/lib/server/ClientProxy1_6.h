@@ -21,12 +21,19 @@
 #include "server/ClientProxy.h"
 #include "base/Fwd.h"
 #include "inputleap/Clipboard.h"
+#include "inputleap/FrameStream.h"
+#include "inputleap/LatencyStats.h"
+#include "inputleap/ReadBudget.h"
 #include "inputleap/protocol_types.h"
+#include <deque>
+#include <memory>
 
 namespace inputleap {
 
+class ClientConnectionSession;
 class Server;
 class IStream;
+class MotionDatagramLane;
 
 //! Proxy for client implementing protocol version 1.0
 class ClientProxy1_6 : public ClientProxy {
@@ -66,6 +73,12 @@ public:
     void sendDragInfo(std::uint32_t fileCount, const char* info, size_t size) override;
     void file_chunk_sending(const FileChunk& chunk) override;
 
+    // BaseClientProxy overrides
+    const LatencyHistogram* get_hook_to_send_latency() const override { return &hook_to_send_; }
+    const LatencyHistogram* get_round_trip_latency() const override { return &round_trip_latency_; }
+    bool resume_session(const std::string& token, std::uint32_t received,
+                        std::unique_ptr<IClientConnection>& conn) override;
+
 protected:
     virtual bool parseHandshakeMessage(const std::uint8_t* code);
     virtual bool parseMessage(const std::uint8_t* code);
@@ -83,16 +96,57 @@ protected:
 
 private:
     void disconnect();
+    void add_stream_handlers();
+    void remove_stream_handlers();
     void remove_handlers();
 
     void handle_data();
     void handle_disconnect();
     void handle_write_error();
     void handle_flatline();
+    void handle_session_expired();
     void handle_clipboard_sending_event(const Event& event);
 
     bool recvInfo();
     bool recvGrabClipboard();
+    bool recvFeatures();
+    bool recvClockQuery();
+    bool recvKeepAliveEcho();
+    bool recvSessionAck();
+    bool recvResume();
+    bool recvClipboardMiss();
+    bool recvClipboardQuery();
+
+    // send clipboard data to the client in chunks
+    void sendClipboardData(ClipboardID id, std::string& data);
+
+    // get the hash of clipboard id, whose marshalled form is data.  it's
+    // computed once per content and kept with the clipboard.
+    const std::string& get_clipboard_hash(ClipboardID id, const std::string& data);
+
+    // remember content the client has so it can be offered by hash
+    void note_client_clipboard(const std::string& hash);
+    bool has_client_clipboard(const std::string& hash) const;
+
+    // issue a session token and start keeping messages for resuming
+    void startSession();
+
+    // keep the session for a while after the connection was lost.  returns
+    // false if it can't be resumed.
+    bool suspendSession();
+
+    // pick the keep alive rate and death timeout from the round trip time
+    void updateKeepAliveRate();
+
+    // resend motion that went out as datagrams before other input
+    void syncMotion();
+
+    // keep the next motion datagram from overtaking input sent before it
+    void syncMotionBarrier();
+
+    // record how long the input being forwarded took to get here.  returns
+    // its capture time or 0 if that's unknown.
+    double recordHookToSend(double now);
 
 protected:
     struct ClientClipboard {
@@ -103,6 +157,14 @@ protected:
         Clipboard m_clipboard;
         std::uint32_t m_sequenceNumber;
         bool m_dirty;
+
+        // only the formats were sent, the data is sent once the client
+        // asks for it with this sequence number
+        bool m_deferred;
+        std::uint32_t m_deferredSequence;
+
+        // hash of the marshalled clipboard, empty until it's needed
+        std::string m_hash;
     };
 
     ClientClipboard m_clipboard[kClipboardEnd];
@@ -119,6 +181,49 @@ protected:
     double m_keepAliveRate;
     EventQueueTimer* m_keepAliveTimer;
     Server* m_server;
+
+    std::uint32_t offered_features_ = 0;
+    std::unique_ptr<MotionDatagramLane> motion_lane_;
+
+    // bounds the messages handled per input ready event
+    ReadBudget read_budget_;
+
+    // the message being parsed, the connection's stream is only read a
+    // whole message at a time
+    FrameStream frames_;
+
+    bool timestamps_ = false;
+    LatencyHistogram hook_to_send_;
+
+    // hashes of recent clipboards the client sent or received, newest
+    // last, once kProtocolFeatureClipboardCache was agreed on.  the
+    // client's cache is larger, a miss just costs a round trip.
+    static constexpr std::size_t kMaxClientClipboards = 16;
+    bool clipboard_cache_ = false;
+    std::deque<std::string> client_clipboards_;
+    std::uint64_t clipboard_offers_ = 0;
+    std::uint64_t clipboard_misses_ = 0;
+    std::uint64_t clipboard_bytes_offered_ = 0;
+
+    // large clipboards are announced with kMsgDClipboardFormats and only
+    // sent when the client pastes them once kProtocolFeatureLazyClipboard
+    // was agreed on.  the client's own clipboards still arrive in full.
+    bool lazy_clipboard_ = false;
+    std::uint32_t clipboard_formats_sent_ = 0;
+    std::uint64_t clipboard_bytes_deferred_ = 0;
+    std::uint64_t clipboard_bytes_fetched_ = 0;
+
+    // keep alive rate from the options, the upper bound of the adaptive rate
+    double configured_keep_alive_rate_ = kKeepAliveRate;
+    bool adaptive_keep_alive_ = false;
+    RoundTripEstimator round_trip_;
+    LatencyHistogram round_trip_latency_;
+
+    // owned by ClientProxy
+    ClientConnectionSession* session_;
+    std::string session_token_;
+    EventQueueTimer* session_timer_ = nullptr;
+    double suspended_time_ = 0.0;
 };
 
 } // namespace inputleap
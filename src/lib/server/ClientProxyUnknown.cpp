@@ -22,6 +22,7 @@
 #include "base/ELevel.h"
 #include "server/Server.h"
 #include "server/ClientProxy1_6.h"
+#include "inputleap/FrameStream.h"
 #include "inputleap/protocol_types.h"
 #include "inputleap/ProtocolUtil.h"
 #include "inputleap/Exceptions.h"
@@ -145,6 +146,7 @@ ClientProxyUnknown::removeTimer()
 void ClientProxyUnknown::handle_data()
 {
     LOG_DEBUG1("parsing hello reply");
+    received_data_ = true;
 
     std::string name("<unknown>");
     try {
@@ -155,9 +157,14 @@ void ClientProxyUnknown::handle_data()
             throw XBadClient();
         }
 
-        // parse the reply to hello
+        // parse the reply to hello from memory.  anything the client sent
+        // after it stays on the stream for the proxy.
+        FrameStream frame(stream_.get());
+        if (!frame.read_frame()) {
+            return;
+        }
         std::int16_t major, minor;
-        if (!ProtocolUtil::readf(stream_.get(), kMsgHelloBack, &major, &minor, &name)) {
+        if (!ProtocolUtil::readf(&frame, kMsgHelloBack, &major, &minor, &name)) {
             throw XBadClient();
         }
 
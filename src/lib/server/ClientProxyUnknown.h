@@ -51,6 +51,16 @@ public:
     inputleap::IStream* getStream() { return stream_.get(); }
 
     //@}
+    //! @name accessors
+    //@{
+
+    //! Test if the client said anything
+    /*!
+    Returns true once the client has sent data in reply to the hello.
+    */
+    bool has_received_data() const { return received_data_; }
+
+    //@}
 
 private:
     void sendSuccess();
@@ -72,6 +82,7 @@ private:
     bool m_ready;
     Server* m_server;
     IEventQueue* m_events;
+    bool received_data_ = false;
 };
 
 } // namespace inputleap
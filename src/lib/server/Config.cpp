@@ -726,6 +726,9 @@ Config::readSectionOptions(ConfigReadContext& s)
 		else if (name == "clipboardSharingSize") {
 			addOption("", kOptionClipboardSharingSize, s.parseInt(value));
 		}
+		else if (name == "motionDatagrams") {
+			addOption("", kOptionMotionDatagrams, s.parseBoolean(value));
+		}
 
 		else {
 			handled = false;
@@ -1338,6 +1341,9 @@ Config::getOptionName(OptionID id)
 	if (id == kOptionClipboardSharingSize) {
 		return "clipboardSharingSize";
 	}
+	if (id == kOptionMotionDatagrams) {
+		return "motionDatagrams";
+	}
 	return nullptr;
 }
 
@@ -1355,7 +1361,8 @@ std::string Config::getOptionValue(OptionID id, OptionValue value)
 		id == kOptionWin32KeepForeground ||
 		id == kOptionScreenPreserveFocus ||
 		id == kOptionClipboardSharing ||
-		id == kOptionClipboardSharingSize) {
+		id == kOptionClipboardSharingSize ||
+		id == kOptionMotionDatagrams) {
 		return (value != 0) ? "true" : "false";
 	}
 	if (id == kOptionModifierMapForShift ||
@@ -1825,33 +1832,37 @@ bool ConfigReadContext::readLine(std::string& line)
 {
 	++m_line;
 	while (std::getline(m_stream, line)) {
-		// strip leading whitespace
-        std::string::size_type i = line.find_first_not_of(" \t");
-        if (i != std::string::npos) {
-            line.erase(0, i);
-		}
-
-		// strip comments and then trailing whitespace
-		i = line.find('#');
-        if (i != std::string::npos) {
-			line.erase(i);
-		}
-		i = line.find_last_not_of(" \r\t");
-        if (i != std::string::npos) {
-			line.erase(i + 1);
-		}
+		// find the text between leading whitespace and a comment or
+		// trailing whitespace in one pass
+        std::string::size_type begin = std::string::npos;
+        std::string::size_type end = 0;
+        for (std::string::size_type i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (c == '#') {
+                break;
+            }
+            if (c != ' ' && c != '\t' && c != '\r') {
+                if (begin == std::string::npos) {
+                    begin = i;
+                }
+                end = i + 1;
+            }
+        }
 
 		// return non empty line
-		if (!line.empty()) {
+        if (begin != std::string::npos) {
 			// make sure there are no invalid characters
-			for (i = 0; i < line.length(); ++i) {
-				if (!isgraph(line[i]) && line[i] != ' ' && line[i] != '\t') {
+            for (std::string::size_type i = begin; i < end; ++i) {
+                unsigned char c = static_cast<unsigned char>(line[i]);
+                if ((c < ' ' && c != '\t') || c >= 0x7f) {
 					throw XConfigRead(*this,
 								"invalid character %{1}",
 								inputleap::string::sprintf("%#2x", line[i]));
 				}
 			}
 
+            line.erase(end);
+            line.erase(0, begin);
 			return true;
 		}
 
@@ -0,0 +1,104 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/ConfigDiff.h"
+#include "server/Config.h"
+#include "server/InputFilter.h"
+
+namespace inputleap {
+
+namespace {
+
+bool are_links_equal(const Config& from, const Config& to, const std::string& name)
+{
+    auto index1 = from.beginNeighbor(name);
+    auto end1 = from.endNeighbor(name);
+    auto index2 = to.beginNeighbor(name);
+    auto end2 = to.endNeighbor(name);
+    for (; index1 != end1 && index2 != end2; ++index1, ++index2) {
+        // CellEdge::operator== doesn't compare names
+        if (index1->first != index2->first || index1->second != index2->second ||
+            !string::CaselessCmp::equal(index1->second.getName(), index2->second.getName())) {
+            return false;
+        }
+    }
+    return index1 == end1 && index2 == end2;
+}
+
+bool are_options_equal(const Config::ScreenOptions* options1,
+                       const Config::ScreenOptions* options2)
+{
+    if (options1 == nullptr || options2 == nullptr) {
+        return options1 == options2;
+    }
+    return *options1 == *options2;
+}
+
+} // namespace
+
+bool ConfigDiff::empty() const
+{
+    return removed_screens.empty() && added_screens.empty() && changed_links.empty() &&
+           changed_options.empty() && renamed_screens.empty() && !aliases_changed && !global_options_changed &&
+           !input_filter_changed && !listen_address_changed;
+}
+
+ConfigDiff ConfigDiff::compute(const Config& from, const Config& to)
+{
+    ConfigDiff diff;
+
+    // screens that are in both configurations are compared with each other.
+    // a screen that's an alias now counts as removed.
+    for (auto index = from.begin(); index != from.end(); ++index) {
+        const std::string& name = *index;
+        if (!to.isCanonicalName(name)) {
+            diff.removed_screens.insert(name);
+            continue;
+        }
+        std::string new_name = to.getCanonicalName(name);
+        if (new_name != name) {
+            diff.renamed_screens.insert(new_name);
+        }
+        if (!are_links_equal(from, to, name)) {
+            diff.changed_links.insert(name);
+        }
+        if (!are_options_equal(from.getOptions(name), to.getOptions(name))) {
+            diff.changed_options.insert(name);
+        }
+    }
+    for (auto index = to.begin(); index != to.end(); ++index) {
+        if (!from.isCanonicalName(*index)) {
+            diff.added_screens.insert(*index);
+        }
+    }
+
+    // aliases, including the canonical names, map to the same screens
+    for (auto index = from.beginAll(); index != from.endAll() && !diff.aliases_changed; ++index) {
+        diff.aliases_changed = !string::CaselessCmp::equal(to.getCanonicalName(index->first),
+                                                           index->second);
+    }
+    for (auto index = to.beginAll(); index != to.endAll() && !diff.aliases_changed; ++index) {
+        diff.aliases_changed = !from.isScreen(index->first);
+    }
+
+    diff.global_options_changed = !are_options_equal(from.getOptions(""), to.getOptions(""));
+    diff.input_filter_changed = !are_rules_equal(from.get_input_filter_rules(),
+                                                 to.get_input_filter_rules());
+    diff.listen_address_changed = from.get_listen_address() != to.get_listen_address();
+    return diff;
+}
+
+} // namespace inputleap
@@ -0,0 +1,53 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "base/String.h"
+#include <set>
+#include <string>
+
+namespace inputleap {
+
+class Config;
+
+//! Differences between two configurations
+/*!
+Lists what a new configuration changes compared to the one in use, so the
+server can apply only that.  Screens are identified by their canonical
+name in the configuration they appear in.
+*/
+struct ConfigDiff {
+    typedef std::set<std::string, inputleap::string::CaselessCmp> ScreenSet;
+
+    ScreenSet removed_screens;      //!< screens that are no longer configured
+    ScreenSet added_screens;        //!< screens that weren't configured
+    ScreenSet changed_links;        //!< screens whose neighbors changed
+    ScreenSet changed_options;      //!< screens whose own options changed
+    ScreenSet renamed_screens;      //!< screens whose name only changed case
+    bool aliases_changed = false;
+    bool global_options_changed = false;
+    bool input_filter_changed = false;
+    bool listen_address_changed = false;
+
+    //! Check if the configurations are the same
+    bool empty() const;
+
+    //! Compute the differences from \p from to \p to
+    static ConfigDiff compute(const Config& from, const Config& to);
+};
+
+} // namespace inputleap
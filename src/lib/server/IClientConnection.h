@@ -23,10 +23,12 @@
 #include "inputleap/mouse_types.h"
 #include "inputleap/option_types.h"
 #include <string>
+#include <vector>
 
 namespace inputleap {
 
 class IStream;
+struct MotionDatagram;
 
 /// A low-level interface to write protocol messages
 class IClientConnection {
@@ -49,6 +51,11 @@ public:
     virtual void send_mouse_up_1_6(ButtonID button) = 0;
     virtual void send_mouse_move_1_6(std::int32_t x_abs, std::int32_t y_abs) = 0;
     virtual void send_mouse_relative_move_1_6(std::int32_t x_rel, std::int32_t y_rel) = 0;
+    virtual void send_mouse_move_timed_1_6(std::int32_t x_abs, std::int32_t y_abs,
+                                           std::uint32_t captured, std::uint32_t sent) = 0;
+    virtual void send_mouse_relative_move_timed_1_6(std::int32_t x_rel, std::int32_t y_rel,
+                                                    std::uint32_t captured,
+                                                    std::uint32_t sent) = 0;
     virtual void send_mouse_wheel_1_6(std::int32_t x_delta, std::int32_t y_delta) = 0;
     virtual void send_drag_info_1_6(std::uint32_t file_count, const std::string& data) = 0;
     virtual void send_screensaver_1_6(bool on) = 0;
@@ -56,9 +63,21 @@ public:
     virtual void send_set_options_1_6(const OptionsList& options) = 0;
     virtual void send_info_ack_1_6() = 0;
     virtual void send_keep_alive_1_6() = 0;
+    virtual void send_keep_alive_timed_1_6(std::uint32_t time, std::uint32_t timeout_ms) = 0;
+    virtual void send_datagram_offer_1_6(std::uint16_t port, std::uint32_t session,
+                                         const std::string& key) = 0;
+    virtual void send_motion_sync_1_6(const MotionDatagram& sync) = 0;
+    virtual void send_clock_1_6(std::uint32_t query_time, std::uint32_t time) = 0;
+    virtual void send_noop_1_6() = 0;
+    virtual void send_session_1_6(const std::string& token) = 0;
+    virtual void send_resume_1_6(bool resumed) = 0;
     virtual void send_close_1_6(const char* msg) = 0;
 
     virtual void send_clipboard_chunk_1_6(const ClipboardChunk& chunk) = 0;
+    virtual void send_clipboard_cached_1_6(ClipboardID id, std::uint32_t sequence,
+                                           const std::string& hash) = 0;
+    virtual void send_clipboard_formats_1_6(ClipboardID id, std::uint32_t sequence,
+                                            const std::vector<std::uint32_t>& formats) = 0;
     virtual void send_file_chunk_1_6(const FileChunk& chunk) = 0;
     virtual void send_grab_clipboard(ClipboardID id) = 0;
 
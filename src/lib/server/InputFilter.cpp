@@ -25,6 +25,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <utility>
 
 namespace inputleap {
 
@@ -593,6 +594,17 @@ InputFilter::Rule::Rule(const Rule& rule) :
     copy(rule);
 }
 
+InputFilter::Rule::Rule(Rule&& rule) noexcept :
+    m_condition(rule.m_condition),
+    m_activateActions(std::move(rule.m_activateActions)),
+    m_deactivateActions(std::move(rule.m_deactivateActions))
+{
+    // moving keeps the condition, and with it the registered hot key
+    rule.m_condition = nullptr;
+    rule.m_activateActions.clear();
+    rule.m_deactivateActions.clear();
+}
+
 InputFilter::Rule::~Rule()
 {
     clear();
@@ -607,6 +619,17 @@ InputFilter::Rule::operator=(const Rule& rule)
     return *this;
 }
 
+InputFilter::Rule& InputFilter::Rule::operator=(Rule&& rule) noexcept
+{
+    if (&rule != this) {
+        clear();
+        std::swap(m_condition, rule.m_condition);
+        std::swap(m_activateActions, rule.m_activateActions);
+        std::swap(m_deactivateActions, rule.m_deactivateActions);
+    }
+    return *this;
+}
+
 void
 InputFilter::Rule::clear()
 {
@@ -851,6 +874,53 @@ void InputFilter::add_rules(const std::vector<Rule>& rules)
     }
 }
 
+std::size_t InputFilter::update_rules(const std::vector<Rule>& rules)
+{
+    // match the new rules with the old ones by their text
+    std::multimap<std::string, std::size_t> unmatched;
+    for (std::size_t i = 0; i < m_ruleList.size(); ++i) {
+        unmatched.emplace(m_ruleList[i].format(), i);
+    }
+    std::vector<std::size_t> matches;
+    matches.reserve(rules.size());
+    for (const auto& rule : rules) {
+        auto match = unmatched.find(rule.format());
+        if (match == unmatched.end()) {
+            matches.push_back(m_ruleList.size());
+        }
+        else {
+            matches.push_back(match->second);
+            unmatched.erase(match);
+        }
+    }
+
+    // unregister the hot keys of removed rules before registering new ones,
+    // the same hot key may be used by a changed rule
+    if (m_primaryClient != nullptr) {
+        for (const auto& index : unmatched) {
+            m_ruleList[index.second].disable(m_primaryClient);
+        }
+    }
+
+    RuleList ruleList;
+    ruleList.reserve(rules.size());
+    std::size_t changes = unmatched.size();
+    for (std::size_t i = 0; i < rules.size(); ++i) {
+        if (matches[i] < m_ruleList.size()) {
+            ruleList.push_back(std::move(m_ruleList[matches[i]]));
+        }
+        else {
+            ruleList.push_back(rules[i]);
+            if (m_primaryClient != nullptr) {
+                ruleList.back().enable(m_primaryClient);
+            }
+            ++changes;
+        }
+    }
+    m_ruleList = std::move(ruleList);
+    return changes;
+}
+
 void
 InputFilter::setPrimaryClient(PrimaryClient* client)
 {
@@ -260,9 +260,11 @@ public:
         Rule();
         Rule(Condition* adopted);
         Rule(const Rule&);
+        Rule(Rule&&) noexcept;
         ~Rule();
 
         Rule& operator=(const Rule&);
+        Rule& operator=(Rule&&) noexcept;
 
         // replace the condition
         void setCondition(Condition* adopted);
@@ -326,6 +328,11 @@ public:
     void addFilterRule(const Rule& rule);
     void add_rules(const std::vector<Rule>& rules);
 
+    // replace the rules.  rules that are already there are kept as they
+    // are so their hot keys stay registered.  returns the number of rules
+    // that were added or removed.
+    std::size_t update_rules(const std::vector<Rule>& rules);
+
     // enable event filtering using the given primary client.  disable
     // if client is nullptr.
     virtual void setPrimaryClient(PrimaryClient* client);
@@ -0,0 +1,212 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/MotionDatagramListener.h"
+
+#include "inputleap/protocol_types.h"
+#include "net/UDPSocket.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+#include "base/Time.h"
+
+#include <random>
+#include <vector>
+
+namespace inputleap {
+
+//
+// MotionDatagramLane
+//
+
+MotionDatagramLane::MotionDatagramLane(MotionDatagramListener* listener,
+                                       const std::string& name, std::uint32_t session) :
+    listener_{listener},
+    name_{name},
+    session_{session},
+    key_{make_motion_datagram_key()},
+    sender_{session}
+{
+}
+
+MotionDatagramLane::~MotionDatagramLane()
+{
+    if (stats_.sent != 0) {
+        LOG_DEBUG("motion datagrams to \"%s\": %u sent, %u received, %u dropped locally, "
+                  "%u old acks", name_.c_str(), stats_.sent, stats_.peer_received,
+                  stats_.send_failures, stats_.replayed_acks);
+    }
+    if (listener_ != nullptr) {
+        listener_->remove_lane(session_);
+    }
+}
+
+int MotionDatagramLane::get_port() const
+{
+    return listener_ != nullptr ? listener_->get_port() : 0;
+}
+
+bool MotionDatagramLane::is_up() const
+{
+    return listener_ != nullptr && peer_.isValid() &&
+           current_time_seconds() - last_ack_time_ <
+               kMotionDatagramAckRate * kMotionDatagramAcksUntilDown;
+}
+
+bool MotionDatagramLane::move(std::int32_t x, std::int32_t y)
+{
+    if (!is_up()) {
+        return false;
+    }
+    return send(sender_.move(static_cast<std::int16_t>(x), static_cast<std::int16_t>(y)));
+}
+
+bool MotionDatagramLane::move_relative(std::int32_t dx, std::int32_t dy)
+{
+    if (!is_up()) {
+        return false;
+    }
+    return send(sender_.move_relative(dx, dy));
+}
+
+bool MotionDatagramLane::take_sync(MotionDatagram& sync)
+{
+    return sender_.take_sync(sync);
+}
+
+bool MotionDatagramLane::take_barrier(MotionDatagram& barrier)
+{
+    return sender_.take_barrier(barrier);
+}
+
+bool MotionDatagramLane::send(const MotionDatagram& datagram)
+{
+    std::uint8_t buffer[kMaxMotionDatagramSize];
+    std::size_t size = encode_motion_datagram(datagram, key_, buffer);
+
+    // the datagram is part of the sync even if the socket dropped it so
+    // the motion isn't lost
+    ++stats_.sent;
+    if (!listener_->send(buffer, size, peer_)) {
+        ++stats_.send_failures;
+    }
+    return true;
+}
+
+void MotionDatagramLane::on_ack(const MotionDatagram& ack, const NetworkAddress& from)
+{
+    // an ack captured earlier and sent again, possibly from another host,
+    // must not redirect the lane
+    if (have_ack_ && !is_newer_sequence(ack.ack_seq, last_ack_seq_)) {
+        LOG_DEBUG2("discarding old ack %u for \"%s\" from %s", ack.ack_seq, name_.c_str(),
+                   from.getHostname().c_str());
+        ++stats_.replayed_acks;
+        return;
+    }
+    have_ack_ = true;
+    last_ack_seq_ = ack.ack_seq;
+
+    // the client's address may change, e.g. when a NAT mapping expires
+    if (!peer_.isValid() || peer_ != from) {
+        LOG_DEBUG1("motion datagrams to \"%s\" go to %s:%d", name_.c_str(),
+                   from.getHostname().c_str(), from.getPort());
+        peer_ = from;
+    }
+
+    last_ack_time_ = current_time_seconds();
+    stats_.acked_seq = ack.seq;
+    stats_.peer_received = ack.received;
+
+    if (!announced_) {
+        LOG_INFO("sending mouse motion to \"%s\" as datagrams", name_.c_str());
+        announced_ = true;
+    }
+}
+
+//
+// MotionDatagramListener
+//
+
+MotionDatagramListener::MotionDatagramListener(IEventQueue* events,
+                                               std::unique_ptr<UDPSocket> socket, int port) :
+    events_{events},
+    socket_{std::move(socket)},
+    port_{port}
+{
+    std::random_device random;
+    next_session_ = random();
+
+    events_->add_handler(EventType::DATAGRAM_INPUT_READY, socket_->get_event_target(),
+                         [this](const auto& e){ handle_input(); });
+}
+
+MotionDatagramListener::~MotionDatagramListener()
+{
+    // lanes may outlive us, they fall back to the stream from now on
+    for (auto& lane : lanes_) {
+        lane.second->listener_ = nullptr;
+    }
+
+    events_->remove_handler(EventType::DATAGRAM_INPUT_READY, socket_->get_event_target());
+    socket_->close();
+}
+
+std::unique_ptr<MotionDatagramLane> MotionDatagramListener::create_lane(const std::string& name)
+{
+    std::uint32_t session = next_session_++;
+    std::unique_ptr<MotionDatagramLane> lane{new MotionDatagramLane(this, name, session)};
+    lanes_[session] = lane.get();
+    return lane;
+}
+
+void MotionDatagramListener::remove_lane(std::uint32_t session)
+{
+    lanes_.erase(session);
+}
+
+bool MotionDatagramListener::send(const std::uint8_t* data, std::size_t size,
+                                  const NetworkAddress& address)
+{
+    return socket_->send_to(data, size, address);
+}
+
+void MotionDatagramListener::handle_input()
+{
+    std::vector<std::uint8_t> data;
+    NetworkAddress from;
+    while (socket_->receive_from(data, from)) {
+        std::uint32_t session = 0;
+        if (!peek_motion_datagram_session(data.data(), data.size(), session)) {
+            continue;
+        }
+
+        auto i = lanes_.find(session);
+        if (i == lanes_.end()) {
+            continue;
+        }
+
+        MotionDatagramLane* lane = i->second;
+        MotionDatagram ack;
+        if (!decode_motion_datagram(data.data(), data.size(), lane->get_key(), ack) ||
+                ack.type != MotionDatagram::Type::Ack) {
+            LOG_DEBUG2("discarding unauthenticated datagram from %s",
+                       from.getHostname().c_str());
+            continue;
+        }
+        lane->on_ack(ack, from);
+    }
+}
+
+} // namespace inputleap
@@ -0,0 +1,170 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "inputleap/MotionDatagram.h"
+#include "net/Fwd.h"
+#include "net/NetworkAddress.h"
+#include "base/Fwd.h"
+#include "base/EventTarget.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace inputleap {
+
+class MotionDatagramListener;
+
+//! Motion datagram lane to one client
+/*!
+Sends mouse motion to one client as datagrams while the client's acks show
+the lane works.  When it doesn't, the send methods return false and the
+caller uses the stream instead.  Lanes are created by
+\c MotionDatagramListener and may outlive it.
+*/
+class MotionDatagramLane {
+public:
+    //! Lane statistics
+    struct Stats {
+        std::uint32_t sent = 0;             //!< datagrams sent
+        std::uint32_t send_failures = 0;    //!< datagrams the socket dropped
+        std::uint32_t acked_seq = 0;        //!< highest sequence number acked
+        std::uint32_t peer_received = 0;    //!< datagrams the client received
+        std::uint32_t replayed_acks = 0;    //!< acks discarded as not newer
+    };
+
+    ~MotionDatagramLane();
+
+    //! @name manipulators
+    //@{
+
+    //! Send an absolute mouse move
+    /*!
+    Returns false if the lane is down and the move must go over the stream.
+    */
+    bool move(std::int32_t x, std::int32_t y);
+
+    //! Send a relative mouse move
+    /*!
+    Returns false if the lane is down and the move must go over the stream.
+    */
+    bool move_relative(std::int32_t dx, std::int32_t dy);
+
+    //! Take the motion to resend over the stream
+    /*!
+    Must be called before any other input is sent over the stream.
+    Returns true and sets \p sync to the latest motion datagram if motion
+    was sent since the last call.  The caller must send it as a
+    \c kMsgDMotionSync before that input so the client never acts on an
+    outdated cursor position.
+    */
+    bool take_sync(MotionDatagram& sync);
+
+    //! Take the sync to send ahead of the next datagram
+    /*!
+    Returns true and sets \p barrier if other input went over the stream
+    since the last datagram.  The caller must send it as a
+    \c kMsgDMotionSync before moving so the client doesn't apply the
+    motion before that input.
+    */
+    bool take_barrier(MotionDatagram& barrier);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    std::uint32_t get_session() const { return session_; }
+    const MotionDatagramKey& get_key() const { return key_; }
+
+    //! Get the UDP port the client must send acks to
+    int get_port() const;
+
+    //! Check if motion currently goes over the lane
+    bool is_up() const;
+
+    const Stats& get_stats() const { return stats_; }
+
+    //@}
+
+private:
+    friend class MotionDatagramListener;
+
+    MotionDatagramLane(MotionDatagramListener* listener, const std::string& name,
+                       std::uint32_t session);
+
+    void on_ack(const MotionDatagram& ack, const NetworkAddress& from);
+    bool send(const MotionDatagram& datagram);
+
+private:
+    MotionDatagramListener* listener_;
+    std::string name_;
+    std::uint32_t session_;
+    MotionDatagramKey key_;
+    MotionDatagramSender sender_;
+    NetworkAddress peer_;
+    bool have_ack_ = false;
+    std::uint32_t last_ack_seq_ = 0;
+    double last_ack_time_ = 0.0;
+    bool announced_ = false;
+    Stats stats_;
+};
+
+//! Motion datagram endpoint of the server
+/*!
+Owns the UDP socket that motion datagrams are sent from and acks are
+received on, and routes acks to lanes by session.
+*/
+class MotionDatagramListener : public EventTarget {
+public:
+    /*!
+    Receives on \p socket, which must already be bound to UDP \p port.
+    */
+    MotionDatagramListener(IEventQueue* events, std::unique_ptr<UDPSocket> socket, int port);
+    ~MotionDatagramListener();
+
+    //! @name manipulators
+    //@{
+
+    //! Create a lane for the client named \p name
+    std::unique_ptr<MotionDatagramLane> create_lane(const std::string& name);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the UDP port clients send acks to
+    int get_port() const { return port_; }
+
+    //@}
+
+private:
+    friend class MotionDatagramLane;
+
+    void remove_lane(std::uint32_t session);
+    bool send(const std::uint8_t* data, std::size_t size, const NetworkAddress& address);
+    void handle_input();
+
+private:
+    IEventQueue* events_;
+    std::unique_ptr<UDPSocket> socket_;
+    int port_;
+    std::uint32_t next_session_;
+    std::map<std::uint32_t, MotionDatagramLane*> lanes_;
+};
+
+} // namespace inputleap
@@ -0,0 +1,71 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/ScreenNameTable.h"
+
+#include <algorithm>
+
+namespace inputleap {
+
+ScreenId ScreenNameTable::intern(const std::string& name)
+{
+    if (name.empty()) {
+        return kInvalidScreenId;
+    }
+
+    auto index = ids_.find(name);
+    if (index != ids_.end()) {
+        names_[index->second] = name;
+        return index->second;
+    }
+
+    if (names_.size() >= kInvalidScreenId) {
+        return kInvalidScreenId;
+    }
+
+    ScreenId id = static_cast<ScreenId>(names_.size());
+    names_.push_back(name);
+    ids_.insert(std::make_pair(name, id));
+    return id;
+}
+
+ScreenId ScreenNameTable::find(const std::string& name) const
+{
+    auto index = ids_.find(name);
+    if (index == ids_.end()) {
+        return kInvalidScreenId;
+    }
+    return index->second;
+}
+
+void ScreenNameTable::sort_by_name(std::vector<ScreenId>& ids) const
+{
+    std::sort(ids.begin(), ids.end(), [this](ScreenId a, ScreenId b)
+    {
+        return name(a) < name(b);
+    });
+}
+
+const std::string& ScreenNameTable::name(ScreenId id) const
+{
+    static const std::string s_empty;
+    if (id >= names_.size()) {
+        return s_empty;
+    }
+    return names_[id];
+}
+
+} // namespace inputleap
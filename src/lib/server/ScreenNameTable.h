@@ -0,0 +1,91 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "base/String.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace inputleap {
+
+//! Identifier of an interned screen name
+using ScreenId = std::uint16_t;
+
+//! Screen id that doesn't name any screen
+constexpr ScreenId kInvalidScreenId = 0xffff;
+
+//! Table of interned screen names
+/*!
+Maps screen names to small integer ids so that code handling input can
+compare and look up screens without comparing or copying strings.  Names
+are matched case insensitively, the last spelling a name was interned
+with is kept.
+Ids are never reused, so an id stays valid for the life of the table even
+if the screen leaves the configuration.
+*/
+class ScreenNameTable {
+public:
+    //! @name manipulators
+    //@{
+
+    //! Intern a name
+    /*!
+    Returns the id of \p name, adding it to the table if it isn't there
+    yet.  If it is there with a different case the name is respelled as
+    \p name.  Returns \c kInvalidScreenId if \p name is empty or the
+    table is full.
+    */
+    ScreenId intern(const std::string& name);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Find a name
+    /*!
+    Returns the id of \p name or \c kInvalidScreenId if it wasn't interned.
+    */
+    ScreenId find(const std::string& name) const;
+
+    //! Get the name of an id
+    /*!
+    Returns the name \p id was interned for or an empty string if \p id is
+    invalid.
+    */
+    const std::string& name(ScreenId id) const;
+
+    //! Get the number of interned names
+    std::size_t size() const { return names_.size(); }
+
+    //! Sort ids by name
+    /*!
+    Sorts \p ids so that their names are in ascending order, comparing
+    them case sensitively.  This is the order screens were kept in before
+    they had ids.
+    */
+    void sort_by_name(std::vector<ScreenId>& ids) const;
+
+    //@}
+
+private:
+    std::vector<std::string> names_;
+    std::map<std::string, ScreenId, inputleap::string::CaselessCmp> ids_;
+};
+
+} // namespace inputleap
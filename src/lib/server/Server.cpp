@@ -22,6 +22,8 @@
 #include "server/ClientProxyUnknown.h"
 #include "server/PrimaryClient.h"
 #include "server/ClientListener.h"
+#include "server/ConfigDiff.h"
+#include "server/MotionDatagramListener.h"
 #include "inputleap/FileChunk.h"
 #include "inputleap/IPlatformScreen.h"
 #include "inputleap/DropHelper.h"
@@ -44,6 +46,7 @@
 #include "base/Log.h"
 #include "base/Time.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstring>
 #include <cstdlib>
@@ -92,29 +95,32 @@ Server::Server(
 	m_ignoreFileTransfer(false),
 	m_enableClipboard(true),
 	m_maximumClipboardSize(INT_MAX),
-	m_sendDragInfoThread(nullptr),
+	m_motionDatagrams(false),
+	m_inputTime(0.0),
 	m_waitDragInfoThread(true),
+	m_clientListener(nullptr),
 	m_args(args)
 {
-    input_filter_.add_rules(config.get_input_filter_rules());
-
 	// must have a primary client and it must have a canonical name
 	assert(m_primaryClient != nullptr);
 	assert(config.isScreen(primaryClient->getName()));
 	assert(m_screen != nullptr);
 
-    std::string primaryName = getName(primaryClient);
+	// screens are identified by the ids of their canonical names
+	intern_screens();
+	primaryClient->set_screen_id(get_screen_id(primaryClient->getName()));
 
 	// clear clipboards
 	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
 		ClipboardInfo& clipboard   = m_clipboards[id];
-		clipboard.m_clipboardOwner  = primaryName;
+		clipboard.m_clipboardOwner  = primaryClient->get_screen_id();
 		clipboard.m_clipboardSeqNum = m_seqNum;
 		if (clipboard.m_clipboard.open(0)) {
 			clipboard.m_clipboard.clear();
 			clipboard.m_clipboard.close();
 		}
 		clipboard.m_clipboardData   = clipboard.m_clipboard.marshall();
+		clipboard.m_clipboardSize   = clipboard.m_clipboardData.size();
 	}
 
     // install event handlers
@@ -159,12 +165,17 @@ Server::Server(
                           [this](const auto& e){ handle_fake_input_begin_event(); });
     m_events->add_handler(EventType::PRIMARY_SCREEN_FAKE_INPUT_END, &input_filter_,
                           [this](const auto& e){ handle_fake_input_end_event(); });
+    m_events->add_handler(EventType::SERVER_SYNC_SCREEN, this,
+                          [this](const auto& e){ handle_sync_screen_event(); });
 
     if (m_args.m_enableDragDrop) {
+        drag_info_worker_ = std::make_unique<WorkerThread>();
         m_events->add_handler(EventType::FILE_CHUNK_SENDING, this,
                               [this](const auto& e){ handle_file_chunk_sending_event(e); });
         m_events->add_handler(EventType::FILE_RECEIVE_COMPLETED, this,
                               [this](const auto& e){ handle_file_receive_completed_event(e); });
+        m_events->add_handler(EventType::SERVER_DRAG_INFO_READY, this,
+                              [this](const auto& e){ handle_drag_info_ready_event(e); });
 	}
 
 	// add connection
@@ -204,9 +215,14 @@ Server::~Server()
     m_events->remove_handler(EventType::PRIMARY_SCREEN_SAVER_DEACTIVATED, m_primaryClient->get_event_target());
     m_events->remove_handler(EventType::PRIMARY_SCREEN_FAKE_INPUT_BEGIN, &input_filter_);
     m_events->remove_handler(EventType::PRIMARY_SCREEN_FAKE_INPUT_END, &input_filter_);
+    m_events->remove_handler(EventType::SERVER_SYNC_SCREEN, this);
     m_events->remove_handler(EventType::TIMER, this);
 	stopSwitch();
 
+	// wait for the drag info worker before the screen goes away
+	drag_info_worker_.reset();
+    m_events->remove_handler(EventType::SERVER_DRAG_INFO_READY, this);
+
 	// force immediate disconnection of secondary clients
 	disconnect();
     for (auto index = m_oldClients.begin(); index != m_oldClients.end(); ++index) {
@@ -233,12 +249,30 @@ Server::setConfig(const Config& config)
 		return false;
 	}
 
+	// find out what changed.  the configuration we were created with
+	// has to be applied in full.
+	bool full = (&config == m_config);
+	ConfigDiff diff;
+	if (!full) {
+		diff = ConfigDiff::compute(*m_config, config);
+		if (diff.empty()) {
+			LOG_DEBUG("configuration is unchanged");
+			return true;
+		}
+	}
+
 	// close clients that are connected but being dropped from the
-	// configuration.
+	// configuration.  everyone else stays connected.
 	closeClients(config);
 
 	// cut over
-	processOptions();
+	if (!full) {
+		*m_config = config;
+		intern_screens();
+	}
+	if (full || diff.global_options_changed) {
+		processOptions();
+	}
 
 	// add ScrollLock as a hotkey to lock to the screen.  this was a
 	// built-in feature in earlier releases and is now supported via
@@ -247,23 +281,43 @@ Server::setConfig(const Config& config)
 	// we will unfortunately generate a warning.  if the user has
 	// configured a LockCursorToScreenAction then we don't add
 	// ScrollLock as a hotkey.
+	std::vector<InputFilter::Rule> rules = m_config->get_input_filter_rules();
 	if (!m_config->hasLockToScreenAction()) {
         IPlatformScreen::KeyInfo key{kKeyScrollLock, 0, 0, 0};
         InputFilter::Rule rule(new InputFilter::KeystrokeCondition(key));
         rule.adoptAction(new InputFilter::LockCursorToScreenAction(), true);
-        m_config->get_input_filter_rules().push_back(rule);
-        input_filter_.addFilterRule(rule);
+        rules.push_back(rule);
 	}
 
-	// tell primary screen about reconfiguration
-	m_primaryClient->reconfigure(getActivePrimarySides());
+	// only the hotkeys of changed rules are registered again
+	std::size_t changedRules = input_filter_.update_rules(rules);
+
+	// tell primary screen about reconfiguration if its neighbors changed
+	std::string primaryName = getName(m_primaryClient);
+	if (full || diff.aliases_changed || diff.changed_links.count(primaryName) != 0) {
+		m_primaryClient->reconfigure(getActivePrimarySides());
+	}
 
-	// tell all (connected) clients about current options
+	// tell (connected) clients about their options if they changed.
+	// resending them resets the client's keep alive.
     for (auto index = m_clients.begin(); index != m_clients.end(); ++index) {
-		BaseClientProxy* client = index->second;
-		sendOptions(client);
+		if (full || diff.global_options_changed ||
+			diff.changed_options.count(screen_names_.name(index->first)) != 0) {
+			sendOptions(index->second);
+		}
 	}
 
+	if (!full) {
+		LOG_DEBUG("applied configuration: %zu screens removed, %zu added, "
+				  "%zu renamed, %zu with new links, %zu with new options, "
+				  "%zu rules changed",
+				  diff.removed_screens.size(), diff.added_screens.size(),
+				  diff.renamed_screens.size(), diff.changed_links.size(),
+				  diff.changed_options.size(), changedRules);
+		if (diff.listen_address_changed) {
+			LOG_WARN("the new listen address is used after restarting the server");
+		}
+	}
 	return true;
 }
 
@@ -283,6 +337,15 @@ Server::adoptClient(BaseClientProxy* client)
 		return;
 	}
 
+	// the name must have an id.  there are none left if the server has
+	// seen too many different screen names.
+	client->set_screen_id(get_screen_id(client->getName()));
+	if (client->get_screen_id() == kInvalidScreenId) {
+		LOG_WARN("out of screen ids for client \"%s\"", client->getName().c_str());
+		closeClient(client, kMsgEUnknown);
+		return;
+	}
+
 	// add client to client list
 	if (!addClient(client)) {
 		// can only have one screen with a given name at any given time
@@ -328,18 +391,87 @@ void
 Server::getClients(std::vector<std::string>& list) const
 {
 	list.clear();
-    for (auto index = m_clients.begin(); index != m_clients.end(); ++index) {
-		list.push_back(index->first);
+	for (ScreenId id : get_client_ids_by_name()) {
+		list.push_back(screen_names_.name(id));
 	}
 }
 
-std::string Server::getName(const BaseClientProxy* client) const
+std::vector<ScreenId> Server::get_client_ids_by_name() const
 {
-    std::string name = m_config->getCanonicalName(client->getName());
-	if (name.empty()) {
-		name = client->getName();
+	std::vector<ScreenId> ids;
+	ids.reserve(m_clients.size());
+	for (const auto& client : m_clients) {
+		ids.push_back(client.first);
+	}
+	screen_names_.sort_by_name(ids);
+	return ids;
+}
+
+std::vector<LatencyReport> Server::get_latency_reports() const
+{
+	std::vector<LatencyReport> reports;
+	for (const auto& client : m_clients) {
+		const LatencyHistogram* latency = client.second->get_hook_to_send_latency();
+		if (latency != nullptr && latency->get_count() != 0) {
+			reports.push_back({screen_names_.name(client.first), LatencyStage::HookToSend,
+							   latency->get_summary()});
+		}
+		latency = client.second->get_round_trip_latency();
+		if (latency != nullptr && latency->get_count() != 0) {
+			reports.push_back({screen_names_.name(client.first), LatencyStage::RoundTrip,
+							   latency->get_summary()});
+		}
+	}
+	if (switch_latency_.get_count() != 0) {
+		reports.push_back({getName(m_primaryClient), LatencyStage::ScreenSwitch,
+						   switch_latency_.get_summary()});
+	}
+	return reports;
+}
+
+const std::string& Server::getName(const BaseClientProxy* client) const
+{
+	return screen_names_.name(client->get_screen_id());
+}
+
+ScreenId Server::get_screen_id(const std::string& name) const
+{
+	return screen_names_.find(m_config->getCanonicalName(name));
+}
+
+void Server::intern_screens()
+{
+	for (auto screen = m_config->begin(); screen != m_config->end(); ++screen) {
+		if (screen_names_.intern(*screen) == kInvalidScreenId) {
+			LOG_WARN("out of screen ids, screen \"%s\" can't connect", screen->c_str());
+		}
+	}
+
+	// clients whose canonical name went away have been closed but the
+	// primary client stays even if its name is now an alias.  ids are
+	// never reused so the primary keeps its old id if the new name got
+	// none, other clients without an id are refused.
+	ClientList clients;
+	std::vector<BaseClientProxy*> refused;
+	for (const auto& client : m_clients) {
+		ScreenId id = get_screen_id(client.second->getName());
+		if (id == kInvalidScreenId) {
+			if (client.second != m_primaryClient) {
+				refused.push_back(client.second);
+				continue;
+			}
+			id = client.first;
+		}
+		client.second->set_screen_id(id);
+		clients.insert(std::make_pair(id, client.second));
+	}
+	m_clients.swap(clients);
+
+	for (BaseClientProxy* client : refused) {
+		LOG_WARN("out of screen ids for client \"%s\"", client->getName().c_str());
+		client->set_screen_id(kInvalidScreenId);
+		closeClient(client, kMsgCClose);
 	}
-	return name;
 }
 
 std::uint32_t Server::getActivePrimarySides() const
@@ -433,16 +565,10 @@ void Server::switchScreen(BaseClientProxy* dst, std::int32_t x, std::int32_t y,
 			return;
 		}
 
-		// update the primary client's clipboards if we're leaving the
-		// primary screen.
+		// the primary client's clipboards are brought up to date after
+		// entering the new screen so that reading them doesn't delay it
 		if (m_active == m_primaryClient && m_enableClipboard) {
-			for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
-				ClipboardInfo& clipboard = m_clipboards[id];
-				if (clipboard.m_clipboardOwner == getName(m_primaryClient)) {
-					onClipboardChanged(m_primaryClient,
-						id, clipboard.m_clipboardSeqNum);
-				}
-			}
+			refresh_primary_clipboards_ = true;
 		}
 
 		// cut over
@@ -456,15 +582,19 @@ void Server::switchScreen(BaseClientProxy* dst, std::int32_t x, std::int32_t y,
 								m_primaryClient->getToggleMask(),
 								forScreensaver);
 
-		if (m_enableClipboard) {
-			// send the clipboard data to new active screen
-			for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
-				// Hackity hackity hack
-				if (m_clipboards[id].m_clipboard.marshall().size() > m_maximumClipboardSize) {
-					continue;
-				}
-				m_active->setClipboard(id, &m_clipboards[id].m_clipboard);
-			}
+		// time until motion is forwarded to the new screen
+		if (m_active != m_primaryClient) {
+			switch_time_ = m_inputTime > 0.0 ? m_inputTime : current_time_seconds();
+		}
+		else {
+			switch_time_ = 0.0;
+		}
+
+		// send the clipboards once the enter went out.  switching again
+		// before that only syncs the screen entered last.
+		if (!screen_sync_pending_) {
+			screen_sync_pending_ = true;
+			m_events->add_event(EventType::SERVER_SYNC_SCREEN, this);
 		}
 
         Server::SwitchToScreenInfo info{m_active->getName()};
@@ -476,6 +606,46 @@ void Server::switchScreen(BaseClientProxy* dst, std::int32_t x, std::int32_t y,
 	}
 }
 
+void Server::handle_sync_screen_event()
+{
+	screen_sync_pending_ = false;
+
+	if (refresh_primary_clipboards_) {
+		refresh_primary_clipboards_ = false;
+
+		// update the primary client's clipboards since we left the
+		// primary screen
+		for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+			ClipboardInfo& clipboard = m_clipboards[id];
+			if (clipboard.m_clipboardOwner == m_primaryClient->get_screen_id()) {
+				onClipboardChanged(m_primaryClient, id, clipboard.m_clipboardSeqNum);
+			}
+		}
+	}
+
+	if (m_enableClipboard) {
+		// send the clipboard data to the active screen
+		for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+			if (m_clipboards[id].m_clipboardSize > m_maximumClipboardSize) {
+				continue;
+			}
+			m_active->setClipboard(id, &m_clipboards[id].m_clipboard);
+		}
+	}
+}
+
+void Server::record_switch_latency()
+{
+	if (switch_time_ == 0.0) {
+		return;
+	}
+	double latency = current_time_seconds() - switch_time_;
+	switch_time_ = 0.0;
+	switch_latency_.record_seconds(latency);
+	LOG_DEBUG1("first motion on \"%s\" %.3fms after switching",
+			   getName(m_active).c_str(), latency * 1000.0);
+}
+
 void
 Server::jumpToScreen(BaseClientProxy* newScreen)
 {
@@ -577,7 +747,7 @@ BaseClientProxy* Server::getNeighbor(BaseClientProxy* src, EDirection dir, std::
 
 		// look up neighbor cell.  if the screen is connected and
 		// ready then we can stop.
-        auto index = m_clients.find(dstName);
+        auto index = m_clients.find(screen_names_.find(dstName));
 		if (index != m_clients.end()) {
 			LOG_DEBUG2("\"%s\" is on %s of \"%s\" at %f", dstName.c_str(), Config::dirName(dir), srcName.c_str(), t);
 			mapToPixel(index->second, dir, tTmp, x, y);
@@ -709,7 +879,7 @@ void Server::avoidJumpZone(BaseClientProxy* dst, EDirection dir, std::int32_t& x
 		return;
 	}
 
-    const std::string dstName(getName(dst));
+    const std::string& dstName = getName(dst);
 	std::int32_t dx, dy, dw, dh;
 	dst->getShape(dx, dy, dw, dh);
 	float t = mapToFraction(dst, dir, x, y);
@@ -1069,11 +1239,44 @@ Server::sendOptions(BaseClientProxy* client) const
 		}
 	}
 
+	// offer protocol features.  clients that don't know this option
+	// ignore it and never use them.
+	std::uint32_t features = kProtocolFeatureTimestamps |
+							 kProtocolFeatureAdaptiveKeepAlive |
+							 kProtocolFeatureSessionResume |
+							 kProtocolFeatureClipboardCache |
+							 kProtocolFeatureLazyClipboard;
+	if (m_motionDatagrams) {
+		features |= kProtocolFeatureMotionDatagrams;
+	}
+	optionsList.push_back(kOptionProtocolFeatures);
+	optionsList.push_back(features);
+
 	// send the options
 	client->resetOptions();
 	client->setOptions(optionsList);
 }
 
+std::unique_ptr<MotionDatagramLane>
+Server::create_motion_datagram_lane(const std::string& name)
+{
+	if (!m_motionDatagrams || m_clientListener == nullptr) {
+		return {};
+	}
+	return m_clientListener->create_motion_datagram_lane(name);
+}
+
+bool
+Server::resume_client(const std::string& name, const std::string& token,
+				std::uint32_t received, std::unique_ptr<IClientConnection>& conn)
+{
+	auto index = m_clients.find(get_screen_id(name));
+	if (index == m_clients.end()) {
+		return false;
+	}
+	return index->second->resume_session(token, received, conn);
+}
+
 void
 Server::processOptions()
 {
@@ -1085,6 +1288,7 @@ Server::processOptions()
 	m_switchNeedsShift = false;		// it seems if I don't add these
 	m_switchNeedsControl = false;	// lines, the 'reload config' option
 	m_switchNeedsAlt = false;		// doesn't work correct.
+	m_motionDatagrams = false;
 
 	bool newRelativeMoves = m_relativeMoves;
     for (auto index = options->begin(); index != options->end(); ++index) {
@@ -1123,6 +1327,9 @@ Server::processOptions()
 				LOG_NOTE("clipboard sharing is disabled");
 			}
 		}
+		else if (id == kOptionMotionDatagrams) {
+			m_motionDatagrams = (value != 0);
+		}
 		else if (id == kOptionClipboardSharingSize) {
 			if (value <= 0) {
 				m_maximumClipboardSize = 0;
@@ -1193,8 +1400,8 @@ void Server::handle_clipboard_grabbed(const Event& event, BaseClientProxy* grabb
 
 	// mark screen as owning clipboard
     LOG_INFO("screen \"%s\" grabbed clipboard %d from \"%s\"", getName(grabber).c_str(),
-         info.m_id, clipboard.m_clipboardOwner.c_str());
-	clipboard.m_clipboardOwner  = getName(grabber);
+         info.m_id, screen_names_.name(clipboard.m_clipboardOwner).c_str());
+	clipboard.m_clipboardOwner  = grabber->get_screen_id();
     clipboard.m_clipboardSeqNum = info.m_sequenceNumber;
 
 	// clear the clipboard data (since it's not known at this point)
@@ -1203,6 +1410,7 @@ void Server::handle_clipboard_grabbed(const Event& event, BaseClientProxy* grabb
 		clipboard.m_clipboard.close();
 	}
 	clipboard.m_clipboardData = clipboard.m_clipboard.marshall();
+	clipboard.m_clipboardSize = clipboard.m_clipboardData.size();
 
 	// tell all other screens to take ownership of clipboard.  tell the
 	// grabber that it's clipboard isn't dirty.
@@ -1260,13 +1468,18 @@ void Server::handle_button_up_event(const Event& event)
 void Server::handle_motion_primary_event(const Event& event)
 {
     const auto& info = event.get_data_as<IPlatformScreen::MotionInfo>();
+    m_inputTime = info.m_time;
     onMouseMovePrimary(info.m_x, info.m_y);
+    m_inputTime = 0.0;
 }
 
 void Server::handle_motion_secondary_event(const Event& event)
 {
     const auto& info = event.get_data_as<IPlatformScreen::MotionInfo>();
+    m_inputTime = info.m_time;
+    record_switch_latency();
     onMouseMoveSecondary(info.m_x, info.m_y);
+    m_inputTime = 0.0;
 }
 
 void Server::handle_wheel_event(const Event& event)
@@ -1321,7 +1534,7 @@ void Server::handle_switch_to_screen_event(const Event& event)
 {
     const auto& info = event.get_data_as<SwitchToScreenInfo>();
 
-    auto index = m_clients.find(info.m_screen);
+    auto index = m_clients.find(get_screen_id(info.m_screen));
 	if (index == m_clients.end()) {
         LOG_DEBUG1("screen \"%s\" not active", info.m_screen.c_str());
 	}
@@ -1335,17 +1548,18 @@ Server::handle_toggle_screen_event(const Event& event)
 {
     (void) event;
 
-  std::string current = getName(m_active);
-  auto index = m_clients.find(current);
-  if (index == m_clients.end()) {
-    LOG_DEBUG1("screen \"%s\" not active", current.c_str());
+  // cycle through the screens in name order
+  std::vector<ScreenId> ids = get_client_ids_by_name();
+  auto index = std::find(ids.begin(), ids.end(), m_active->get_screen_id());
+  if (index == ids.end()) {
+    LOG_DEBUG1("screen \"%s\" not active", getName(m_active).c_str());
   }
   else {
     ++index;
-    if (index == m_clients.end()) {
-      index = m_clients.begin();
+    if (index == ids.end()) {
+      index = ids.begin();
     }
-    jumpToScreen(index->second);
+    jumpToScreen(m_clients[*index]);
   }
 }
 
@@ -1462,28 +1676,30 @@ void Server::onClipboardChanged(BaseClientProxy* sender, ClipboardID id, std::ui
 
 	// should be the expected client
 	assert(sender == m_clients.find(clipboard.m_clipboardOwner)->second);
+	const std::string& owner = screen_names_.name(clipboard.m_clipboardOwner);
 
 	// get data
 	if (!sender->getClipboard(id, &clipboard.m_clipboard)) {
 		LOG_DEBUG("ignored screen \"%s\" update of clipboard %d (failed to get clipboard)",
-				clipboard.m_clipboardOwner.c_str(), id);
+				owner.c_str(), id);
 		return;
 	}
 
 	// ignore if data hasn't changed
     std::string data = clipboard.m_clipboard.marshall();
+	clipboard.m_clipboardSize = data.size();
 	if (data.size() > m_maximumClipboardSize) {
 		LOG_NOTE("not updating clipboard because it's over the size limit (%zi KB) configured by the server",
 			m_maximumClipboardSize);
 		return;
 	}
 	if (data == clipboard.m_clipboardData) {
-		LOG_DEBUG("ignored screen \"%s\" update of clipboard %d (unchanged)", clipboard.m_clipboardOwner.c_str(), id);
+		LOG_DEBUG("ignored screen \"%s\" update of clipboard %d (unchanged)", owner.c_str(), id);
 		return;
 	}
 
 	// got new data
-	LOG_INFO("screen \"%s\" updated clipboard %d", clipboard.m_clipboardOwner.c_str(), id);
+	LOG_INFO("screen \"%s\" updated clipboard %d", owner.c_str(), id);
 	clipboard.m_clipboardData = data;
 
 	// tell all clients except the sender that the clipboard is dirty
@@ -1569,7 +1785,7 @@ Server::onKeyDown(KeyID id, KeyModifierMask mask, KeyButton button,
 			}
 		}
         for (auto index = m_clients.begin(); index != m_clients.end(); ++index) {
-			if (IKeyState::KeyInfo::contains(screens, index->first)) {
+			if (IKeyState::KeyInfo::contains(screens, screen_names_.name(index->first))) {
 				index->second->keyDown(id, mask, button);
 			}
 		}
@@ -1595,7 +1811,7 @@ Server::onKeyUp(KeyID id, KeyModifierMask mask, KeyButton button,
 			}
 		}
         for (auto index = m_clients.begin(); index != m_clients.end(); ++index) {
-			if (IKeyState::KeyInfo::contains(screens, index->first)) {
+			if (IKeyState::KeyInfo::contains(screens, screen_names_.name(index->first))) {
 				index->second->keyUp(id, mask, button);
 			}
 		}
@@ -1739,9 +1955,9 @@ bool Server::onMouseMovePrimary(std::int32_t x, std::int32_t y)
 				&& m_screen->isDraggingStarted()
 				&& m_active != newScreen
 				&& m_waitDragInfoThread) {
-				if (m_sendDragInfoThread == nullptr) {
-                    m_sendDragInfoThread = new Thread([this, newScreen]()
-                                                      { send_drag_info_thread(newScreen); });
+				if (!drag_info_pending_.exchange(true)) {
+                    drag_info_worker_->post([this, id = newScreen->get_screen_id()]()
+                                            { collect_drag_info_thread(id); });
 				}
 
 				return false;
@@ -1757,16 +1973,27 @@ bool Server::onMouseMovePrimary(std::int32_t x, std::int32_t y)
 	return false;
 }
 
-void Server::send_drag_info_thread(BaseClientProxy* newScreen)
+void Server::collect_drag_info_thread(ScreenId screen_id)
 {
-	m_dragFileList.clear();
+	DragFileList files;
     std::string& dragFileList = m_screen->getDraggingFilename();
 	if (!dragFileList.empty()) {
 		DragInformation di;
 		di.setFilename(dragFileList);
-		m_dragFileList.push_back(di);
+		files.push_back(di);
 	}
 
+	// the client may be gone by the time the list is ready, so the event
+	// loop sends it after looking the screen up again
+    m_events->add_event(EventType::SERVER_DRAG_INFO_READY, this,
+                        create_event_data<DragInfoReadyInfo>(
+                            DragInfoReadyInfo{screen_id, std::move(files)}));
+}
+
+void Server::handle_drag_info_ready_event(const Event& event)
+{
+    const auto& info = event.get_data_as<DragInfoReadyInfo>();
+
 #if defined(__APPLE__)
 	// on mac it seems that after faking a LMB up, system would signal back
     // to InputLeap a mouse up event, which doesn't happen on windows. as a
@@ -1775,13 +2002,15 @@ void Server::send_drag_info_thread(BaseClientProxy* newScreen)
 	m_ignoreFileTransfer = true;
 #endif
 
-	// send drag file info to client if there is any
-	if (m_dragFileList.size() > 0) {
-		sendDragInfo(newScreen);
+	// send drag file info to client if there is any and it is still connected
+    auto index = m_clients.find(info.screen_id_);
+	if (index != m_clients.end() && !info.files_.empty()) {
+		m_dragFileList = info.files_;
+		sendDragInfo(index->second);
 		m_dragFileList.clear();
 	}
 	m_waitDragInfoThread = false;
-	m_sendDragInfoThread = nullptr;
+	drag_info_pending_ = false;
 }
 
 void
@@ -2011,8 +2240,8 @@ void Server::write_to_drop_dir_thread()
 bool
 Server::addClient(BaseClientProxy* client)
 {
-    std::string name = getName(client);
-	if (m_clients.count(name) != 0) {
+    ScreenId id = client->get_screen_id();
+	if (m_clients.count(id) != 0) {
 		return false;
 	}
 
@@ -2026,7 +2255,7 @@ Server::addClient(BaseClientProxy* client)
 
 	// add to list
 	m_clientSet.insert(client);
-	m_clients.insert(std::make_pair(name, client));
+	m_clients.insert(std::make_pair(id, client));
 
 	// initialize client data
 	std::int32_t x, y;
@@ -2054,7 +2283,7 @@ Server::removeClient(BaseClientProxy* client)
     m_events->remove_handler(EventType::CLIPBOARD_CHANGED, client->get_event_target());
 
 	// remove from list
-	m_clients.erase(getName(client));
+	m_clients.erase(client->get_screen_id());
 	m_clientSet.erase(i);
 
 	return true;
@@ -2074,7 +2303,7 @@ Server::closeClient(BaseClientProxy* client, const char* msg)
 	// note that this method also works on clients that are not in
 	// the m_clients list.  adoptClient() may call us with such a
 	// client.
-	LOG_NOTE("disconnecting client \"%s\"", getName(client).c_str());
+	LOG_NOTE("disconnecting client \"%s\"", client->getName().c_str());
 
 	// send message
 	// FIXME -- avoid type cast (kinda hard, though)
@@ -2106,7 +2335,7 @@ Server::closeClients(const Config& config)
 	typedef std::set<BaseClientProxy*> RemovedClients;
 	RemovedClients removed;
     for (auto index = m_clients.begin(); index != m_clients.end(); ++index) {
-		if (!config.isCanonicalName(index->first)) {
+		if (!config.isCanonicalName(screen_names_.name(index->first))) {
 			removed.insert(index->second);
 		}
 	}
@@ -2168,6 +2397,7 @@ Server::forceLeaveClient(BaseClientProxy* client)
 
 		// cut over
 		m_active = m_primaryClient;
+		switch_time_ = 0.0;
 
 		// enter new screen (unless we already have because of the
 		// screen saver)
@@ -2200,7 +2430,8 @@ Server::forceLeaveClient(BaseClientProxy* client)
 Server::ClipboardInfo::ClipboardInfo() :
 	m_clipboard(),
 	m_clipboardData(),
-	m_clipboardOwner(),
+	m_clipboardSize(0),
+	m_clipboardOwner(kInvalidScreenId),
 	m_clipboardSeqNum(0)
 {
 	// do nothing
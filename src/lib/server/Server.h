@@ -19,6 +19,7 @@
 #pragma once
 
 #include "server/Config.h"
+#include "server/ScreenNameTable.h"
 #include "inputleap/clipboard_types.h"
 #include "inputleap/Clipboard.h"
 #include "inputleap/key_types.h"
@@ -26,14 +27,18 @@
 #include "inputleap/Fwd.h"
 #include "inputleap/INode.h"
 #include "inputleap/DragInformation.h"
+#include "inputleap/LatencyStats.h"
 #include "inputleap/ServerArgs.h"
 #include "base/Fwd.h"
 #include "base/Event.h"
 #include "base/EventTarget.h"
 #include "base/Stopwatch.h"
 #include "base/EventTypes.h"
+#include "mt/WorkerThread.h"
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -44,6 +49,8 @@ class PrimaryClient;
 class InputFilter;
 class Thread;
 class ClientListener;
+class MotionDatagramLane;
+class IClientConnection;
 
 /// This class implements the top-level server algorithms for InputLeap.
 class Server : public INode, public EventTarget {
@@ -107,6 +114,19 @@ public:
         std::string screens_;
     };
 
+    //! Drag information collected for a screen
+    class DragInfoReadyInfo {
+    public:
+        DragInfoReadyInfo(ScreenId screen_id, DragFileList files) :
+            screen_id_{screen_id},
+            files_{std::move(files)}
+        {}
+
+    public:
+        ScreenId screen_id_;
+        DragFileList files_;
+    };
+
     /*!
     Start the server with the configuration \p config and the primary
     client (local screen) \p primaryClient.  The client retains
@@ -157,6 +177,23 @@ public:
     //! Store ClientListener pointer
     void setListener(ClientListener* p) { m_clientListener = p; }
 
+    //! Create a motion datagram lane
+    /*!
+    Returns a lane to send mouse motion to the client named \p name as
+    datagrams, or nullptr if the motionDatagrams option is disabled or
+    datagrams are unavailable.
+    */
+    std::unique_ptr<MotionDatagramLane> create_motion_datagram_lane(const std::string& name);
+
+    //! Resume a client session
+    /*!
+    Hands \p conn to the connected client named \p name if it can resume
+    the session identified by \p token after receiving \p received
+    messages.  Returns false, leaving \p conn alone, otherwise.
+    */
+    bool resume_client(const std::string& name, const std::string& token,
+                       std::uint32_t received, std::unique_ptr<IClientConnection>& conn);
+
     //@}
     //! @name accessors
     //@{
@@ -185,11 +222,32 @@ public:
     //! Return fake drag file list
     DragFileList getFakeDragFileList() { return m_fakeDragFileList; }
 
+    //! Get capture time of the current input
+    /*!
+    Returns the time, as returned by \c current_time_seconds(), when the
+    primary screen captured the input that is being forwarded to the
+    active screen, or 0 if that is unknown.
+    */
+    double get_input_time() const { return m_inputTime; }
+
+    //! Get input latency and round trip times of the connected clients
+    std::vector<LatencyReport> get_latency_reports() const;
+
     //@}
 
 private:
     // get canonical name of client
-    std::string getName(const BaseClientProxy*) const;
+    const std::string& getName(const BaseClientProxy*) const;
+
+    // get the id of a screen name or alias, kInvalidScreenId if unknown
+    ScreenId get_screen_id(const std::string& name) const;
+
+    // intern the names of the configured screens and update the ids of
+    // connected clients whose canonical name changed
+    void intern_screens();
+
+    // get the ids of the connected clients sorted by screen name
+    std::vector<ScreenId> get_client_ids_by_name() const;
 
     // get the sides of the primary screen that have neighbors
     std::uint32_t getActivePrimarySides() const;
@@ -318,6 +376,12 @@ private:
     void handle_fake_input_end_event();
     void handle_file_chunk_sending_event(const Event& event);
     void handle_file_receive_completed_event(const Event& event);
+    void handle_sync_screen_event();
+    void handle_drag_info_ready_event(const Event& event);
+
+    // record the time from switching screens to the first motion
+    // forwarded to the new screen
+    void record_switch_latency();
 
     // event processing
     void onClipboardChanged(BaseClientProxy* sender, ClipboardID id, std::uint32_t seqNum);
@@ -364,8 +428,8 @@ private:
     // thread function for writing file to drop directory
     void write_to_drop_dir_thread();
 
-    // thread function for sending drag information
-    void send_drag_info_thread(BaseClientProxy* newScreen);
+    // thread function for collecting drag information for a screen
+    void collect_drag_info_thread(ScreenId screen_id);
 
     // send drag info to new client screen
     void sendDragInfo(BaseClientProxy* newScreen);
@@ -381,15 +445,20 @@ private:
     public:
         Clipboard m_clipboard;
         std::string m_clipboardData;
-        std::string m_clipboardOwner;
+        // marshalled size of m_clipboard, which may be over the size limit
+        std::size_t m_clipboardSize;
+        ScreenId m_clipboardOwner;
         std::uint32_t m_clipboardSeqNum;
     };
 
     // the primary screen client
     PrimaryClient* m_primaryClient;
 
-    // all clients (including the primary client) indexed by name
-    typedef std::map<std::string, BaseClientProxy*> ClientList;
+    // interned names of all screens that have been configured
+    ScreenNameTable screen_names_;
+
+    // all clients (including the primary client) indexed by screen id
+    typedef std::map<ScreenId, BaseClientProxy*> ClientList;
     typedef std::set<BaseClientProxy*> ClientSet;
     ClientList m_clients;
     ClientSet m_clientSet;
@@ -478,7 +547,25 @@ private:
     bool m_enableClipboard;
     size_t m_maximumClipboardSize;
 
-    Thread* m_sendDragInfoThread;
+    // protocol features offered to clients
+    bool m_motionDatagrams;
+
+    // capture time of the input being handled
+    double m_inputTime;
+
+    // the screen entered last gets its clipboards from a
+    // SERVER_SYNC_SCREEN event after the enter went out
+    bool screen_sync_pending_ = false;
+    bool refresh_primary_clipboards_ = false;
+
+    // capture time of the input that switched screens until motion is
+    // forwarded to the new screen
+    double switch_time_ = 0.0;
+    LatencyHistogram switch_latency_;
+
+    // drag info is sent from a worker, at most one job is queued
+    std::unique_ptr<WorkerThread> drag_info_worker_;
+    std::atomic<bool> drag_info_pending_{false};
     bool m_waitDragInfoThread;
 
     ClientListener* m_clientListener;
@@ -0,0 +1,211 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test/global/TestEventQueue.h"
+#include "client/ServerConnector.h"
+#include "net/IDataSocket.h"
+#include "net/IListenSocket.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace inputleap {
+
+namespace {
+
+const int kTestPort = 24804;
+
+// stands in for a slow resolver that returns an address nothing answers
+// on before the one the server listens on
+class DelayedResolver {
+public:
+    explicit DelayedResolver(std::chrono::milliseconds delay) : delay_{delay} { }
+
+    std::vector<NetworkAddress> operator()(const NetworkAddress& address) const
+    {
+        std::this_thread::sleep_for(delay_);
+
+        // TEST-NET-1 is never routed, connecting to it hangs or fails
+        NetworkAddress unreachable("192.0.2.1", address.getPort());
+        unreachable.resolve();
+        NetworkAddress local("127.0.0.1", address.getPort());
+        local.resolve();
+        return {unreachable, local};
+    }
+
+private:
+    std::chrono::milliseconds delay_;
+};
+
+} // namespace
+
+class ServerConnectorTests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        factory_ = std::make_unique<TCPSocketFactory>(&events_, &multiplexer_);
+        listener_ = factory_->create_listen(IArchNetwork::kINET,
+                                            ConnectionSecurityLevel::PLAINTEXT);
+        NetworkAddress address("127.0.0.1", kTestPort);
+        address.resolve();
+        listener_->bind(address);
+    }
+
+    // returns the seconds from starting to connect until a connection won
+    double connect_once(ServerConnector& connector)
+    {
+        auto start = std::chrono::steady_clock::now();
+        connector.connect(NetworkAddress("server", kTestPort),
+                          ConnectionSecurityLevel::PLAINTEXT);
+        events_.initQuitTimeout(10);
+        events_.loop();
+        events_.cleanupQuitTimeout();
+        return std::chrono::duration<double>(connected_time_ - start).count();
+    }
+
+    TestEventQueue events_;
+    SocketMultiplexer multiplexer_;
+    std::unique_ptr<TCPSocketFactory> factory_;
+    std::unique_ptr<IListenSocket> listener_;
+
+    std::unique_ptr<IDataSocket> socket_;
+    NetworkAddress connected_address_;
+    std::chrono::steady_clock::time_point connected_time_;
+    std::string error_;
+};
+
+TEST_F(ServerConnectorTests, connects_to_reachable_address)
+{
+    const auto resolver_delay = std::chrono::milliseconds(100);
+    ServerConnector connector(&events_, factory_.get(),
+        [this](std::unique_ptr<IDataSocket> socket, const NetworkAddress& address) {
+            connected_time_ = std::chrono::steady_clock::now();
+            socket_ = std::move(socket);
+            connected_address_ = address;
+            events_.raiseQuitEvent();
+        },
+        [this](const std::string& what) {
+            error_ = what;
+            events_.raiseQuitEvent();
+        },
+        DelayedResolver(resolver_delay));
+
+    double elapsed = connect_once(connector);
+    RecordProperty("resolver_delay_ms", static_cast<int>(resolver_delay.count()));
+    RecordProperty("time_to_connected_ms", static_cast<int>(elapsed * 1000));
+
+    ASSERT_TRUE(error_.empty()) << error_;
+    ASSERT_NE(socket_, nullptr);
+    EXPECT_EQ(connected_address_.getHostname(), "127.0.0.1");
+    EXPECT_FALSE(connector.is_connecting());
+
+    // the unreachable address costs at most one attempt delay
+    EXPECT_LT(elapsed, 0.1 + ServerConnector::kConnectAttemptDelay + 1.0);
+}
+
+TEST_F(ServerConnectorTests, tries_last_address_first)
+{
+    const auto resolver_delay = std::chrono::milliseconds(100);
+    ServerConnector connector(&events_, factory_.get(),
+        [this](std::unique_ptr<IDataSocket> socket, const NetworkAddress& address) {
+            connected_time_ = std::chrono::steady_clock::now();
+            socket_ = std::move(socket);
+            connected_address_ = address;
+            events_.raiseQuitEvent();
+        },
+        [this](const std::string& what) {
+            error_ = what;
+            events_.raiseQuitEvent();
+        },
+        DelayedResolver(resolver_delay));
+
+    connect_once(connector);
+    ASSERT_NE(socket_, nullptr);
+    socket_.reset();
+    EXPECT_EQ(connector.get_last_address().getHostname(), "127.0.0.1");
+
+    // the remembered address doesn't wait behind the unreachable one
+    double elapsed = connect_once(connector);
+    RecordProperty("time_to_reconnected_ms", static_cast<int>(elapsed * 1000));
+    ASSERT_NE(socket_, nullptr);
+    EXPECT_LT(elapsed, 0.1 + ServerConnector::kConnectAttemptDelay);
+}
+
+TEST_F(ServerConnectorTests, order_addresses_interleaves_families)
+{
+    NetworkAddress v4a("127.0.0.1", kTestPort);
+    NetworkAddress v4b("127.0.0.2", kTestPort);
+    NetworkAddress v6("::1", kTestPort);
+    v4a.resolve();
+    v4b.resolve();
+    v6.resolve();
+
+    auto ordered = ServerConnector::order_addresses({v4a, v4b, v6}, NetworkAddress());
+    ASSERT_EQ(ordered.size(), 3u);
+    EXPECT_EQ(ordered[0], v4a);
+    EXPECT_EQ(ordered[1], v6);
+    EXPECT_EQ(ordered[2], v4b);
+
+    ordered = ServerConnector::order_addresses({v4a, v4b, v6}, v4b);
+    ASSERT_EQ(ordered.size(), 3u);
+    EXPECT_EQ(ordered[0], v4b);
+    EXPECT_EQ(ordered[1], v4a);
+    EXPECT_EQ(ordered[2], v6);
+}
+
+TEST_F(ServerConnectorTests, fails_over_to_standby)
+{
+    ServerConnector connector(&events_, factory_.get(),
+        [this](std::unique_ptr<IDataSocket> socket, const NetworkAddress& address) {
+            connected_time_ = std::chrono::steady_clock::now();
+            socket_ = std::move(socket);
+            connected_address_ = address;
+            events_.raiseQuitEvent();
+        },
+        [this](const std::string& what) {
+            error_ = what;
+            events_.raiseQuitEvent();
+        },
+        [](const NetworkAddress& address) {
+            NetworkAddress resolved(address);
+            resolved.resolve();
+            return std::vector<NetworkAddress>{resolved};
+        });
+    const double deadline = 0.5;
+    connector.set_failover_deadline(deadline);
+
+    // the primary is down and doesn't answer at all
+    auto start = std::chrono::steady_clock::now();
+    connector.connect({NetworkAddress("192.0.2.1", kTestPort),
+                       NetworkAddress("127.0.0.1", kTestPort)},
+                      ConnectionSecurityLevel::PLAINTEXT);
+    events_.initQuitTimeout(10);
+    events_.loop();
+    events_.cleanupQuitTimeout();
+    double elapsed = std::chrono::duration<double>(connected_time_ - start).count();
+    RecordProperty("time_to_failover_ms", static_cast<int>(elapsed * 1000));
+
+    ASSERT_TRUE(error_.empty()) << error_;
+    ASSERT_NE(socket_, nullptr);
+    EXPECT_EQ(connected_address_.getHostname(), "127.0.0.1");
+    EXPECT_LT(elapsed, deadline + 1.0);
+}
+
+} // namespace inputleap
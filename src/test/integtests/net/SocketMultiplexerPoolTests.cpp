@@ -0,0 +1,254 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test/global/TestEventQueue.h"
+#include "inputleap/FrameStream.h"
+#include "inputleap/PacketStreamFilter.h"
+#include "inputleap/ProtocolUtil.h"
+#include "inputleap/protocol_types.h"
+#include "common/DataDirectories.h"
+#include "net/FingerprintDatabase.h"
+#include "net/IDataSocket.h"
+#include "net/IListenSocket.h"
+#include "net/NetworkAddress.h"
+#include "net/SecureSocket.h"
+#include "net/SecureUtils.h"
+#include "net/SocketMultiplexer.h"
+#include "net/SocketMultiplexerPool.h"
+#include "net/TCPSocket.h"
+#include "net/TCPSocketFactory.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace inputleap {
+
+namespace {
+
+const int kTestPort = 24805;
+const std::uint32_t kMessagesPerClient = 256;
+const std::uint32_t kClipboardSize = 4096;
+const std::size_t kClientWorkers = 4;
+
+// points the profile at a scratch directory holding a certificate the
+// test clients trust
+void use_test_certificate()
+{
+    static bool done = false;
+    if (done) {
+        return;
+    }
+    done = true;
+
+    DataDirectories::profile(fs::temp_directory_path() / "inputleap-pool-tests");
+    auto certificate = DataDirectories::ssl_certificate_path();
+    fs::create_directories(certificate.parent_path());
+    fs::create_directories(DataDirectories::ssl_fingerprints_path());
+    generate_pem_self_signed_cert(certificate.u8string());
+
+    FingerprintDatabase db;
+    db.add_trusted(get_pem_file_cert_fingerprint(certificate.u8string(),
+                                                 FingerprintType::SHA256));
+    db.write(DataDirectories::trusted_servers_ssl_fingerprints_path());
+}
+
+// a connection as the server sees it: packets are framed by the socket's
+// worker, the proxy parses whole frames on the event loop
+struct Connection {
+    std::unique_ptr<PacketStreamFilter> stream;
+    FrameStream frames;
+};
+
+// connects virtual clients that each send kMessagesPerClient clipboard
+// messages and returns the seconds until the server side has parsed all
+// of them
+double run_clients(std::size_t workers, std::size_t clients,
+                   ConnectionSecurityLevel security_level)
+{
+    TestEventQueue events;
+    SocketMultiplexer multiplexer;
+    SocketMultiplexerPool pool(workers);
+    SocketMultiplexerPool client_pool(kClientWorkers);
+    TCPSocketFactory server_factory(&events, &multiplexer, &pool);
+
+    auto listener = server_factory.create_listen(IArchNetwork::kINET, security_level);
+    NetworkAddress address("127.0.0.1", kTestPort);
+    address.resolve();
+    listener->bind(address);
+
+    std::vector<std::unique_ptr<Connection>> accepted;
+    std::uint64_t received = 0;
+    const std::uint64_t expected = static_cast<std::uint64_t>(kMessagesPerClient) * clients;
+
+    events.add_handler(EventType::LISTEN_SOCKET_CONNECTING, listener->get_event_target(),
+                       [&](const auto&) {
+        auto socket = listener->accept();
+        if (!socket) {
+            return;
+        }
+        socket->set_packet_framing(PROTOCOL_MAX_MESSAGE_LENGTH);
+        auto connection = std::make_unique<Connection>();
+        connection->stream = std::make_unique<PacketStreamFilter>(&events, std::move(socket));
+        connection->frames.set_stream(connection->stream.get());
+
+        Connection* raw = connection.get();
+        events.add_handler(EventType::STREAM_INPUT_READY, raw->stream->get_event_target(),
+                           [&, raw](const auto&) {
+            while (raw->frames.read_frame()) {
+                std::uint8_t id = 0;
+                std::uint32_t seq = 0;
+                std::uint8_t mark = 0;
+                std::string data;
+                if (ProtocolUtil::readf(&raw->frames, kMsgDClipboard, &id, &seq, &mark, &data) &&
+                    data.size() == kClipboardSize) {
+                    ++received;
+                }
+            }
+            if (received == expected) {
+                events.raiseQuitEvent();
+            }
+        });
+        accepted.push_back(std::move(connection));
+    });
+
+    // clients encrypt on their own workers so only the server side varies
+    auto connected_type = EventType::DATA_SOCKET_CONNECTED;
+    if (security_level != ConnectionSecurityLevel::PLAINTEXT) {
+        connected_type = EventType::DATA_SOCKET_SECURE_CONNECTED;
+    }
+    std::string clipboard(kClipboardSize, 'x');
+    std::vector<std::unique_ptr<PacketStreamFilter>> connecting;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < clients; ++i) {
+        std::unique_ptr<IDataSocket> socket;
+        if (security_level != ConnectionSecurityLevel::PLAINTEXT) {
+            auto secure = std::make_unique<SecureSocket>(&events, client_pool.next(),
+                                                         IArchNetwork::kINET, security_level);
+            secure->initSsl(false);
+            socket = std::move(secure);
+        } else {
+            socket = std::make_unique<TCPSocket>(&events, client_pool.next(),
+                                                 IArchNetwork::kINET);
+        }
+        IDataSocket* raw_socket = socket.get();
+        auto stream = std::make_unique<PacketStreamFilter>(&events, std::move(socket));
+        PacketStreamFilter* raw = stream.get();
+        events.add_handler(connected_type, raw_socket->get_event_target(),
+                           [&, raw](const auto&) {
+            for (std::uint32_t seq = 0; seq < kMessagesPerClient; ++seq) {
+                ProtocolUtil::writef(raw, kMsgDClipboard, 0, seq, 0, &clipboard);
+            }
+        });
+        raw_socket->connect(address);
+        connecting.push_back(std::move(stream));
+    }
+
+    events.initQuitTimeout(60);
+    events.loop();
+    events.cleanupQuitTimeout();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                   start).count();
+
+    for (auto& stream : connecting) {
+        events.remove_handler(connected_type, stream->getStream()->get_event_target());
+    }
+    for (auto& connection : accepted) {
+        events.remove_handler(EventType::STREAM_INPUT_READY,
+                              connection->stream->get_event_target());
+    }
+    events.remove_handler(EventType::LISTEN_SOCKET_CONNECTING, listener->get_event_target());
+
+    EXPECT_EQ(received, expected);
+    return elapsed;
+}
+
+// best of a few runs, to keep scheduling noise out of the comparison
+double best_of_runs(std::size_t workers, std::size_t clients,
+                    ConnectionSecurityLevel security_level)
+{
+    double best = run_clients(workers, clients, security_level);
+    for (int i = 1; i < 3; ++i) {
+        best = std::min(best, run_clients(workers, clients, security_level));
+    }
+    return best;
+}
+
+} // namespace
+
+TEST(SocketMultiplexerPoolTests, hands_out_multiplexers_in_turn)
+{
+    SocketMultiplexerPool pool(3);
+    ASSERT_EQ(pool.get_size(), 3u);
+
+    SocketMultiplexer* first = pool.next();
+    SocketMultiplexer* second = pool.next();
+    SocketMultiplexer* third = pool.next();
+    EXPECT_NE(first, second);
+    EXPECT_NE(second, third);
+    EXPECT_NE(first, third);
+    EXPECT_EQ(pool.next(), first);
+
+    EXPECT_GE(SocketMultiplexerPool::get_default_size(), 1u);
+    EXPECT_LE(SocketMultiplexerPool::get_default_size(),
+              SocketMultiplexerPool::kMaxDefaultSize);
+}
+
+TEST(SocketMultiplexerPoolTests, records_virtual_clients)
+{
+    use_test_certificate();
+
+    const std::size_t kWorkers[] = { 1, 4 };
+    const std::size_t kClients[] = { 1, 8, 64 };
+    const ConnectionSecurityLevel kLevels[] = {
+        ConnectionSecurityLevel::PLAINTEXT, ConnectionSecurityLevel::ENCRYPTED
+    };
+
+    for (auto level : kLevels) {
+        std::string prefix = level == ConnectionSecurityLevel::PLAINTEXT ? "plain_" : "tls_";
+        for (std::size_t workers : kWorkers) {
+            for (std::size_t clients : kClients) {
+                double elapsed = run_clients(workers, clients, level);
+                RecordProperty(prefix + "workers_" + std::to_string(workers) + "_clients_" +
+                                   std::to_string(clients) + "_ms",
+                               static_cast<int>(elapsed * 1000));
+            }
+        }
+    }
+}
+
+TEST(SocketMultiplexerPoolTests, tls_scales_with_workers)
+{
+    // the server's four workers and the clients' own workers need cores
+    // of their own, or the comparison only measures the scheduler
+    if (std::thread::hardware_concurrency() < 4 + kClientWorkers) {
+        GTEST_SKIP() << "not enough cores to compare worker counts";
+    }
+    use_test_certificate();
+
+    double one = best_of_runs(1, 64, ConnectionSecurityLevel::ENCRYPTED);
+    double four = best_of_runs(4, 64, ConnectionSecurityLevel::ENCRYPTED);
+    RecordProperty("tls_one_worker_ms", static_cast<int>(one * 1000));
+    RecordProperty("tls_four_workers_ms", static_cast<int>(four * 1000));
+
+    // handshakes, decryption and framing are spread over the workers
+    EXPECT_LT(four, one * 0.75);
+}
+
+} // namespace inputleap
@@ -0,0 +1,70 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "server/IClientConnection.h"
+
+#include <gmock/gmock.h>
+
+namespace inputleap {
+
+class MockClientConnection : public IClientConnection
+{
+public:
+    MOCK_METHOD0(get_event_target, const EventTarget*());
+    MOCK_METHOD0(get_stream, IStream*());
+    MOCK_METHOD0(send_query_info_1_6, void());
+    MOCK_METHOD0(send_leave_1_6, void());
+    MOCK_METHOD4(send_enter_1_6, void(std::int32_t, std::int32_t, std::uint32_t,
+                                      KeyModifierMask));
+    MOCK_METHOD3(send_key_down_1_6, void(KeyID, KeyModifierMask, KeyButton));
+    MOCK_METHOD3(send_key_up_1_6, void(KeyID, KeyModifierMask, KeyButton));
+    MOCK_METHOD4(send_key_repeat_1_6, void(KeyID, KeyModifierMask, std::int32_t, KeyButton));
+    MOCK_METHOD1(send_mouse_down_1_6, void(ButtonID));
+    MOCK_METHOD1(send_mouse_up_1_6, void(ButtonID));
+    MOCK_METHOD2(send_mouse_move_1_6, void(std::int32_t, std::int32_t));
+    MOCK_METHOD2(send_mouse_relative_move_1_6, void(std::int32_t, std::int32_t));
+    MOCK_METHOD4(send_mouse_move_timed_1_6, void(std::int32_t, std::int32_t, std::uint32_t,
+                                                 std::uint32_t));
+    MOCK_METHOD4(send_mouse_relative_move_timed_1_6, void(std::int32_t, std::int32_t,
+                                                          std::uint32_t, std::uint32_t));
+    MOCK_METHOD2(send_mouse_wheel_1_6, void(std::int32_t, std::int32_t));
+    MOCK_METHOD2(send_drag_info_1_6, void(std::uint32_t, const std::string&));
+    MOCK_METHOD1(send_screensaver_1_6, void(bool));
+    MOCK_METHOD0(send_reset_options_1_6, void());
+    MOCK_METHOD1(send_set_options_1_6, void(const OptionsList&));
+    MOCK_METHOD0(send_info_ack_1_6, void());
+    MOCK_METHOD0(send_keep_alive_1_6, void());
+    MOCK_METHOD2(send_keep_alive_timed_1_6, void(std::uint32_t, std::uint32_t));
+    MOCK_METHOD3(send_datagram_offer_1_6, void(std::uint16_t, std::uint32_t, const std::string&));
+    MOCK_METHOD1(send_motion_sync_1_6, void(const MotionDatagram&));
+    MOCK_METHOD2(send_clock_1_6, void(std::uint32_t, std::uint32_t));
+    MOCK_METHOD0(send_noop_1_6, void());
+    MOCK_METHOD1(send_session_1_6, void(const std::string&));
+    MOCK_METHOD1(send_resume_1_6, void(bool));
+    MOCK_METHOD1(send_close_1_6, void(const char*));
+    MOCK_METHOD1(send_clipboard_chunk_1_6, void(const ClipboardChunk&));
+    MOCK_METHOD3(send_clipboard_cached_1_6, void(ClipboardID, std::uint32_t, const std::string&));
+    MOCK_METHOD3(send_clipboard_formats_1_6,
+                 void(ClipboardID, std::uint32_t, const std::vector<std::uint32_t>&));
+    MOCK_METHOD1(send_file_chunk_1_6, void(const FileChunk&));
+    MOCK_METHOD1(send_grab_clipboard, void(ClipboardID));
+    MOCK_METHOD0(flush, void());
+    MOCK_METHOD0(close, void());
+};
+
+} // namespace inputleap
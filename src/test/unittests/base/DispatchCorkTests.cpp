@@ -0,0 +1,162 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/DispatchCork.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace inputleap {
+
+TEST(DispatchCorkTests, runs_at_once_without_cork)
+{
+    int runs = 0;
+    DispatchCork::defer(&runs, [&runs]() { ++runs; });
+    EXPECT_EQ(runs, 1);
+    EXPECT_FALSE(DispatchCork::is_corked());
+}
+
+TEST(DispatchCorkTests, runs_once_per_key_when_released)
+{
+    int key_a = 0;
+    int key_b = 0;
+    int runs_a = 0;
+    int runs_b = 0;
+    {
+        DispatchCork cork;
+        {
+            // nested corks, e.g. events dispatched from a handler
+            DispatchCork inner;
+            for (int i = 0; i < 5; ++i) {
+                DispatchCork::defer(&key_a, [&runs_a]() { ++runs_a; });
+            }
+        }
+        DispatchCork::defer(&key_b, [&runs_b]() { ++runs_b; });
+        EXPECT_EQ(runs_a, 0);
+        EXPECT_EQ(runs_b, 0);
+    }
+    EXPECT_EQ(runs_a, 1);
+    EXPECT_EQ(runs_b, 1);
+}
+
+TEST(DispatchCorkTests, release_and_cancel)
+{
+    int key_a = 0;
+    int key_b = 0;
+    int runs_a = 0;
+    int runs_b = 0;
+    {
+        DispatchCork cork;
+        DispatchCork::defer(&key_a, [&runs_a]() { ++runs_a; });
+        DispatchCork::defer(&key_b, [&runs_b]() { ++runs_b; });
+
+        DispatchCork::release(&key_a);
+        EXPECT_EQ(runs_a, 1);
+
+        DispatchCork::cancel(&key_b);
+    }
+    EXPECT_EQ(runs_a, 1);
+    EXPECT_EQ(runs_b, 0);
+}
+
+TEST(DispatchCorkTests, release_all_while_corked)
+{
+    int key_a = 0;
+    int key_b = 0;
+    int runs_a = 0;
+    int runs_b = 0;
+    {
+        DispatchCork cork;
+        DispatchCork::defer(&key_a, [&]() {
+            ++runs_a;
+            // still corked, so this is run by the same release_all()
+            DispatchCork::defer(&key_b, [&runs_b]() { ++runs_b; });
+        });
+
+        DispatchCork::release_all();
+        EXPECT_EQ(runs_a, 1);
+        EXPECT_EQ(runs_b, 1);
+
+        // the cork keeps deferring afterwards
+        DispatchCork::defer(&key_a, [&runs_a]() { ++runs_a; });
+        EXPECT_EQ(runs_a, 1);
+    }
+    EXPECT_EQ(runs_a, 2);
+    EXPECT_EQ(runs_b, 1);
+}
+
+TEST(DispatchCorkTests, cancel_from_other_thread)
+{
+    // e.g. a socket written to by the event loop and destroyed elsewhere
+    int key = 0;
+    std::atomic<int> runs{0};
+    std::promise<void> deferred;
+    std::promise<void> cancelled;
+
+    std::thread loop([&]() {
+        DispatchCork cork;
+        DispatchCork::defer(&key, [&runs]() { ++runs; });
+        deferred.set_value();
+        cancelled.get_future().wait();
+    });
+
+    deferred.get_future().wait();
+    DispatchCork::cancel(&key);
+    cancelled.set_value();
+    loop.join();
+
+    EXPECT_EQ(runs, 0);
+}
+
+TEST(DispatchCorkTests, cancel_waits_for_running_work)
+{
+    int key = 0;
+    std::atomic<bool> done{false};
+    std::promise<void> started;
+
+    std::thread loop([&]() {
+        DispatchCork cork;
+        DispatchCork::defer(&key, [&]() {
+            started.set_value();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            done = true;
+        });
+    });
+
+    started.get_future().wait();
+    DispatchCork::cancel(&key);
+    EXPECT_TRUE(done);
+    loop.join();
+}
+
+TEST(DispatchCorkTests, work_can_cancel_itself)
+{
+    int key = 0;
+    int runs = 0;
+    {
+        DispatchCork cork;
+        DispatchCork::defer(&key, [&]() {
+            ++runs;
+            DispatchCork::cancel(&key);
+        });
+    }
+    EXPECT_EQ(runs, 1);
+}
+
+} // namespace inputleap
@@ -0,0 +1,144 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/NestedEventLoop.h"
+#include "base/DispatchCork.h"
+#include "base/EventTarget.h"
+#include "test/global/TestEventQueue.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+namespace inputleap {
+
+namespace {
+
+// a started queue, events are dispatched by hand from here on
+void start(TestEventQueue& events)
+{
+    events.raiseQuitEvent();
+    events.loop();
+}
+
+} // namespace
+
+TEST(NestedEventLoopTests, returns_once_done)
+{
+    TestEventQueue events;
+    start(events);
+
+    EventTarget target;
+    bool arrived = false;
+    events.add_handler(EventType::CLIPBOARD_CHANGED, &target, [&](const auto&) {
+        arrived = true;
+    });
+    events.add_event(EventType::CLIPBOARD_CHANGED, &target);
+
+    EXPECT_TRUE(run_nested_event_loop(&events, 5.0, [&]() { return arrived; }));
+    events.remove_handler(EventType::CLIPBOARD_CHANGED, &target);
+}
+
+TEST(NestedEventLoopTests, times_out)
+{
+    TestEventQueue events;
+    start(events);
+
+    EXPECT_FALSE(run_nested_event_loop(&events, 0.05, []() { return false; }));
+}
+
+TEST(NestedEventLoopTests, leaves_quit_to_outer_loop)
+{
+    TestEventQueue events;
+    start(events);
+
+    events.add_event(EventType::QUIT);
+    EXPECT_FALSE(run_nested_event_loop(&events, 5.0, []() { return false; }));
+
+    Event event;
+    ASSERT_TRUE(events.getEvent(event, 0.0));
+    EXPECT_EQ(event.getType(), EventType::QUIT);
+}
+
+TEST(NestedEventLoopTests, runs_deferred_work_while_waiting)
+{
+    TestEventQueue events;
+    start(events);
+
+    // like a socket write inside the handler that waits, the reply only
+    // comes once the write went out
+    EventTarget target;
+    int key = 0;
+    bool sent = false;
+    bool replied = false;
+    events.add_handler(EventType::CLIPBOARD_REQUESTED, &target, [&](const auto&) {
+        DispatchCork::defer(&key, [&]() {
+            sent = true;
+            events.add_event(EventType::CLIPBOARD_CHANGED, &target);
+        });
+    });
+    events.add_handler(EventType::CLIPBOARD_CHANGED, &target, [&](const auto&) {
+        replied = true;
+    });
+
+    {
+        DispatchCork cork;
+        events.add_event(EventType::CLIPBOARD_REQUESTED, &target);
+        EXPECT_TRUE(run_nested_event_loop(&events, 5.0, [&]() { return replied; }));
+        EXPECT_TRUE(sent);
+    }
+    events.remove_handler(EventType::CLIPBOARD_REQUESTED, &target);
+    events.remove_handler(EventType::CLIPBOARD_CHANGED, &target);
+}
+
+TEST(NestedEventLoopTests, handlers_run_reentrantly)
+{
+    TestEventQueue events;
+    start(events);
+
+    // a handler waits for a second event, whose handler removes the
+    // first one while it's still running
+    EventTarget target;
+    int depth = 0;
+    int max_depth = 0;
+    bool second = false;
+    events.add_handler(EventType::CLIPBOARD_REQUESTED, &target, [&](const auto&) {
+        ++depth;
+        max_depth = std::max(max_depth, depth);
+        events.add_event(EventType::CLIPBOARD_CHANGED, &target);
+        EXPECT_TRUE(run_nested_event_loop(&events, 5.0, [&]() { return second; }));
+        --depth;
+    });
+    events.add_handler(EventType::CLIPBOARD_CHANGED, &target, [&](const auto&) {
+        ++depth;
+        max_depth = std::max(max_depth, depth);
+        events.remove_handler(EventType::CLIPBOARD_REQUESTED, &target);
+        second = true;
+        --depth;
+    });
+
+    events.add_event(EventType::CLIPBOARD_REQUESTED, &target);
+    Event event;
+    ASSERT_TRUE(events.getEvent(event, 0.0));
+    events.dispatchEvent(event);
+    Event::deleteData(event);
+
+    EXPECT_TRUE(second);
+    EXPECT_EQ(depth, 0);
+    EXPECT_EQ(max_depth, 2);
+    events.remove_handler(EventType::CLIPBOARD_CHANGED, &target);
+}
+
+} // namespace inputleap
@@ -201,3 +201,18 @@ TEST(StringTests, splitString_headAndTailSeparators_returnTwoParts)
     EXPECT_EQ("stub1", results[0]);
     EXPECT_EQ("stub2", results[1]);
 }
+
+TEST(StringTests, caselessCmp_mixedCase_comparesIgnoringCase)
+{
+    EXPECT_TRUE(string::CaselessCmp::equal("Screen1.Example", "sCREEN1.eXAMPLE"));
+    EXPECT_FALSE(string::CaselessCmp::equal("screen1", "screen12"));
+    EXPECT_FALSE(string::CaselessCmp::equal("screen1", "screen2"));
+
+    EXPECT_TRUE(string::CaselessCmp::less("Alpha", "beta"));
+    EXPECT_FALSE(string::CaselessCmp::less("beta", "Alpha"));
+    EXPECT_TRUE(string::CaselessCmp::less("ABC", "abcd"));
+    EXPECT_FALSE(string::CaselessCmp::less("abc", "ABC"));
+    EXPECT_FALSE(string::CaselessCmp::less("ABC", "abc"));
+    // letters are compared lowercased, so '_' sorts before 'Z' as with tolower()
+    EXPECT_TRUE(string::CaselessCmp::less("_", "Z"));
+}
@@ -0,0 +1,126 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/Unicode.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string utf16(std::initializer_list<std::uint16_t> words)
+{
+    std::string result;
+    for (std::uint16_t word : words) {
+        result.append(reinterpret_cast<const char*>(&word), 2);
+    }
+    return result;
+}
+
+std::string repeat(const std::string& s, std::size_t count)
+{
+    std::string result;
+    for (std::size_t i = 0; i < count; ++i) {
+        result += s;
+    }
+    return result;
+}
+
+// the corpora are long enough to go through the block conversions and
+// have characters of every length straddle the block boundaries
+const char* const kAscii = "2024-01-01 12:00:00,INFO,request served in 12ms\n";
+const char* const kEuropean = "Gr\xc3\xb6\xc3\x9f" "e,caf\xc3\xa9,na\xc3\xafve,se\xc3\xb1or\n";
+const char* const kCjk = "\xe4\xb8\xad\xe6\x96\x87,\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\n";
+const char* const kAstral = "emoji \xf0\x9f\x98\x80 and \xf0\x9d\x84\x9e\n";
+
+} // namespace
+
+TEST(UnicodeTests, isUTF8_validCorpora_true)
+{
+    for (const char* corpus : { kAscii, kEuropean, kCjk, kAstral }) {
+        EXPECT_TRUE(Unicode::isUTF8(repeat(corpus, 50))) << corpus;
+    }
+}
+
+TEST(UnicodeTests, isUTF8_invalidAfterAsciiRun_false)
+{
+    std::string ascii = repeat(kAscii, 10);
+    EXPECT_FALSE(Unicode::isUTF8(ascii + "\xc0\xaf"));
+    EXPECT_FALSE(Unicode::isUTF8(ascii + "\xed\xa0\x80" + ascii));
+    EXPECT_FALSE(Unicode::isUTF8(ascii + "\xe4\xb8"));
+    EXPECT_FALSE(Unicode::isUTF8(ascii + "\x80" + ascii));
+}
+
+TEST(UnicodeTests, UTF8ToUTF16_mixedCharacters_encoded)
+{
+    bool errors = true;
+    std::string result = Unicode::UTF8ToUTF16("a\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80", &errors);
+
+    EXPECT_EQ(utf16({ 0x0061, 0x00e9, 0x4e2d, 0xd83d, 0xde00 }), result);
+    EXPECT_FALSE(errors);
+}
+
+TEST(UnicodeTests, UTF8ToUTF16_invalidSequences_replaced)
+{
+    std::string ascii(20, 'x');
+    std::string result = Unicode::UTF8ToUTF16(ascii + "\xc0\xaf" "\xed\xa0\x80" "\xef\xbf\xbe");
+
+    std::string expected = Unicode::UTF8ToUTF16(ascii);
+    expected += utf16({ 0xfffd, 0xfffd, 0xfffd });
+    EXPECT_EQ(expected, result);
+}
+
+TEST(UnicodeTests, UTF16ToUTF8_roundTripCorpora_unchanged)
+{
+    for (const char* corpus : { kAscii, kEuropean, kCjk, kAstral }) {
+        // cut the corpus in every length to move the characters around the
+        // block boundaries
+        std::string text = repeat(corpus, 20);
+        for (std::size_t size = text.size() - 40; size <= text.size(); ++size) {
+            std::string part = text.substr(0, size);
+            if (!Unicode::isUTF8(part)) {
+                continue;
+            }
+            bool errors = true;
+            EXPECT_EQ(part, Unicode::UTF16ToUTF8(Unicode::UTF8ToUTF16(part), &errors));
+            EXPECT_FALSE(errors);
+        }
+    }
+}
+
+TEST(UnicodeTests, UTF16ToUTF8_byteSwapped_decoded)
+{
+    std::string big_endian = "\xfe\xff" + repeat(std::string("\x00" "a" "\x4e\x2d", 4), 16);
+
+    EXPECT_EQ(repeat("a\xe4\xb8\xad", 16), Unicode::UTF16ToUTF8(big_endian));
+}
+
+TEST(UnicodeTests, UTF16ToUTF8_loneSurrogates_replacedWithError)
+{
+    bool errors = false;
+    std::string result = Unicode::UTF16ToUTF8(utf16({ 'a', 0xdc00, 'b', 0xd800 }), &errors);
+
+    EXPECT_EQ("a\xef\xbf\xbd" "b\xef\xbf\xbd", result);
+    EXPECT_TRUE(errors);
+}
+
+TEST(UnicodeTests, UCS2ToUTF8_corpus_encoded)
+{
+    std::string text = repeat(kCjk, 10) + repeat(kEuropean, 10);
+    bool errors = true;
+
+    EXPECT_EQ(text, Unicode::UCS2ToUTF8(Unicode::UTF8ToUCS2(text), &errors));
+    EXPECT_FALSE(errors);
+}
@@ -96,4 +96,54 @@ TEST(ClientArgsParsingTests, parseClientArgs_unrecognizedArg_returnFalse)
     EXPECT_FALSE(result);
 }
 
+TEST(ClientArgsParsingTests, parseClientArgs_standbyArgs_setStandbyAddresses)
+{
+    NiceMock<MockArgParser> argParser;
+    ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(client_stubParseGenericArgs));
+    ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(client_stubCheckUnexpectedArgs));
+    ClientArgs clientArgs;
+    const int argc = 8;
+    const char* kStandbyCmd[argc] = { "stub", "--standby", "standby1", "--standby", "standby2",
+                                      "--failover-deadline", "0.5", "mock_address" };
+
+    bool result = argParser.parseClientArgs(clientArgs, argc, kStandbyCmd);
+
+    EXPECT_TRUE(result);
+    EXPECT_EQ("mock_address", clientArgs.network_address);
+    ASSERT_EQ(2u, clientArgs.standby_addresses.size());
+    EXPECT_EQ("standby1", clientArgs.standby_addresses[0]);
+    EXPECT_EQ("standby2", clientArgs.standby_addresses[1]);
+    EXPECT_DOUBLE_EQ(0.5, clientArgs.failover_deadline);
+}
+
+TEST(ClientArgsParsingTests, parseClientArgs_badFailoverDeadline_returnFalse)
+{
+    NiceMock<MockArgParser> argParser;
+    ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(client_stubParseGenericArgs));
+    ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(client_stubCheckUnexpectedArgs));
+    ClientArgs clientArgs;
+    const int argc = 4;
+    const char* kDeadlineCmd[argc] = { "stub", "--failover-deadline", "0", "mock_address" };
+
+    bool result = argParser.parseClientArgs(clientArgs, argc, kDeadlineCmd);
+
+    EXPECT_FALSE(result);
+}
+
+TEST(ClientArgsParsingTests, parseClientArgs_clipboardCacheDirArg_setClipboardCacheDir)
+{
+    NiceMock<MockArgParser> argParser;
+    ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(client_stubParseGenericArgs));
+    ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(client_stubCheckUnexpectedArgs));
+    ClientArgs clientArgs;
+    const int argc = 4;
+    const char* kCacheDirCmd[argc] = { "stub", "--clipboard-cache-dir", "mock_dir",
+                                       "mock_address" };
+
+    bool result = argParser.parseClientArgs(clientArgs, argc, kCacheDirCmd);
+
+    EXPECT_TRUE(result);
+    EXPECT_EQ("mock_dir", clientArgs.clipboard_cache_dir);
+}
+
 } // namespace inputleap
@@ -0,0 +1,141 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/ClipboardCache.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+
+namespace inputleap {
+
+namespace {
+
+std::string make_content(char fill, std::size_t size)
+{
+    return std::string(size, fill);
+}
+
+} // namespace
+
+TEST(ClipboardCacheTests, hash_is_sha256)
+{
+    auto hash = ClipboardCache::hash("abc");
+    ASSERT_EQ(hash.size(), 32u);
+    EXPECT_EQ(static_cast<unsigned char>(hash[0]), 0xbau);
+    EXPECT_EQ(static_cast<unsigned char>(hash[1]), 0x78u);
+    EXPECT_EQ(static_cast<unsigned char>(hash[31]), 0xadu);
+}
+
+TEST(ClipboardCacheTests, finds_inserted_content)
+{
+    ClipboardCache cache;
+    std::string content = make_content('a', 10000);
+    auto hash = ClipboardCache::hash(content);
+
+    std::string found;
+    EXPECT_FALSE(cache.find(hash, found));
+    cache.insert(hash, content);
+    EXPECT_TRUE(cache.contains(hash));
+    ASSERT_TRUE(cache.find(hash, found));
+    EXPECT_EQ(found, content);
+
+    EXPECT_EQ(cache.get_counters().hits, 1u);
+    EXPECT_EQ(cache.get_counters().misses, 1u);
+}
+
+TEST(ClipboardCacheTests, drops_least_recently_used)
+{
+    ClipboardCache cache(25000);
+    std::string a = make_content('a', 10000);
+    std::string b = make_content('b', 10000);
+    std::string c = make_content('c', 10000);
+    auto hash_a = ClipboardCache::hash(a);
+    auto hash_b = ClipboardCache::hash(b);
+    auto hash_c = ClipboardCache::hash(c);
+
+    cache.insert(hash_a, a);
+    cache.insert(hash_b, b);
+
+    // using a makes b the oldest
+    std::string found;
+    ASSERT_TRUE(cache.find(hash_a, found));
+    cache.insert(hash_c, c);
+
+    EXPECT_TRUE(cache.contains(hash_a));
+    EXPECT_FALSE(cache.contains(hash_b));
+    EXPECT_TRUE(cache.contains(hash_c));
+    EXPECT_EQ(cache.get_size(), 20000u);
+    EXPECT_EQ(cache.get_counters().evictions, 1u);
+}
+
+TEST(ClipboardCacheTests, spills_to_directory)
+{
+    fs::path directory = fs::temp_directory_path() / "inputleap-clipboard-cache-test";
+    {
+        ClipboardCache cache(15000);
+        cache.set_spill_directory(directory);
+
+        std::string a = make_content('a', 10000);
+        std::string b = make_content('b', 10000);
+        auto hash_a = ClipboardCache::hash(a);
+        cache.insert(hash_a, a);
+        cache.insert(ClipboardCache::hash(b), b);
+
+        EXPECT_EQ(cache.get_counters().spills, 1u);
+        EXPECT_TRUE(cache.contains(hash_a));
+
+        std::string found;
+        ASSERT_TRUE(cache.find(hash_a, found));
+        EXPECT_EQ(found, a);
+    }
+
+    // the cache cleans up after itself
+    EXPECT_TRUE(fs::is_empty(directory));
+    fs::remove_all(directory);
+}
+
+TEST(ClipboardCacheTests, repeated_transfer_cost)
+{
+    // bouncing between screens with a large clipboard:  the first offer
+    // misses and the data is sent, every later one is a hit
+    const std::size_t kSize = 30 * 1024 * 1024;
+    const int kBounces = 10;
+    ClipboardCache cache;
+    std::string content = make_content('x', kSize);
+
+    std::size_t bytes_sent = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kBounces; ++i) {
+        auto hash = ClipboardCache::hash(content);
+        std::string found;
+        bytes_sent += hash.size();
+        if (!cache.find(hash, found)) {
+            bytes_sent += content.size();
+            cache.insert(hash, content);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                   start).count();
+
+    EXPECT_EQ(cache.get_counters().hits, static_cast<std::uint64_t>(kBounces - 1));
+    EXPECT_LT(bytes_sent, 2 * kSize);
+    RecordProperty("kbytes_without_cache", static_cast<int>(kSize * kBounces / 1024));
+    RecordProperty("kbytes_with_cache", static_cast<int>(bytes_sent / 1024));
+    RecordProperty("hash_and_lookup_ms_per_bounce", static_cast<int>(elapsed * 1000 / kBounces));
+}
+
+} // namespace inputleap
@@ -0,0 +1,215 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/ClipboardCodec.h"
+
+#include <gtest/gtest.h>
+
+namespace inputleap {
+
+namespace {
+
+void put16(std::string& data, std::uint16_t value)
+{
+    data += static_cast<char>(value & 0xff);
+    data += static_cast<char>(value >> 8);
+}
+
+void put32(std::string& data, std::uint32_t value)
+{
+    put16(data, static_cast<std::uint16_t>(value & 0xffff));
+    put16(data, static_cast<std::uint16_t>(value >> 16));
+}
+
+std::string make_dib_header(std::int32_t width, std::int32_t height, std::uint16_t bit_count,
+                            std::uint32_t compression)
+{
+    std::string header;
+    put32(header, 40);
+    put32(header, static_cast<std::uint32_t>(width));
+    put32(header, static_cast<std::uint32_t>(height));
+    put16(header, 1);
+    put16(header, bit_count);
+    put32(header, compression);
+    put32(header, 0);
+    put32(header, 1000);
+    put32(header, 1000);
+    put32(header, 0);
+    put32(header, 0);
+    return header;
+}
+
+} // namespace
+
+TEST(ClipboardCodecTests, count_lf_longText_countsEveryBlock)
+{
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "line\n";
+    }
+
+    EXPECT_EQ(100u, clipboard_codec::count_lf(text.data(), text.size()));
+    EXPECT_EQ(0u, clipboard_codec::count_lf(text.data(), 4));
+}
+
+TEST(ClipboardCodecTests, lf_to_crlf_newlines_crInserted)
+{
+    EXPECT_EQ("a\r\nb\r\n\r\nc", clipboard_codec::lf_to_crlf("a\nb\n\nc"));
+    EXPECT_EQ("\r\n", clipboard_codec::lf_to_crlf("\n"));
+    EXPECT_EQ("no newline", clipboard_codec::lf_to_crlf("no newline"));
+    EXPECT_EQ("", clipboard_codec::lf_to_crlf(""));
+}
+
+TEST(ClipboardCodecTests, crlf_to_lf_newlines_crRemoved)
+{
+    EXPECT_EQ("a\nb\n\nc", clipboard_codec::crlf_to_lf("a\r\nb\r\n\r\nc"));
+    EXPECT_EQ("a\rb\r\n", clipboard_codec::crlf_to_lf("a\rb\r\r\n"));
+    EXPECT_EQ("trailing\r", clipboard_codec::crlf_to_lf("trailing\r"));
+    EXPECT_EQ("", clipboard_codec::crlf_to_lf(""));
+}
+
+TEST(ClipboardCodecTests, crlf_to_lf_roundTrip_unchanged)
+{
+    std::string text;
+    for (int i = 0; i < 50; ++i) {
+        text += "some text of a line\n\n";
+    }
+
+    EXPECT_EQ(text, clipboard_codec::crlf_to_lf(clipboard_codec::lf_to_crlf(text)));
+}
+
+TEST(ClipboardCodecTests, html_to_cf_html_fragment_offsetsLocateFragment)
+{
+    std::string fragment = "<b>bold</b>";
+    std::string data = clipboard_codec::html_to_cf_html(fragment);
+
+    EXPECT_EQ(0u, data.find("Version:0.9\r\nStartHTML:0000000105\r\n"));
+    EXPECT_EQ(data.find("<!DOCTYPE>"), 105u);
+    std::size_t end_html = data.find("EndHTML:");
+    ASSERT_NE(std::string::npos, end_html);
+    EXPECT_EQ(data.size(), std::stoul(data.substr(end_html + 8, 10)));
+    EXPECT_EQ(fragment, clipboard_codec::cf_html_to_html(data));
+}
+
+TEST(ClipboardCodecTests, cf_html_to_html_otherApplication_fragmentExtracted)
+{
+    // offsets without padding, in another order and with a source url
+    std::string document = "<html><body>\r\n<!--StartFragment-->hello<!--EndFragment-->";
+    std::string header = "Version:1.0\r\nEndFragment:XXX\r\nStartFragment:YYY\r\n"
+                         "SourceURL:http://example.com/\r\n";
+    std::size_t start = header.size() + document.find("hello");
+    header.replace(header.find("XXX"), 3, std::to_string(start + 5));
+    header.replace(header.find("YYY"), 3, std::to_string(start));
+
+    EXPECT_EQ("hello", clipboard_codec::cf_html_to_html(header + document));
+}
+
+TEST(ClipboardCodecTests, cf_html_to_html_invalidOffsets_empty)
+{
+    EXPECT_EQ("", clipboard_codec::cf_html_to_html("<b>no header</b>"));
+    EXPECT_EQ("", clipboard_codec::cf_html_to_html(
+        "StartFragment:0000000050\r\nEndFragment:0000000040\r\n<b>x</b>"));
+    EXPECT_EQ("", clipboard_codec::cf_html_to_html(
+        "StartFragment:0000000040\r\nEndFragment:0000009999\r\n<b>x</b>"));
+    // the names must be in the description, not the document
+    EXPECT_EQ("", clipboard_codec::cf_html_to_html(
+        "Version:0.9\r\n<p>StartFragment:1 EndFragment:5</p>"));
+}
+
+TEST(ClipboardCodecTests, parse_dib_topDown_heightPositive)
+{
+    std::string dib = make_dib_header(3, -2, 24, 0) + std::string(2 * 12, '\0');
+
+    clipboard_codec::DibInfo info;
+    ASSERT_TRUE(clipboard_codec::parse_dib(dib, info));
+    EXPECT_EQ(3, info.width);
+    EXPECT_EQ(2, info.height);
+    EXPECT_TRUE(info.top_down);
+    EXPECT_EQ(12u, info.stride);
+    EXPECT_EQ(40u, info.bits_offset);
+}
+
+TEST(ClipboardCodecTests, parse_dib_truncatedPixels_false)
+{
+    std::string dib = make_dib_header(3, 2, 24, 0) + std::string(12, '\0');
+
+    clipboard_codec::DibInfo info;
+    EXPECT_FALSE(clipboard_codec::parse_dib(dib, info));
+    EXPECT_FALSE(clipboard_codec::parse_dib(dib.substr(0, 20), info));
+}
+
+TEST(ClipboardCodecTests, convert_dib_canonical_unchanged)
+{
+    std::string dib = make_dib_header(1, 1, 32, 0) + std::string("\x01\x02\x03\x00", 4);
+
+    EXPECT_EQ(dib, clipboard_codec::convert_dib(dib, 32));
+}
+
+TEST(ClipboardCodecTests, convert_dib_topDown24_flippedTo32)
+{
+    // two rows of one pixel, padded to four bytes, top row first
+    std::string dib = make_dib_header(1, -2, 24, 0) +
+                      std::string("\x01\x02\x03\x00" "\x04\x05\x06\x00", 8);
+
+    std::string result = clipboard_codec::convert_dib(dib, 32);
+
+    ASSERT_EQ(48u, result.size());
+    clipboard_codec::DibInfo info;
+    ASSERT_TRUE(clipboard_codec::parse_dib(result, info));
+    EXPECT_FALSE(info.top_down);
+    EXPECT_EQ(32, info.bit_count);
+    EXPECT_EQ(std::string("\x04\x05\x06\x00" "\x01\x02\x03\x00", 8), result.substr(40));
+}
+
+TEST(ClipboardCodecTests, convert_dib_32to24_rowsPadded)
+{
+    std::string dib = make_dib_header(2, 1, 32, 0) +
+                      std::string("\x01\x02\x03\xff" "\x04\x05\x06\xff", 8);
+
+    std::string result = clipboard_codec::convert_dib(dib, 24);
+
+    EXPECT_EQ(std::string("\x01\x02\x03\x04\x05\x06\x00\x00", 8), result.substr(40));
+}
+
+TEST(ClipboardCodecTests, convert_dib_bitfields_convertedToRgb)
+{
+    std::string dib = make_dib_header(1, 1, 32, 3);
+    put32(dib, 0x00ff0000);
+    put32(dib, 0x0000ff00);
+    put32(dib, 0x000000ff);
+    dib += std::string("\x01\x02\x03\x00", 4);
+
+    std::string result = clipboard_codec::convert_dib(dib, 32);
+
+    EXPECT_EQ(make_dib_header(1, 1, 32, 0).substr(0, 16), result.substr(0, 16));
+    EXPECT_EQ(std::string("\x01\x02\x03\x00", 4), result.substr(40));
+}
+
+TEST(ClipboardCodecTests, convert_dib_unsupported_empty)
+{
+    std::string palette = make_dib_header(8, 1, 8, 0) + std::string(4 * 256 + 8, '\0');
+    std::string bitfields = make_dib_header(1, 1, 32, 3);
+    put32(bitfields, 0x000000ff);
+    put32(bitfields, 0x0000ff00);
+    put32(bitfields, 0x00ff0000);
+    bitfields += std::string(4, '\0');
+
+    EXPECT_EQ("", clipboard_codec::convert_dib(palette, 32));
+    EXPECT_EQ("", clipboard_codec::convert_dib(bitfields, 32));
+    EXPECT_EQ("", clipboard_codec::convert_dib(make_dib_header(1, 1, 32, 0), 32));
+}
+
+} // namespace inputleap
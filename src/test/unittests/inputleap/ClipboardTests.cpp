@@ -398,4 +398,27 @@ TEST(ClipboardTests, copy_withSingleText_clipboardsAreEqual)
     EXPECT_EQ("test string!", actual);
 }
 
+TEST(ClipboardTests, describe_emptyData_returnsNoFormats)
+{
+    Clipboard clipboard;
+
+    std::vector<std::uint32_t> actual = IClipboard::describe(&clipboard);
+
+    EXPECT_TRUE(actual.empty());
+}
+
+TEST(ClipboardTests, describe_withTextAndHtml_returnsFormatsAndSizes)
+{
+    Clipboard clipboard;
+    clipboard.open(0);
+    clipboard.add(IClipboard::kText, "test string!");
+    clipboard.add(IClipboard::kHTML, "<b>test</b>");
+    clipboard.close();
+
+    std::vector<std::uint32_t> actual = IClipboard::describe(&clipboard);
+
+    std::vector<std::uint32_t> expected = { IClipboard::kText, 12, IClipboard::kHTML, 11 };
+    EXPECT_EQ(expected, actual);
+}
+
 } // namespace inputleap
@@ -0,0 +1,334 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/FrameStream.h"
+#include "inputleap/PacketStreamFilter.h"
+#include "inputleap/ProtocolUtil.h"
+#include "base/EventTarget.h"
+#include "test/mock/inputleap/MockEventQueue.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace inputleap {
+
+namespace {
+
+// behaves like PacketStreamFilter:  a packet is only readable once all of
+// it has arrived and reads stop at the end of the current packet
+class FakePacketStream : public IStream {
+public:
+    void add_packet(const std::string& data, std::size_t arrived)
+    {
+        packets_.push_back({data, arrived});
+    }
+
+    void add_packet(const std::string& data) { add_packet(data, data.size()); }
+
+    void arrive() { packets_.front().arrived = packets_.front().data.size(); }
+
+    void close() override { packets_.clear(); }
+    std::uint32_t read(void* buffer, std::uint32_t n) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!is_ready_no_lock()) {
+            return 0;
+        }
+        Packet& packet = packets_.front();
+        n = std::min<std::uint32_t>(n, packet.data.size() - position_);
+        if (buffer != nullptr) {
+            packet.data.copy(static_cast<char*>(buffer), n, position_);
+        }
+        position_ += n;
+        if (position_ == packet.data.size()) {
+            packets_.pop_front();
+            position_ = 0;
+        }
+        return n;
+    }
+    void write(const void* buffer, std::uint32_t n) override
+    {
+        written_.append(static_cast<const char*>(buffer), n);
+    }
+    void flush() override { }
+    void shutdownInput() override { }
+    void shutdownOutput() override { }
+    const EventTarget* get_event_target() const override { return &target_; }
+    bool isReady() const override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return is_ready_no_lock();
+    }
+    std::uint32_t getSize() const override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!is_ready_no_lock()) {
+            return 0;
+        }
+        return static_cast<std::uint32_t>(packets_.front().data.size() - position_);
+    }
+
+    std::string written_;
+
+private:
+    struct Packet {
+        std::string data;
+        std::size_t arrived;
+    };
+
+    bool is_ready_no_lock() const
+    {
+        return !packets_.empty() && packets_.front().arrived == packets_.front().data.size();
+    }
+
+    mutable std::mutex mutex_;
+    std::deque<Packet> packets_;
+    std::size_t position_ = 0;
+    EventTarget target_;
+};
+
+std::string keep_alive_echo(std::uint32_t time)
+{
+    std::string message = "CALE";
+    message.push_back(static_cast<char>((time >> 24) & 0xff));
+    message.push_back(static_cast<char>((time >> 16) & 0xff));
+    message.push_back(static_cast<char>((time >> 8) & 0xff));
+    message.push_back(static_cast<char>(time & 0xff));
+    return message;
+}
+
+// the bytes a socket hands to a PacketStreamFilter
+class RawStream : public IStream {
+public:
+    explicit RawStream(std::string data) : data_{std::move(data)} { }
+
+    void close() override { }
+    std::uint32_t read(void* buffer, std::uint32_t n) override
+    {
+        n = std::min<std::uint32_t>(n, data_.size() - position_);
+        data_.copy(static_cast<char*>(buffer), n, position_);
+        position_ += n;
+        return n;
+    }
+    void write(const void*, std::uint32_t) override { }
+    void flush() override { }
+    void shutdownInput() override { }
+    void shutdownOutput() override { }
+    const EventTarget* get_event_target() const override { return &target_; }
+    bool isReady() const override { return position_ != data_.size(); }
+    std::uint32_t getSize() const override
+    {
+        return static_cast<std::uint32_t>(data_.size() - position_);
+    }
+
+private:
+    std::string data_;
+    std::size_t position_ = 0;
+    EventTarget target_;
+};
+
+// the mix of messages a client gets while the mouse and keyboard are used
+std::string client_backlog(std::uint32_t messages)
+{
+    std::string data;
+    auto add_packet = [&data](const std::string& payload) {
+        std::uint32_t size = static_cast<std::uint32_t>(payload.size());
+        data.push_back(static_cast<char>((size >> 24) & 0xff));
+        data.push_back(static_cast<char>((size >> 16) & 0xff));
+        data.push_back(static_cast<char>((size >> 8) & 0xff));
+        data.push_back(static_cast<char>(size & 0xff));
+        data += payload;
+    };
+    for (std::uint32_t i = 0; i < messages; ++i) {
+        switch (i % 4) {
+        case 0:
+            add_packet(std::string("DKDN\0\x61\0\x02\0\x1e", 10));
+            break;
+        case 3:
+            add_packet(keep_alive_echo(i));
+            break;
+        default:
+            add_packet(std::string("DMMV\x01\x00\x02\x00", 8));
+            break;
+        }
+    }
+    return data;
+}
+
+// parses one message of client_backlog(), returns a checksum of its fields
+std::uint32_t parse_message(IStream* stream, const std::uint8_t* code)
+{
+    std::int16_t a = 0, b = 0, c = 0;
+    std::uint32_t time = 0;
+    if (code[1] == 'K') {
+        ProtocolUtil::readf(stream, "%2i%2i%2i", &a, &b, &c);
+    }
+    else if (code[1] == 'M') {
+        ProtocolUtil::readf(stream, "%2i%2i", &a, &b);
+    }
+    else {
+        ProtocolUtil::readf(stream, "%4i", &time);
+    }
+    return static_cast<std::uint32_t>(a + b + c) + time;
+}
+
+// a PacketStreamFilter that received the whole backlog
+class Backlog {
+public:
+    explicit Backlog(std::uint32_t messages)
+    {
+        using ::testing::_;
+        using ::testing::SaveArg;
+
+        IEventQueue::EventHandler handler;
+        ON_CALL(events_, add_handler(EventType::UNKNOWN, _, _))
+            .WillByDefault(SaveArg<2>(&handler));
+        auto raw = std::make_unique<RawStream>(client_backlog(messages));
+        const EventTarget* target = raw->get_event_target();
+        filter_ = std::make_unique<PacketStreamFilter>(&events_, std::move(raw));
+        handler(Event(EventType::STREAM_INPUT_READY, target));
+    }
+
+    PacketStreamFilter* get() { return filter_.get(); }
+
+private:
+    ::testing::NiceMock<MockEventQueue> events_;
+    std::unique_ptr<PacketStreamFilter> filter_;
+};
+
+} // namespace
+
+TEST(FrameStreamTests, waits_for_whole_packet)
+{
+    FakePacketStream stream;
+    stream.add_packet("CNOP", 2);
+    FrameStream frames(&stream);
+
+    EXPECT_FALSE(frames.read_frame());
+    EXPECT_FALSE(frames.isReady());
+
+    stream.arrive();
+    EXPECT_TRUE(frames.isReady());
+    ASSERT_TRUE(frames.read_frame());
+    EXPECT_EQ(frames.get_remaining(), 4u);
+}
+
+TEST(FrameStreamTests, reads_stop_at_end_of_frame)
+{
+    FakePacketStream stream;
+    stream.add_packet("CNOPextra");
+    stream.add_packet("CINN");
+    FrameStream frames(&stream);
+
+    ASSERT_TRUE(frames.read_frame());
+    char code[4];
+    ASSERT_EQ(frames.read(code, 4), 4u);
+    EXPECT_EQ(std::string(code, 4), "CNOP");
+
+    // unread bytes of a message don't leak into the next one
+    ASSERT_TRUE(frames.read_frame());
+    char buffer[16];
+    ASSERT_EQ(frames.read(buffer, sizeof(buffer)), 4u);
+    EXPECT_EQ(std::string(buffer, 4), "CINN");
+    EXPECT_EQ(frames.read(buffer, sizeof(buffer)), 0u);
+    EXPECT_FALSE(frames.read_frame());
+}
+
+TEST(FrameStreamTests, unread_frame_is_read_again)
+{
+    FakePacketStream stream;
+    stream.add_packet("DMMV1234");
+    stream.add_packet("DKDN123456");
+    FrameStream frames(&stream);
+
+    // look at the next message and leave it
+    ASSERT_TRUE(frames.read_frame());
+    char code[4];
+    ASSERT_EQ(frames.read(code, 4), 4u);
+    frames.unread_frame();
+    EXPECT_EQ(frames.get_remaining(), 8u);
+    EXPECT_TRUE(frames.isReady());
+
+    ASSERT_TRUE(frames.read_frame());
+    char buffer[16];
+    ASSERT_EQ(frames.read(buffer, sizeof(buffer)), 8u);
+    EXPECT_EQ(std::string(buffer, 8), "DMMV1234");
+
+    ASSERT_TRUE(frames.read_frame());
+    ASSERT_EQ(frames.read(buffer, sizeof(buffer)), 10u);
+    EXPECT_EQ(std::string(buffer, 10), "DKDN123456");
+
+    // nothing to put back once the stream ran dry
+    EXPECT_FALSE(frames.read_frame());
+    frames.unread_frame();
+    EXPECT_FALSE(frames.read_frame());
+}
+
+TEST(FrameStreamTests, writes_go_to_wrapped_stream)
+{
+    FakePacketStream stream;
+    FrameStream frames(&stream);
+
+    ProtocolUtil::writef(&frames, "CNOP");
+    EXPECT_EQ(stream.written_, "CNOP");
+}
+
+TEST(FrameStreamTests, cpu_per_message)
+{
+    // parse the same backlog off a PacketStreamFilter field by field, the
+    // way ClientProxy1_6 used to, and a whole message at a time
+    const std::uint32_t kMessages = 100000;
+
+    Backlog by_field(kMessages);
+    std::uint32_t sum_by_field = 0;
+    std::uint32_t parsed_by_field = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::uint8_t code[4];
+    while (by_field.get()->read(code, 4) == 4) {
+        sum_by_field += parse_message(by_field.get(), code);
+        ++parsed_by_field;
+    }
+    double by_field_time = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                         start).count();
+
+    Backlog by_frame(kMessages);
+    FrameStream frames(by_frame.get());
+    std::uint32_t sum_by_frame = 0;
+    std::uint32_t parsed_by_frame = 0;
+    start = std::chrono::steady_clock::now();
+    while (frames.read_frame()) {
+        ASSERT_EQ(frames.read(code, 4), 4u);
+        sum_by_frame += parse_message(&frames, code);
+        ++parsed_by_frame;
+    }
+    double by_frame_time = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                         start).count();
+
+    EXPECT_EQ(parsed_by_field, kMessages);
+    EXPECT_EQ(parsed_by_frame, kMessages);
+    EXPECT_EQ(sum_by_field, sum_by_frame);
+    RecordProperty("messages", static_cast<int>(kMessages));
+    RecordProperty("by_field_ns_per_message",
+                   static_cast<int>(by_field_time * 1e9 / kMessages));
+    RecordProperty("by_frame_ns_per_message",
+                   static_cast<int>(by_frame_time * 1e9 / kMessages));
+}
+
+} // namespace inputleap
@@ -21,6 +21,9 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <chrono>
+#include <string>
+#include <vector>
 
 using ::testing::_;
 using ::testing::NiceMock;
@@ -31,6 +34,103 @@ using ::testing::SaveArg;
 
 namespace inputleap {
 
+namespace {
+
+void add_test_key(KeyMap& keyMap, KeyID id, std::int32_t group, KeyButton button,
+                  KeyModifierMask required, KeyModifierMask sensitive)
+{
+    KeyMap::KeyItem item;
+    item.m_id = id;
+    item.m_group = group;
+    item.m_button = button;
+    item.m_required = required;
+    item.m_sensitive = sensitive;
+    item.m_client = button;
+    KeyMap::initModifierKey(item);
+    keyMap.addKeyEntry(item);
+}
+
+// a US like layout with Latin-1 letters on AltGr in group 0 and CJK
+// ideographs in group 1
+void make_test_layout(KeyMap& keyMap)
+{
+    for (std::int32_t group = 0; group < 2; ++group) {
+        add_test_key(keyMap, kKeyShift_L, group, 0x1f0, 0, 0);
+        add_test_key(keyMap, kKeyAltGr, group, 0x1f1, 0, 0);
+    }
+    for (KeyID id = 0x20; id < 0x7f; ++id) {
+        if (id >= 'A' && id <= 'Z') {
+            add_test_key(keyMap, id, 0, id + 0x20, KeyModifierShift, KeyModifierShift);
+        }
+        else {
+            add_test_key(keyMap, id, 0, id, 0, KeyModifierShift);
+        }
+    }
+    for (KeyID id = 0xc0; id < 0x100; ++id) {
+        add_test_key(keyMap, id, 0, id - 0x40, KeyModifierAltGr,
+                     KeyModifierAltGr | KeyModifierShift);
+    }
+    for (KeyID id = 0x4e00; id < 0x4e40; ++id) {
+        add_test_key(keyMap, id, 1, 0x100 + (id - 0x4e00), 0, 0);
+    }
+    keyMap.finish();
+}
+
+bool same_keystrokes(const KeyMap::Keystrokes& a, const KeyMap::Keystrokes& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].m_type != b[i].m_type) {
+            return false;
+        }
+        if (a[i].m_type == KeyMap::Keystroke::kButton) {
+            const KeyMap::Keystroke::Button& x = a[i].m_data.m_button;
+            const KeyMap::Keystroke::Button& y = b[i].m_data.m_button;
+            if (x.m_button != y.m_button || x.m_press != y.m_press ||
+                x.m_repeat != y.m_repeat || x.m_client != y.m_client) {
+                return false;
+            }
+        }
+        else {
+            const KeyMap::Keystroke::Group& x = a[i].m_data.m_group;
+            const KeyMap::Keystroke::Group& y = b[i].m_data.m_group;
+            if (x.m_group != y.m_group || x.m_absolute != y.m_absolute ||
+                x.m_restore != y.m_restore) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// maps each key of text like a client does and returns keys per second
+double map_keys_per_second(const KeyMap& keyMap, const std::vector<KeyID>& text,
+                           std::size_t count)
+{
+    KeyMap::ModifierToKeys activeModifiers;
+    KeyModifierMask currentState = 0;
+    KeyMap::Keystrokes keys;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        KeyID id = text[i % text.size()];
+        KeyModifierMask mask = (id >= 'A' && id <= 'Z') ? KeyModifierShift : 0;
+        keys.clear();
+        keyMap.mapKey(keys, id, 0, activeModifiers, currentState, mask, false);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(count) / elapsed.count();
+}
+
+std::vector<KeyID> to_key_ids(const std::u32string& text)
+{
+    return std::vector<KeyID>(text.begin(), text.end());
+}
+
+} // namespace
+
 TEST(KeyMapTests, findBestKey_requiredDown_matchExactFirstItem)
 {
     KeyMap keyMap;
@@ -215,4 +315,88 @@ TEST(KeyMapTests, isCommand_superMask_returnTrue)
     EXPECT_EQ(true, keyMap.isCommand(mask));
 }
 
+TEST(KeyMapTests, mapKey_compiledMatchesGeneralPath)
+{
+    KeyMap keyMap;
+    make_test_layout(keyMap);
+
+    std::vector<KeyID> ids;
+    for (KeyID id = 0x20; id < 0x100; ++id) {
+        ids.push_back(id);
+    }
+    for (KeyID id = 0x4e00; id < 0x4e48; ++id) {
+        ids.push_back(id);
+    }
+
+    const KeyModifierMask states[] = {
+        0, KeyModifierShift, KeyModifierAltGr, KeyModifierShift | KeyModifierAltGr
+    };
+    for (KeyID id : ids) {
+        for (std::int32_t group = 0; group < 2; ++group) {
+            for (KeyModifierMask state : states) {
+                for (KeyModifierMask mask : { KeyModifierMask(0), KeyModifierShift }) {
+                    for (bool isAutoRepeat : { false, true }) {
+                        KeyMap::Keystrokes compiledKeys, generalKeys;
+                        KeyMap::ModifierToKeys compiledModifiers, generalModifiers;
+                        KeyModifierMask compiledState = state, generalState = state;
+
+                        const KeyMap::KeyItem* compiled = keyMap.mapKey(
+                                    compiledKeys, id, group, compiledModifiers,
+                                    compiledState, mask, isAutoRepeat);
+                        const KeyMap::KeyItem* general = keyMap.mapCharacterKey(
+                                    generalKeys, id, group, generalModifiers,
+                                    generalState, mask, isAutoRepeat);
+
+                        EXPECT_EQ(general, compiled) << std::hex << id;
+                        EXPECT_TRUE(same_keystrokes(generalKeys, compiledKeys)) << std::hex << id;
+                        EXPECT_EQ(generalState, compiledState) << std::hex << id;
+                        EXPECT_EQ(generalModifiers.size(), compiledModifiers.size());
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(KeyMapTests, keystrokes_growPastInlineSize)
+{
+    KeyMap::Keystrokes keys;
+    for (std::uint32_t i = 0; i < 3 * KeyMap::Keystrokes::kInlineSize; ++i) {
+        keys.push_back(KeyMap::Keystroke(static_cast<KeyButton>(i), true, false, i));
+    }
+
+    ASSERT_EQ(3u * KeyMap::Keystrokes::kInlineSize, keys.size());
+    std::uint32_t i = 0;
+    for (const KeyMap::Keystroke& key : keys) {
+        EXPECT_EQ(i++, key.m_data.m_button.m_client);
+    }
+
+    keys.clear();
+    EXPECT_TRUE(keys.empty());
+    keys.push_back(KeyMap::Keystroke(1, false, false));
+    EXPECT_EQ(KeyMap::Keystroke::kGroup, keys.back().m_type);
+}
+
+TEST(KeyMapTests, mapKey_keysPerSecond)
+{
+    KeyMap keyMap;
+    make_test_layout(keyMap);
+
+    const std::size_t count = 100000;
+    double ascii = map_keys_per_second(keyMap,
+                to_key_ids(U"The quick brown fox jumps over the lazy dog 0123456789."), count);
+    double latin1 = map_keys_per_second(keyMap,
+                to_key_ids(U"\u00e0\u00e9\u00ee\u00f5\u00fc\u00e7\u00f1\u00df"), count);
+    double cjk = map_keys_per_second(keyMap,
+                to_key_ids(U"\u4e00\u4e09\u4e0a\u4e0b\u4e2d\u4e8c"), count);
+    RecordProperty("ascii_keys_per_second", static_cast<int>(ascii));
+    RecordProperty("latin1_keys_per_second", static_cast<int>(latin1));
+    RecordProperty("cjk_keys_per_second", static_cast<int>(cjk));
+
+    // generous, text entry tools don't go beyond a few thousand keys a second
+    EXPECT_GT(ascii, 10000.0);
+    EXPECT_GT(latin1, 10000.0);
+    EXPECT_GT(cjk, 10000.0);
+}
+
 }
@@ -22,6 +22,7 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <string>
 
 namespace inputleap {
 
@@ -44,9 +45,37 @@ const inputleap::KeyMap::KeyItem* stubMapKey(inputleap::KeyMap::Keystrokes& keys
                                              KeyModifierMask& currentState,
                                              KeyModifierMask desiredMask, bool isAutoRepeat);
 
+const inputleap::KeyMap::KeyItem* stubMapTypedKey(inputleap::KeyMap::Keystrokes& keys, KeyID id,
+                                                  std::int32_t group,
+                                                  inputleap::KeyMap::ModifierToKeys& activeModifiers,
+                                                  KeyModifierMask& currentState,
+                                                  KeyModifierMask desiredMask, bool isAutoRepeat);
+
+std::size_t typeText(KeyState& keyState, const std::string& text);
+
 inputleap::KeyMap::Keystroke s_stubKeystroke(1, false, false);
 inputleap::KeyMap::KeyItem s_stubKeyItem;
 
+// a platform that injects a batch of key events with one call
+class BatchingKeyState : public MockKeyState {
+public:
+    BatchingKeyState(const MockEventQueue& eventQueue, const MockKeyMap& keyMap) :
+        MockKeyState(eventQueue, keyMap)
+    {
+    }
+
+    std::size_t m_calls = 0;
+    std::size_t m_keystrokes = 0;
+
+protected:
+    void fakeKeyBatch(const Keystroke* keystrokes, std::size_t count) override
+    {
+        (void) keystrokes;
+        ++m_calls;
+        m_keystrokes += count;
+    }
+};
+
 TEST(CKeyStateTests, onKey_aKeyDown_keyStateOne)
 {
     MockKeyMap keyMap;
@@ -402,6 +431,64 @@ TEST(KeyStateTests, isKeyDown_noKeysDown_returnsFalse)
     ASSERT_FALSE(actual);
 }
 
+TEST(KeyStateTests, fakeKeyRepeat_count_fakeKeyCalledForEachRepeat)
+{
+    NiceMock<MockKeyMap> keyMap;
+    MockEventQueue eventQueue;
+    KeyStateImpl keyState(eventQueue, keyMap);
+    ON_CALL(keyMap, mapKey(_, _, _, _, _, _, _)).WillByDefault(Invoke(stubMapTypedKey));
+    keyState.fakeKeyDown('a', 0, 1);
+
+    // a release and a press for each repeat
+    EXPECT_CALL(keyState, fakeKey(_)).Times(6);
+
+    ASSERT_TRUE(keyState.fakeKeyRepeat('a', 0, 3, 1));
+}
+
+TEST(KeyStateTests, fakeKeyRepeat_batchingPlatform_oneBatchForAllRepeats)
+{
+    NiceMock<MockKeyMap> keyMap;
+    MockEventQueue eventQueue;
+    NiceMock<BatchingKeyState> keyState(eventQueue, keyMap);
+    ON_CALL(keyMap, mapKey(_, _, _, _, _, _, _)).WillByDefault(Invoke(stubMapTypedKey));
+    keyState.fakeKeyDown('a', 0, 1);
+
+    EXPECT_CALL(keyState, fakeKey(_)).Times(0);
+
+    ASSERT_TRUE(keyState.fakeKeyRepeat('a', 0, 3, 1));
+    EXPECT_EQ(2u, keyState.m_calls);
+    EXPECT_EQ(7u, keyState.m_keystrokes);
+}
+
+TEST(KeyStateTests, typeText_batchingPlatform_fewerCallsPerCharacter)
+{
+    const std::string text = "The Quick Brown Fox Jumps Over The Lazy Dog";
+
+    NiceMock<MockKeyMap> keyMap;
+    MockEventQueue eventQueue;
+    ON_CALL(keyMap, mapKey(_, _, _, _, _, _, _)).WillByDefault(Invoke(stubMapTypedKey));
+
+    // one injection for each key event
+    KeyStateImpl keyState(eventQueue, keyMap);
+    std::size_t calls = 0;
+    ON_CALL(keyState, fakeKey(_)).WillByDefault(Invoke([&calls](const KeyMap::Keystroke&) {
+        ++calls;
+    }));
+    std::size_t characters = typeText(keyState, text);
+
+    // one injection for each key press or release
+    NiceMock<BatchingKeyState> batchingKeyState(eventQueue, keyMap);
+    typeText(batchingKeyState, text);
+
+    RecordProperty("calls_per_100_characters", static_cast<int>(100 * calls / characters));
+    RecordProperty("batched_calls_per_100_characters",
+                   static_cast<int>(100 * batchingKeyState.m_calls / characters));
+
+    EXPECT_EQ(calls, batchingKeyState.m_keystrokes);
+    EXPECT_EQ(2 * characters, batchingKeyState.m_calls);
+    EXPECT_LT(batchingKeyState.m_calls, calls);
+}
+
 void
 stubPollPressedKeys(IKeyState::KeyButtonSet& pressedKeys)
 {
@@ -433,4 +520,50 @@ const inputleap::KeyMap::KeyItem* stubMapKey(inputleap::KeyMap::Keystrokes& keys
     return &s_stubKeyItem;
 }
 
+// maps like a US layout:  uppercase letters need shift around the key
+const inputleap::KeyMap::KeyItem* stubMapTypedKey(inputleap::KeyMap::Keystrokes& keys, KeyID id,
+                                                  std::int32_t group,
+                                                  inputleap::KeyMap::ModifierToKeys& activeModifiers,
+                                                  KeyModifierMask& currentState,
+                                                  KeyModifierMask desiredMask, bool isAutoRepeat)
+{
+    (void) group;
+    (void) activeModifiers;
+    (void) currentState;
+
+    static inputleap::KeyMap::KeyItem s_item;
+    const KeyButton shift = 0x32;
+    s_item.m_button = static_cast<KeyButton>(id);
+    s_item.m_client = 0;
+
+    bool shifted = (desiredMask & KeyModifierShift) != 0;
+    if (shifted) {
+        keys.push_back(inputleap::KeyMap::Keystroke(shift, true, false, 0));
+    }
+    if (isAutoRepeat) {
+        keys.push_back(inputleap::KeyMap::Keystroke(s_item.m_button, false, true, 0));
+        keys.push_back(inputleap::KeyMap::Keystroke(s_item.m_button, true, true, 0));
+    }
+    else {
+        keys.push_back(inputleap::KeyMap::Keystroke(s_item.m_button, true, false, 0));
+    }
+    if (shifted) {
+        keys.push_back(inputleap::KeyMap::Keystroke(shift, false, false, 0));
+    }
+    return &s_item;
+}
+
+// presses and releases a key for each character of text like a client
+// does.  returns the number of characters.
+std::size_t typeText(KeyState& keyState, const std::string& text)
+{
+    for (char c : text) {
+        KeyID id = static_cast<KeyID>(c);
+        KeyModifierMask mask = (c >= 'A' && c <= 'Z') ? KeyModifierShift : 0;
+        keyState.fakeKeyDown(id, mask, 1);
+        keyState.fakeKeyUp(1);
+    }
+    return text.size();
+}
+
 } // namespace inputleap
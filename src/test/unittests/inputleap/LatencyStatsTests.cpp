@@ -0,0 +1,194 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/LatencyStats.h"
+#include "inputleap/protocol_types.h"
+
+#include <gtest/gtest.h>
+
+namespace inputleap {
+
+TEST(LatencyStatsTests, wire_time_diff_across_wrap)
+{
+    std::uint32_t earlier = 0xffffff00u;
+    std::uint32_t later = earlier + 0x200u;
+    EXPECT_EQ(wire_time_diff(later, earlier), 0x200);
+    EXPECT_EQ(wire_time_diff(earlier, later), -0x200);
+}
+
+TEST(LatencyStatsTests, empty_histogram)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.get_count(), 0u);
+    EXPECT_EQ(histogram.get_percentile(50.0), 0u);
+    EXPECT_EQ(histogram.get_summary().p999, 0u);
+}
+
+TEST(LatencyStatsTests, small_values_are_exact)
+{
+    LatencyHistogram histogram;
+    for (std::uint32_t i = 1; i <= 50; ++i) {
+        histogram.record(i);
+    }
+    EXPECT_EQ(histogram.get_count(), 50u);
+    EXPECT_EQ(histogram.get_percentile(50.0), 25u);
+    EXPECT_EQ(histogram.get_percentile(100.0), 50u);
+    EXPECT_EQ(histogram.get_max(), 50u);
+}
+
+TEST(LatencyStatsTests, relative_error_is_bounded)
+{
+    for (std::uint32_t value : {100u, 1000u, 12345u, 1000000u, 3000000000u}) {
+        LatencyHistogram histogram;
+        histogram.record(value);
+        histogram.record(0xffffffffu);
+
+        std::uint32_t reported = histogram.get_percentile(50.0);
+        EXPECT_GE(reported, value);
+        EXPECT_LE(reported - value, value / 32);
+    }
+}
+
+TEST(LatencyStatsTests, percentiles)
+{
+    LatencyHistogram histogram;
+    for (int i = 0; i < 980; ++i) {
+        histogram.record(1000);
+    }
+    for (int i = 0; i < 19; ++i) {
+        histogram.record(20000);
+    }
+    histogram.record(500000);
+
+    auto summary = histogram.get_summary();
+    EXPECT_EQ(summary.count, 1000u);
+    EXPECT_NEAR(summary.p50, 1000, 1000 / 32);
+    EXPECT_NEAR(summary.p99, 20000, 20000 / 32);
+    EXPECT_NEAR(summary.p999, 20000, 20000 / 32);
+    EXPECT_EQ(summary.max, 500000u);
+    EXPECT_EQ(histogram.get_percentile(100.0), 500000u);
+}
+
+TEST(LatencyStatsTests, record_seconds_clamps)
+{
+    LatencyHistogram histogram;
+    histogram.record_seconds(-0.5);
+    histogram.record_seconds(0.002);
+    EXPECT_EQ(histogram.get_percentile(0.0), 0u);
+    EXPECT_EQ(histogram.get_max(), 2000u);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.get_count(), 0u);
+    EXPECT_EQ(histogram.get_max(), 0u);
+}
+
+TEST(LatencyStatsTests, clock_offset_from_symmetric_round_trip)
+{
+    ClockOffsetEstimator clock;
+    EXPECT_FALSE(clock.is_valid());
+
+    // remote clock is 5s ahead, 2ms each way
+    clock.add_sample(1000000, 6002000, 1004000);
+    ASSERT_TRUE(clock.is_valid());
+    EXPECT_EQ(clock.get_offset(), 5000000);
+    EXPECT_EQ(clock.get_round_trip_time(), 4000u);
+    EXPECT_EQ(clock.to_local(6002000), 1002000u);
+}
+
+TEST(LatencyStatsTests, clock_offset_prefers_fastest_round_trip)
+{
+    ClockOffsetEstimator clock;
+
+    // a round trip delayed on the way back biases the estimate
+    clock.add_sample(0, 5001000, 50000);
+    clock.add_sample(100000, 5101000, 102000);
+    clock.add_sample(200000, 5230000, 240000);
+
+    EXPECT_EQ(clock.get_offset(), 5000000);
+    EXPECT_EQ(clock.get_round_trip_time(), 2000u);
+}
+
+TEST(LatencyStatsTests, clock_offset_across_wrap)
+{
+    ClockOffsetEstimator clock;
+    std::uint32_t sent = 0xfffff000u;
+    clock.add_sample(sent, sent + 1000 - 300, sent + 2000);
+
+    // remote is 300us behind
+    EXPECT_EQ(clock.get_offset(), -300);
+    EXPECT_EQ(clock.to_local(5u), 305u);
+}
+
+TEST(LatencyStatsTests, round_trip_first_sample)
+{
+    RoundTripEstimator rtt;
+    EXPECT_FALSE(rtt.is_valid());
+    EXPECT_EQ(rtt.get_keep_alive_rate(3.0), 3.0);
+
+    rtt.add_sample(0.1);
+    EXPECT_TRUE(rtt.is_valid());
+    EXPECT_DOUBLE_EQ(rtt.get_smoothed(), 0.1);
+    EXPECT_DOUBLE_EQ(rtt.get_variation(), 0.05);
+    EXPECT_DOUBLE_EQ(rtt.get_timeout(), 0.3);
+}
+
+TEST(LatencyStatsTests, round_trip_smoothing)
+{
+    RoundTripEstimator rtt;
+    rtt.add_sample(0.1);
+    rtt.add_sample(0.2);
+
+    EXPECT_DOUBLE_EQ(rtt.get_variation(), 0.75 * 0.05 + 0.25 * 0.1);
+    EXPECT_DOUBLE_EQ(rtt.get_smoothed(), 0.875 * 0.1 + 0.125 * 0.2);
+
+    rtt.reset();
+    EXPECT_FALSE(rtt.is_valid());
+}
+
+TEST(LatencyStatsTests, round_trip_keep_alive_fast_link)
+{
+    RoundTripEstimator rtt;
+    for (int i = 0; i < 20; ++i) {
+        rtt.add_sample(0.001);
+    }
+
+    // a steady wired link notices a dead peer within about two seconds
+    double rate = rtt.get_keep_alive_rate(kKeepAliveRate);
+    EXPECT_EQ(rate, kKeepAliveMinRate);
+    EXPECT_LT(rtt.get_death_timeout(rate), 2.0);
+}
+
+TEST(LatencyStatsTests, round_trip_keep_alive_jittery_link)
+{
+    RoundTripEstimator rtt;
+    for (int i = 0; i < 20; ++i) {
+        rtt.add_sample(i % 2 == 0 ? 0.05 : 0.5);
+    }
+
+    // a jittery link gets more slack than the fixed rate would give it
+    double rate = rtt.get_keep_alive_rate(kKeepAliveRate);
+    EXPECT_EQ(rate, kKeepAliveRate);
+    EXPECT_GT(rtt.get_death_timeout(rate), kKeepAliveRate * kKeepAlivesUntilDeath);
+}
+
+TEST(LatencyStatsTests, round_trip_ignores_negative)
+{
+    RoundTripEstimator rtt;
+    rtt.add_sample(-1.0);
+    EXPECT_FALSE(rtt.is_valid());
+}
+
+} // namespace inputleap
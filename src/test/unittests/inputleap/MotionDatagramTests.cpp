@@ -0,0 +1,306 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/MotionDatagram.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace inputleap {
+
+namespace {
+
+MotionDatagramKey test_key(std::uint8_t seed)
+{
+    MotionDatagramKey key;
+    for (std::size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<std::uint8_t>(seed + i);
+    }
+    return key;
+}
+
+} // namespace
+
+TEST(MotionDatagramTests, encode_motion_roundTrips)
+{
+    MotionDatagram datagram;
+    datagram.flags = MotionDatagram::kAbsolute;
+    datagram.session = 0x12345678;
+    datagram.seq = 42;
+    datagram.x = -5;
+    datagram.y = 1080;
+    datagram.dx_total = -100000;
+    datagram.dy_total = 7;
+
+    std::uint8_t buffer[kMaxMotionDatagramSize];
+    std::size_t size = encode_motion_datagram(datagram, test_key(1), buffer);
+
+    MotionDatagram decoded;
+    ASSERT_TRUE(decode_motion_datagram(buffer, size, test_key(1), decoded));
+    EXPECT_EQ(MotionDatagram::Type::Motion, decoded.type);
+    EXPECT_EQ(MotionDatagram::kAbsolute, decoded.flags);
+    EXPECT_EQ(0x12345678u, decoded.session);
+    EXPECT_EQ(42u, decoded.seq);
+    EXPECT_EQ(-5, decoded.x);
+    EXPECT_EQ(1080, decoded.y);
+    EXPECT_EQ(-100000, decoded.dx_total);
+    EXPECT_EQ(7, decoded.dy_total);
+    EXPECT_EQ(0u, decoded.epoch);
+
+    std::uint32_t session = 0;
+    ASSERT_TRUE(peek_motion_datagram_session(buffer, size, session));
+    EXPECT_EQ(0x12345678u, session);
+}
+
+TEST(MotionDatagramTests, encode_ack_roundTrips)
+{
+    MotionDatagramReceiver receiver;
+    MotionDatagramReceiver::Motion motion;
+    MotionDatagram datagram;
+    datagram.seq = 9;
+    receiver.accept(datagram, motion);
+
+    MotionDatagram ack = receiver.make_ack(3);
+    ack.ack_seq = 17;
+
+    std::uint8_t buffer[kMaxMotionDatagramSize];
+    std::size_t size = encode_motion_datagram(ack, test_key(1), buffer);
+
+    MotionDatagram decoded;
+    ASSERT_TRUE(decode_motion_datagram(buffer, size, test_key(1), decoded));
+    EXPECT_EQ(MotionDatagram::Type::Ack, decoded.type);
+    EXPECT_EQ(3u, decoded.session);
+    EXPECT_EQ(9u, decoded.seq);
+    EXPECT_EQ(1u, decoded.received);
+    EXPECT_EQ(17u, decoded.ack_seq);
+}
+
+TEST(MotionDatagramTests, decode_wrongKey_rejected)
+{
+    MotionDatagram datagram;
+    std::uint8_t buffer[kMaxMotionDatagramSize];
+    std::size_t size = encode_motion_datagram(datagram, test_key(1), buffer);
+
+    MotionDatagram decoded;
+    EXPECT_FALSE(decode_motion_datagram(buffer, size, test_key(2), decoded));
+}
+
+TEST(MotionDatagramTests, decode_tamperedOrTruncated_rejected)
+{
+    MotionDatagram datagram;
+    datagram.x = 10;
+    std::uint8_t buffer[kMaxMotionDatagramSize];
+    std::size_t size = encode_motion_datagram(datagram, test_key(1), buffer);
+
+    MotionDatagram decoded;
+    EXPECT_FALSE(decode_motion_datagram(buffer, size - 1, test_key(1), decoded));
+
+    for (std::size_t i = 0; i < size; ++i) {
+        buffer[i] ^= 0x01;
+        EXPECT_FALSE(decode_motion_datagram(buffer, size, test_key(1), decoded)) << i;
+        buffer[i] ^= 0x01;
+    }
+    EXPECT_TRUE(decode_motion_datagram(buffer, size, test_key(1), decoded));
+}
+
+TEST(MotionDatagramTests, receiver_reordered_staleDiscarded)
+{
+    MotionDatagramSender sender(1);
+    MotionDatagram first = sender.move(10, 10);
+    MotionDatagram second = sender.move(20, 20);
+
+    MotionDatagramReceiver receiver;
+    MotionDatagramReceiver::Motion motion;
+    EXPECT_TRUE(receiver.accept(second, motion));
+    EXPECT_FALSE(receiver.accept(first, motion));
+
+    EXPECT_TRUE(motion.has_absolute);
+    EXPECT_EQ(20, motion.x);
+    EXPECT_EQ(20, motion.y);
+    EXPECT_EQ(1u, receiver.get_received());
+    EXPECT_EQ(1u, receiver.get_stale());
+}
+
+TEST(MotionDatagramTests, receiver_lostRelative_recoveredFromTotals)
+{
+    MotionDatagramSender sender(1);
+    MotionDatagramReceiver receiver;
+
+    MotionDatagramReceiver::Motion motion;
+    receiver.accept(sender.move_relative(3, -4), motion);
+    sender.move_relative(5, 5);     // lost
+    receiver.accept(sender.move_relative(-1, 2), motion);
+
+    EXPECT_FALSE(motion.has_absolute);
+    EXPECT_EQ(7, motion.dx);
+    EXPECT_EQ(3, motion.dy);
+}
+
+TEST(MotionDatagramTests, receiver_syncAfterDatagram_notAppliedTwice)
+{
+    MotionDatagramSender sender(1);
+    MotionDatagramReceiver receiver;
+
+    MotionDatagramReceiver::Motion motion;
+    receiver.accept(sender.move_relative(3, 4), motion);
+
+    MotionDatagram sync;
+    ASSERT_TRUE(sender.take_sync(sync));
+    EXPECT_FALSE(sender.take_sync(sync));
+    EXPECT_FALSE(receiver.accept_sync(sync, motion));
+    EXPECT_EQ(3, motion.dx);
+    EXPECT_EQ(4, motion.dy);
+}
+
+TEST(MotionDatagramTests, receiver_datagramAheadOfStream_heldUntilBarrier)
+{
+    // mouse down goes over the stream, the drag that follows as datagrams
+    MotionDatagramSender sender(1);
+    MotionDatagramReceiver receiver;
+    MotionDatagramReceiver::Motion motion;
+
+    receiver.accept(sender.move(10, 10), motion);
+
+    // the sync goes out ahead of the button down
+    MotionDatagram sync;
+    ASSERT_TRUE(sender.take_sync(sync));
+
+    MotionDatagram barrier;
+    ASSERT_TRUE(sender.take_barrier(barrier));
+    EXPECT_FALSE(sender.take_barrier(barrier));
+    MotionDatagram drag = sender.move(50, 50);
+
+    // the datagram overtakes the button down
+    MotionDatagramReceiver::Motion early;
+    EXPECT_FALSE(receiver.accept(drag, early));
+    EXPECT_FALSE(early.has_absolute);
+    EXPECT_EQ(1u, receiver.get_held());
+
+    // the sync was received as a datagram already, the button down is
+    // applied at 10,10 and then the barrier arrives
+    MotionDatagramReceiver::Motion late;
+    EXPECT_FALSE(receiver.accept_sync(sync, late));
+    EXPECT_TRUE(receiver.accept_sync(barrier, late));
+    EXPECT_TRUE(late.has_absolute);
+    EXPECT_EQ(50, late.x);
+    EXPECT_EQ(50, late.y);
+    EXPECT_EQ(0u, receiver.get_stale());
+}
+
+TEST(MotionDatagramTests, receiver_syncBeforeInput_doesNotReleaseLaterMotion)
+{
+    MotionDatagramSender sender(1);
+    MotionDatagramReceiver receiver;
+    MotionDatagramReceiver::Motion motion;
+
+    MotionDatagram barrier;
+    ASSERT_TRUE(sender.take_barrier(barrier));
+    receiver.accept_sync(barrier, motion);
+    receiver.accept(sender.move(10, 10), motion);
+
+    // button up: motion sync, then the button up, then more motion
+    MotionDatagram sync;
+    ASSERT_TRUE(sender.take_sync(sync));
+    ASSERT_TRUE(sender.take_barrier(barrier));
+    MotionDatagram after = sender.move(90, 90);
+
+    MotionDatagramReceiver::Motion applied;
+    EXPECT_FALSE(receiver.accept(after, applied));
+
+    // the sync ahead of the button up must not apply the later motion
+    EXPECT_FALSE(receiver.accept_sync(sync, applied));
+    EXPECT_FALSE(applied.has_absolute);
+
+    EXPECT_TRUE(receiver.accept_sync(barrier, applied));
+    EXPECT_EQ(90, applied.x);
+}
+
+TEST(MotionDatagramTests, receiver_heldThenSync_appliedInOrder)
+{
+    MotionDatagramSender sender(1);
+    MotionDatagramReceiver receiver;
+    MotionDatagramReceiver::Motion motion;
+
+    MotionDatagram barrier;
+    ASSERT_TRUE(sender.take_barrier(barrier));
+    MotionDatagram first = sender.move(10, 10);
+    sender.move(20, 20);
+    MotionDatagram sync;
+    ASSERT_TRUE(sender.take_sync(sync));
+
+    EXPECT_FALSE(receiver.accept(first, motion));
+    EXPECT_TRUE(receiver.accept_sync(barrier, motion));
+    EXPECT_EQ(10, motion.x);
+    EXPECT_TRUE(receiver.accept_sync(sync, motion));
+    EXPECT_EQ(20, motion.x);
+}
+
+TEST(MotionDatagramTests, is_newer_sequence_wrapsAround)
+{
+    EXPECT_TRUE(is_newer_sequence(2, 1));
+    EXPECT_FALSE(is_newer_sequence(1, 1));
+    EXPECT_FALSE(is_newer_sequence(1, 2));
+    EXPECT_TRUE(is_newer_sequence(0, 0xffffffffu));
+}
+
+TEST(MotionDatagramTests, receiver_lossyReorderingChannel_convergesOnLastMotion)
+{
+    // 20% loss and frequent reordering.  after the sender's final state
+    // is synced over the stream the receiver must have applied exactly the
+    // motion that was sent.
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> delta(-20, 20);
+
+    MotionDatagramSender sender(1);
+    MotionDatagramReceiver receiver;
+    MotionDatagramReceiver::Motion motion;
+    std::vector<MotionDatagram> in_flight;
+    std::int32_t sent_dx = 0, sent_dy = 0;
+    int sent = 0;
+
+    for (int i = 0; i < 10000; ++i) {
+        std::int32_t dx = delta(random);
+        std::int32_t dy = delta(random);
+        sent_dx += dx;
+        sent_dy += dy;
+        MotionDatagram datagram = sender.move_relative(dx, dy);
+        ++sent;
+
+        if (percent(random) < 20) {
+            continue;
+        }
+        in_flight.push_back(datagram);
+        if (in_flight.size() > 1 && percent(random) < 30) {
+            std::swap(in_flight[in_flight.size() - 1], in_flight[in_flight.size() - 2]);
+        }
+        if (in_flight.size() > 2) {
+            receiver.accept(in_flight.front(), motion);
+            in_flight.erase(in_flight.begin());
+        }
+    }
+
+    MotionDatagram sync;
+    ASSERT_TRUE(sender.take_sync(sync));
+    receiver.accept_sync(sync, motion);
+
+    EXPECT_EQ(sent_dx, motion.dx);
+    EXPECT_EQ(sent_dy, motion.dy);
+    EXPECT_LT(receiver.get_received(), static_cast<std::uint32_t>(sent * 85 / 100));
+}
+
+} // namespace inputleap
@@ -0,0 +1,143 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/PacketStreamFilter.h"
+#include "base/DispatchCork.h"
+#include "test/mock/inputleap/MockEventQueue.h"
+#include "test/mock/io/MockStream.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+namespace inputleap {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+// stands in for a TCPSocket: writes are buffered and, like
+// TCPSocket::write(), the first write into an empty buffer wakes the
+// socket multiplexer through the cork.  a wakeup sends the whole buffer.
+struct CountingSocket {
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::uint8_t> sent;
+    std::vector<std::size_t> sends;
+    int writes = 0;
+    int wakeups = 0;
+
+    void write(const void* data, std::uint32_t n)
+    {
+        ++writes;
+        bool was_empty = buffer.empty();
+        auto bytes = static_cast<const std::uint8_t*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + n);
+        if (was_empty) {
+            DispatchCork::defer(this, [this]() { wake(); });
+        }
+    }
+
+    void wake()
+    {
+        ++wakeups;
+        sends.push_back(buffer.size());
+        sent.insert(sent.end(), buffer.begin(), buffer.end());
+        buffer.clear();
+    }
+};
+
+class PacketStreamFilterTests : public ::testing::Test {
+protected:
+    PacketStreamFilterTests()
+    {
+        auto stream = std::make_unique<NiceMock<MockStream>>();
+        ON_CALL(*stream, write(_, _)).WillByDefault(Invoke(&socket_, &CountingSocket::write));
+        filter_ = std::make_unique<PacketStreamFilter>(&events_, std::move(stream));
+    }
+
+    ~PacketStreamFilterTests() override
+    {
+        DispatchCork::cancel(&socket_);
+    }
+
+    // a key press with three modifiers held
+    void write_key_press()
+    {
+        const std::uint8_t message[] = { 'D', 'K', 'D', 'N', 0, 'a', 0, 7, 0, 30 };
+        for (int i = 0; i < 4; ++i) {
+            filter_->write(message, sizeof(message));
+        }
+    }
+
+    CountingSocket socket_;
+    NiceMock<MockEventQueue> events_;
+    std::unique_ptr<PacketStreamFilter> filter_;
+};
+
+} // namespace
+
+TEST_F(PacketStreamFilterTests, small_message_is_one_write)
+{
+    const std::uint8_t message[] = { 'C', 'N', 'O', 'P' };
+    filter_->write(message, sizeof(message));
+
+    EXPECT_EQ(1, socket_.writes);
+    EXPECT_EQ((std::vector<std::uint8_t>{ 0, 0, 0, 4, 'C', 'N', 'O', 'P' }), socket_.sent);
+}
+
+TEST_F(PacketStreamFilterTests, uncorked_writes_wake_per_message)
+{
+    write_key_press();
+
+    // outside a dispatch, e.g. on the file transfer thread
+    EXPECT_EQ(4, socket_.writes);
+    EXPECT_EQ(4, socket_.wakeups);
+    EXPECT_EQ((std::vector<std::size_t>{ 14, 14, 14, 14 }), socket_.sends);
+}
+
+TEST_F(PacketStreamFilterTests, dispatch_sends_messages_together)
+{
+    {
+        DispatchCork cork;
+        write_key_press();
+        EXPECT_EQ(0, socket_.wakeups);
+    }
+
+    // four messages, one wakeup and one send
+    EXPECT_EQ(4, socket_.writes);
+    EXPECT_EQ(1, socket_.wakeups);
+    EXPECT_EQ(std::vector<std::size_t>{ 4 * 14 }, socket_.sends);
+}
+
+TEST_F(PacketStreamFilterTests, large_message_is_sent_once)
+{
+    std::vector<std::uint8_t> message(1000, 'x');
+    {
+        DispatchCork cork;
+        filter_->write(message.data(), static_cast<std::uint32_t>(message.size()));
+    }
+
+    // length and payload are written apart but go out together
+    EXPECT_EQ(2, socket_.writes);
+    EXPECT_EQ(1, socket_.wakeups);
+    EXPECT_EQ(std::vector<std::size_t>{ message.size() + 4 }, socket_.sends);
+}
+
+} // namespace inputleap
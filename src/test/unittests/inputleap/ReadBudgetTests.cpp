@@ -0,0 +1,48 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/ReadBudget.h"
+
+#include <gtest/gtest.h>
+
+namespace inputleap {
+
+TEST(ReadBudgetTests, stops_after_max_messages)
+{
+    ReadBudget budget(4, 1.0);
+    budget.start(0.0);
+
+    EXPECT_TRUE(budget.consume(0.0));
+    EXPECT_TRUE(budget.consume(0.0));
+    EXPECT_TRUE(budget.consume(0.0));
+    EXPECT_FALSE(budget.consume(0.0));
+    EXPECT_EQ(budget.get_count(), 4u);
+
+    budget.start(1.0);
+    EXPECT_TRUE(budget.consume(1.0));
+    EXPECT_EQ(budget.get_count(), 1u);
+}
+
+TEST(ReadBudgetTests, stops_after_max_time)
+{
+    ReadBudget budget(1000, 0.002);
+    budget.start(10.0);
+
+    EXPECT_TRUE(budget.consume(10.001));
+    EXPECT_FALSE(budget.consume(10.002));
+}
+
+} // namespace inputleap
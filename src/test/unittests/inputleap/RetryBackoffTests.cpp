@@ -0,0 +1,66 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inputleap/RetryBackoff.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+namespace inputleap {
+
+TEST(RetryBackoffTests, ceiling_doubles_up_to_maximum)
+{
+    RetryBackoff backoff(1.0, 30.0, 1);
+
+    const double ceilings[] = { 1.0, 2.0, 4.0, 8.0, 16.0, 30.0, 30.0 };
+    for (double ceiling : ceilings) {
+        EXPECT_DOUBLE_EQ(backoff.get_ceiling(), ceiling);
+        double delay = backoff.next();
+        EXPECT_GE(delay, 0.5 * ceiling);
+        EXPECT_LE(delay, ceiling);
+    }
+}
+
+TEST(RetryBackoffTests, reset_starts_over)
+{
+    RetryBackoff backoff(1.0, 30.0, 1);
+    backoff.next();
+    backoff.next();
+    backoff.reset();
+
+    EXPECT_DOUBLE_EQ(backoff.get_ceiling(), 1.0);
+    EXPECT_LE(backoff.next(), 1.0);
+}
+
+TEST(RetryBackoffTests, clients_spread_out)
+{
+    // clients that lost the same server shouldn't retry at the same time
+    const int kClients = 50;
+    double earliest = 1e9;
+    double latest = 0.0;
+    for (int i = 0; i < kClients; ++i) {
+        RetryBackoff backoff(1.0, 30.0, i);
+        for (int retry = 0; retry < 5; ++retry) {
+            backoff.next();
+        }
+        double delay = backoff.next();
+        earliest = std::min(earliest, delay);
+        latest = std::max(latest, delay);
+    }
+    EXPECT_GT(latest - earliest, 4.0);
+}
+
+} // namespace inputleap
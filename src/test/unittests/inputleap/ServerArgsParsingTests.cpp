@@ -67,4 +67,22 @@ TEST(ServerArgsParsingTests, parseServerArgs_configArg_setConfigFile)
     EXPECT_EQ("mock_configFile", serverArgs.m_configFile);
 }
 
+TEST(ServerArgsParsingTests, parseServerArgs_ioThreadsArg_setIoThreads)
+{
+    NiceMock<MockArgParser> argParser;
+    ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(server_stubParseGenericArgs));
+    ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(server_stubCheckUnexpectedArgs));
+    ServerArgs serverArgs;
+    const int argc = 3;
+    const char* kIoThreadsCmd[argc] = { "stub", "--io-threads", "3" };
+
+    EXPECT_TRUE(argParser.parseServerArgs(serverArgs, argc, kIoThreadsCmd));
+    EXPECT_EQ(3u, serverArgs.io_threads);
+
+    ServerArgs badArgs;
+    const char* kBadCmd[argc] = { "stub", "--io-threads", "0" };
+    EXPECT_FALSE(argParser.parseServerArgs(badArgs, argc, kBadCmd));
+    EXPECT_EQ(0u, badArgs.io_threads);
+}
+
 } // namespace inputleap
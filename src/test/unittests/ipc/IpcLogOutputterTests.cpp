@@ -36,9 +36,28 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::AtLeast;
 
+// the log lines of a batch, each followed by a newline
+std::string batchLines(const IpcLogBatchMessage& m)
+{
+    std::string data(m.span(0).data, m.span(0).size);
+    data.append(m.span(1).data, m.span(1).size);
+
+    std::string lines;
+    for (std::size_t i = 0; i + IpcLogRing::kRecordHeaderSize <= data.size(); ) {
+        std::size_t length = 0;
+        for (std::size_t j = 4; j < 8; ++j) {
+            length = (length << 8) | static_cast<unsigned char>(data[i + j]);
+        }
+        i += IpcLogRing::kRecordHeaderSize;
+        lines += data.substr(i, length) + "\n";
+        i += length;
+    }
+    return lines;
+}
+
 MATCHER_P(LogMessageHasString, str, "Match log line string") {
-    const IpcLogLineMessage& m = dynamic_cast<const IpcLogLineMessage&>(arg);
-    return str.compare(m.logLine()) == 0;
+    const IpcLogBatchMessage& m = dynamic_cast<const IpcLogBatchMessage&>(arg);
+    return str.compare(batchLines(m)) == 0;
 }
 
 TEST(IpcLogOutputterTests, write_threadingEnabled_bufferIsSent)
@@ -68,7 +87,7 @@ TEST(IpcLogOutputterTests, write_overBufferMaxSize_firstLineTruncated)
     EXPECT_CALL(mockServer, send(LogMessageHasString(std::string("mock 2\nmock 3\n")), _)).Times(1);
 
     IpcLogOutputter outputter(mockServer, kIpcClientUnknown, false);
-    outputter.bufferMaxSize(2);
+    outputter.bufferMaxSize(2 * (IpcLogRing::kRecordHeaderSize + 6));
 
     // log more lines than the buffer can contain
     outputter.write(kNOTE, "mock 1");
@@ -87,7 +106,7 @@ TEST(IpcLogOutputterTests, write_underBufferMaxSize_allLinesAreSent)
     EXPECT_CALL(mockServer, send(LogMessageHasString(std::string("mock 1\nmock 2\n")), _)).Times(1);
 
     IpcLogOutputter outputter(mockServer, kIpcClientUnknown, false);
-    outputter.bufferMaxSize(2);
+    outputter.bufferMaxSize(2 * (IpcLogRing::kRecordHeaderSize + 6));
 
     // log more lines than the buffer can contain
     outputter.write(kNOTE, "mock 1");
@@ -110,7 +129,7 @@ TEST(IpcLogOutputterTests, write_overBufferRateLimit_lastLineTruncated)
     EXPECT_CALL(mockServer, send(IpcLogLineMessageEq("mock 4\nmock 5\n"), _)).Times(1);
 
     IpcLogOutputter outputter(mockServer, false);
-    outputter.bufferRateLimit(2, 1); // 1s
+    outputter.bufferRateLimit(12, 1); // 2 lines per 1s
 
     // log 1 more line than the buffer can accept in time limit.
     outputter.write(kNOTE, "mock 1");
@@ -143,7 +162,7 @@ TEST(IpcLogOutputterTests, write_underBufferRateLimit_allLinesAreSent)
     EXPECT_CALL(mockServer, send(LogMessageHasString(std::string("mock 3\nmock 4\n")), _)).Times(1);
 
     IpcLogOutputter outputter(mockServer, kIpcClientUnknown, false);
-    outputter.bufferRateLimit(4, 1); // 1s (should be plenty of time)
+    outputter.bufferRateLimit(24, 1); // 4 lines per 1s (should be plenty of time)
 
     // log 1 more line than the buffer can accept in time limit.
     outputter.write(kNOTE, "mock 1");
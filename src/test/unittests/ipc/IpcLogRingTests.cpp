@@ -0,0 +1,150 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ipc/IpcLogRing.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+namespace inputleap {
+
+namespace {
+
+void push(IpcLogRing& ring, std::uint32_t sequence, const char* text, bool expected = true)
+{
+    EXPECT_EQ(expected, ring.push(sequence, text, std::strlen(text)));
+}
+
+// acquires up to max_size bytes and decodes the records as
+// "sequence:text" lines
+std::string acquire(IpcLogRing& ring, std::size_t max_size = 1024)
+{
+    IpcLogRing::Span spans[2];
+    std::size_t size = ring.acquire(max_size, spans);
+    EXPECT_EQ(size, spans[0].size + spans[1].size);
+
+    std::string data(spans[0].data, spans[0].size);
+    data.append(spans[1].data, spans[1].size);
+
+    std::string result;
+    for (std::size_t i = 0; i + IpcLogRing::kRecordHeaderSize <= data.size(); ) {
+        auto read32 = [&](std::size_t offset) {
+            std::uint32_t value = 0;
+            for (std::size_t j = 0; j < 4; ++j) {
+                value = (value << 8) | static_cast<unsigned char>(data[offset + j]);
+            }
+            return value;
+        };
+        std::uint32_t sequence = read32(i);
+        std::uint32_t length = read32(i + 4);
+        i += IpcLogRing::kRecordHeaderSize;
+        result += std::to_string(sequence) + ":" + data.substr(i, length) + "\n";
+        i += length;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(IpcLogRingTests, push_acquire_recordsInOrder)
+{
+    IpcLogRing ring(100);
+    push(ring, 1, "one");
+    push(ring, 2, "two");
+
+    EXPECT_TRUE(ring.has_pending());
+    EXPECT_EQ("1:one\n2:two\n", acquire(ring));
+    EXPECT_FALSE(ring.has_pending());
+
+    ring.release();
+    EXPECT_EQ(0u, ring.size());
+    EXPECT_EQ("", acquire(ring));
+}
+
+TEST(IpcLogRingTests, push_full_oldestEvicted)
+{
+    // room for two records of 4 bytes
+    IpcLogRing ring(2 * (IpcLogRing::kRecordHeaderSize + 4));
+    push(ring, 1, "aaaa");
+    push(ring, 2, "bbbb");
+    push(ring, 3, "cccc");
+
+    EXPECT_EQ(1u, ring.evicted());
+    EXPECT_EQ("2:bbbb\n3:cccc\n", acquire(ring));
+}
+
+TEST(IpcLogRingTests, push_wrapsAround_spansJoined)
+{
+    IpcLogRing ring(30);
+    push(ring, 1, "first");
+    acquire(ring);
+    ring.release();
+
+    // the second record crosses the end of the ring
+    push(ring, 2, "second line");
+
+    IpcLogRing::Span spans[2];
+    std::size_t size = ring.acquire(1024, spans);
+    EXPECT_EQ(IpcLogRing::kRecordHeaderSize + 11, size);
+    EXPECT_NE(0u, spans[1].size);
+    ring.release();
+
+    push(ring, 3, "third");
+    EXPECT_EQ("3:third\n", acquire(ring));
+}
+
+TEST(IpcLogRingTests, push_tooLarge_dropped)
+{
+    IpcLogRing ring(16);
+
+    push(ring, 1, "much too long for the ring", false);
+    EXPECT_EQ(0u, ring.size());
+}
+
+TEST(IpcLogRingTests, push_acquiredRecordsFull_newRecordDropped)
+{
+    IpcLogRing ring(2 * (IpcLogRing::kRecordHeaderSize + 4));
+    push(ring, 1, "aaaa");
+    push(ring, 2, "bbbb");
+
+    IpcLogRing::Span spans[2];
+    ring.acquire(1024, spans);
+    push(ring, 3, "cccc", false);
+    ring.release();
+
+    push(ring, 4, "dddd");
+    EXPECT_EQ("4:dddd\n", acquire(ring));
+}
+
+TEST(IpcLogRingTests, acquire_maxSize_wholeRecords)
+{
+    IpcLogRing ring(100);
+    push(ring, 1, "aaaa");
+    push(ring, 2, "bbbb");
+    push(ring, 3, "cccc");
+
+    // one and a half records
+    EXPECT_EQ("1:aaaa\n", acquire(ring, 18));
+    // at least one record even if it's larger
+    EXPECT_EQ("2:bbbb\n", acquire(ring, 1));
+    EXPECT_EQ("3:cccc\n", acquire(ring));
+    ring.release();
+    EXPECT_EQ(0u, ring.size());
+}
+
+} // namespace inputleap
@@ -0,0 +1,100 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mt/WorkerThread.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace inputleap {
+
+TEST(WorkerThreadTests, runs_jobs_in_order)
+{
+    std::vector<int> order;
+    std::promise<void> done;
+    {
+        WorkerThread worker;
+        for (int i = 0; i < 100; ++i) {
+            worker.post([&order, i]() { order.push_back(i); });
+        }
+        worker.post([&done]() { done.set_value(); });
+        done.get_future().wait();
+    }
+
+    ASSERT_EQ(100u, order.size());
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(WorkerThreadTests, reuses_one_thread)
+{
+    std::vector<std::thread::id> ids;
+    std::promise<void> done;
+    WorkerThread worker;
+    for (int i = 0; i < 10; ++i) {
+        worker.post([&ids]() { ids.push_back(std::this_thread::get_id()); });
+    }
+    worker.post([&done]() { done.set_value(); });
+    done.get_future().wait();
+
+    ASSERT_EQ(10u, ids.size());
+    for (const auto& id : ids) {
+        EXPECT_EQ(ids.front(), id);
+    }
+    EXPECT_NE(std::this_thread::get_id(), ids.front());
+}
+
+TEST(WorkerThreadTests, keeps_running_after_failed_job)
+{
+    std::promise<int> result;
+    WorkerThread worker;
+    worker.post([]() { throw std::runtime_error("failed"); });
+    worker.post([&result]() { result.set_value(1); });
+
+    EXPECT_EQ(1, result.get_future().get());
+}
+
+TEST(WorkerThreadTests, drops_jobs_not_started_when_destroyed)
+{
+    std::promise<void> started;
+    std::promise<void> release;
+    bool dropped_ran = false;
+    std::thread releaser;
+    {
+        WorkerThread worker;
+        std::shared_future<void> released = release.get_future().share();
+        worker.post([&started, released]() { started.set_value(); released.wait(); });
+        worker.post([&dropped_ran]() { dropped_ran = true; });
+        started.get_future().wait();
+        EXPECT_EQ(2u, worker.get_pending());
+
+        // let the running job finish only once the worker is being destroyed
+        releaser = std::thread([&release]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            release.set_value();
+        });
+    }
+    releaser.join();
+
+    EXPECT_FALSE(dropped_ran);
+}
+
+} // namespace inputleap
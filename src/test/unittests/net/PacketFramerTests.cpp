@@ -0,0 +1,93 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "net/PacketFramer.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace inputleap {
+
+namespace {
+
+std::vector<std::uint8_t> make_packet(std::uint32_t size)
+{
+    std::vector<std::uint8_t> packet = {
+        static_cast<std::uint8_t>(size >> 24), static_cast<std::uint8_t>(size >> 16),
+        static_cast<std::uint8_t>(size >> 8), static_cast<std::uint8_t>(size)
+    };
+    packet.resize(4 + size, 'x');
+    return packet;
+}
+
+} // namespace
+
+TEST(PacketFramerTests, whole_packet_is_ready)
+{
+    PacketFramer framer(1024);
+    auto packet = make_packet(10);
+
+    EXPECT_FALSE(framer.has_packet());
+    EXPECT_TRUE(framer.add(packet.data(), packet.size()));
+    EXPECT_TRUE(framer.has_packet());
+
+    framer.consume(packet.size());
+    EXPECT_FALSE(framer.has_packet());
+}
+
+TEST(PacketFramerTests, partial_packet_is_not_ready)
+{
+    PacketFramer framer(1024);
+    auto packet = make_packet(100);
+
+    // split inside the length and inside the payload
+    EXPECT_TRUE(framer.add(packet.data(), 2));
+    EXPECT_FALSE(framer.has_packet());
+    EXPECT_TRUE(framer.add(packet.data() + 2, 50));
+    EXPECT_FALSE(framer.has_packet());
+    EXPECT_TRUE(framer.add(packet.data() + 52, packet.size() - 52));
+    EXPECT_TRUE(framer.has_packet());
+}
+
+TEST(PacketFramerTests, partial_packet_consumed_early)
+{
+    PacketFramer framer(1024);
+    auto first = make_packet(8);
+    auto second = make_packet(8);
+
+    // the reader drains the buffer including the start of the second packet
+    EXPECT_TRUE(framer.add(first.data(), first.size()));
+    EXPECT_TRUE(framer.add(second.data(), 6));
+    framer.consume(first.size() + 6);
+    EXPECT_FALSE(framer.has_packet());
+
+    EXPECT_TRUE(framer.add(second.data() + 6, second.size() - 6));
+    EXPECT_TRUE(framer.has_packet());
+    framer.consume(second.size() - 6);
+    EXPECT_FALSE(framer.has_packet());
+}
+
+TEST(PacketFramerTests, oversize_packet_is_an_error)
+{
+    PacketFramer framer(16);
+    auto packet = make_packet(17);
+
+    EXPECT_FALSE(framer.add(packet.data(), packet.size()));
+    EXPECT_TRUE(framer.has_error());
+    EXPECT_FALSE(framer.has_packet());
+}
+
+} // namespace inputleap
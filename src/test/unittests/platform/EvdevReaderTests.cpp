@@ -0,0 +1,292 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/EvdevReader.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace inputleap {
+
+namespace {
+
+bool add(EvdevReader::FrameBuilder& builder, std::uint16_t type, std::uint16_t code,
+         std::int32_t value, EvdevReader::Frame& frame)
+{
+    input_event event{};
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    return builder.add(event, frame);
+}
+
+// a directory of FIFOs stands in for /dev/input.  the reader can't ask
+// them for their capabilities, so the tests name the devices to read.
+class FakeInputDir {
+public:
+    FakeInputDir()
+    {
+        char path[] = "/tmp/inputleap-input-XXXXXX";
+        if (mkdtemp(path) != nullptr) {
+            path_ = path;
+        }
+    }
+
+    ~FakeInputDir()
+    {
+        for (int fd : writers_) {
+            close(fd);
+        }
+        for (const auto& node : nodes_) {
+            unlink(node.c_str());
+        }
+        rmdir(path_.c_str());
+    }
+
+    std::string node_path(const std::string& name) const { return path_ + "/" + name; }
+
+    void add_node(const std::string& name)
+    {
+        std::string path = node_path(name);
+        ASSERT_EQ(0, mkfifo(path.c_str(), 0600));
+        nodes_.push_back(path);
+    }
+
+    // opens the writing end once the reader has opened the node
+    int plug(const std::string& name)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        for (;;) {
+            int fd = open(node_path(name).c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd >= 0) {
+                writers_.push_back(fd);
+                return fd;
+            }
+            if (errno != ENXIO || std::chrono::steady_clock::now() > deadline) {
+                return -1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void unplug(int fd)
+    {
+        close(fd);
+        writers_.erase(std::remove(writers_.begin(), writers_.end(), fd), writers_.end());
+    }
+
+    static void send(int fd, const std::vector<input_event>& events)
+    {
+        ASSERT_EQ(static_cast<ssize_t>(events.size() * sizeof(input_event)),
+                  write(fd, events.data(), events.size() * sizeof(input_event)));
+    }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    std::vector<std::string> nodes_;
+    std::vector<int> writers_;
+};
+
+input_event make_event(std::uint16_t type, std::uint16_t code, std::int32_t value)
+{
+    input_event event{};
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    return event;
+}
+
+// waits until the reader has queued at least count frames
+std::vector<EvdevReader::Frame> wait_for_frames(EvdevReader& reader, std::size_t count)
+{
+    std::vector<EvdevReader::Frame> frames;
+    std::vector<EvdevReader::Frame> popped;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (frames.size() < count && std::chrono::steady_clock::now() < deadline) {
+        if (reader.pop_frames(popped)) {
+            for (auto& frame : popped) {
+                frames.push_back(std::move(frame));
+            }
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return frames;
+}
+
+} // namespace
+
+TEST(EvdevReaderTests, frame_builder_accumulatesUntilSynReport)
+{
+    EvdevReader::FrameBuilder builder;
+    EvdevReader::Frame frame;
+
+    EXPECT_FALSE(add(builder, EV_REL, REL_X, 3, frame));
+    EXPECT_FALSE(add(builder, EV_REL, REL_Y, -2, frame));
+    EXPECT_FALSE(add(builder, EV_REL, REL_X, 4, frame));
+    EXPECT_FALSE(add(builder, EV_KEY, BTN_LEFT, 1, frame));
+    ASSERT_TRUE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+
+    EXPECT_EQ(frame.dx, 7);
+    EXPECT_EQ(frame.dy, -2);
+    ASSERT_EQ(frame.keys.size(), 1u);
+    EXPECT_EQ(frame.keys[0].code, BTN_LEFT);
+    EXPECT_EQ(frame.keys[0].value, 1);
+
+    // the next frame starts from scratch
+    EXPECT_FALSE(add(builder, EV_REL, REL_Y, 1, frame));
+    ASSERT_TRUE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+    EXPECT_EQ(frame.dx, 0);
+    EXPECT_EQ(frame.dy, 1);
+    EXPECT_TRUE(frame.keys.empty());
+}
+
+TEST(EvdevReaderTests, frame_builder_skipsEmptyFrames)
+{
+    EvdevReader::FrameBuilder builder;
+    EvdevReader::Frame frame;
+
+    EXPECT_FALSE(add(builder, EV_MSC, MSC_SCAN, 30, frame));
+    EXPECT_FALSE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+}
+
+TEST(EvdevReaderTests, frame_builder_wheelNotches)
+{
+    EvdevReader::FrameBuilder builder;
+    EvdevReader::Frame frame;
+
+    add(builder, EV_REL, REL_WHEEL, -1, frame);
+    add(builder, EV_REL, REL_HWHEEL, 2, frame);
+    ASSERT_TRUE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+
+    EXPECT_EQ(frame.wheel_y, -120);
+    EXPECT_EQ(frame.wheel_x, 240);
+}
+
+#ifdef REL_WHEEL_HI_RES
+TEST(EvdevReaderTests, frame_builder_prefersHiResWheel)
+{
+    EvdevReader::FrameBuilder builder;
+    EvdevReader::Frame frame;
+
+    add(builder, EV_REL, REL_WHEEL_HI_RES, 60, frame);
+    ASSERT_TRUE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+    EXPECT_EQ(frame.wheel_y, 60);
+
+    // the plain axis only reports what the high resolution one already did
+    add(builder, EV_REL, REL_WHEEL_HI_RES, 60, frame);
+    add(builder, EV_REL, REL_WHEEL, 1, frame);
+    ASSERT_TRUE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+    EXPECT_EQ(frame.wheel_y, 60);
+}
+#endif
+
+TEST(EvdevReaderTests, frame_builder_discardsDroppedFrames)
+{
+    EvdevReader::FrameBuilder builder;
+    EvdevReader::Frame frame;
+
+    add(builder, EV_REL, REL_X, 5, frame);
+    add(builder, EV_SYN, SYN_DROPPED, 0, frame);
+    add(builder, EV_REL, REL_X, 7, frame);
+    EXPECT_FALSE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+
+    add(builder, EV_REL, REL_X, 2, frame);
+    ASSERT_TRUE(add(builder, EV_SYN, SYN_REPORT, 0, frame));
+    EXPECT_EQ(frame.dx, 2);
+}
+
+TEST(EvdevReaderTests, reader_readsOneFramePerReport)
+{
+    FakeInputDir dir;
+    dir.add_node("event0");
+    EvdevReader reader({ dir.node_path("event0") }, dir.path());
+    int notified = 0;
+    reader.start([&notified]() { ++notified; });
+
+    int fd = dir.plug("event0");
+    ASSERT_GE(fd, 0);
+    FakeInputDir::send(fd, { make_event(EV_REL, REL_X, 3), make_event(EV_REL, REL_Y, 1),
+                             make_event(EV_REL, REL_X, 4), make_event(EV_SYN, SYN_REPORT, 0) });
+
+    auto frames = wait_for_frames(reader, 1);
+    reader.stop();
+
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(7, frames[0].dx);
+    EXPECT_EQ(1, frames[0].dy);
+    EXPECT_GT(frames[0].time, 0.0);
+    EXPECT_EQ(1, notified);
+}
+
+TEST(EvdevReaderTests, reader_picksUpNewDevice)
+{
+    FakeInputDir dir;
+    EvdevReader reader({ dir.node_path("event1") }, dir.path());
+    reader.start([]() {});
+
+    // the node shows up after the reader looked for it
+    dir.add_node("event1");
+    int fd = dir.plug("event1");
+    ASSERT_GE(fd, 0);
+    FakeInputDir::send(fd, { make_event(EV_KEY, KEY_A, 1), make_event(EV_SYN, SYN_REPORT, 0) });
+
+    auto frames = wait_for_frames(reader, 1);
+    reader.stop();
+
+    ASSERT_EQ(1u, frames.size());
+    ASSERT_EQ(1u, frames[0].keys.size());
+    EXPECT_EQ(KEY_A, frames[0].keys[0].code);
+    EXPECT_EQ(1, frames[0].keys[0].value);
+}
+
+TEST(EvdevReaderTests, reader_releasesHeldKeysOfRemovedDevice)
+{
+    FakeInputDir dir;
+    dir.add_node("event0");
+    EvdevReader reader({ dir.node_path("event0") }, dir.path());
+    reader.start([]() {});
+
+    int fd = dir.plug("event0");
+    ASSERT_GE(fd, 0);
+    FakeInputDir::send(fd, { make_event(EV_KEY, KEY_LEFTSHIFT, 1),
+                             make_event(EV_SYN, SYN_REPORT, 0) });
+    ASSERT_EQ(1u, wait_for_frames(reader, 1).size());
+
+    dir.unplug(fd);
+    auto frames = wait_for_frames(reader, 1);
+    reader.stop();
+
+    ASSERT_EQ(1u, frames.size());
+    ASSERT_EQ(1u, frames[0].keys.size());
+    EXPECT_EQ(KEY_LEFTSHIFT, frames[0].keys[0].code);
+    EXPECT_EQ(0, frames[0].keys[0].value);
+}
+
+} // namespace inputleap
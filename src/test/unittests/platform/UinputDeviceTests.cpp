@@ -0,0 +1,134 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/UinputDevice.h"
+#include "inputleap/XScreen.h"
+
+#include <gtest/gtest.h>
+
+#include <linux/input-event-codes.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace inputleap {
+
+namespace {
+
+// a plain file stands in for /dev/uinput.  it can't be configured, but
+// everything the device writes ends up in it.
+class FileUinputDevice : public UinputDevice {
+public:
+    explicit FileUinputDevice(const std::string& path) : UinputDevice(path) {}
+
+    Setup setup;
+
+protected:
+    bool configure(int fd, const Setup& s) override
+    {
+        setup = s;
+        return true;
+    }
+};
+
+class UinputDeviceTests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        char path[] = "/tmp/inputleap-uinput-XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path_ = path;
+    }
+
+    void TearDown() override
+    {
+        std::remove(path_.c_str());
+    }
+
+    std::vector<input_event> read_events() const
+    {
+        std::vector<input_event> events;
+        FILE* file = std::fopen(path_.c_str(), "rb");
+        input_event event;
+        while (std::fread(&event, sizeof(event), 1, file) == 1) {
+            events.push_back(event);
+        }
+        std::fclose(file);
+        return events;
+    }
+
+    std::string path_;
+};
+
+} // namespace
+
+TEST_F(UinputDeviceTests, sync_writesFrameEndingInReport)
+{
+    FileUinputDevice device(path_);
+    device.create({ "test pointer", { BTN_LEFT }, {}, { { ABS_X, 0, 99 } } });
+    EXPECT_EQ("test pointer", device.setup.name);
+
+    device.emit(EV_ABS, ABS_X, 10);
+    device.emit(EV_ABS, ABS_Y, 20);
+    EXPECT_EQ(2u, device.pending());
+    EXPECT_TRUE(read_events().empty());
+
+    device.sync();
+    EXPECT_EQ(0u, device.pending());
+
+    auto events = read_events();
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ(EV_ABS, events[0].type);
+    EXPECT_EQ(ABS_X, events[0].code);
+    EXPECT_EQ(10, events[0].value);
+    EXPECT_EQ(ABS_Y, events[1].code);
+    EXPECT_EQ(20, events[1].value);
+    EXPECT_EQ(EV_SYN, events[2].type);
+    EXPECT_EQ(SYN_REPORT, events[2].code);
+}
+
+TEST_F(UinputDeviceTests, sync_nothingQueued_writesNothing)
+{
+    FileUinputDevice device(path_);
+    device.create({ "test keyboard", { KEY_A }, {}, {} });
+
+    device.sync();
+    device.emit(EV_KEY, KEY_A, 1);
+    device.sync();
+    device.sync();
+
+    EXPECT_EQ(2u, read_events().size());
+}
+
+TEST_F(UinputDeviceTests, create_plainFile_refused)
+{
+    // a file can't take the uinput ioctls
+    UinputDevice device(path_);
+    EXPECT_THROW(device.create({ "test keyboard", { KEY_A }, {}, {} }), XScreenOpenFailure);
+}
+
+TEST_F(UinputDeviceTests, create_missingNode_throws)
+{
+    UinputDevice device(path_ + ".missing");
+    EXPECT_THROW(device.create({ "test keyboard", { KEY_A }, {}, {} }), XScreenOpenFailure);
+}
+
+} // namespace inputleap
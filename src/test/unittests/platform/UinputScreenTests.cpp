@@ -0,0 +1,188 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "platform/UinputScreen.h"
+#include "platform/UinputDevice.h"
+
+#include <gtest/gtest.h>
+
+#include <linux/input-event-codes.h>
+
+#include <memory>
+#include <vector>
+
+namespace inputleap {
+
+struct RecordedEvent {
+    std::uint16_t type;
+    std::uint16_t code;
+    std::int32_t value;
+};
+
+// stands in for /dev/uinput and records every write as one frame
+class RecordingUinputDevice : public UinputDevice {
+public:
+    void create(const Setup& s) override { setup = s; }
+
+    std::vector<std::vector<RecordedEvent>> frames;
+    Setup setup;
+
+protected:
+    void write_events(const input_event* events, std::size_t count) override
+    {
+        std::vector<RecordedEvent> frame;
+        for (std::size_t i = 0; i < count; ++i) {
+            frame.push_back({ events[i].type, events[i].code, events[i].value });
+        }
+        frames.push_back(frame);
+    }
+};
+
+class UinputScreenTests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        auto keyboard = std::make_unique<RecordingUinputDevice>();
+        auto pointer = std::make_unique<RecordingUinputDevice>();
+        keyboard_ = keyboard.get();
+        pointer_ = pointer.get();
+        screen_ = std::make_unique<UinputScreen>(std::move(keyboard), std::move(pointer),
+                                                 1920, 1080, nullptr);
+    }
+
+    static bool contains(const std::vector<RecordedEvent>& frame, std::uint16_t type,
+                         std::uint16_t code, std::int32_t value)
+    {
+        for (const auto& event : frame) {
+            if (event.type == type && event.code == code && event.value == value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool ends_with_sync(const std::vector<RecordedEvent>& frame)
+    {
+        return !frame.empty() && frame.back().type == EV_SYN && frame.back().code == SYN_REPORT;
+    }
+
+    RecordingUinputDevice* keyboard_ = nullptr;
+    RecordingUinputDevice* pointer_ = nullptr;
+    std::unique_ptr<UinputScreen> screen_;
+};
+
+TEST_F(UinputScreenTests, create_pointerAxesCoverShape)
+{
+    ASSERT_EQ(2u, pointer_->setup.abs_axes.size());
+    EXPECT_EQ(ABS_X, pointer_->setup.abs_axes[0].code);
+    EXPECT_EQ(0, pointer_->setup.abs_axes[0].min);
+    EXPECT_EQ(1919, pointer_->setup.abs_axes[0].max);
+    EXPECT_EQ(ABS_Y, pointer_->setup.abs_axes[1].code);
+    EXPECT_EQ(1079, pointer_->setup.abs_axes[1].max);
+    EXPECT_FALSE(keyboard_->setup.keys.empty());
+}
+
+TEST_F(UinputScreenTests, fakeMouseMove_oneFrame)
+{
+    screen_->fakeMouseMove(100, 200);
+
+    ASSERT_EQ(1u, pointer_->frames.size());
+    const auto& frame = pointer_->frames[0];
+    ASSERT_EQ(3u, frame.size());
+    EXPECT_TRUE(contains(frame, EV_ABS, ABS_X, 100));
+    EXPECT_TRUE(contains(frame, EV_ABS, ABS_Y, 200));
+    EXPECT_TRUE(ends_with_sync(frame));
+}
+
+TEST_F(UinputScreenTests, fakeMouseRelativeMove_clampedToShape)
+{
+    screen_->fakeMouseMove(10, 10);
+    screen_->fakeMouseRelativeMove(-50, 5000);
+
+    std::int32_t x, y;
+    screen_->getCursorPos(x, y);
+    EXPECT_EQ(0, x);
+    EXPECT_EQ(1079, y);
+    EXPECT_TRUE(contains(pointer_->frames.back(), EV_ABS, ABS_X, 0));
+    EXPECT_TRUE(contains(pointer_->frames.back(), EV_ABS, ABS_Y, 1079));
+}
+
+TEST_F(UinputScreenTests, fakeMouseWheel_halfNotches_notchSentOnceComplete)
+{
+    screen_->fakeMouseWheel(0, 60);
+    screen_->fakeMouseWheel(0, 60);
+
+    ASSERT_EQ(2u, pointer_->frames.size());
+    EXPECT_FALSE(contains(pointer_->frames[0], EV_REL, REL_WHEEL, 1));
+    EXPECT_TRUE(contains(pointer_->frames[1], EV_REL, REL_WHEEL, 1));
+#ifdef REL_WHEEL_HI_RES
+    EXPECT_TRUE(contains(pointer_->frames[0], EV_REL, REL_WHEEL_HI_RES, 60));
+    EXPECT_TRUE(contains(pointer_->frames[1], EV_REL, REL_WHEEL_HI_RES, 60));
+#endif
+}
+
+TEST_F(UinputScreenTests, fakeMouseButton_pressAndRelease)
+{
+    screen_->fakeMouseButton(kButtonRight, true);
+
+    std::uint32_t button = 0;
+    EXPECT_TRUE(screen_->isAnyMouseButtonDown(button));
+    EXPECT_EQ(kButtonRight, button);
+
+    screen_->fakeMouseButton(kButtonRight, false);
+
+    ASSERT_EQ(2u, pointer_->frames.size());
+    EXPECT_TRUE(contains(pointer_->frames[0], EV_KEY, BTN_RIGHT, 1));
+    EXPECT_TRUE(contains(pointer_->frames[1], EV_KEY, BTN_RIGHT, 0));
+    EXPECT_FALSE(screen_->isAnyMouseButtonDown(button));
+}
+
+TEST_F(UinputScreenTests, fakeKeyDown_shiftedKey_oneFrame)
+{
+    screen_->updateKeyMap();
+    screen_->updateKeyState();
+
+    screen_->fakeKeyDown('A', 0, 30);
+
+    ASSERT_EQ(1u, keyboard_->frames.size());
+    const auto& frame = keyboard_->frames[0];
+    EXPECT_TRUE(contains(frame, EV_KEY, KEY_LEFTSHIFT, 1));
+    EXPECT_TRUE(contains(frame, EV_KEY, KEY_A, 1));
+    EXPECT_TRUE(ends_with_sync(frame));
+}
+
+TEST_F(UinputScreenTests, fakeKeyRepeat_repeatValue)
+{
+    screen_->updateKeyMap();
+    screen_->updateKeyState();
+
+    screen_->fakeKeyDown('x', 0, 45);
+    screen_->fakeKeyRepeat('x', 0, 2, 45);
+
+    ASSERT_EQ(2u, keyboard_->frames.size());
+    const auto& frame = keyboard_->frames[1];
+    std::size_t repeats = 0;
+    for (const auto& event : frame) {
+        if (event.type == EV_KEY) {
+            EXPECT_EQ(KEY_X, event.code);
+            EXPECT_EQ(2, event.value);
+            ++repeats;
+        }
+    }
+    EXPECT_EQ(2u, repeats);
+}
+
+} // namespace inputleap
@@ -0,0 +1,65 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/AcceptLimiter.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+namespace inputleap {
+
+TEST(AcceptLimiterTests, allows_burst_then_rate)
+{
+    AcceptLimiter limiter(4.0, 2.0);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(limiter.try_acquire("10.0.0.1", 100.0));
+    }
+    EXPECT_FALSE(limiter.try_acquire("10.0.0.1", 100.0));
+
+    // two tokens per second come back
+    EXPECT_FALSE(limiter.try_acquire("10.0.0.1", 100.4));
+    EXPECT_TRUE(limiter.try_acquire("10.0.0.1", 100.5));
+    EXPECT_FALSE(limiter.try_acquire("10.0.0.1", 100.5));
+}
+
+TEST(AcceptLimiterTests, sources_are_independent)
+{
+    AcceptLimiter limiter(2.0, 1.0);
+
+    // a flood from one host doesn't lock out another
+    for (int i = 0; i < 100; ++i) {
+        limiter.try_acquire("10.0.0.66", 100.0);
+    }
+    EXPECT_FALSE(limiter.try_acquire("10.0.0.66", 100.0));
+    EXPECT_TRUE(limiter.try_acquire("10.0.0.2", 100.0));
+}
+
+TEST(AcceptLimiterTests, tracked_sources_are_bounded)
+{
+    AcceptLimiter limiter(2.0, 1.0);
+
+    for (std::size_t i = 0; i < 2 * AcceptLimiter::kMaxSources; ++i) {
+        limiter.try_acquire("host" + std::to_string(i), 100.0);
+    }
+    EXPECT_LE(limiter.get_source_count(), AcceptLimiter::kMaxSources);
+
+    // hosts that were quiet long enough are forgotten first
+    limiter.try_acquire("late", 200.0);
+    EXPECT_EQ(limiter.get_source_count(), 1u);
+}
+
+} // namespace inputleap
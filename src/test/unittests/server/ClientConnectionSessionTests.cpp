@@ -0,0 +1,173 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/ClientConnectionSession.h"
+#include "test/mock/server/MockClientConnection.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace inputleap {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::InSequence;
+using ::testing::NiceMock;
+using ::testing::StrictMock;
+
+TEST(ClientConnectionSessionTests, not_started_only_forwards)
+{
+    auto conn = std::make_unique<StrictMock<MockClientConnection>>();
+    EXPECT_CALL(*conn, send_mouse_move_1_6(1, 2));
+
+    ClientConnectionSession session(std::move(conn));
+    session.send_mouse_move_1_6(1, 2);
+
+    EXPECT_EQ(session.get_sent(), 0u);
+    EXPECT_EQ(session.get_kept(), 0u);
+    EXPECT_FALSE(session.can_resume(0));
+}
+
+TEST(ClientConnectionSessionTests, acknowledge_drops_received)
+{
+    ClientConnectionSession session(std::make_unique<NiceMock<MockClientConnection>>());
+    session.start();
+    session.send_key_down_1_6(1, 0, 10);
+    session.send_key_up_1_6(1, 0, 10);
+    session.send_mouse_move_1_6(3, 4);
+
+    EXPECT_EQ(session.get_sent(), 3u);
+    EXPECT_EQ(session.get_kept(), 3u);
+    EXPECT_TRUE(session.can_resume(0));
+    EXPECT_TRUE(session.can_resume(3));
+    EXPECT_FALSE(session.can_resume(4));
+
+    session.acknowledge(2);
+    EXPECT_EQ(session.get_kept(), 1u);
+    EXPECT_FALSE(session.can_resume(1));
+    EXPECT_TRUE(session.can_resume(2));
+
+    // bogus acknowledgments are ignored
+    session.acknowledge(7);
+    EXPECT_EQ(session.get_kept(), 1u);
+}
+
+TEST(ClientConnectionSessionTests, attach_sends_missed_messages)
+{
+    ClientConnectionSession session(std::make_unique<NiceMock<MockClientConnection>>());
+    session.start();
+    session.send_key_down_1_6(1, 0, 10);
+
+    // messages while detached are only kept
+    auto old_conn = session.detach();
+    EXPECT_FALSE(session.is_attached());
+    session.send_keep_alive_1_6();
+    session.send_key_up_1_6(1, 0, 10);
+
+    auto conn = std::make_unique<StrictMock<MockClientConnection>>();
+    {
+        InSequence seq;
+        EXPECT_CALL(*conn, send_key_down_1_6(1, 0, 10));
+        EXPECT_CALL(*conn, send_noop_1_6());
+        EXPECT_CALL(*conn, send_key_up_1_6(1, 0, 10));
+        EXPECT_CALL(*conn, send_mouse_up_1_6(2));
+    }
+
+    ASSERT_TRUE(session.can_resume(0));
+    session.attach(std::move(conn), 0);
+    EXPECT_TRUE(session.is_attached());
+    session.send_mouse_up_1_6(2);
+    EXPECT_EQ(session.get_sent(), 4u);
+}
+
+TEST(ClientConnectionSessionTests, attach_skips_received_messages)
+{
+    ClientConnectionSession session(std::make_unique<NiceMock<MockClientConnection>>());
+    session.start();
+    session.send_mouse_down_1_6(1);
+    session.send_mouse_up_1_6(1);
+    session.detach();
+
+    auto conn = std::make_unique<StrictMock<MockClientConnection>>();
+    EXPECT_CALL(*conn, send_mouse_up_1_6(1));
+
+    session.attach(std::move(conn), 1);
+    EXPECT_EQ(session.get_kept(), 1u);
+}
+
+TEST(ClientConnectionSessionTests, unacknowledged_messages_are_bounded)
+{
+    ClientConnectionSession session(std::make_unique<NiceMock<MockClientConnection>>());
+    session.start();
+    for (int i = 0; i < 10000; ++i) {
+        session.send_mouse_relative_move_1_6(1, 1);
+    }
+
+    EXPECT_EQ(session.get_sent(), 10000u);
+    EXPECT_LT(session.get_kept(), 10000u);
+    EXPECT_FALSE(session.can_resume(0));
+    EXPECT_TRUE(session.can_resume(10000 - static_cast<std::uint32_t>(session.get_kept())));
+}
+
+namespace {
+
+// records mouse moves as their x and drag infos as minus their file count
+std::unique_ptr<NiceMock<MockClientConnection>> make_recording_connection(std::vector<int>& log)
+{
+    auto conn = std::make_unique<NiceMock<MockClientConnection>>();
+    ON_CALL(*conn, send_mouse_move_1_6(_, _))
+        .WillByDefault(Invoke([&log](std::int32_t x, std::int32_t) { log.push_back(x); }));
+    ON_CALL(*conn, send_drag_info_1_6(_, _))
+        .WillByDefault(Invoke([&log](std::uint32_t count, const std::string&)
+                              { log.push_back(-static_cast<int>(count)); }));
+    return conn;
+}
+
+} // namespace
+
+TEST(ClientConnectionSessionTests, sends_from_two_threads_are_counted_in_wire_order)
+{
+    const int kMessages = 2000;
+
+    std::vector<int> written;
+    ClientConnectionSession session(make_recording_connection(written));
+    session.start();
+
+    // input from the event loop while drag info goes out from a worker
+    std::thread worker([&session, kMessages]()
+    {
+        for (int i = 1; i <= kMessages; ++i) {
+            session.send_drag_info_1_6(i, "file");
+        }
+    });
+    for (int i = 1; i <= kMessages; ++i) {
+        session.send_mouse_move_1_6(i, 0);
+    }
+    worker.join();
+
+    ASSERT_EQ(written.size(), 2u * kMessages);
+    EXPECT_EQ(session.get_sent(), 2u * kMessages);
+    EXPECT_EQ(session.get_kept(), 2u * kMessages);
+
+    // a resumed connection gets the messages in the order they were written
+    std::vector<int> resent;
+    session.detach();
+    session.attach(make_recording_connection(resent), 0);
+    EXPECT_EQ(resent, written);
+}
+
+} // namespace inputleap
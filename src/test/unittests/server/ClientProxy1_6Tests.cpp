@@ -0,0 +1,360 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/ClientProxy1_6.h"
+#include "inputleap/Clipboard.h"
+#include "inputleap/ClipboardCache.h"
+#include "inputleap/ProtocolUtil.h"
+#include "inputleap/ReadBudget.h"
+#include "inputleap/option_types.h"
+#include "inputleap/protocol_types.h"
+#include "base/EventTarget.h"
+#include "io/IStream.h"
+#include "test/global/TestEventQueue.h"
+#include "test/mock/server/MockClientConnection.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <deque>
+
+namespace inputleap {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::SaveArg;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+// a connection with messages queued on it, read like a PacketStreamFilter
+// that has them all buffered
+class BacklogStream : public IStream {
+public:
+    explicit BacklogStream(std::uint32_t messages) : remaining_{messages} { }
+
+    void close() override { }
+    std::uint32_t read(void* buffer, std::uint32_t n) override
+    {
+        if (remaining_ == 0) {
+            return 0;
+        }
+        // every message is a whole no-op packet
+        n = std::min<std::uint32_t>(n, 4);
+        if (buffer != nullptr) {
+            std::memcpy(buffer, "CNOP", n);
+        }
+        --remaining_;
+        return n;
+    }
+    void write(const void*, std::uint32_t) override { }
+    void flush() override { }
+    void shutdownInput() override { }
+    void shutdownOutput() override { }
+    const EventTarget* get_event_target() const override { return &target_; }
+    bool isReady() const override { return remaining_ != 0; }
+    std::uint32_t getSize() const override { return remaining_ != 0 ? 4 : 0; }
+
+    std::uint32_t get_remaining() const { return remaining_; }
+
+private:
+    std::uint32_t remaining_;
+    EventTarget target_;
+};
+
+// what the client sent, read like a PacketStreamFilter.  each write is
+// one message from the client, so ProtocolUtil::writef() queues one.
+class MessageStream : public IStream {
+public:
+    void close() override { }
+    std::uint32_t read(void* buffer, std::uint32_t n) override
+    {
+        if (messages_.empty()) {
+            return 0;
+        }
+        std::string& message = messages_.front();
+        n = std::min<std::uint32_t>(n, static_cast<std::uint32_t>(message.size()));
+        if (buffer != nullptr) {
+            std::memcpy(buffer, message.data(), n);
+        }
+        message.erase(0, n);
+        if (message.empty()) {
+            messages_.pop_front();
+        }
+        return n;
+    }
+    void write(const void* buffer, std::uint32_t n) override
+    {
+        messages_.emplace_back(static_cast<const char*>(buffer), n);
+    }
+    void flush() override { }
+    void shutdownInput() override { }
+    void shutdownOutput() override { }
+    const EventTarget* get_event_target() const override { return &target_; }
+    bool isReady() const override { return !messages_.empty(); }
+    std::uint32_t getSize() const override
+    {
+        return messages_.empty() ? 0 : static_cast<std::uint32_t>(messages_.front().size());
+    }
+
+private:
+    std::deque<std::string> messages_;
+    EventTarget target_;
+};
+
+// a proxy for a client that is past the handshake, on a started queue
+class ProxyFixture {
+public:
+    ProxyFixture()
+    {
+        events.raiseQuitEvent();
+        events.loop();
+
+        auto owned = std::make_unique<NiceMock<MockClientConnection>>();
+        conn = owned.get();
+        ON_CALL(*conn, get_stream()).WillByDefault(Return(&stream));
+        ON_CALL(*conn, get_event_target()).WillByDefault(Return(stream.get_event_target()));
+        proxy = std::make_unique<ClientProxy1_6>("client", std::move(owned), nullptr, &events);
+
+        ProtocolUtil::writef(&stream, kMsgDInfo, 0, 0, 1920, 1080, 0, 0, 0);
+        dispatch();
+    }
+
+    ~ProxyFixture()
+    {
+        proxy.reset();
+    }
+
+    // offer protocol features and have the client take all of them
+    void agree_features(std::uint32_t features)
+    {
+        proxy->setOptions({ kOptionProtocolFeatures, features });
+        ProtocolUtil::writef(&stream, kMsgCFeatures, features);
+        dispatch();
+    }
+
+    // handle what the client sent and everything that follows from it
+    void dispatch()
+    {
+        events.add_event(EventType::STREAM_INPUT_READY, stream.get_event_target());
+        Event event;
+        while (events.getEvent(event, 0.0)) {
+            events.dispatchEvent(event);
+            Event::deleteData(event);
+        }
+    }
+
+    TestEventQueue events;
+    MessageStream stream;
+    NiceMock<MockClientConnection>* conn = nullptr;
+    std::unique_ptr<ClientProxy1_6> proxy;
+};
+
+void fill_clipboard(Clipboard& clipboard, char c, std::size_t size)
+{
+    clipboard.open(0);
+    clipboard.clear();
+    clipboard.add(IClipboard::kText, std::string(size, c));
+    clipboard.close();
+}
+
+} // namespace
+
+TEST(ClientProxy1_6Tests, backlog_does_not_starve_other_targets)
+{
+    const std::uint32_t kBacklog = 10000;
+
+    // start the queue, events are then dispatched one at a time below
+    TestEventQueue events;
+    events.raiseQuitEvent();
+    events.loop();
+
+    BacklogStream stream(kBacklog);
+    auto conn = std::make_unique<NiceMock<MockClientConnection>>();
+    ON_CALL(*conn, get_stream()).WillByDefault(Return(&stream));
+    ON_CALL(*conn, get_event_target()).WillByDefault(Return(stream.get_event_target()));
+    ClientProxy1_6 proxy("client", std::move(conn), nullptr, &events);
+
+    // another screen's event arrives right after the backlog
+    EventTarget other;
+    std::uint32_t handled_before_other = 0;
+    bool other_dispatched = false;
+    events.add_handler(EventType::STREAM_INPUT_READY, &other, [&](const auto&) {
+        handled_before_other = kBacklog - stream.get_remaining();
+        other_dispatched = true;
+    });
+    events.add_event(EventType::STREAM_INPUT_READY, stream.get_event_target());
+    events.add_event(EventType::STREAM_INPUT_READY, &other);
+
+    // run the queue until the backlog has been read, counting the slices
+    std::uint32_t slices = 0;
+    Event event;
+    while (events.getEvent(event, 0.0)) {
+        if (event.getTarget() == stream.get_event_target()) {
+            ++slices;
+        }
+        events.dispatchEvent(event);
+        Event::deleteData(event);
+    }
+
+    EXPECT_EQ(stream.get_remaining(), 0u);
+    ASSERT_TRUE(other_dispatched);
+
+    // the other event waited for one slice of the backlog, not all of it
+    EXPECT_GT(handled_before_other, 0u);
+    EXPECT_LE(handled_before_other, ReadBudget::kDefaultMaxMessages);
+    EXPECT_GE(slices, kBacklog / ReadBudget::kDefaultMaxMessages);
+    RecordProperty("backlog_messages", static_cast<int>(kBacklog));
+    RecordProperty("messages_before_other_target", static_cast<int>(handled_before_other));
+    RecordProperty("slices", static_cast<int>(slices));
+}
+
+TEST(ClientProxy1_6Tests, offers_known_clipboard_by_hash)
+{
+    ProxyFixture fixture;
+    fixture.agree_features(kProtocolFeatureClipboardCache);
+
+    std::size_t chunks = 0;
+    ON_CALL(*fixture.conn, send_clipboard_chunk_1_6(_)).WillByDefault([&](const auto&) {
+        ++chunks;
+    });
+
+    Clipboard first;
+    fill_clipboard(first, 'a', ClipboardCache::kMinSize * 2);
+    ClipboardCache::Hash first_hash = ClipboardCache::hash(first.marshall());
+
+    // the first time the data goes out
+    fixture.proxy->setClipboard(kClipboardClipboard, &first);
+    fixture.dispatch();
+    EXPECT_GT(chunks, 0u);
+
+    // the second time only its hash
+    chunks = 0;
+    EXPECT_CALL(*fixture.conn, send_clipboard_cached_1_6(kClipboardClipboard, 0, first_hash));
+    fixture.proxy->setClipboardDirty(kClipboardClipboard, true);
+    fixture.proxy->setClipboard(kClipboardClipboard, &first);
+    fixture.dispatch();
+    EXPECT_EQ(chunks, 0u);
+
+    // a miss gets the data
+    ProtocolUtil::writef(&fixture.stream, kMsgCClipboardMiss, kClipboardClipboard, &first_hash);
+    fixture.dispatch();
+    EXPECT_GT(chunks, 0u);
+
+    // a miss for content that was replaced since is ignored
+    Clipboard second;
+    fill_clipboard(second, 'b', ClipboardCache::kMinSize * 2);
+    fixture.proxy->setClipboardDirty(kClipboardClipboard, true);
+    fixture.proxy->setClipboard(kClipboardClipboard, &second);
+    fixture.dispatch();
+    chunks = 0;
+    ProtocolUtil::writef(&fixture.stream, kMsgCClipboardMiss, kClipboardClipboard, &first_hash);
+    fixture.dispatch();
+    EXPECT_EQ(chunks, 0u);
+}
+
+TEST(ClientProxy1_6Tests, lazy_clipboard_is_sent_when_queried)
+{
+    ProxyFixture fixture;
+    fixture.agree_features(kProtocolFeatureLazyClipboard);
+
+    std::size_t chunks = 0;
+    ON_CALL(*fixture.conn, send_clipboard_chunk_1_6(_)).WillByDefault([&](const auto&) {
+        ++chunks;
+    });
+
+    Clipboard clipboard;
+    fill_clipboard(clipboard, 'a', kLazyClipboardMinSize);
+
+    // only the formats go out on entering the screen
+    std::uint32_t seq = 0;
+    std::vector<std::uint32_t> described;
+    EXPECT_CALL(*fixture.conn, send_clipboard_formats_1_6(kClipboardClipboard, _, _))
+            .WillOnce(DoAll(SaveArg<1>(&seq), SaveArg<2>(&described)));
+    fixture.proxy->setClipboard(kClipboardClipboard, &clipboard);
+    fixture.dispatch();
+    EXPECT_EQ(chunks, 0u);
+    EXPECT_EQ(described, IClipboard::describe(&clipboard));
+
+    // the data once the client pastes
+    ProtocolUtil::writef(&fixture.stream, kMsgQClipboard, kClipboardClipboard, seq);
+    fixture.dispatch();
+    EXPECT_GT(chunks, 0u);
+
+    // and only once
+    chunks = 0;
+    ProtocolUtil::writef(&fixture.stream, kMsgQClipboard, kClipboardClipboard, seq);
+    fixture.dispatch();
+    EXPECT_EQ(chunks, 0u);
+}
+
+TEST(ClientProxy1_6Tests, lazy_clipboard_ignores_stale_query)
+{
+    ProxyFixture fixture;
+    fixture.agree_features(kProtocolFeatureLazyClipboard);
+
+    std::size_t chunks = 0;
+    ON_CALL(*fixture.conn, send_clipboard_chunk_1_6(_)).WillByDefault([&](const auto&) {
+        ++chunks;
+    });
+
+    std::uint32_t first_seq = 0;
+    std::uint32_t second_seq = 0;
+    EXPECT_CALL(*fixture.conn, send_clipboard_formats_1_6(kClipboardClipboard, _, _))
+            .WillOnce(SaveArg<1>(&first_seq))
+            .WillOnce(SaveArg<1>(&second_seq));
+
+    Clipboard first;
+    fill_clipboard(first, 'a', kLazyClipboardMinSize);
+    fixture.proxy->setClipboard(kClipboardClipboard, &first);
+
+    // the clipboard changes before the client asks for the first one
+    Clipboard second;
+    fill_clipboard(second, 'b', kLazyClipboardMinSize);
+    fixture.proxy->setClipboardDirty(kClipboardClipboard, true);
+    fixture.proxy->setClipboard(kClipboardClipboard, &second);
+    fixture.dispatch();
+    EXPECT_NE(first_seq, second_seq);
+
+    ProtocolUtil::writef(&fixture.stream, kMsgQClipboard, kClipboardClipboard, first_seq);
+    fixture.dispatch();
+    EXPECT_EQ(chunks, 0u);
+
+    ProtocolUtil::writef(&fixture.stream, kMsgQClipboard, kClipboardClipboard, second_seq);
+    fixture.dispatch();
+    EXPECT_GT(chunks, 0u);
+}
+
+TEST(ClientProxy1_6Tests, small_clipboard_is_sent_eagerly)
+{
+    ProxyFixture fixture;
+    fixture.agree_features(kProtocolFeatureLazyClipboard);
+
+    std::size_t chunks = 0;
+    ON_CALL(*fixture.conn, send_clipboard_chunk_1_6(_)).WillByDefault([&](const auto&) {
+        ++chunks;
+    });
+    EXPECT_CALL(*fixture.conn, send_clipboard_formats_1_6(_, _, _)).Times(0);
+
+    Clipboard clipboard;
+    fill_clipboard(clipboard, 'a', 16);
+    fixture.proxy->setClipboard(kClipboardClipboard, &clipboard);
+    fixture.dispatch();
+    EXPECT_GT(chunks, 0u);
+}
+
+} // namespace inputleap
@@ -0,0 +1,193 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/ConfigDiff.h"
+#include "server/Config.h"
+#include "server/InputFilter.h"
+#include "inputleap/option_types.h"
+#include "inputleap/protocol_types.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+
+namespace inputleap {
+
+namespace {
+
+std::string grid_name(int x, int y)
+{
+    return "screen" + std::to_string(x) + "x" + std::to_string(y);
+}
+
+// screens in a size by size grid, each linked to its neighbors
+void make_grid(Config& config, int size)
+{
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            config.addScreen(grid_name(x, y));
+        }
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            std::string name = grid_name(x, y);
+            if (x > 0) {
+                config.connect(name, kLeft, 0.0f, 1.0f, grid_name(x - 1, y), 0.0f, 1.0f);
+            }
+            if (x + 1 < size) {
+                config.connect(name, kRight, 0.0f, 1.0f, grid_name(x + 1, y), 0.0f, 1.0f);
+            }
+            if (y > 0) {
+                config.connect(name, kTop, 0.0f, 1.0f, grid_name(x, y - 1), 0.0f, 1.0f);
+            }
+            if (y + 1 < size) {
+                config.connect(name, kBottom, 0.0f, 1.0f, grid_name(x, y + 1), 0.0f, 1.0f);
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(ConfigDiffTests, same_config_is_empty)
+{
+    Config from, to;
+    make_grid(from, 3);
+    make_grid(to, 3);
+
+    ConfigDiff diff = ConfigDiff::compute(from, to);
+
+    EXPECT_TRUE(diff.empty());
+}
+
+TEST(ConfigDiffTests, added_and_removed_screens)
+{
+    Config from, to;
+    from.addScreen("server");
+    from.addScreen("old");
+    to.addScreen("server");
+    to.addScreen("new");
+
+    ConfigDiff diff = ConfigDiff::compute(from, to);
+
+    EXPECT_EQ(ConfigDiff::ScreenSet{"old"}, diff.removed_screens);
+    EXPECT_EQ(ConfigDiff::ScreenSet{"new"}, diff.added_screens);
+    EXPECT_TRUE(diff.changed_links.empty());
+}
+
+TEST(ConfigDiffTests, changed_link_only_affects_source)
+{
+    Config from, to;
+    make_grid(from, 3);
+    make_grid(to, 3);
+    to.disconnect(grid_name(1, 1), kRight);
+    to.connect(grid_name(1, 1), kRight, 0.0f, 1.0f, grid_name(2, 0), 0.0f, 1.0f);
+
+    ConfigDiff diff = ConfigDiff::compute(from, to);
+
+    EXPECT_EQ(ConfigDiff::ScreenSet{grid_name(1, 1)}, diff.changed_links);
+    EXPECT_TRUE(diff.removed_screens.empty());
+    EXPECT_TRUE(diff.changed_options.empty());
+}
+
+TEST(ConfigDiffTests, changed_options)
+{
+    Config from, to;
+    from.addScreen("server");
+    from.addScreen("client");
+    to.addScreen("server");
+    to.addScreen("client");
+    to.addOption("client", kOptionHeartbeat, 1000);
+
+    ConfigDiff diff = ConfigDiff::compute(from, to);
+    EXPECT_EQ(ConfigDiff::ScreenSet{"client"}, diff.changed_options);
+    EXPECT_FALSE(diff.global_options_changed);
+
+    to.addOption("", kOptionScreenSwitchDelay, 250);
+    diff = ConfigDiff::compute(from, to);
+    EXPECT_TRUE(diff.global_options_changed);
+}
+
+TEST(ConfigDiffTests, changed_aliases)
+{
+    Config from, to;
+    from.addScreen("client");
+    to.addScreen("client");
+    to.addAlias("client", "laptop");
+
+    ConfigDiff diff = ConfigDiff::compute(from, to);
+
+    EXPECT_TRUE(diff.aliases_changed);
+    EXPECT_TRUE(diff.removed_screens.empty());
+    EXPECT_TRUE(diff.added_screens.empty());
+}
+
+TEST(ConfigDiffTests, renamed_screen_case)
+{
+    Config from, to;
+    from.addScreen("client");
+    to.addScreen("Client");
+
+    ConfigDiff diff = ConfigDiff::compute(from, to);
+
+    EXPECT_FALSE(diff.empty());
+    EXPECT_EQ(ConfigDiff::ScreenSet{"Client"}, diff.renamed_screens);
+    EXPECT_EQ("Client", *diff.renamed_screens.begin());
+    EXPECT_TRUE(diff.removed_screens.empty());
+    EXPECT_TRUE(diff.added_screens.empty());
+}
+
+TEST(ConfigDiffTests, large_config_is_fast)
+{
+    const int size = 32;
+    Config from, to;
+    make_grid(from, size);
+    make_grid(to, size);
+    to.disconnect(grid_name(5, 7), kBottom);
+    to.addOption(grid_name(20, 20), kOptionHeartbeat, 1000);
+
+    auto start = std::chrono::steady_clock::now();
+    ConfigDiff diff = ConfigDiff::compute(from, to);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    RecordProperty("screens", size * size);
+    RecordProperty("diff_us", static_cast<int>(elapsed));
+
+    EXPECT_EQ(ConfigDiff::ScreenSet{grid_name(5, 7)}, diff.changed_links);
+    EXPECT_EQ(ConfigDiff::ScreenSet{grid_name(20, 20)}, diff.changed_options);
+    EXPECT_TRUE(diff.removed_screens.empty());
+    // generous, a diff of a thousand screens takes a few milliseconds
+    EXPECT_LT(elapsed, 1000000);
+}
+
+TEST(ConfigDiffTests, update_rules_keeps_unchanged_rules)
+{
+    InputFilter filter(nullptr);
+    InputFilter::Rule f1(new InputFilter::KeystrokeCondition(kKeyF1, 0));
+    InputFilter::Rule f2(new InputFilter::KeystrokeCondition(kKeyF2, 0));
+    InputFilter::Rule f3(new InputFilter::KeystrokeCondition(kKeyF3, 0));
+
+    EXPECT_EQ(2u, filter.update_rules({f1, f2}));
+    const InputFilter::Condition* kept = filter.get_rules()[1].getCondition();
+
+    EXPECT_EQ(2u, filter.update_rules({f2, f3}));
+    ASSERT_EQ(2u, filter.get_rules().size());
+    EXPECT_EQ(kept, filter.get_rules()[0].getCondition());
+    EXPECT_EQ(f3.format(), filter.get_rules()[1].format());
+
+    EXPECT_EQ(0u, filter.update_rules({f2, f3}));
+}
+
+} // namespace inputleap
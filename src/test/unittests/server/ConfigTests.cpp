@@ -0,0 +1,148 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/Config.h"
+#include "inputleap/option_types.h"
+#include "inputleap/protocol_types.h"
+
+#include <chrono>
+#include <sstream>
+#include <gtest/gtest.h>
+
+namespace inputleap {
+
+namespace {
+
+std::string grid_name(int x, int y)
+{
+    return "screen" + std::to_string(x) + "x" + std::to_string(y);
+}
+
+// the text of a configuration with a size by size grid of screens, each
+// with an alias, some options and a hotkey to switch to it
+std::string make_grid_text(int size)
+{
+    std::ostringstream s;
+    s << "section: screens\n";
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            s << "\t" << grid_name(x, y) << ":\n"
+              << "\t\thalfDuplexCapsLock = false\n"
+              << "\t\tswitchCornerSize = 4\n";
+        }
+    }
+    s << "end\n";
+
+    s << "section: aliases\n";
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            s << "\t" << grid_name(x, y) << ":\n"
+              << "\t\talias" << x << "x" << y << ".example.com\n";
+        }
+    }
+    s << "end\n";
+
+    s << "section: links\n";
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            s << "\t" << grid_name(x, y) << ":\n";
+            if (x > 0) {
+                s << "\t\tleft = " << grid_name(x - 1, y) << "\n";
+            }
+            if (x + 1 < size) {
+                s << "\t\tright(0,50) = " << grid_name(x + 1, y) << "(50,100)\n";
+            }
+            if (y > 0) {
+                s << "\t\tup = " << grid_name(x, y - 1) << "\n";
+            }
+            if (y + 1 < size) {
+                s << "\t\tdown = " << grid_name(x, y + 1) << "\n";
+            }
+        }
+    }
+    s << "end\n";
+
+    s << "section: options\n"
+      << "\theartbeat = 5000   # comment\n"
+      << "\tswitchDelay = 250\n";
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            s << "\tkeystroke(Control+Alt+" << static_cast<char>('a' + x % 26)
+              << ") = switchToScreen(" << grid_name(x, y) << ")\n";
+        }
+    }
+    s << "end\n";
+    return s.str();
+}
+
+} // namespace
+
+TEST(ConfigTests, read_strips_whitespace_and_comments)
+{
+    std::istringstream text("# leading comment\n"
+                            "section: screens   \r\n"
+                            "  \t server: # trailing comment\n"
+                            "\t\tshift = alt\n"
+                            "end\n");
+    Config config;
+    text >> config;
+
+    EXPECT_TRUE(config.isScreen("server"));
+    EXPECT_TRUE(config.isScreen("SERVER"));
+    const Config::ScreenOptions* options = config.getOptions("server");
+    ASSERT_NE(nullptr, options);
+    EXPECT_EQ(1u, options->count(kOptionModifierMapForShift));
+}
+
+TEST(ConfigTests, read_rejects_invalid_character)
+{
+    std::istringstream text("section: screens\n\tser\x01ver:\nend\n");
+    Config config;
+    EXPECT_THROW(text >> config, XConfigRead);
+}
+
+TEST(ConfigTests, read_large_config)
+{
+    const int size = 32;
+    std::string text = make_grid_text(size);
+
+    auto start = std::chrono::steady_clock::now();
+    std::istringstream stream(text);
+    Config config;
+    stream >> config;
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    RecordProperty("screens", size * size);
+    RecordProperty("bytes", static_cast<int>(text.size()));
+    RecordProperty("read_us", static_cast<int>(elapsed));
+
+    EXPECT_TRUE(config.isCanonicalName(grid_name(31, 31)));
+    EXPECT_EQ(grid_name(3, 4), config.getCanonicalName("ALIAS3x4.example.com"));
+    EXPECT_EQ(grid_name(6, 5), config.getNeighbor(grid_name(5, 5), kRight, 0.25f, nullptr));
+    EXPECT_EQ(grid_name(5, 4), config.getNeighbor(grid_name(5, 5), kTop, 0.5f, nullptr));
+
+    // written and read back the configuration must be the same
+    std::stringstream copy_text;
+    copy_text << config;
+    Config copy;
+    copy_text >> copy;
+    EXPECT_EQ(config, copy);
+
+    // generous, reading a thousand screens takes a few tens of milliseconds
+    EXPECT_LT(elapsed, 5000000);
+}
+
+} // namespace inputleap
@@ -0,0 +1,86 @@
+/*  InputLeap -- mouse and keyboard sharing utility
+    Copyright (C) InputLeap contributors
+
+    This package is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    found in the file LICENSE that should have accompanied this file.
+
+    This package is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/ScreenNameTable.h"
+
+#include <gtest/gtest.h>
+
+namespace inputleap {
+
+TEST(ScreenNameTableTests, intern_returns_same_id_ignoring_case)
+{
+    ScreenNameTable names;
+    ScreenId server = names.intern("Server");
+    ScreenId laptop = names.intern("laptop");
+
+    EXPECT_NE(server, laptop);
+    EXPECT_EQ(server, names.intern("SERVER"));
+    EXPECT_EQ(laptop, names.find("Laptop"));
+    EXPECT_EQ(2u, names.size());
+}
+
+TEST(ScreenNameTableTests, keeps_last_spelling)
+{
+    // a configuration that only changes the case of a name renames it
+    ScreenNameTable names;
+    ScreenId id = names.intern("Server");
+    EXPECT_EQ(id, names.intern("server"));
+
+    EXPECT_EQ("server", names.name(id));
+    EXPECT_EQ(id, names.find("SERVER"));
+    EXPECT_EQ(1u, names.size());
+}
+
+TEST(ScreenNameTableTests, unknown_and_empty_names)
+{
+    ScreenNameTable names;
+    names.intern("server");
+
+    EXPECT_EQ(kInvalidScreenId, names.find("laptop"));
+    EXPECT_EQ(kInvalidScreenId, names.intern(""));
+    EXPECT_EQ("", names.name(kInvalidScreenId));
+    EXPECT_EQ("", names.name(1));
+}
+
+TEST(ScreenNameTableTests, ids_are_stable)
+{
+    ScreenNameTable names;
+    std::vector<ScreenId> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back(names.intern("screen" + std::to_string(i)));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(ids[i], names.find("SCREEN" + std::to_string(i)));
+        EXPECT_EQ("screen" + std::to_string(i), names.name(ids[i]));
+    }
+}
+
+TEST(ScreenNameTableTests, sort_by_name_ignores_interning_order)
+{
+    ScreenNameTable names;
+    ScreenId zeta = names.intern("zeta");
+    ScreenId alpha = names.intern("alpha");
+    ScreenId upper = names.intern("Mike");
+    ScreenId beta = names.intern("beta");
+
+    std::vector<ScreenId> ids{zeta, alpha, upper, beta};
+    names.sort_by_name(ids);
+
+    // case sensitive, like the std::string keyed map clients were kept in
+    EXPECT_EQ((std::vector<ScreenId>{upper, alpha, beta, zeta}), ids);
+}
+
+} // namespace inputleap